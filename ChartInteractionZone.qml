@@ -145,7 +145,9 @@ Rectangle {
             function updateTooltip(mouseX, mouseY) {
                 if (!chartView || !tooltip) return
 
-                let chartPoint = chartView.mapToValue(Qt.point(mouseX, mouseY), chartView.heightSeries)
+                // ناحیه روی plotArea است، نه گوشه‌ی چارت
+                let chartPoint = chartView.mapToValue(root.mapToItem(chartView, mouseX, mouseY),
+                                                      chartView.heightSeries)
                 let closestPoint = findClosestPoint(chartPoint.x)
 
                 if (closestPoint.found) {
@@ -32,10 +32,251 @@ Item {
     property alias bloodGlucoseAxisVisible:     chartView.bloodGlucoseAxisVisible
     property alias oxygenSaturationAxisVisible: chartView.oxygenSaturationAxisVisible
 
-    property var menstruationPeriods: []
+    property var menstruationModel: null
+    property alias periodTimebar: periodTimebar
 
     function findClosestPoint(targetX) { return chartView.findClosestPoint(targetX) }
     function clearAll()                { chartView.clearAll() }
+    // point در مختصات همین Item (ChartView کل آن را پر کرده)
+    function mapToValue(point, series) { return chartView.mapToValue(point, series) }
+
+    // ── پر کردن سری‌ها — از Main.qml (سیگنال‌های Backend) و bench/qml ──
+    // type: HealthMeasurement::Type → سری‌ها و محور چارت همان متریک (Metric::Descriptor در C++)
+    //   series2: سری موازی (diastolic)، scale: واحد نمایش (قد: m → cm)، ceiling: سقف محور
+    function metricView(type) {
+        switch (type) {
+        case 1: return { series: chartView.heightSeries, axis: chartView.heightAxis, scale: 100 }
+        case 2: return { series: chartView.weightSeries, axis: chartView.weightAxis }
+        case 3: return { series: chartView.bpSystolicSeries, series2: chartView.bpDiastolicSeries,
+                         axis: chartView.bpAxis }
+        case 4: return { series: chartView.heartRateSeries, axis: chartView.hrAxis }
+        case 5: return { series: chartView.bloodGlucoseSeries, axis: chartView.bgAxis }
+        case 6: return { series: chartView.oxygenSaturationSeries, axis: chartView.spo2Axis,
+                         ceiling: 100 }
+        }
+        return null
+    }
+
+    // یک صفحه از خواندن صفحه‌ای؛ false یعنی نوع ناشناخته.
+    // ترتیب یک بار برای کل صفحه بررسی می‌شود: صفحه‌ی صعودی بعد از آخرین نقطه
+    // پشت سری اضافه می‌شود، صفحه‌ی هم‌پوشان کل سری را عوض می‌کند (mergeChunk)
+    function appendChunk(type, values, values2) {
+        let view = metricView(type)
+        if (!view)
+            return false
+        if (values.length === 0)
+            return true
+        let n = view.series.count
+        let inOrder = n === 0 || view.series.at(n - 1).x <= values[0].x
+        for (let i = 1; inOrder && i < values.length; i++)
+            inOrder = values[i - 1].x <= values[i].x
+        if (!inOrder)
+            return mergeChunk(view, values, values2)
+        fillSeries(view, values, values2, view.scale || 1)
+        return true
+    }
+
+    // کل سری یک نوع — seriesReplaced (Backend خودش صفحه‌ی هم‌پوشان را merge کرده)
+    function replaceSeries(type, values, values2) {
+        let view = metricView(type)
+        if (!view)
+            return false
+        view.series.clear()
+        if (view.series2)
+            view.series2.clear()
+        fillSeries(view, values, values2, view.scale || 1)
+        return true
+    }
+
+    // بدون Backend (bench/qml): سری یک بار خوانده می‌شود، با صفحه مرتب و جایگزین
+    function mergeChunk(view, values, values2) {
+        let scale = view.scale || 1
+        let rows = []
+        for (let i = 0; i < view.series.count; i++)
+            rows.push({ x: view.series.at(i).x, y: view.series.at(i).y,
+                        y2: view.series2 ? view.series2.at(i).y : 0 })
+        for (let i = 0; i < values.length; i++)
+            rows.push({ x: values[i].x, y: values[i].y * scale,
+                        y2: view.series2 ? values2[i].y : 0 })
+        rows.sort((a, b) => a.x - b.x)   // پایدار: نقطه‌های هم‌زمان به ترتیب رسیدن
+
+        view.series.clear()
+        if (view.series2)
+            view.series2.clear()
+        for (let i = 0; i < rows.length; i++) {
+            view.series.append(rows[i].x, rows[i].y)
+            if (view.series2)
+                view.series2.append(rows[i].x, rows[i].y2)
+        }
+        return true
+    }
+
+    function fillSeries(view, values, values2, scale) {
+        let series = view.series
+        for (let i = 0; i < values.length; i++)
+            series.append(values[i].x, values[i].y * scale)
+        if (view.series2) {
+            for (let i = 0; i < values2.length; i++)
+                view.series2.append(values2[i].x, values2[i].y)
+        }
+    }
+
+    // میانگین هر bucket به جای رکوردهای خام؛
+    // محور از کمینه و بیشینه‌ی bucket ها تنظیم می‌شود
+    function setBuckets(type, avg, avg2, min, max) {
+        let view = metricView(type)
+        if (!view || avg.length === 0)
+            return false
+        let series = view.series
+        let axis = view.axis
+
+        series.clear()
+        if (view.series2)
+            view.series2.clear()
+
+        let lo = min[0].y, hi = max[0].y
+        for (let i = 0; i < avg.length; i++) {
+            series.append(avg[i].x, avg[i].y)
+            if (view.series2)
+                view.series2.append(avg2[i].x, avg2[i].y)
+            if (min[i].y < lo) lo = min[i].y
+            if (max[i].y > hi) hi = max[i].y
+        }
+
+        let margin = (hi - lo) * 0.1 + 1
+        axis.min = lo - margin
+        axis.max = (view.ceiling !== undefined) ? Math.min(hi + margin, view.ceiling) : hi + margin
+
+        let first = new Date(avg[0].x)
+        if (isNaN(chartView.xAxis.min.getTime()) || first < chartView.xAxis.min)
+            chartView.xAxis.min = first
+        return true
+    }
+
+    // هر سری از نو، محور هر متریک از کمینه/بیشینه‌ی خودش — newDataRead
+    function setAllSeries(hList, wList, bpSystolicList, bpDiastolicList, heartRateList, bloodGlucoseList, oxygenSaturationList) {
+        chartView.heightSeries.clear()
+        chartView.weightSeries.clear()
+        chartView.bpSystolicSeries.clear()
+        chartView.bpDiastolicSeries.clear()
+        chartView.heartRateSeries.clear()
+        chartView.bloodGlucoseSeries.clear()
+        chartView.oxygenSaturationSeries.clear()
+
+        let minTime = Number.MAX_VALUE
+
+        if (hList.length > 0) {
+            let minH = 140, maxH = 200
+            minH = (hList[0].y * 100) - 10
+            maxH = (hList[0].y * 100) + 10
+            if(hList[0].x < minTime) minTime = hList[0].x
+            // پردازش داده‌های قد
+            for (let i = 0; i < hList.length; i++) {
+                let hi = hList[i].y * 100
+                chartView.heightSeries.append(hList[i].x, hi)
+                if (hi < minH) minH = hi - 10
+                if (hi > maxH) maxH = hi + 10
+            }
+
+            chartView.heightAxis.min = minH
+            chartView.heightAxis.max = maxH
+        }
+
+        if (wList.length > 0) {
+            let minW = 50, maxW = 120
+            minW = wList[0].y - 1
+            maxW = wList[0].y + 1
+            if(wList[0].x < minTime) minTime = wList[0].x
+            // پردازش داده‌های وزن
+            for (let i = 0; i < wList.length; i++) {
+                let wi = wList[i].y
+                chartView.weightSeries.append(wList[i].x, wi)
+                if (wi < minW) minW = wi - 1
+                if (wi > maxW) maxW = wi + 1
+            }
+
+            chartView.weightAxis.min = minW
+            chartView.weightAxis.max = maxW
+        }
+
+        if (bpDiastolicList.length > 0) {
+            let minBP = 60, maxBP = 140
+            minBP = bpDiastolicList[0].y - 1
+            maxBP = bpSystolicList[0].y + 1
+            if(bpSystolicList[0].x < minTime) minTime = bpSystolicList[0].x
+            // پردازش داده‌های فشار خون
+            for (let i = 0; i < bpSystolicList.length; i++) {
+                chartView.bpSystolicSeries.append(bpSystolicList[i].x, bpSystolicList[i].y)
+                chartView.bpDiastolicSeries.append(bpDiastolicList[i].x, bpDiastolicList[i].y)
+
+                if (bpSystolicList[i].y < minBP) minBP = bpSystolicList[i].y
+                if (bpSystolicList[i].y > maxBP) maxBP = bpSystolicList[i].y
+                if (bpDiastolicList[i].y < minBP) minBP = bpDiastolicList[i].y
+                if (bpDiastolicList[i].y > maxBP) maxBP = bpDiastolicList[i].y
+            }
+
+            let bpMargin = (maxBP - minBP) * 0.1
+            chartView.bpAxis.min = minBP - bpMargin
+            chartView.bpAxis.max = maxBP + bpMargin
+        }
+
+        if (heartRateList.length > 0) {
+            let minHR = 50, maxHR = 120
+            minHR = heartRateList[0].y - 1
+            maxHR = heartRateList[0].y + 1
+            if(heartRateList[0].x < minTime) minTime = heartRateList[0].x
+            // === پردازش ضربان قلب ===
+            console.log("heartRateList siz : " + heartRateList.length)
+            for (let i = 0; i < heartRateList.length; i++) {
+                let hr = heartRateList[i].y
+                chartView.heartRateSeries.append(heartRateList[i].x, hr)
+                if (hr < minHR) minHR = hr - 1
+                if (hr > maxHR) maxHR = hr + 1
+            }
+
+            chartView.hrAxis.min = minHR
+            chartView.hrAxis.max = maxHR
+        }
+
+        if (bloodGlucoseList.length > 0) {
+            let minBG = 70, maxBG = 200
+            minBG = bloodGlucoseList[0].y - 1
+            maxBG = bloodGlucoseList[0].y + 1
+            if(bloodGlucoseList[0].x < minTime) minTime = bloodGlucoseList[0].x
+            // === پردازش قند خون ===
+            for (let i = 0; i < bloodGlucoseList.length; i++) {
+                let bg = bloodGlucoseList[i].y
+                chartView.bloodGlucoseSeries.append(bloodGlucoseList[i].x, bg)
+                if (bg < minBG) minBG = bg - 2
+                if (bg > maxBG) maxBG = bg + 2
+            }
+
+            chartView.bgAxis.min = minBG
+            chartView.bgAxis.max = maxBG
+        }
+
+        if (oxygenSaturationList.length > 0) {
+            let minSpo2 = 85, maxSpo2 = 100
+            minSpo2 = oxygenSaturationList[0].y - 1
+            maxSpo2 = oxygenSaturationList[0].y + 1
+            if(maxSpo2 > 100) maxSpo2 = 100
+            if(oxygenSaturationList[0].x < minTime) minTime = oxygenSaturationList[0].x
+            // پردازش داده‌های SPO2
+            for (let i = 0; i < oxygenSaturationList.length; i++) {
+                let Spoi = oxygenSaturationList[i].y
+                chartView.oxygenSaturationSeries.append(oxygenSaturationList[i].x, Spoi)
+                if (Spoi < minSpo2) minSpo2 = Spoi - 1
+                if (Spoi > maxSpo2) maxSpo2 = Spoi + 1
+            }
+
+            chartView.spo2Axis.min = minSpo2
+            chartView.spo2Axis.max = maxSpo2
+        }
+
+        // تنظیم محدوده محورهای زمان
+        chartView.xAxis.min = new Date(minTime)
+        chartView.xAxis.max = new Date(Date.now())
+    }
 
     // ── ChartView اصلی ──
     ChartView {
@@ -368,7 +609,7 @@ Item {
         z:      2
 
         xAxis:      chartView.xAxis
-        periodData: root.menstruationPeriods
+        model:      root.menstruationModel
 
         // ── DEBUG border ──
         Rectangle {
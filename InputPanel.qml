@@ -22,6 +22,14 @@ Rectangle {
     signal oxygenSaturationSubmitted(double value)
     signal menstruationFlowSubmitted(int flowLevel)
     signal menstruationPeriodEndRequested()
+    signal exportCompressionSelected(int mode)
+    signal exportModeSelected(int mode)
+    signal exportFormatSelected(int format)
+
+    // ── تنظیمات خروجی Excel ──
+    property int exportCompression: 1
+    property int exportMode: 0
+    property int exportFormat: 0
 
     // ── بازه زمانی ──
     signal dateRangePickerRequested(string target, var initialDate)
@@ -1100,6 +1108,149 @@ Rectangle {
             Divider {
                 themeManager: root.themeManager
             }
+
+            // ===== بخش تنظیمات خروجی =====
+            Column {
+                width: parent.width
+                spacing: 10
+
+                Text {
+                    text: "⬇ تنظیمات خروجی Excel"
+                    font.pixelSize: 16
+                    font.bold: true
+                    color: root.themeManager.primaryTextColor
+                    Behavior on color { ColorAnimation { duration: 300 } }
+                }
+
+                Text {
+                    text: "قالب فایل:"
+                    font.pixelSize: 14
+                    color: root.themeManager.secondaryTextColor
+                    Behavior on color { ColorAnimation { duration: 300 } }
+                }
+
+                ComboBox {
+                    id: exportFormatCombo
+                    width: parent.width
+                    // ترتیب مطابق SeriesExporter::Format
+                    model: [
+                        "Excel (xlsx)",
+                        "CSV",
+                        "NDJSON",
+                        "باینری ستونی (hcol)"
+                    ]
+
+                    currentIndex: root.exportFormat
+
+                    background: Rectangle {
+                        color: root.themeManager.inputBackgroundColor
+                        border.color: root.themeManager.inputBorderColor
+                        border.width: 1
+                        radius: 4
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                        Behavior on border.color { ColorAnimation { duration: 300 } }
+                    }
+
+                    contentItem: Text {
+                        text: exportFormatCombo.displayText
+                        font.pixelSize: 14
+                        color: root.themeManager.primaryTextColor
+                        verticalAlignment: Text.AlignVCenter
+                        rightPadding: 30
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                    }
+
+                    onActivated: (index) => root.exportFormatSelected(index)
+                }
+
+                Text {
+                    text: "فشرده‌سازی:"
+                    font.pixelSize: 14
+                    color: root.themeManager.secondaryTextColor
+                    Behavior on color { ColorAnimation { duration: 300 } }
+                }
+
+                ComboBox {
+                    id: exportCompressionCombo
+                    width: parent.width
+                    enabled: root.exportFormat === 0
+                    // ترتیب مطابق ZipRepacker::Compression
+                    model: [
+                        "بدون فشرده‌سازی (سریع‌ترین)",
+                        "سریع",
+                        "حداکثر",
+                        "حداکثر — موازی"
+                    ]
+
+                    currentIndex: root.exportCompression
+
+                    background: Rectangle {
+                        color: root.themeManager.inputBackgroundColor
+                        border.color: root.themeManager.inputBorderColor
+                        border.width: 1
+                        radius: 4
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                        Behavior on border.color { ColorAnimation { duration: 300 } }
+                    }
+
+                    contentItem: Text {
+                        text: exportCompressionCombo.displayText
+                        font.pixelSize: 14
+                        color: root.themeManager.primaryTextColor
+                        verticalAlignment: Text.AlignVCenter
+                        rightPadding: 30
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                    }
+
+                    onActivated: (index) => root.exportCompressionSelected(index)
+                }
+
+                Text {
+                    text: "محدوده‌ی خروجی:"
+                    font.pixelSize: 14
+                    color: root.themeManager.secondaryTextColor
+                    Behavior on color { ColorAnimation { duration: 300 } }
+                }
+
+                ComboBox {
+                    id: exportModeCombo
+                    width: parent.width
+                    enabled: root.exportFormat === 0
+                    // ترتیب مطابق Backend::ExportMode
+                    model: [
+                        "کل بازه‌ی نمایش‌داده‌شده",
+                        "فقط داده‌های جدید — فایل جدا",
+                        "فقط داده‌های جدید — افزودن به فایل تجمعی"
+                    ]
+
+                    currentIndex: root.exportMode
+
+                    background: Rectangle {
+                        color: root.themeManager.inputBackgroundColor
+                        border.color: root.themeManager.inputBorderColor
+                        border.width: 1
+                        radius: 4
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                        Behavior on border.color { ColorAnimation { duration: 300 } }
+                    }
+
+                    contentItem: Text {
+                        text: exportModeCombo.displayText
+                        font.pixelSize: 14
+                        color: root.themeManager.primaryTextColor
+                        verticalAlignment: Text.AlignVCenter
+                        rightPadding: 30
+                        elide: Text.ElideRight
+                        Behavior on color { ColorAnimation { duration: 300 } }
+                    }
+
+                    onActivated: (index) => root.exportModeSelected(index)
+                }
+            }
+
+            Divider {
+                themeManager: root.themeManager
+            }
         }
     }
 
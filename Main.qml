@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick.Controls
+import QtQuick.Dialogs
 
 Rectangle {
     id: mainView
@@ -31,6 +32,10 @@ Rectangle {
     signal setOxygenSaturation(double value,date dt)
     signal setMenstruationFlow(int flowLevel,date dt)
     signal setMenstruationPeriodEnd(date dt)
+    signal setExportCompression(int mode)
+    signal setExportMode(int mode)
+    signal setExportFormat(int format)
+    signal importSignal(string fileUrl)
 
     // ✅ یک tooltip سراسری برای کل برنامه
     GenericTooltip {
@@ -44,10 +49,11 @@ Rectangle {
     HealthChartView {
         id: chartView
         themeManager: appTheme
+        menstruationModel: myBackend.menstruationModel
 
         anchors.left: parent.left
         //anchors.right: parent.right
-        anchors.right: inputPanel.left
+        anchors.right: inputPanelLoader.left
         anchors.bottom: parent.bottom
         anchors.top: controlButtons.bottom
         anchors.topMargin: 5  // فاصله کمی از پایین دکمه‌ها
@@ -147,132 +153,229 @@ Rectangle {
         }
     }
 
+    // ===== خلاصه‌ی آخرین اندازه‌گیری‌ها =====
+    Text {
+        id: latestSummary
+        anchors.left: chartView.left
+        anchors.top: chartView.top
+        anchors.margins: 12
+        z: 2
+        color: appTheme.secondaryTextColor
+        font.pixelSize: 12
+
+        function part(label, reading, digits, unit) {
+            return reading.valid ? label + " " + reading.value.toFixed(digits) + unit : ""
+        }
+
+        text: [
+            part("وزن", myBackend.latestWeight, 1, " kg"),
+            myBackend.latestBloodPressure.valid
+                ? "فشار " + Math.round(myBackend.latestBloodPressure.value) + "/"
+                  + Math.round(myBackend.latestBloodPressure.value2)
+                : "",
+            part("قند", myBackend.latestBloodGlucose, 0, " mg/dL"),
+            part("ضربان", myBackend.latestHeartRate, 0, " bpm"),
+            part("SpO2", myBackend.latestOxygenSaturation, 0, "%")
+        ].filter(s => s.length > 0).join("   ·   ")
+    }
+
     // ===== دکمه باز/بسته پنل =====
     TogglePanelButton {
         themeManager: appTheme
         id: togglePanelBtn
-        panelExpanded: inputPanel.expanded
+        panelExpanded: mainView.panelExpanded
         x: parent.width - (togglePanelBtn.width + 50)
         y: 10
         z: 3
 
         onTogglePanel: {
-            inputPanel.expanded = !inputPanel.expanded
+            inputPanelLoader.active = true
+            mainView.panelExpanded = !mainView.panelExpanded
+        }
+    }
+
+    // ── شروع گرم: محدوده‌ی محورها در snapshot بک‌اند ذخیره می‌شود ──
+    function displayedAxes() {
+        return {
+            "x":      [chartView.xAxis.min.getTime(), chartView.xAxis.max.getTime()],
+            "height": [chartView.heightAxis.min, chartView.heightAxis.max],
+            "weight": [chartView.weightAxis.min, chartView.weightAxis.max],
+            "bp":     [chartView.bpAxis.min, chartView.bpAxis.max],
+            "hr":     [chartView.hrAxis.min, chartView.hrAxis.max],
+            "bg":     [chartView.bgAxis.min, chartView.bgAxis.max],
+            "spo2":   [chartView.spo2Axis.min, chartView.spo2Axis.max]
+        }
+    }
+
+    function applyAxes(axes) {
+        let valueAxes = { "height": chartView.heightAxis, "weight": chartView.weightAxis,
+                          "bp": chartView.bpAxis, "hr": chartView.hrAxis,
+                          "bg": chartView.bgAxis, "spo2": chartView.spo2Axis }
+        for (let key in valueAxes) {
+            if (axes[key] && axes[key].length === 2) {
+                valueAxes[key].min = axes[key][0]
+                valueAxes[key].max = axes[key][1]
+            }
+        }
+        if (axes["x"] && axes["x"].length === 2 && !isNaN(axes["x"][0])) {
+            chartView.xAxis.min = new Date(axes["x"][0])
+            chartView.xAxis.max = new Date(axes["x"][1])
         }
     }
 
     property date publicSelectedDateTime: new Date()
     property var _pendingAction: null  // ✅ نگه‌داری موقت action
 
-    DateTimePicker {
-        id: dateTimePicker
-        themeManager: appTheme
+    // ── پنل‌های سنگین فقط با اولین استفاده ساخته می‌شوند ──
+    property bool panelExpanded: false
+    property bool periodActive: false
 
-        onConfirmed: (selectedDateTime) => {
-            publicSelectedDateTime = selectedDateTime
+    // تاریخ انتخاب‌شده به action داده می‌شود؛ لغو آن را دور می‌ریزد
+    function pickDateTime(initialDate, action) {
+        dateTimePickerLoader.active = true
+        _pendingAction = action
+        dateTimePickerLoader.item.picker.openWithDate(initialDate)
+    }
 
-            // ✅ اجرای action بعد از تأیید کاربر
-            if (_pendingAction) {
-                _pendingAction(selectedDateTime)
-                _pendingAction = null
-            }
-        }
+    // پیام وضعیت ثبت در پنل — اگر پنل هنوز ساخته نشده جایی برای نمایش نیست
+    function setPanelStatus(name, text, color) {
+        let panel = inputPanelLoader.item
+        if (!panel)
+            return
+        panel[name + "StatusText"]  = text
+        panel[name + "StatusColor"] = color
+    }
+
+    // بازه‌ی خواندن؛ تا پنل ساخته نشده همان پیش‌فرض پنل: یک ماه اخیر
+    function rangeFrom() {
+        if (inputPanelLoader.item)
+            return inputPanelLoader.item.getFromDate()
+        let d = new Date()
+        d.setMonth(d.getMonth() - 1)
+        return d
+    }
+
+    function rangeTo() {
+        return inputPanelLoader.item ? inputPanelLoader.item.getToDate() : new Date()
+    }
+
+    Loader {
+        id: dateTimePickerLoader
+        anchors.fill: parent
+        active: false
+        z: 4
+
+        // Popup خودش Item نیست — Loader فقط Item می‌سازد
+        sourceComponent: Item {
+            property alias picker: dateTimePicker
+
+            DateTimePicker {
+                id: dateTimePicker
+                themeManager: appTheme
+
+                onConfirmed: (selectedDateTime) => {
+                    publicSelectedDateTime = selectedDateTime
+
+                    // ✅ اجرای action بعد از تأیید کاربر
+                    if (_pendingAction) {
+                        _pendingAction(selectedDateTime)
+                        _pendingAction = null
+                    }
+                }
 
-        onCancelled: {
-            publicSelectedDateTime = new Date()
-            _pendingAction = null  // پاکسازی
+                onCancelled: {
+                    publicSelectedDateTime = new Date()
+                    _pendingAction = null  // پاکسازی
+                }
+            }
         }
     }
 
     // ===== پنل ورودی =====
-    InputPanel {
-        id: inputPanel
-        themeManager: appTheme
+    Loader {
+        id: inputPanelLoader
         anchors.right: parent.right
         anchors.top: controlButtons.bottom
         anchors.bottom: parent.bottom
-
+        active: false
         z: 3
 
-        onDateRangePickerRequested: (target, initialDate) => {
-            // تنظیم تاریخ پیش‌فرض datepicker با تاریخ فعلی همان textbox
-            dateTimePicker.selectedYear  = initialDate.getFullYear()
-            dateTimePicker.selectedMonth = initialDate.getMonth() + 1
-            dateTimePicker.selectedDay   = initialDate.getDate()
-            dateTimePicker.selectedHour  = initialDate.getHours()
-            dateTimePicker.selectedMinute = initialDate.getMinutes()
-            dateTimePicker.selectedSecond = initialDate.getSeconds()
-
-            _pendingAction = (dt) => {
-                inputPanel.applySelectedDate(dt)
+        sourceComponent: InputPanel {
+            id: inputPanel
+            themeManager: appTheme
+            // پهنا از بیرون؛ parent این‌جا خود Loader است
+            width: mainView.panelExpanded ? (mainView.width / 3) : 0
+            expanded: mainView.panelExpanded
+            periodActive: mainView.periodActive
+
+            exportCompression: myBackend.exportCompression
+            onExportCompressionSelected: (mode) => mainView.setExportCompression(mode)
+            exportMode: myBackend.exportMode
+            onExportModeSelected: (mode) => mainView.setExportMode(mode)
+            exportFormat: myBackend.exportFormat
+            onExportFormatSelected: (format) => mainView.setExportFormat(format)
+
+            onDateRangePickerRequested: (target, initialDate) => {
+                // تنظیم تاریخ پیش‌فرض datepicker با تاریخ فعلی همان textbox
+                pickDateTime(initialDate, (dt) => inputPanel.applySelectedDate(dt))
             }
-            dateTimePicker.openWithDate(initialDate)
-        }
 
-        onHeightSubmitted: (value) => {
-                // ذخیره action به صورت closure
-                _pendingAction = (dt) => {
+            onHeightSubmitted: (value) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setHeight(value, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
             onWeightSubmitted: (value) => {
-                _pendingAction = (dt) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setWeight(value, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
             onHeartRateSubmitted: (bpm) => {
-                _pendingAction = (dt) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setHeartRate(bpm, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
             onBloodPressureSubmitted: (sys, dia) => {
-                _pendingAction = (dt) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setBloodPressure(sys, dia, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
             onBloodGlucoseSubmitted: (glucose, specimen, meal, relation) => {
-                _pendingAction = (dt) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setBloodGlucose(glucose, specimen, meal, relation, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
             onOxygenSaturationSubmitted: (value) => {
-                _pendingAction = (dt) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setOxygenSaturation(value, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
-            onMenstruationFlowSubmitted: (value) =>{
-                _pendingAction = (dt) => {
+            onMenstruationFlowSubmitted: (value) => {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setMenstruationFlow(value, dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
 
-            onMenstruationPeriodEndRequested:{
-                _pendingAction = (dt) => {
+            onMenstruationPeriodEndRequested: {
+                pickDateTime(new Date(Date.now()), (dt) => {
                     loadingOverlay.show()
                     mainView.setMenstruationPeriodEnd(dt)
-                }
-                dateTimePicker.openWithDate(new Date(Date.now()))
+                })
             }
+        }
     }
 
     // ===== دکمه Export =====
@@ -304,6 +407,54 @@ Rectangle {
         }
     }
 
+    // ===== دکمه Import =====
+    CButton {
+        id: importBtn
+        themeManager: appTheme
+
+        text: "⬆ Import"
+        width: 120
+        height: 42
+
+        anchors.left: exportBtn.right
+        anchors.bottom: parent.bottom
+        anchors.margins: 16
+
+        z: 3
+
+        tooltipText: "Import CSV / Excel into Health Connect"
+        tooltipTarget: globalTooltip
+
+        onClicked: importDialog.open()
+    }
+
+    FileDialog {
+        id: importDialog
+        title: "انتخاب فایل برای وارد کردن"
+        nameFilters: ["Health data (*.csv *.xlsx)", "All files (*)"]
+        onAccepted: {
+            loadingOverlay.show("در حال وارد کردن...")
+            mainView.importSignal(selectedFile.toString())
+        }
+    }
+
+    // ===== overlay ی debug: QMLHC_METRICS=1 یا تنظیم debug/metrics =====
+    Loader {
+        active: myBackend.metricsOverlay
+        anchors.left: parent.left
+        anchors.bottom: exportBtn.top
+        anchors.margins: 16
+        z: 50
+
+        sourceComponent: MetricsOverlay {
+            themeManager: appTheme
+            model: myBackend.metrics
+            onDumped: (filePath) => exportToast.showMessage(filePath.length > 0,
+                                                            filePath.length > 0 ? filePath
+                                                                                : "ذخیره‌ی metrics ناموفق بود")
+        }
+    }
+
     Toast {
         id: exportToast
         themeManager: appTheme
@@ -330,7 +481,7 @@ Rectangle {
         onTriggered: {
             mainView.updateSignal(chartView.heightAxisVisible,chartView.weightAxisVisible,chartView.bpAxisVisible,
                                   chartView.bloodGlucoseAxisVisible,chartView.heartRateAxisVisible,chartView.oxygenSaturationAxisVisible,
-                                  inputPanel.getFromDate(),inputPanel.getToDate())
+                                  mainView.rangeFrom(),mainView.rangeTo())
         }
     }
     // ===== Timers برای ریست وضعیت =====
@@ -339,8 +490,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.heightStatusText = ""
-            inputPanel.heightStatusColor = "gray"
+            setPanelStatus("height", "", "gray")
         }
     }
 
@@ -349,8 +499,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.weightStatusText = ""
-            inputPanel.weightStatusColor = "gray"
+            setPanelStatus("weight", "", "gray")
         }
     }
 
@@ -359,8 +508,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.bpStatusText = ""
-            inputPanel.bpStatusColor = "gray"
+            setPanelStatus("bp", "", "gray")
         }
     }
 
@@ -369,8 +517,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.heartRateStatusText = ""
-            inputPanel.heartRateStatusColor = "gray"
+            setPanelStatus("heartRate", "", "gray")
         }
     }
 
@@ -379,8 +526,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.bloodGlucoseStatusText = ""
-            inputPanel.bloodGlucoseStatusColor = "gray"
+            setPanelStatus("bloodGlucose", "", "gray")
         }
     }
 
@@ -389,8 +535,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.oxygenSaturationStatusText = ""
-            inputPanel.oxygenSaturationStatusColor = "gray"
+            setPanelStatus("oxygenSaturation", "", "gray")
         }
     }
 
@@ -399,8 +544,7 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.menstruationStatusText  = ""
-            inputPanel.menstruationStatusColor = "gray"
+            setPanelStatus("menstruation", "", "gray")
         }
     }
 
@@ -409,13 +553,13 @@ Rectangle {
         interval: parent.statusResetDelay
         repeat: false
         onTriggered: {
-            inputPanel.periodEndStatusText  = ""
-            inputPanel.periodEndStatusColor = "gray"
+            setPanelStatus("periodEnd", "", "gray")
         }
     }
 
     // ===== اتصالات Backend =====
     Component.onCompleted: {
+        let trace = myBackend.traceBegin()
         updateSignal.connect(myBackend.onUpdateRequest)
         exportSignal.connect(myBackend.onExportRequest)
         setHeight.connect(myBackend.writeHeight)
@@ -426,8 +570,13 @@ Rectangle {
         setOxygenSaturation.connect(myBackend.writeOxygenSaturation)
         setMenstruationFlow.connect(myBackend.writeMenstruationFlow)
         setMenstruationPeriodEnd.connect(myBackend.writeMenstruationPeriod)
+        setExportCompression.connect(myBackend.setExportCompression)
+        setExportMode.connect(myBackend.setExportMode)
+        setExportFormat.connect(myBackend.setExportFormat)
+        importSignal.connect(myBackend.onImportRequest)
 
         controlButtons.setInitialVisibility(false,true,true,false,true,true)
+        myBackend.traceEnd("Main.onCompleted", trace)
 
         myBackend.onQmlReady()
     }
@@ -447,14 +596,30 @@ Rectangle {
             exportToast.showMessage(success, message)
         }
 
+        function onImportProgress(percent, rowsRead, inserted)
+        {
+            loadingOverlay.show("در حال وارد کردن... " + percent + "%\n" + inserted + " / " + rowsRead)
+        }
+
+        function onImportFinished(success, message)
+        {
+            console.log(message)
+            loadingOverlay.hide()
+            exportToast.showMessage(success, message)
+            startUpdate.restart()
+        }
+
+        // write* ها فوراً پاسخ می‌دهند؛ این فقط وقتی است که Health Connect بعداً رد کند
+        function onWriteRejected(count, message) {
+            console.log(message)
+            exportToast.showMessage(false, message)
+        }
+
         function onHeightWritten(success, message) {
             if (success) {
-                inputPanel.heightStatusText = "✅ قد " + message + " ثبت شد"
-                inputPanel.heightStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("height", "✅ قد " + message + " ثبت شد", "green")
             } else {
-                inputPanel.heightStatusText = "❌ " + message
-                inputPanel.heightStatusColor = "red"
+                setPanelStatus("height", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             heightStatusTimer.restart()  // ← در هر دو حالت تایمر استارت میشه
@@ -462,12 +627,9 @@ Rectangle {
 
         function onWeightWritten(success, message) {
             if (success) {
-                inputPanel.weightStatusText = "✅ وزن " + message + " ثبت شد"
-                inputPanel.weightStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("weight", "✅ وزن " + message + " ثبت شد", "green")
             } else {
-                inputPanel.weightStatusText = "❌ " + message
-                inputPanel.weightStatusColor = "red"
+                setPanelStatus("weight", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             weightStatusTimer.restart()
@@ -475,12 +637,9 @@ Rectangle {
 
         function onBloodPressureWritten(success, message) {
             if (success) {
-                inputPanel.bpStatusText = "✅ فشار خون " + message + " ثبت شد"
-                inputPanel.bpStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("bp", "✅ فشار خون " + message + " ثبت شد", "green")
             } else {
-                inputPanel.bpStatusText = "❌ " + message
-                inputPanel.bpStatusColor = "red"
+                setPanelStatus("bp", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             bpStatusTimer.restart()
@@ -488,12 +647,9 @@ Rectangle {
 
         function onHeartRateWritten(success, message) {
             if (success) {
-                inputPanel.heartRateStatusText = "✅ ضربان قلب " + message + " ثبت شد"
-                inputPanel.heartRateStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("heartRate", "✅ ضربان قلب " + message + " ثبت شد", "green")
             } else {
-                inputPanel.heartRateStatusText = "❌ " + message
-                inputPanel.heartRateStatusColor = "red"
+                setPanelStatus("heartRate", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             heartRateStatusTimer.restart()
@@ -501,12 +657,9 @@ Rectangle {
 
         function onBloodGlucoseWritten(success, message) {
             if (success) {
-                inputPanel.bloodGlucoseStatusText = "✅ قند خون " + message + " ثبت شد"
-                inputPanel.bloodGlucoseStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("bloodGlucose", "✅ قند خون " + message + " ثبت شد", "green")
             } else {
-                inputPanel.bloodGlucoseStatusText = "❌ " + message
-                inputPanel.bloodGlucoseStatusColor = "red"
+                setPanelStatus("bloodGlucose", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             bloodGlucoseStatusTimer.restart()
@@ -514,12 +667,9 @@ Rectangle {
 
         function onOxygenSaturationWritten(success, message) {
             if (success) {
-                inputPanel.oxygenSaturationStatusText = "✅ اکسیژن خون " + message + " ثبت شد"
-                inputPanel.oxygenSaturationStatusColor = "green"
-                startUpdate.restart()
+                setPanelStatus("oxygenSaturation", "✅ اکسیژن خون " + message + " ثبت شد", "green")
             } else {
-                inputPanel.oxygenSaturationStatusText = "❌ " + message
-                inputPanel.oxygenSaturationStatusColor = "red"
+                setPanelStatus("oxygenSaturation", "❌ " + message, "red")
                 loadingOverlay.hide()
             }
             oxygenSaturationTimer.restart()
@@ -527,92 +677,33 @@ Rectangle {
 
         function onMenstruationFlowWritten(success, message) {
             if (success) {
-                inputPanel.menstruationStatusText  = "✅ " + message
-                inputPanel.menstruationStatusColor = "#2E7D32"
-                inputPanel.periodActive = true   // دوره شروع شد
+                setPanelStatus("menstruation", "✅ " + message, "#2E7D32")
+                mainView.periodActive = true   // دوره شروع شد
                 startUpdate.restart()
             } else {
-                inputPanel.menstruationStatusText  = "❌ " + message
-                inputPanel.menstruationStatusColor = "red"
+                setPanelStatus("menstruation", "❌ " + message, "red")
             }
             menstruationStatusTimer.restart()
         }
 
         function onMenstruationPeriodWritten(success, message) {
             if (success) {
-                inputPanel.periodEndStatusText  = "✅ " + message
-                inputPanel.periodEndStatusColor = "#2E7D32"
-                inputPanel.periodActive = false  // دوره تموم شد
+                setPanelStatus("periodEnd", "✅ " + message, "#2E7D32")
+                mainView.periodActive = false  // دوره تموم شد
                 startUpdate.restart()
             } else {
-                inputPanel.periodEndStatusText  = "❌ " + message
-                inputPanel.periodEndStatusColor = "red"
+                setPanelStatus("periodEnd", "❌ " + message, "red")
             }
             periodEndStatusTimer.restart()
         }
 
         function onPeriodStateChanged(state) {
-            inputPanel.periodActive = state
+            mainView.periodActive = state
         }
 
-        function onMenstruationDataRead(jsonData) {
-            console.log("[MAIN] menstruationDataRead raw:", jsonData.substring(0, 200))
-
-            var root
-            try {
-                root = JSON.parse(jsonData)
-            } catch(e) {
-                console.warn("[MAIN] JSON parse error:", e)
-                return
-            }
-
-            var periods = root.periods || []
-            var flows   = root.flows   || []
-
-            console.log("[MAIN] periods:", periods.length, "| flows:", flows.length)
-
-            if (periods.length === 0) {
-                console.log("[MAIN] No menstruation data")
-                chartView.menstruationPeriods = []
-                return
-            }
-
-            var result = []
-            for (var i = 0; i < periods.length; i++) {
-                var p = periods[i]
-
-                // ✅ مستقیم عدد - نه Date، نه String
-                var startMs = p.startMs
-                var endMs   = p.endMs
-
-                if (isNaN(startMs) || isNaN(endMs)) {
-                    console.warn("[MAIN] ❌ NaN ms at period", i)
-                    continue
-                }
-
-                console.log("[MAIN] period[" + i + "]:",
-                            new Date(startMs).toISOString(),
-                            "→", new Date(endMs).toISOString())
-
-                // ── flows مرتبط با این دوره ───────────────────────────
-                var segFlows = []
-                for (var j = 0; j < flows.length; j++) {
-                    var f = flows[j]
-                    if (f.timeMs >= startMs && f.timeMs <= endMs) {
-                        segFlows.push({ time: f.timeMs, level: f.level })
-                    }
-                }
-
-                console.log("[MAIN] period[" + i + "] flows:", segFlows.length)
-
-                result.push({ start: startMs, end: endMs, flows: segFlows })
-            }
-
-            console.log("[MAIN] ✅ menstruationPeriods:", result.length)
-            chartView.menstruationPeriods = result
-        }
-
-        function onNewDataRead(hList, wList, bpSystolicList, bpDiastolicList, heartRateList, bloodGlucoseList, oxygenSaturationList) {
+        // ── خواندن صفحه‌ای: هر صفحه همان لحظه روی چارت می‌آید ──
+        // در پایان فقط محورها (seriesAxesRead)؛ newDataRead فقط snapshot را می‌کشد
+        function onReadStarted() {
             chartView.heightSeries.clear()
             chartView.weightSeries.clear()
             chartView.bpSystolicSeries.clear()
@@ -620,123 +711,67 @@ Rectangle {
             chartView.heartRateSeries.clear()
             chartView.bloodGlucoseSeries.clear()
             chartView.oxygenSaturationSeries.clear()
+        }
 
-            let minTime = Number.MAX_VALUE
-
-            if (hList.length > 0) {
-                let minH = 140, maxH = 200
-                minH = (hList[0].y * 100) - 10
-                maxH = (hList[0].y * 100) + 10
-                if(hList[0].x < minTime) minTime = hList[0].x
-                // پردازش داده‌های قد
-                for (let i = 0; i < hList.length; i++) {
-                    let hi = hList[i].y * 100
-                    chartView.heightSeries.append(hList[i].x, hi)
-                    if (hi < minH) minH = hi - 10
-                    if (hi > maxH) maxH = hi + 10
-                }
-
-                chartView.heightAxis.min = minH
-                chartView.heightAxis.max = maxH
-            }
-
-            if (wList.length > 0) {
-                let minW = 50, maxW = 120
-                minW = wList[0].y - 1
-                maxW = wList[0].y + 1
-                if(wList[0].x < minTime) minTime = wList[0].x
-                // پردازش داده‌های وزن
-                for (let i = 0; i < wList.length; i++) {
-                    let wi = wList[i].y
-                    chartView.weightSeries.append(wList[i].x, wi)
-                    if (wi < minW) minW = wi - 1
-                    if (wi > maxW) maxW = wi + 1
-                }
-
-                chartView.weightAxis.min = minW
-                chartView.weightAxis.max = maxW
-            }
-
-            if (bpDiastolicList.length > 0) {
-                let minBP = 60, maxBP = 140
-                minBP = bpDiastolicList[0].y - 1
-                maxBP = bpSystolicList[0].y + 1
-                if(bpSystolicList[0].x < minTime) minTime = bpSystolicList[0].x
-                // پردازش داده‌های فشار خون
-                for (let i = 0; i < bpSystolicList.length; i++) {
-                    chartView.bpSystolicSeries.append(bpSystolicList[i].x, bpSystolicList[i].y)
-                    chartView.bpDiastolicSeries.append(bpDiastolicList[i].x, bpDiastolicList[i].y)
-
-                    if (bpSystolicList[i].y < minBP) minBP = bpSystolicList[i].y
-                    if (bpSystolicList[i].y > maxBP) maxBP = bpSystolicList[i].y
-                    if (bpDiastolicList[i].y < minBP) minBP = bpDiastolicList[i].y
-                    if (bpDiastolicList[i].y > maxBP) maxBP = bpDiastolicList[i].y
-                }
-
-                let bpMargin = (maxBP - minBP) * 0.1
-                chartView.bpAxis.min = minBP - bpMargin
-                chartView.bpAxis.max = maxBP + bpMargin
-            }
-
-            if (heartRateList.length > 0) {
-                let minHR = 50, maxHR = 120
-                minHR = heartRateList[0].y - 1
-                maxHR = heartRateList[0].y + 1
-                if(heartRateList[0].x < minTime) minTime = heartRateList[0].x
-                // === پردازش ضربان قلب ===
-                console.log("heartRateList siz : " + heartRateList.length)
-                for (let i = 0; i < heartRateList.length; i++) {
-                    let hr = heartRateList[i].y
-                    chartView.heartRateSeries.append(heartRateList[i].x, hr)
-                    if (hr < minHR) minHR = hr - 1
-                    if (hr > maxHR) maxHR = hr + 1
-                }
+        function onSeriesChunkRead(type, values, values2) {
+            let trace = myBackend.traceBegin()
+            if (!chartView.appendChunk(type, values, values2))
+                return
+            myBackend.traceEnd("appendChunk", trace)
+            loadingOverlay.hide()
+        }
 
-                chartView.hrAxis.min = minHR
-                chartView.hrAxis.max = maxHR
-            }
+        // صفحه‌ای که با نقطه‌های قبلی هم‌پوشانی دارد: سری merge شده از Backend
+        function onSeriesReplaced(type, values, values2) {
+            let trace = myBackend.traceBegin()
+            if (!chartView.replaceSeries(type, values, values2))
+                return
+            myBackend.traceEnd("replaceSeries", trace)
+            loadingOverlay.hide()
+        }
 
-            if (bloodGlucoseList.length > 0) {
-                let minBG = 70, maxBG = 200
-                minBG = bloodGlucoseList[0].y - 1
-                maxBG = bloodGlucoseList[0].y + 1
-                if(bloodGlucoseList[0].x < minTime) minTime = bloodGlucoseList[0].x
-                // === پردازش قند خون ===
-                for (let i = 0; i < bloodGlucoseList.length; i++) {
-                    let bg = bloodGlucoseList[i].y
-                    chartView.bloodGlucoseSeries.append(bloodGlucoseList[i].x, bg)
-                    if (bg < minBG) minBG = bg - 2
-                    if (bg > maxBG) maxBG = bg + 2
-                }
+        function onSeriesAxesRead(axes) {
+            mainView.applyAxes(axes)
+            loadingOverlay.hide()
+            myBackend.setDisplayedAxes(mainView.displayedAxes())
+        }
 
-                chartView.bgAxis.min = minBG
-                chartView.bgAxis.max = maxBG
-            }
+        // بازه‌های طولانی: میانگین هر bucket به جای رکوردهای خام
+        function onBucketSeriesRead(type, avg, avg2, min, max) {
+            let trace = myBackend.traceBegin()
+            if (!chartView.setBuckets(type, avg, avg2, min, max))
+                return
+            myBackend.traceEnd("appendBuckets", trace)
+            loadingOverlay.hide()
+            myBackend.setDisplayedAxes(mainView.displayedAxes())
+        }
 
-            if (oxygenSaturationList.length > 0) {
-                let minSpo2 = 85, maxSpo2 = 100
-                minSpo2 = oxygenSaturationList[0].y - 1
-                maxSpo2 = oxygenSaturationList[0].y + 1
-                if(maxSpo2 > 100) maxSpo2 = 100
-                if(oxygenSaturationList[0].x < minTime) minTime = oxygenSaturationList[0].x
-                // پردازش داده‌های SPO2
-                for (let i = 0; i < oxygenSaturationList.length; i++) {
-                    let Spoi = oxygenSaturationList[i].y
-                    chartView.oxygenSaturationSeries.append(oxygenSaturationList[i].x, Spoi)
-                    if (Spoi < minSpo2) minSpo2 = Spoi - 1
-                    if (Spoi > maxSpo2) maxSpo2 = Spoi + 1
-                }
+        // snapshot آخرین اجرا قبل از اولین فریم کشیده شد؛ خواندن واقعی در پس‌زمینه
+        function onSnapshotRestored(axes, savedAtMs) {
+            mainView.applyAxes(axes)
+            myBackend.setDisplayedAxes(mainView.displayedAxes())
+            console.log("🧊 snapshot from", new Date(savedAtMs))
+            startUpdate.restart()
+        }
 
-                chartView.spo2Axis.min = minSpo2
-                chartView.spo2Axis.max = maxSpo2
+        function onReadFinished(complete, message) {
+            if (!complete) {
+                // بدون دسترسی seriesAxesRead نمی‌آید
+                loadingOverlay.hide()
+                console.log("⚠️ incomplete read:", message)
+                exportToast.showMessage(false, "بخشی از داده‌ها خوانده نشد\n" + message)
             }
+        }
 
-            // تنظیم محدوده محورهای زمان
-            chartView.xAxis.min = new Date(minTime)
-            chartView.xAxis.max = new Date(Date.now())
-
+        // snapshot ی آخرین اجرا: همه‌ی سری‌ها از نو
+        function onNewDataRead(hList, wList, bpSystolicList, bpDiastolicList, heartRateList, bloodGlucoseList, oxygenSaturationList) {
+            let trace = myBackend.traceBegin()
+            chartView.setAllSeries(hList, wList, bpSystolicList, bpDiastolicList,
+                                   heartRateList, bloodGlucoseList, oxygenSaturationList)
+            myBackend.traceEnd("rebuildSeries", trace)
 
             loadingOverlay.hide()
+            myBackend.setDisplayedAxes(mainView.displayedAxes())
         }
     }
 }
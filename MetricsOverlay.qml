@@ -0,0 +1,108 @@
+import QtQuick
+
+// ── overlay ی debug: صدک‌های تأخیر هر مرحله (StageMetrics) ──
+// فقط با QMLHC_METRICS=1 یا تنظیم debug/metrics ساخته می‌شود
+Rectangle {
+    id: root
+
+    required property var themeManager
+    property var model: null          // Backend.metrics
+
+    signal dumped(string filePath)
+
+    width: 430
+    height: header.height + list.contentHeight + memory.height + 20
+    radius: 8
+    color: themeManager.isDarkMode ? "#CC000000" : "#CCFFFFFF"
+    border.color: root.themeManager.panelBorderColor
+    border.width: 1
+
+    // فقط وقتی دیده می‌شود model هر ثانیه به‌روز می‌شود
+    Binding {
+        target: root.model
+        property: "active"
+        value: root.visible
+        when: root.model !== null
+    }
+
+    function fmt(ms) {
+        return ms < 10 ? ms.toFixed(2) : ms < 100 ? ms.toFixed(1) : Math.round(ms).toString()
+    }
+
+    function mb(bytes) {
+        return (bytes / (1024 * 1024)).toFixed(1)
+    }
+
+    Row {
+        id: header
+        x: 8; y: 8
+        spacing: 8
+
+        Text {
+            text: "📈 stage · n · p50 / p90 / p99 / max ms · items/s"
+            font.pixelSize: 11
+            font.family: "monospace"
+            color: root.themeManager.primaryTextColor
+            anchors.verticalCenter: parent.verticalCenter
+        }
+
+        CButton {
+            themeManager: root.themeManager
+            text: "dump"
+            width: 56
+            height: 24
+            onClicked: root.dumped(myBackend.dumpMetrics())
+        }
+    }
+
+    ListView {
+        id: list
+        x: 8
+        anchors.top: header.bottom
+        anchors.topMargin: 4
+        width: parent.width - 16
+        height: contentHeight
+        interactive: false
+        model: root.model
+
+        delegate: Text {
+            required property string name
+            required property var count
+            required property real p50Ms
+            required property real p90Ms
+            required property real p99Ms
+            required property real maxMs
+            required property real rate
+
+            width: ListView.view.width
+            font.pixelSize: 11
+            font.family: "monospace"
+            color: root.themeManager.primaryTextColor
+            text: name.padEnd(15) + String(count).padStart(6) + "  "
+                  + root.fmt(p50Ms) + " / " + root.fmt(p90Ms) + " / "
+                  + root.fmt(p99Ms) + " / " + root.fmt(maxMs)
+                  + "  " + Math.round(rate)
+        }
+    }
+
+    // ── حافظه‌ی سری‌ها (Backend.memoryUsage) ──
+    Text {
+        id: memory
+        x: 8
+        anchors.top: list.bottom
+        anchors.topMargin: 4
+        width: parent.width - 16
+        font.pixelSize: 11
+        font.family: "monospace"
+        color: root.themeManager.secondaryTextColor
+        wrapMode: Text.WordWrap
+
+        readonly property var usage: myBackend.memoryUsage
+        text: "💾 cache " + root.mb(usage.totalBytes) + " / " + root.mb(usage.budgetBytes) + " MB"
+              + " (packed " + root.mb(usage.packedBytes) + ", coarse " + root.mb(usage.coarseBytes) + ")"
+              + " · live " + root.mb(usage.liveBytes) + " MB"
+              + " · " + usage.residentWindows + "/" + usage.windows + " windows"
+              + " · hit " + usage.hits + " miss " + usage.misses
+              + " · evicted " + usage.evictions
+    }
+}
@@ -6,7 +6,7 @@ Canvas {
 
     // ── ورودی‌ها ──────────────────────────────────────────────
     property var xAxis: null
-    property var periodData: []
+    property var model: null      // Backend.menstruationModel
 
     // ── ظاهر ──────────────────────────────────────────────────
     property real barHeight:    10
@@ -27,11 +27,12 @@ Canvas {
         function onMaxChanged() { root.requestPaint() }
     }
 
-    onPeriodDataChanged: {
-        console.log("[PTB] periodData changed, length=",
-                    periodData ? periodData.length : "null")
-        requestPaint()
+    Connections {
+        target: root.model
+        function onModelReset() { root.requestPaint() }
     }
+
+    onModelChanged:  requestPaint()
     onWidthChanged:  requestPaint()
     onHeightChanged: requestPaint()
 
@@ -65,11 +66,9 @@ Canvas {
             return
         }
 
-        // ── Guard 2: periodData ──
-        if (!periodData || periodData.length === 0) {
-            console.warn("[PTB] SKIP: periodData empty")
+        // ── Guard 2: model ──
+        if (!model || model.count === 0)
             return
-        }
 
         // ── Guard 3: ابعاد ──
         if (width <= 0 || height <= 0) {
@@ -85,9 +84,6 @@ Canvas {
                    ? xAxis.max.getTime()
                    : Number(xAxis.max)
 
-        console.log("[PTB] xMin ms =", xMin, "→", new Date(xMin).toISOString())
-        console.log("[PTB] xMax ms =", xMax, "→", new Date(xMax).toISOString())
-
         // ── Guard 4: xRange ──
         var xRange = xMax - xMin
         if (xRange <= 0) {
@@ -97,69 +93,29 @@ Canvas {
 
         var barY = height - barHeight - bottomMargin
 
-        // ── رسم دوره‌ها ──
-        for (var i = 0; i < periodData.length; i++) {
-            var period = periodData[i]
-
-            var pStart = (period.start instanceof Date)
-                         ? period.start.getTime()
-                         : Number(period.start)
-            var pEnd   = (period.end instanceof Date)
-                         ? period.end.getTime()
-                         : Number(period.end)
-
-            console.log("[PTB] period[" + i + "]:",
-                        new Date(pStart).toISOString(), "→",
-                        new Date(pEnd).toISOString())
-
-            if (isNaN(pStart) || isNaN(pEnd)) {
-                console.warn("[PTB] NaN! start=", period.start, "end=", period.end)
-                continue
-            }
-
-            if (pEnd < xMin || pStart > xMax) {
-                console.warn("[PTB] period[" + i + "] OUT OF RANGE")
-                continue
-            }
-
-            var flows = period.flows
-
-            // ── بدون flow: رنگ پیش‌فرض ──
-            if (!flows || flows.length === 0) {
-                var cs  = Math.max(pStart, xMin)
-                var ce  = Math.min(pEnd,   xMax)
-                var rx  = (cs - xMin) / xRange * width
-                var rw  = Math.max((ce - cs) / xRange * width, 4)
+        // ── فقط بخش‌های داخل محور؛ گروه‌بندی flow ها در C++ انجام شده ──
+        // [start, end, level, ...] — level = -1 یعنی دوره‌ی بدون flow
+        var segs = model.segments(xMin, xMax)
+        for (var i = 0; i < segs.length; i += 3) {
+            var level = segs[i + 2]
+            var cs = Math.max(segs[i],     xMin)
+            var ce = Math.min(segs[i + 1], xMax)
 
+            if (level < 0) {
+                // ── بدون flow: رنگ پیش‌فرض ──
                 ctx.fillStyle = "#88E91E8C"
-                drawRoundRect(ctx, rx, barY, rw, barHeight, barRadius)
+                drawRoundRect(ctx, (cs - xMin) / xRange * width, barY,
+                              Math.max((ce - cs) / xRange * width, 4), barHeight, barRadius)
                 ctx.fill()
                 continue
             }
 
-            // ── رسم بخش‌های flow ──
-            for (var j = 0; j < flows.length; j++) {
-                var segStart = (j === 0)
-                               ? pStart
-                               : Number(flows[j - 1].time)
-                var segEnd   = (j === flows.length - 1)
-                               ? pEnd
-                               : Number(flows[j].time)
-                var level    = Math.min(Math.max(Number(flows[j].level), 0), 3)
-
-                var cs2 = Math.max(segStart, xMin)
-                var ce2 = Math.min(segEnd,   xMax)
-                if (ce2 <= cs2) continue
-
-                var sx = (cs2 - xMin) / xRange * width
-                var sw = Math.max((ce2 - cs2) / xRange * width, 2)
-
-                ctx.fillStyle = flowColors[level]
-                drawRoundRect(ctx, sx, barY, sw, barHeight, barRadius)
-                ctx.fill()
-            }
-        }
+            if (ce <= cs) continue
 
-        console.log("[PTB] paint done ✅")
+            ctx.fillStyle = flowColors[level]
+            drawRoundRect(ctx, (cs - xMin) / xRange * width, barY,
+                          Math.max((ce - cs) / xRange * width, 2), barHeight, barRadius)
+            ctx.fill()
+        }
     }
 }
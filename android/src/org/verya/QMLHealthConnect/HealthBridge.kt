@@ -7,6 +7,7 @@ import android.util.Log
 
 import androidx.health.connect.client.HealthConnectClient
 import androidx.health.connect.client.permission.HealthPermission
+import androidx.health.connect.client.request.AggregateGroupByDurationRequest
 import androidx.health.connect.client.request.ReadRecordsRequest
 import androidx.health.connect.client.time.TimeRangeFilter
 
@@ -28,31 +29,57 @@ import androidx.health.connect.client.units.Pressure
 import androidx.health.connect.client.units.BloodGlucose
 import androidx.health.connect.client.units.Percentage
 
+import kotlin.reflect.KClass
+
 import kotlinx.coroutines.*
 import kotlinx.coroutines.delay
-import kotlinx.coroutines.sync.Mutex
-import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.coroutines.sync.withPermit
 
 import org.json.JSONArray
 import org.json.JSONObject
 
+import java.time.Duration
 import java.time.Instant
 import java.time.ZoneId
-import java.time.temporal.ChronoUnit
 
 object HealthBridge {
 
     private const val TAG = "HealthBridge"
     const val REQUEST_CODE_PERMISSIONS = 1001
 
-    private const val SPECIMEN_SOURCE_CAPILLARY_BLOOD = 1
-    private const val MEAL_TYPE_UNKNOWN = 0
-    private const val RELATION_TO_MEAL_GENERAL = 0
+    // ── streamRecords: اندازه‌ی صفحه بر اساس زمان پاسخ تنظیم می‌شود ──
+    private const val MIN_PAGE_SIZE    = 200
+    private const val MAX_PAGE_SIZE    = 5000
+    private const val TARGET_PAGE_MS   = 400L
+
+    // shard های ShardedReader در C++ هم‌زمان می‌خوانند؛ بیشتر از این
+    // تعداد readRecords موازی به rate limit در Health Connect می‌خورد
+    private const val MAX_CONCURRENT_READS = 3
+
+    // ── writeBatch: نوع رکورد — هم‌شماره با HealthMeasurement::Type در C++ ──
+    private const val BATCH_HEIGHT            = 1
+    private const val BATCH_WEIGHT            = 2
+    private const val BATCH_BLOOD_PRESSURE    = 3
+    private const val BATCH_HEART_RATE        = 4
+    private const val BATCH_BLOOD_GLUCOSE     = 5
+    private const val BATCH_OXYGEN_SATURATION = 6
+    private const val BATCH_MENSTRUATION_FLOW   = 7
+    private const val BATCH_MENSTRUATION_PERIOD = 8
+
+    // ── writeBatch: وضعیت هر آیتم — هم‌شماره با Backend::WriteStatus ──
+    private const val ITEM_OK       = 0
+    private const val ITEM_INVALID  = 1
+    private const val ITEM_FAILED   = 2
+    private const val ITEM_DENIED   = 3
+
+    // رکورد در هر insertRecords
+    private const val BATCH_CHUNK_SIZE = 500
 
-    // ── سراسری: حداکثر صفحات برای همه توابع read ─────────────────
-    private const val MAX_PAGES = 30
+    private val readPermits = Semaphore(MAX_CONCURRENT_READS)
 
-    private val readMutex = Mutex()
+    // آخرین اندازه‌ی صفحه‌ی موفق — بین stream ها و shard ها مشترک
+    @Volatile private var streamPageSize = 1000
 
     // ══════════════════════════════════════════════════════════════
     // منبع واحد حقیقت برای مجوزها
@@ -99,7 +126,7 @@ object HealthBridge {
 
         repeat(maxRetries) {
             try {
-                return readMutex.withLock {
+                return readPermits.withPermit {
                     client.readRecords(request)
                 }
             } catch (e: Exception) {
@@ -297,687 +324,551 @@ object HealthBridge {
     }
 
     // ─────────────────────────────────────────────────────────────
-    // READ HEIGHT — با pagination
+    // STREAM RECORDS — صفحه به صفحه به C++
+    // هر صفحه همان لحظه با nativeOnPage تحویل داده می‌شود؛ چیزی در
+    // Kotlin جمع نمی‌شود و سقف تعداد صفحه وجود ندارد.
+    //   type    : BATCH_*
+    //   values  : height m / weight kg / systolic / bpm / mg/dL / SpO2 %
+    //   values2 : BP → diastolic
+    //   extras  : BG → specimen | meal<<8 | relation<<16
+    // خروجی: {"status":"COMPLETE|TRUNCATED|CANCELLED","records":n,"pages":n}
+    // یا SECURITY_ERROR / ERROR: ...
     // ─────────────────────────────────────────────────────────────
     @JvmStatic
-    fun readHeight(
-        startTime: String? = null,
-        endTime: String? = null
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            val pointMap = sortedMapOf<Instant, Double>()
-            var pageToken: String? = null
-            var pageCount = 0
-
-            do {
-                val request = ReadRecordsRequest(
-                    recordType = HeightRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
-                }
-
-                response.records.forEach { record ->
-                    pointMap[record.time] = record.height.inMeters
-                }
-
-                val newToken = response.pageToken
-                pageCount++
-
-                if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ Height: pageToken unchanged — SDK bug detected. Stopping.")
-                    break
-                }
-                pageToken = newToken
-
-            } while (pageToken != null && pageCount < MAX_PAGES)
-
-            if (pointMap.isEmpty()) return "NO_HEIGHT_DATA"
-
-            val arr = JSONArray()
-            pointMap.forEach { (time, meters) ->
-                arr.put(JSONObject().apply {
-                    put("height_m", meters)
-                    put("time", time.toString())
-                })
+    private external fun nativeOnPage(
+        requestId: Long, type: Int, count: Int,
+        timesMs: LongArray, values: DoubleArray, values2: DoubleArray, extras: IntArray
+    ): Boolean
+
+    // آرایه‌های یک صفحه — بین صفحه‌ها دوباره استفاده می‌شوند
+    private class PageBuffer {
+        var count = 0
+        var timesMs = LongArray(streamPageSize)
+        var values  = DoubleArray(streamPageSize)
+        var values2 = DoubleArray(streamPageSize)
+        var extras  = IntArray(streamPageSize)
+
+        fun add(time: Instant, value: Double, value2: Double = 0.0, extra: Int = 0) {
+            // یک رکورد ضربان قلب می‌تواند چند نمونه داشته باشد
+            if (count == timesMs.size) {
+                val size = count * 2
+                timesMs = timesMs.copyOf(size)
+                values  = values.copyOf(size)
+                values2 = values2.copyOf(size)
+                extras  = extras.copyOf(size)
             }
-            arr.toString()
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading height", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading height", e)
-            "ERROR: ${e.message}"
+            timesMs[count] = time.toEpochMilli()
+            values[count]  = value
+            values2[count] = value2
+            extras[count]  = extra
+            count++
         }
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // WRITE HEIGHT
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeHeight(heightMeters: Double, timeIso: String): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            if (heightMeters < 0.1 || heightMeters > 3.0)
-                return "ERROR: Invalid height ($heightMeters). Must be 0.1-3.0 m"
-
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-            val record = HeightRecord(
-                height = Length.meters(heightMeters),
-                time = instant,
-                zoneOffset = zoneOffset
-            )
-            runBlocking(Dispatchers.IO) { client.insertRecords(listOf(record)) }
-            "SUCCESS: Height $heightMeters m saved at $instant"
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error writing height", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing height", e)
-            "ERROR: ${e.message}"
-        }
+    // صفحه‌ی سریع → بزرگ‌تر (رفت‌وبرگشت کمتر)، صفحه‌ی کند → کوچک‌تر (اولین نقطه زودتر روی چارت)
+    private fun adaptPageSize(records: Int, elapsedMs: Long) {
+        if (records < streamPageSize / 2) return   // صفحه‌ی آخر نیمه‌پر، معیار خوبی نیست
+        val perRecordMs = elapsedMs.coerceAtLeast(1L).toDouble() / records
+        val ideal = (TARGET_PAGE_MS / perRecordMs).toInt().coerceIn(MIN_PAGE_SIZE, MAX_PAGE_SIZE)
+        streamPageSize = (streamPageSize + ideal) / 2
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // READ WEIGHT — با pagination
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun readWeight(
-        startTime: String? = null,
-        endTime: String? = null
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            val pointMap = sortedMapOf<Instant, Double>()
-            var pageToken: String? = null
-            var pageCount = 0
-
-            do {
-                val request = ReadRecordsRequest(
-                    recordType = WeightRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
-                }
-
-                response.records.forEach { record ->
-                    pointMap[record.time] = record.weight.inKilograms
-                }
-
-                val newToken = response.pageToken
-                pageCount++
-
-                if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ Weight: pageToken unchanged — SDK bug detected. Stopping.")
-                    break
-                }
-                pageToken = newToken
-
-            } while (pageToken != null && pageCount < MAX_PAGES)
-
-            if (pointMap.isEmpty()) return "NO_WEIGHT_DATA"
-
-            val arr = JSONArray()
-            pointMap.forEach { (time, kg) ->
-                arr.put(JSONObject().apply {
-                    put("weight_kg", kg)
-                    put("time", time.toString())
-                })
-            }
-            arr.toString()
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading weight", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading weight", e)
-            "ERROR: ${e.message}"
-        }
+    // یک صفحه از یک نوع در buffer؛ خروجی pageToken صفحه‌ی بعد
+    private suspend fun <T : Record> readPageInto(
+        client: HealthConnectClient,
+        recordType: KClass<T>,
+        filter: TimeRangeFilter,
+        ascending: Boolean,
+        pageSize: Int,
+        pageToken: String?,
+        buffer: PageBuffer,
+        mapper: (T, PageBuffer) -> Unit
+    ): String? {
+        val request = ReadRecordsRequest(
+            recordType = recordType,
+            timeRangeFilter = filter,
+            ascendingOrder = ascending,
+            pageSize = pageSize,
+            pageToken = pageToken
+        )
+        val response = safeReadBlocking(client, request)
+        response.records.forEach { mapper(it, buffer) }
+        return response.pageToken
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // WRITE WEIGHT
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeWeight(weightKg: Double, timeIso: String): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            if (weightKg < 0.1 || weightKg > 300.0)
-                return "ERROR: Invalid weight ($weightKg). Must be 0.1-300 kg"
-
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-            val record = WeightRecord(
-                weight = Mass.kilograms(weightKg),
-                time = instant,
-                zoneOffset = zoneOffset
-            )
-            runBlocking(Dispatchers.IO) { client.insertRecords(listOf(record)) }
-            "SUCCESS: Weight $weightKg kg saved at $instant"
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error writing weight", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing weight", e)
-            "ERROR: ${e.message}"
+    // نوع BATCH_* → کلاس رکورد و نگاشت به values/values2/extras
+    private suspend fun readTypePage(
+        client: HealthConnectClient,
+        type: Int,
+        filter: TimeRangeFilter,
+        ascending: Boolean,
+        pageSize: Int,
+        pageToken: String?,
+        buffer: PageBuffer
+    ): String? = when (type) {
+        BATCH_HEIGHT -> readPageInto(client, HeightRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            b.add(r.time, r.height.inMeters)
+        }
+        BATCH_WEIGHT -> readPageInto(client, WeightRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            b.add(r.time, r.weight.inKilograms)
+        }
+        BATCH_BLOOD_PRESSURE -> readPageInto(client, BloodPressureRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            b.add(r.time, r.systolic.inMillimetersOfMercury, r.diastolic.inMillimetersOfMercury)
+        }
+        BATCH_HEART_RATE -> readPageInto(client, HeartRateRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            r.samples.forEach { b.add(it.time, it.beatsPerMinute.toDouble()) }
+        }
+        BATCH_BLOOD_GLUCOSE -> readPageInto(client, BloodGlucoseRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            b.add(r.time, r.level.inMilligramsPerDeciliter, 0.0,
+                  (r.specimenSource and 0xFF) or
+                  ((r.mealType and 0xFF) shl 8) or
+                  ((r.relationToMeal and 0xFF) shl 16))
         }
+        BATCH_OXYGEN_SATURATION -> readPageInto(client, OxygenSaturationRecord::class, filter, ascending, pageSize, pageToken, buffer) { r, b ->
+            b.add(r.time, r.percentage.value)
+        }
+        else -> throw IllegalArgumentException("Unknown type $type")
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // READ BLOOD PRESSURE — با pagination
-    // ─────────────────────────────────────────────────────────────
     @JvmStatic
-    fun readBloodPressure(
-        startTime: String? = null,
-        endTime: String? = null
-    ): String {
+    fun streamRecords(type: Int, startTime: String?, endTime: String?, requestId: Long): String {
         val client = healthConnectClient ?: return "CLIENT_NULL"
         return try {
-            data class BPPoint(val sys: Double, val dia: Double)
-            val pointMap = sortedMapOf<Instant, BPPoint>()
+            val filter = createTimeFilter(startTime, endTime)
+            val buffer = PageBuffer()
             var pageToken: String? = null
-            var pageCount = 0
+            var pages = 0
+            var records = 0L
+            var status = "COMPLETE"
 
             do {
-                val request = ReadRecordsRequest(
-                    recordType = BloodPressureRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
+                buffer.count = 0
+                val started = System.nanoTime()
+                val newToken = runBlocking(Dispatchers.IO) {
+                    readTypePage(client, type, filter, true, streamPageSize, pageToken, buffer)
                 }
-
-                response.records.forEach { record ->
-                    pointMap[record.time] = BPPoint(
-                        record.systolic.inMillimetersOfMercury,
-                        record.diastolic.inMillimetersOfMercury
-                    )
+                adaptPageSize(buffer.count, (System.nanoTime() - started) / 1_000_000)
+                pages++
+                records += buffer.count
+
+                if (buffer.count > 0 &&
+                    !nativeOnPage(requestId, type, buffer.count,
+                                  buffer.timesMs, buffer.values, buffer.values2, buffer.extras)) {
+                    status = "CANCELLED"
+                    break
                 }
 
-                val newToken = response.pageToken
-                pageCount++
-
                 if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ BP: pageToken unchanged — SDK bug detected. Stopping.")
+                    Log.w(TAG, "⚠️ stream $type: pageToken unchanged — SDK bug detected. Stopping.")
+                    status = "TRUNCATED"
                     break
                 }
                 pageToken = newToken
 
-            } while (pageToken != null && pageCount < MAX_PAGES)
+            } while (pageToken != null)
 
-            if (pointMap.isEmpty()) return "NO_BLOOD_PRESSURE_DATA"
-
-            val arr = JSONArray()
-            pointMap.forEach { (time, bp) ->
-                arr.put(JSONObject().apply {
-                    put("systolic", bp.sys)
-                    put("diastolic", bp.dia)
-                    put("time", time.toString())
-                })
-            }
-            arr.toString()
+            JSONObject().apply {
+                put("status", status)
+                put("records", records)
+                put("pages", pages)
+            }.toString()
 
         } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading blood pressure", e)
+            Log.e(TAG, "❌ Security error streaming type $type", e)
             "SECURITY_ERROR"
         } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading blood pressure", e)
+            Log.e(TAG, "❌ Error streaming type $type", e)
             "ERROR: ${e.message}"
         }
     }
 
     // ─────────────────────────────────────────────────────────────
-    // WRITE BLOOD PRESSURE
+    // LATEST RECORDS — آخرین count رکورد هر نوع، نزولی
+    // همه‌ی نوع‌ها هم‌زمان و هر کدام با یک صفحه‌ی کوچک خوانده می‌شوند؛
+    // هزینه مستقل از طول تاریخچه است. برای هر نوع یک nativeOnPage.
+    // خروجی مثل streamRecords
     // ─────────────────────────────────────────────────────────────
     @JvmStatic
-    fun writeBloodPressure(systolicMmHg: Double, diastolicMmHg: Double, timeIso: String): String {
+    fun latestRecords(types: IntArray, count: Int, requestId: Long): String {
         val client = healthConnectClient ?: return "CLIENT_NULL"
         return try {
-            if (systolicMmHg < 80 || systolicMmHg > 200)
-                return "ERROR: Invalid systolic ($systolicMmHg). Must be 80-200 mmHg"
-            if (diastolicMmHg < 40 || diastolicMmHg > 130)
-                return "ERROR: Invalid diastolic ($diastolicMmHg). Must be 40-130 mmHg."
-            if (systolicMmHg <= diastolicMmHg)
-                return "ERROR: Systolic must be > diastolic"
-
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-            val record = BloodPressureRecord(
-                systolic = Pressure.millimetersOfMercury(systolicMmHg),
-                diastolic = Pressure.millimetersOfMercury(diastolicMmHg),
-                time = instant,
-                zoneOffset = zoneOffset
-            )
-            runBlocking(Dispatchers.IO) { client.insertRecords(listOf(record)) }
-            "SUCCESS: BP $systolicMmHg/$diastolicMmHg saved at $instant"
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing BP", e)
-            "ERROR: ${e.message}"
-        }
-    }
-
-    // ─────────────────────────────────────────────────────────────
-    // READ BLOOD GLUCOSE — با pagination
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun readBloodGlucose(
-        startTime: String? = null,
-        endTime: String? = null
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            // ✅ از List استفاده می‌کنیم نه Map — تا رکوردهای هم‌زمان گم نشن
-            val records = mutableListOf<BloodGlucoseRecord>()
-            var pageToken: String? = null
-            var pageCount = 0
-
-            do {
-                val request = ReadRecordsRequest(
-                    recordType = BloodGlucoseRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
-                }
-
-                records.addAll(response.records)
-
-                val newToken = response.pageToken
-                pageCount++
+            val filter = createTimeFilter(null, null)
+            val buffers = types.map { PageBuffer() }
+            runBlocking(Dispatchers.IO) {
+                types.indices.map { i ->
+                    async { readTypePage(client, types[i], filter, false, count, null, buffers[i]) }
+                }.awaitAll()
+            }
 
-                if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ Glucose: pageToken unchanged — SDK bug detected. Stopping.")
+            var status = "COMPLETE"
+            var records = 0L
+            for (i in types.indices) {
+                val b = buffers[i]
+                records += b.count
+                if (b.count > 0 &&
+                    !nativeOnPage(requestId, types[i], b.count, b.timesMs, b.values, b.values2, b.extras)) {
+                    status = "CANCELLED"
                     break
                 }
-                pageToken = newToken
-
-            } while (pageToken != null && pageCount < MAX_PAGES)
-
-            if (records.isEmpty()) return "NO_BLOOD_GLUCOSE_DATA"
-
-            // ✅ مرتب‌سازی بر اساس زمان (چون دیگه sortedMap نداریم)
-            records.sortBy { it.time }
-
-            val arr = JSONArray()
-            records.forEach { record ->
-                arr.put(JSONObject().apply {
-                    put("time",            record.time.toString())
-                    put("glucose",         record.level.inMilligramsPerDeciliter)
-                    put("specimenSource",  record.specimenSource)
-                    put("mealType",        record.mealType)
-                    put("relationToMeal",  record.relationToMeal)
-                })
             }
-            arr.toString()
+
+            JSONObject().apply {
+                put("status", status)
+                put("records", records)
+                put("pages", types.size)
+            }.toString()
 
         } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading blood glucose", e)
+            Log.e(TAG, "❌ Security error reading latest records", e)
             "SECURITY_ERROR"
         } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading blood glucose", e)
+            Log.e(TAG, "❌ Error reading latest records", e)
             "ERROR: ${e.message}"
         }
     }
 
     // ─────────────────────────────────────────────────────────────
-    // WRITE BLOOD GLUCOSE
+    // AGGREGATE BUCKETS — min/avg/max در bucket های bucketSeconds ثانیه‌ای
+    // HR و BP از aggregateGroupByDuration خود Health Connect؛ قند خون و
+    // SpO2 متریک تجمیعی ندارند و همین‌جا از رکوردهای خام bucket می‌شوند —
+    // در هر دو حالت فقط bucket ها از JNI رد می‌شوند.
+    // خروجی: {"status":"COMPLETE","buckets":[{start,end,min,avg,max,min2,avg2,max2,count}]}
     // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeBloodGlucose(
-        glucoseMgDl: Double,
-        timeIso: String,
-        specimenSource: Int = SPECIMEN_SOURCE_CAPILLARY_BLOOD,
-        mealType: Int = MEAL_TYPE_UNKNOWN,
-        relationToMeal: Int = RELATION_TO_MEAL_GENERAL
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            if (glucoseMgDl < 20.0 || glucoseMgDl > 600.0) {
-                return "ERROR: Invalid glucose ($glucoseMgDl). Must be 20-600 mg/dL."
-            }
+    private class BucketAccumulator(val startMs: Long, val endMs: Long) {
+        var count = 0L
+        var min = Double.MAX_VALUE
+        var max = -Double.MAX_VALUE
+        var sum = 0.0
 
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
+        fun add(value: Double) {
+            count++
+            sum += value
+            if (value < min) min = value
+            if (value > max) max = value
+        }
 
-            val record = BloodGlucoseRecord(
-                level = BloodGlucose.milligramsPerDeciliter(glucoseMgDl),
-                specimenSource = specimenSource,
-                mealType = mealType,
-                relationToMeal = relationToMeal,
-                time = instant,
-                zoneOffset = zoneOffset
-            )
+        fun toJson(): JSONObject = JSONObject().apply {
+            put("start", startMs)
+            put("end", endMs)
+            put("min", min)
+            put("avg", sum / count)
+            put("max", max)
+            put("count", count)
+        }
+    }
 
-            runBlocking(Dispatchers.IO) {
-                client.insertRecords(listOf(record))
+    private fun <T : Record> bucketLocally(
+        client: HealthConnectClient,
+        recordType: KClass<T>,
+        filter: TimeRangeFilter,
+        fromMs: Long,
+        toMs: Long,
+        bucketMs: Long,
+        sample: (T) -> Pair<Instant, Double>
+    ): Pair<JSONArray, String> {
+        val buckets = sortedMapOf<Long, BucketAccumulator>()
+        var pageToken: String? = null
+        var status = "COMPLETE"
+        do {
+            val request = ReadRecordsRequest(
+                recordType = recordType,
+                timeRangeFilter = filter,
+                ascendingOrder = true,
+                pageSize = streamPageSize,
+                pageToken = pageToken
+            )
+            val response = runBlocking(Dispatchers.IO) {
+                safeReadBlocking(client, request)
             }
+            response.records.forEach { record ->
+                val (time, value) = sample(record)
+                val start = fromMs + (time.toEpochMilli() - fromMs) / bucketMs * bucketMs
+                buckets.getOrPut(start) {
+                    BucketAccumulator(start, minOf(start + bucketMs, toMs))
+                }.add(value)
+            }
+            val newToken = response.pageToken
+            if (newToken == pageToken && newToken != null) {
+                Log.w(TAG, "⚠️ bucket ${recordType.simpleName}: pageToken unchanged — SDK bug detected. Stopping.")
+                status = "TRUNCATED"
+                break
+            }
+            pageToken = newToken
+        } while (pageToken != null)
 
-            "SUCCESS: Glucose $glucoseMgDl mg/dL saved at $instant"
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing blood glucose", e)
-            "ERROR: ${e.message}"
-        }
+        val arr = JSONArray()
+        buckets.values.forEach { arr.put(it.toJson()) }
+        return Pair(arr, status)
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // READ HEART RATE — با pagination
-    // ─────────────────────────────────────────────────────────────
     @JvmStatic
-    fun readHeartRate(
-        startTime: String? = null,
-        endTime: String? = null
-    ): String {
+    fun aggregateBuckets(type: Int, startTime: String?, endTime: String?, bucketSeconds: Long): String {
         val client = healthConnectClient ?: return "CLIENT_NULL"
         return try {
-            val pointMap = sortedMapOf<Instant, Long>()
-            var pageToken: String? = null
-            var pageCount = 0
-
-            do {
-                val request = ReadRecordsRequest(
-                    recordType = HeartRateRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
+            val filter = createTimeFilter(startTime, endTime)
+            val fromMs = (parseInstant(startTime) ?: Instant.parse("2000-01-01T00:00:00.000Z")).toEpochMilli()
+            val toMs = (parseInstant(endTime) ?: Instant.now()).toEpochMilli()
+            val slicer = Duration.ofSeconds(bucketSeconds)
+            // TRUNCATED اگر bucketLocally پیش از آخرین صفحه متوقف شود — مثل streamRecords
+            var status = "COMPLETE"
+
+            val buckets = when (type) {
+                BATCH_HEART_RATE -> {
+                    val groups = runBlocking(Dispatchers.IO) {
+                        readPermits.withPermit {
+                            client.aggregateGroupByDuration(AggregateGroupByDurationRequest(
+                                metrics = setOf(HeartRateRecord.BPM_MIN, HeartRateRecord.BPM_AVG,
+                                                HeartRateRecord.BPM_MAX, HeartRateRecord.MEASUREMENTS_COUNT),
+                                timeRangeFilter = filter,
+                                timeRangeSlicer = slicer
+                            ))
+                        }
+                    }
+                    JSONArray().apply {
+                        groups.forEach { g ->
+                            val avg = g.result[HeartRateRecord.BPM_AVG] ?: return@forEach
+                            put(JSONObject().apply {
+                                put("start", g.startTime.toEpochMilli())
+                                put("end", g.endTime.toEpochMilli())
+                                put("min", g.result[HeartRateRecord.BPM_MIN] ?: avg)
+                                put("avg", avg)
+                                put("max", g.result[HeartRateRecord.BPM_MAX] ?: avg)
+                                put("count", g.result[HeartRateRecord.MEASUREMENTS_COUNT] ?: 0L)
+                            })
+                        }
+                    }
                 }
-
-                response.records.forEach { record ->
-                    record.samples.forEach { sample ->
-                        pointMap[sample.time] = sample.beatsPerMinute
+                BATCH_BLOOD_PRESSURE -> {
+                    val groups = runBlocking(Dispatchers.IO) {
+                        readPermits.withPermit {
+                            client.aggregateGroupByDuration(AggregateGroupByDurationRequest(
+                                metrics = setOf(BloodPressureRecord.SYSTOLIC_MIN, BloodPressureRecord.SYSTOLIC_AVG,
+                                                BloodPressureRecord.SYSTOLIC_MAX, BloodPressureRecord.DIASTOLIC_MIN,
+                                                BloodPressureRecord.DIASTOLIC_AVG, BloodPressureRecord.DIASTOLIC_MAX),
+                                timeRangeFilter = filter,
+                                timeRangeSlicer = slicer
+                            ))
+                        }
+                    }
+                    JSONArray().apply {
+                        groups.forEach { g ->
+                            val sys = g.result[BloodPressureRecord.SYSTOLIC_AVG] ?: return@forEach
+                            val dia = g.result[BloodPressureRecord.DIASTOLIC_AVG] ?: return@forEach
+                            put(JSONObject().apply {
+                                put("start", g.startTime.toEpochMilli())
+                                put("end", g.endTime.toEpochMilli())
+                                put("min",  (g.result[BloodPressureRecord.SYSTOLIC_MIN] ?: sys).inMillimetersOfMercury)
+                                put("avg",  sys.inMillimetersOfMercury)
+                                put("max",  (g.result[BloodPressureRecord.SYSTOLIC_MAX] ?: sys).inMillimetersOfMercury)
+                                put("min2", (g.result[BloodPressureRecord.DIASTOLIC_MIN] ?: dia).inMillimetersOfMercury)
+                                put("avg2", dia.inMillimetersOfMercury)
+                                put("max2", (g.result[BloodPressureRecord.DIASTOLIC_MAX] ?: dia).inMillimetersOfMercury)
+                            })
+                        }
                     }
                 }
-
-                val newToken = response.pageToken
-                pageCount++
-
-                if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ HR: pageToken unchanged — SDK bug detected. Stopping.")
-                    break
+                BATCH_BLOOD_GLUCOSE -> {
+                    val (arr, localStatus) =
+                        bucketLocally(client, BloodGlucoseRecord::class, filter, fromMs, toMs, bucketSeconds * 1000) {
+                            Pair(it.time, it.level.inMilligramsPerDeciliter)
+                        }
+                    status = localStatus
+                    arr
                 }
-                pageToken = newToken
-
-            } while (pageToken != null && pageCount < MAX_PAGES)
-
-            if (pointMap.isEmpty()) return "NO_HEART_RATE_DATA"
-
-            val arr = JSONArray()
-            pointMap.forEach { (time, bpm) ->
-                arr.put(JSONObject().apply {
-                    put("bpm", bpm)
-                    put("time", time.toString())
-                })
+                BATCH_OXYGEN_SATURATION -> {
+                    val (arr, localStatus) =
+                        bucketLocally(client, OxygenSaturationRecord::class, filter, fromMs, toMs, bucketSeconds * 1000) {
+                            Pair(it.time, it.percentage.value)
+                        }
+                    status = localStatus
+                    arr
+                }
+                else -> return "ERROR: No aggregate for type $type"
             }
-            arr.toString()
 
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading heart rate", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading heart rate", e)
-            "ERROR: ${e.message}"
-        }
-    }
+            JSONObject().apply {
+                put("status", status)
+                put("buckets", buckets)
+            }.toString()
 
-    // ─────────────────────────────────────────────────────────────
-    // WRITE HEART RATE
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeHeartRate(bpm: Long, timeIso: String): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            if (bpm < 30 || bpm > 250)
-                return "ERROR: Invalid heart rate ($bpm). Must be 30-250 bpm"
-
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-            val sample = HeartRateRecord.Sample(time = instant, beatsPerMinute = bpm)
-            val record = HeartRateRecord(
-                samples = listOf(sample),
-                startTime = instant,
-                endTime = instant,
-                startZoneOffset = zoneOffset,
-                endZoneOffset = zoneOffset
-            )
-            runBlocking(Dispatchers.IO) { client.insertRecords(listOf(record)) }
-            "SUCCESS: Heart rate $bpm bpm saved at $instant"
         } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error writing heart rate", e)
+            Log.e(TAG, "❌ Security error aggregating type $type", e)
             "SECURITY_ERROR"
         } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing heart rate", e)
+            Log.e(TAG, "❌ Error aggregating type $type", e)
             "ERROR: ${e.message}"
         }
     }
 
     // ─────────────────────────────────────────────────────────────
-    // READ OXYGEN SATURATION — با pagination
+    // WRITE BATCH
+    // چند اندازه‌گیری در یک فراخوانی JNI؛ درج در تکه‌های BATCH_CHUNK_SIZE تایی
+    // آرایه‌ها هم‌طول‌اند و آیتم i از خانه‌ی i همه‌ی آن‌ها ساخته می‌شود:
+    //   types    : BATCH_*
+    //   timesMs  : epoch ms (UTC)
+    //   values   : مقدار اصلی (BP → systolic، flow → شدت ۰ تا ۳)
+    //   values2  : BP → diastolic، دوره‌ی قاعدگی → پایان (epoch ms)، بقیه 0
+    //   extras   : قند خون → specimen | meal << 8 | relation << 16
+    // خروجی: {"inserted":N,"failed":M,"status":[0,0,1,...],"errors":[{"index":i,"message":"..."}]}
     // ─────────────────────────────────────────────────────────────
     @JvmStatic
-    fun readOxygenSaturation(
-        startTime: String? = null,
-        endTime: String? = null
+    fun writeBatch(
+        types: IntArray,
+        timesMs: LongArray,
+        values: DoubleArray,
+        values2: DoubleArray,
+        extras: IntArray
     ): String {
         val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            val pointMap = sortedMapOf<Instant, Double>()
-            var pageToken: String? = null
-            var pageCount = 0
-
-            do {
-                val request = ReadRecordsRequest(
-                    recordType = OxygenSaturationRecord::class,
-                    timeRangeFilter = createTimeFilter(startTime, endTime),
-                    ascendingOrder = true,
-                    pageSize = 1000,
-                    pageToken = pageToken
-                )
-                val response = runBlocking(Dispatchers.IO) {
-                    safeReadBlocking(client, request)
-                }
-
-                response.records.forEach { record ->
-                    pointMap[record.time] = record.percentage.value
-                }
-
-                val newToken = response.pageToken
-                pageCount++
-
-                if (newToken == pageToken && newToken != null) {
-                    Log.w(TAG, "⚠️ SpO2: pageToken unchanged — likely Android < 14 SDK bug. Stopping.")
-                    break
-                }
-                pageToken = newToken
-
-            } while (pageToken != null && pageCount < MAX_PAGES)
-
-            if (pointMap.isEmpty()) return "NO_OXYGEN_DATA"
-
-            val arr = JSONArray()
-            pointMap.forEach { (time, percentage) ->
-                arr.put(JSONObject().apply {
-                    put("percentage", percentage)
-                    put("time", time.toString())
-                })
-            }
-            arr.toString()
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error reading oxygen saturation", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error reading oxygen saturation", e)
-            "ERROR: ${e.message}"
+        val count = types.size
+        if (timesMs.size != count || values.size != count ||
+            values2.size != count || extras.size != count) {
+            return "ERROR: writeBatch arrays length mismatch"
         }
-    }
-
-    // ─────────────────────────────────────────────────────────────
-    // WRITE OXYGEN SATURATION
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeOxygenSaturation(percentage: Double, timeIso: String): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
 
-        return try {
-            if (percentage < 50.0 || percentage > 100.0) {
-                return "ERROR: Invalid SpO2 ($percentage). Must be 50-100%"
+        val status = IntArray(count) { ITEM_FAILED }
+        val errors = JSONArray()
+
+        // ── ساخت رکوردها؛ نامعتبرها همین‌جا کنار گذاشته می‌شوند ──
+        val indices = ArrayList<Int>(count)
+        val records = ArrayList<Record>(count)
+        for (i in 0 until count) {
+            val error = validateBatchItem(types[i], timesMs[i], values[i], values2[i])
+            if (error != null) {
+                status[i] = ITEM_INVALID
+                errors.put(JSONObject().put("index", i).put("message", error))
+                continue
             }
+            indices.add(i)
+            records.add(buildBatchRecord(types[i], Instant.ofEpochMilli(timesMs[i]),
+                                         values[i], values2[i], extras[i]))
+        }
 
-            val instant = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-
-            val record = OxygenSaturationRecord(
-                percentage = Percentage(percentage),
-                time = instant,
-                zoneOffset = zoneOffset
-            )
-
-            runBlocking(Dispatchers.IO) {
-                client.insertRecords(listOf(record))
+        // ── درج تکه‌تکه؛ اگر تکه‌ای رد شد، آیتم‌هایش تک‌تک امتحان می‌شوند ──
+        runBlocking(Dispatchers.IO) {
+            var start = 0
+            while (start < records.size) {
+                val end = minOf(start + BATCH_CHUNK_SIZE, records.size)
+                try {
+                    client.insertRecords(records.subList(start, end))
+                    for (k in start until end) status[indices[k]] = ITEM_OK
+                } catch (e: SecurityException) {
+                    Log.e(TAG, "❌ Security error in writeBatch chunk $start-$end", e)
+                    for (k in start until end) status[indices[k]] = ITEM_DENIED
+                } catch (e: Exception) {
+                    Log.w(TAG, "⚠️ writeBatch chunk $start-$end failed, retrying per item", e)
+                    for (k in start until end) {
+                        status[indices[k]] = try {
+                            client.insertRecords(listOf(records[k]))
+                            ITEM_OK
+                        } catch (se: SecurityException) {
+                            ITEM_DENIED
+                        } catch (ie: Exception) {
+                            errors.put(JSONObject().put("index", indices[k])
+                                                   .put("message", ie.message ?: "insert failed"))
+                            ITEM_FAILED
+                        }
+                    }
+                }
+                start = end
             }
-
-            "SUCCESS: Oxygen saturation $percentage% saved at $instant"
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error while writing oxygen saturation", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing oxygen saturation", e)
-            "ERROR: ${e.message}"
         }
-    }
 
-    // ─────────────────────────────────────────────────────────────
-    // WRITE MENSTRUATION PERIOD
-    // ثبت بازه کامل دوره قاعدگی (startTime تا endTime)
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeMenstruationPeriod(
-        startTimeIso: String,
-        endTimeIso: String
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            val startInstant = Instant.parse(startTimeIso)
-            val endInstant   = Instant.parse(endTimeIso)
+        val inserted = status.count { it == ITEM_OK }
+        Log.d(TAG, "📦 writeBatch: $inserted/$count inserted")
 
-            if (!endInstant.isAfter(startInstant)) {
-                return "ERROR: endTime must be after startTime"
-            }
+        return JSONObject()
+            .put("inserted", inserted)
+            .put("failed", count - inserted)
+            .put("status", JSONArray(status))
+            .put("errors", errors)
+            .toString()
+    }
 
-            // حداکثر طول منطقی دوره: 15 روز
-            val diffDays = ChronoUnit.DAYS.between(startInstant, endInstant)
-            if (diffDays > 15) {
-                return "ERROR: Period duration too long ($diffDays days). Max is 15 days."
+    private fun validateBatchItem(type: Int, timeMs: Long, value: Double, value2: Double): String? {
+        return when (type) {
+            BATCH_HEIGHT ->
+                if (value < 0.1 || value > 3.0) "Invalid height ($value). Must be 0.1-3.0 m" else null
+            BATCH_WEIGHT ->
+                if (value < 0.1 || value > 300.0) "Invalid weight ($value). Must be 0.1-300 kg" else null
+            BATCH_BLOOD_PRESSURE -> when {
+                value < 80 || value > 200   -> "Invalid systolic ($value). Must be 80-200 mmHg"
+                value2 < 40 || value2 > 130 -> "Invalid diastolic ($value2). Must be 40-130 mmHg."
+                value <= value2             -> "Systolic must be > diastolic"
+                else                        -> null
             }
-
-            val startZoneOffset = ZoneId.systemDefault().rules.getOffset(startInstant)
-            val endZoneOffset   = ZoneId.systemDefault().rules.getOffset(endInstant)
-
-            val record = MenstruationPeriodRecord(
-                startTime       = startInstant,
-                startZoneOffset = startZoneOffset,
-                endTime         = endInstant,
-                endZoneOffset   = endZoneOffset
-            )
-
-            runBlocking(Dispatchers.IO) {
-                client.insertRecords(listOf(record))
+            BATCH_HEART_RATE ->
+                if (value < 30 || value > 250) "Invalid heart rate ($value). Must be 30-250 bpm" else null
+            BATCH_BLOOD_GLUCOSE ->
+                if (value < 20.0 || value > 600.0) "Invalid glucose ($value). Must be 20-600 mg/dL." else null
+            BATCH_OXYGEN_SATURATION ->
+                if (value < 50.0 || value > 100.0) "Invalid SpO2 ($value). Must be 50-100%" else null
+            BATCH_MENSTRUATION_FLOW ->
+                if (value < 0 || value > 3)
+                    "Invalid flowLevel ($value). Must be 0-3 (0=UNKNOWN, 1=LIGHT, 2=MEDIUM, 3=HEAVY)"
+                else null
+            BATCH_MENSTRUATION_PERIOD -> {
+                // حداکثر طول منطقی دوره: 15 روز
+                val diffDays = (value2.toLong() - timeMs) / (24L * 3600 * 1000)
+                when {
+                    value2.toLong() <= timeMs -> "endTime must be after startTime"
+                    diffDays > 15             -> "Period duration too long ($diffDays days). Max is 15 days."
+                    else                      -> null
+                }
             }
-
-            "SUCCESS: Menstruation period saved from $startInstant to $endInstant"
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error writing menstruation period", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing menstruation period", e)
-            "ERROR: ${e.message}"
+            else -> "Unknown measurement type ($type)"
         }
     }
 
-    // ─────────────────────────────────────────────────────────────
-    // WRITE MENSTRUATION FLOW
-    // ثبت شدت خونریزی در یک لحظه مشخص
-    // flowLevel: 0=UNKNOWN, 1=LIGHT, 2=MEDIUM, 3=HEAVY
-    // ─────────────────────────────────────────────────────────────
-    @JvmStatic
-    fun writeMenstruationFlow(
-        timeIso: String,
-        flowLevel: Int
-    ): String {
-        val client = healthConnectClient ?: return "CLIENT_NULL"
-        return try {
-            // اعتبارسنجی flowLevel — دقیقاً مثل validation های بقیه توابع
-            if (flowLevel < 0 || flowLevel > 3) {
-                return "ERROR: Invalid flowLevel ($flowLevel). Must be 0-3 " +
-                       "(0=UNKNOWN, 1=LIGHT, 2=MEDIUM, 3=HEAVY)"
+    private fun buildBatchRecord(
+        type: Int, instant: Instant, value: Double, value2: Double, extra: Int
+    ): Record {
+        val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
+        return when (type) {
+            BATCH_HEIGHT -> HeightRecord(
+                height = Length.meters(value), time = instant, zoneOffset = zoneOffset)
+            BATCH_WEIGHT -> WeightRecord(
+                weight = Mass.kilograms(value), time = instant, zoneOffset = zoneOffset)
+            BATCH_BLOOD_PRESSURE -> BloodPressureRecord(
+                systolic = Pressure.millimetersOfMercury(value),
+                diastolic = Pressure.millimetersOfMercury(value2),
+                time = instant, zoneOffset = zoneOffset)
+            BATCH_HEART_RATE -> HeartRateRecord(
+                samples = listOf(HeartRateRecord.Sample(time = instant, beatsPerMinute = value.toLong())),
+                startTime = instant, endTime = instant,
+                startZoneOffset = zoneOffset, endZoneOffset = zoneOffset)
+            BATCH_BLOOD_GLUCOSE -> BloodGlucoseRecord(
+                level = BloodGlucose.milligramsPerDeciliter(value),
+                specimenSource = extra and 0xFF,
+                mealType = (extra shr 8) and 0xFF,
+                relationToMeal = (extra shr 16) and 0xFF,
+                time = instant, zoneOffset = zoneOffset)
+            BATCH_MENSTRUATION_FLOW -> MenstruationFlowRecord(
+                flow = when (value.toInt()) {
+                    1    -> MenstruationFlowRecord.FLOW_LIGHT
+                    2    -> MenstruationFlowRecord.FLOW_MEDIUM
+                    3    -> MenstruationFlowRecord.FLOW_HEAVY
+                    else -> MenstruationFlowRecord.FLOW_UNKNOWN
+                },
+                time = instant, zoneOffset = zoneOffset)
+            BATCH_MENSTRUATION_PERIOD -> {
+                val end = Instant.ofEpochMilli(value2.toLong())
+                MenstruationPeriodRecord(
+                    startTime = instant, startZoneOffset = zoneOffset,
+                    endTime = end, endZoneOffset = ZoneId.systemDefault().rules.getOffset(end))
             }
-
-            val instant    = Instant.parse(timeIso)
-            val zoneOffset = ZoneId.systemDefault().rules.getOffset(instant)
-
-            val flow = when (flowLevel) {
-                1    -> MenstruationFlowRecord.FLOW_LIGHT
-                2    -> MenstruationFlowRecord.FLOW_MEDIUM
-                3    -> MenstruationFlowRecord.FLOW_HEAVY
-                else -> MenstruationFlowRecord.FLOW_UNKNOWN
-            }
-
-            val record = MenstruationFlowRecord(
-                time       = instant,
-                zoneOffset = zoneOffset,
-                flow       = flow
-            )
-
-            runBlocking(Dispatchers.IO) {
-                client.insertRecords(listOf(record))
-            }
-
-            "SUCCESS: Menstruation flow level $flowLevel saved at $instant"
-
-        } catch (e: SecurityException) {
-            Log.e(TAG, "❌ Security error writing menstruation flow", e)
-            "SECURITY_ERROR"
-        } catch (e: Exception) {
-            Log.e(TAG, "❌ Error writing menstruation flow", e)
-            "ERROR: ${e.message}"
+            else -> OxygenSaturationRecord(
+                percentage = Percentage(value), time = instant, zoneOffset = zoneOffset)
         }
     }
 
     // ─────────────────────────────────────────────────────────────
-    // READ MENSTRUATION DATA — با pagination، هم‌سبک با readHeartRate
+    // READ MENSTRUATION DATA — همه‌ی صفحه‌ها، مثل streamRecords
     // خروجی JSON ترکیبی از periods و flows:
     // {
+    //   "status":  "COMPLETE" | "TRUNCATED",
     //   "periods": [ { "start": "...", "end": "..." }, ... ],
-    //   "flows":   [ { "time": "...", "flow": 2 }, ... ]
+    //   "flows":   [ { "time": "...", "level": 2 }, ... ]
     // }
     // ─────────────────────────────────────────────────────────────
     @JvmStatic
@@ -985,51 +876,34 @@ object HealthBridge {
         val client = healthConnectClient ?: return "CLIENT_NULL"
 
         return try {
-            val result = runBlocking {
+            val result = runBlocking(Dispatchers.IO) {
                 val timeFilter = createTimeFilter(startTime, endTime)
 
                 // ── خواندن دوره‌ها ──────────────────────────────────────
-                val periodsResponse = safeReadBlocking(
-                    client,
-                    ReadRecordsRequest(
-                        recordType       = MenstruationPeriodRecord::class,
-                        timeRangeFilter  = timeFilter
-                    )
-                )
-
-                // ── خواندن جریان‌ها ─────────────────────────────────────
-                val flowsResponse = safeReadBlocking(
-                    client,
-                    ReadRecordsRequest(
-                        recordType       = MenstruationFlowRecord::class,
-                        timeRangeFilter  = timeFilter
-                    )
-                )
-
                 val periodsArr = JSONArray()
-                for (record in periodsResponse.records) {
-                    val obj = JSONObject()
-                    // ✅ کلیدهای صحیح: "start" و "end"
-                    obj.put("start", record.startTime.toString())
-                    obj.put("end",   record.endTime.toString())
-                    periodsArr.put(obj)
-
-                    Log.d("HealthBridge", "[Kotlin] period: ${record.startTime} → ${record.endTime}")
+                val periodsStatus = readAllPages(client, MenstruationPeriodRecord::class, timeFilter) { record ->
+                    periodsArr.put(JSONObject().apply {
+                        put("start", record.startTime.toString())
+                        put("end",   record.endTime.toString())
+                    })
                 }
 
+                // ── خواندن جریان‌ها ─────────────────────────────────────
                 val flowsArr = JSONArray()
-                for (record in flowsResponse.records) {
-                    val obj = JSONObject()
-                    // ✅ کلید صحیح: "time" (نه "timeMs")
-                    // ✅ مقدار صحیح: record.flow (نه record.level)
-                    obj.put("time",  record.time.toString())
-                    obj.put("level", record.flow)   // ← این مقدار 1، 2 یا 3 است
-
-                    Log.d("HealthBridge", "[Kotlin] flow: time=${record.time} flow=${record.flow}")
-                    flowsArr.put(obj)
+                val flowsStatus = readAllPages(client, MenstruationFlowRecord::class, timeFilter) { record ->
+                    flowsArr.put(JSONObject().apply {
+                        put("time",  record.time.toString())
+                        put("level", record.flow)   // 1، 2 یا 3
+                    })
                 }
 
+                val status = if (periodsStatus == "COMPLETE" && flowsStatus == "COMPLETE") "COMPLETE"
+                             else "TRUNCATED"
+                Log.d(TAG, "🩸 readMenstruationData: ${periodsArr.length()} periods, " +
+                           "${flowsArr.length()} flows — $status")
+
                 val root = JSONObject()
+                root.put("status",  status)
                 root.put("periods", periodsArr)
                 root.put("flows",   flowsArr)
                 root.toString()
@@ -1041,6 +915,34 @@ object HealthBridge {
         }
     }
 
+    // همه‌ی صفحه‌های یک نوع رکورد، صعودی؛ TRUNCATED اگر pageToken تکرار شود
+    private suspend fun <T : Record> readAllPages(
+        client: HealthConnectClient,
+        recordType: KClass<T>,
+        filter: TimeRangeFilter,
+        onRecord: (T) -> Unit
+    ): String {
+        var pageToken: String? = null
+        do {
+            val response = safeReadBlocking(client, ReadRecordsRequest(
+                recordType = recordType,
+                timeRangeFilter = filter,
+                ascendingOrder = true,
+                pageSize = streamPageSize,
+                pageToken = pageToken
+            ))
+            response.records.forEach(onRecord)
+
+            val newToken = response.pageToken
+            if (newToken == pageToken && newToken != null) {
+                Log.w(TAG, "⚠️ ${recordType.simpleName}: pageToken unchanged — SDK bug detected. Stopping.")
+                return "TRUNCATED"
+            }
+            pageToken = newToken
+        } while (pageToken != null)
+        return "COMPLETE"
+    }
+
     @JvmStatic
     fun openHealthConnectInStore(activity: Activity): String {
         val packageName = if (android.os.Build.VERSION.SDK_INT >= 34) {
@@ -26,6 +26,10 @@ extern "C"
         qDebug() << permission << (granted ? "✅" : "❌");
     }
 
+    // کاربر چیزی را تغییر داده — refresh بعدی دوباره از Health Connect می‌پرسد
+    QMetaObject::invokeMethod(g_mainWindowInstance, &Backend::invalidatePermissions,
+                              Qt::QueuedConnection);
+
     // QMetaObject::invokeMethod(g_mainWindowInstance, [=]() {
     //     QString str = (qMsg == "start") ? "Play" : "Pause";
 
@@ -40,7 +44,10 @@ extern "C"
 Backend::Backend(QObject *parent)
     : QObject{parent}
 {
+    m_startupTimer.start();
     g_mainWindowInstance = this;
+    m_menstruationModel = new MenstruationModel(this);
+    m_metrics           = new MetricsModel(this);
 #ifdef ANDROID
     QJniObject context = QNativeInterface::QAndroidApplication::context();
     if (!context.isValid())
@@ -63,10 +70,104 @@ Backend::Backend(QObject *parent)
         );
 #endif
     loadAvailablePath();
+    loadExportSettings();
+
+    // ── ردیابی: QMLHC_TRACE=1 یا تنظیم debug/trace ──
+    Tracer::setOutputDir(path);
+    if (QSettings().value("debug/trace", false).toBool())
+        Tracer::setEnabled(true);
+    if (Tracer::enabled())
+        qDebug() << "🧭 Tracing to" << Tracer::outputPath();
+    m_metricsOverlay = qEnvironmentVariableIntValue("QMLHC_METRICS") > 0
+                       || QSettings().value("debug/metrics", false).toBool();
+
+    // ── سقف حافظه‌ی کش سری‌ها: QMLHC_CACHE_BUDGET_MB یا تنظیم cache/budgetMB ──
+    bool budgetFromEnv = false;
+    int budgetMB = qEnvironmentVariableIntValue("QMLHC_CACHE_BUDGET_MB", &budgetFromEnv);
+    if (!budgetFromEnv || budgetMB < 0)
+        budgetMB = QSettings().value("cache/budgetMB",
+                                     int(SeriesCache::DefaultBudgetBytes / (1024 * 1024))).toInt();
+    m_cache.setBudgetBytes(qint64(qMax(budgetMB, 0)) * 1024 * 1024);
+
+    // ── آخرین چارت، تا QML زود چیزی برای کشیدن داشته باشد ──
+    //    خواندن فایل و qUncompress روی m_snapshotPool، هم‌زمان با بارگذاری QML
+    m_snapshotPool.setMaxThreadCount(1);   // load و save ها پشت سر هم، روی یک فایل
+    const QString snapshotPath = QDir(path).filePath(SnapshotName);
+    const quint64 snapshotGeneration = m_readGeneration.load();
+    QtConcurrent::run(&m_snapshotPool, [this, snapshotPath, snapshotGeneration]() {
+        TraceSpan snapshotSpan("startup", "loadSnapshot");
+        RenderSnapshot snapshot;
+        if (!RenderSnapshot::load(snapshotPath, &snapshot) || snapshot.isEmpty())
+            return;
+        snapshotSpan.arg("points", snapshot.pointCount());
+        QMetaObject::invokeMethod(this, [this, snapshot, snapshotGeneration]() {
+            // خواندن Health Connect زودتر شروع شده — snapshot دیگر به کار نمی‌آید
+            if (m_readGeneration.load() != snapshotGeneration)
+                return;
+            applySnapshot(snapshot);
+            qDebug() << "🧊 Render snapshot:" << m_snapshotPoints << "points from"
+                     << QDateTime::fromMSecsSinceEpoch(snapshot.savedAtMs).toString("yyyy/MM/dd hh:mm:ss")
+                     << "restored at" << m_startupTimer.elapsed() << "ms";
+            if (m_qmlReady) {
+                emitLocalUpdate();
+                emit snapshotRestored(m_displayedAxes, m_snapshotSavedAtMs);
+            }
+        }, Qt::QueuedConnection);
+    });
+
+    // بعد از برگشتن از Settings ممکن است دسترسی‌ها عوض شده باشند
+    // (در حالت headless فقط QCoreApplication هست)
+    if (qGuiApp) {
+        connect(qGuiApp, &QGuiApplication::applicationStateChanged, this,
+                [this](Qt::ApplicationState state) {
+                    if (state == Qt::ApplicationActive)
+                        invalidatePermissions();
+                });
+    }
+
+    // ── صف write-behind روی thread خودش ──
+    m_writeQueue = new WriteQueue(QDir(path).filePath(WriteJournalName), &Backend::insertBatch);
+    m_writeQueue->moveToThread(&m_writeThread);
+    connect(&m_writeThread, &QThread::finished, m_writeQueue, &QObject::deleteLater);
+    connect(&m_writeThread, &QThread::started, m_writeQueue, &WriteQueue::start);
+    connect(m_writeQueue, &WriteQueue::pendingCountChanged, this, [this](int count) {
+        m_pendingWrites = count;
+        emit pendingWritesChanged(count);
+    });
+    connect(m_writeQueue, &WriteQueue::writeRejected, this, &Backend::writeRejected);
+    connect(m_writeQueue, &WriteQueue::writeDeferred, this, [](int count, int retryInMs) {
+        qDebug() << "⏳ Write queue:" << count << "deferred, retry in" << retryInMs << "ms";
+    });
+    m_readPool.setMaxThreadCount(1);   // خواندن‌ها پشت سر هم، نه موازی
+    m_writeThread.setObjectName("WriteQueue");
+    m_writeThread.start();
+}
+
+Backend::~Backend()
+{
+    // خواندن در حال اجرا در صفحه‌ی بعدی متوقف می‌شود
+    ++m_readGeneration;
+    m_readPool.waitForDone();
+    m_snapshotPool.waitForDone();
+    saveSnapshot(false);
+    Tracer::flush();
+
+    // آنچه flush نشده در journal می‌ماند و اجرای بعدی فرستاده می‌شود
+    m_writeThread.quit();
+    m_writeThread.wait();
 }
 
 void Backend::onQmlReady()
 {
+    TraceSpan span("startup", "onQmlReady");
+    m_qmlReady = true;
+
+    // ── snapshot اگر تا اینجا رسیده، همین حالا کشیده می‌شود؛ وگرنه وقتی برسد ──
+    if (m_snapshotSavedAtMs > 0) {
+        emitLocalUpdate();
+        emit snapshotRestored(m_displayedAxes, m_snapshotSavedAtMs);
+    }
+
     QStringList permissions = { "android.permission.health.READ_HEIGHT",
                                 "android.permission.health.WRITE_HEIGHT",
                                 "android.permission.health.READ_WEIGHT",
@@ -81,23 +182,40 @@ void Backend::onQmlReady()
                                 "android.permission.health.WRITE_OXYGEN_SATURATION",
                                 "android.permission.health.READ_MENSTRUATION",
                                 "android.permission.health.WRITE_MENSTRUATION"};
-    askForPermission(permissions,12);
+    {
+        TraceSpan permissionsSpan("startup", "askForPermission");
+        askForPermission(permissions,12);
+    }
     checkPermissions();
     loadPeriodState();
+
+    // خلاصه‌ی داشبورد پیش از خواندن بازه‌ی چارت
+    refreshLatest();
 }
 
 void Backend::onUpdateRequest(bool height, bool weight, bool bp, bool bg, bool hr, bool spo2, QDateTime startFrom, QDateTime endTo)
 {
-    hList.clear();
-    wList.clear();
-    bpSystolicList.clear();
-    bpDiastolicList.clear();
-    heartRateList.clear();
-    bloodGlucoseList.clear();
-    oxygenSaturationList.clear();
+    // بدون دسترسی چارت قبلی دست نمی‌خورد و به‌جای چارت خالی پیام وضعیت می‌آید
+    if (!ensurePermissions()) {
+        const QString message = m_permissionsMessage.isEmpty()
+                                    ? QString("دسترسی به Health Connect داده نشده است")
+                                    : m_permissionsMessage;
+        qDebug() << "🔐 Read skipped, no permissions:" << message;
+        emit readFinished(false, message);
+        return;
+    }
 
-#ifdef Q_OS_ANDROID
-    checkPermissions();
+    // اگر خواندن قبلی هنوز تمام نشده، صفحه‌های بعدی‌اش کنار گذاشته می‌شوند
+    const quint64 generation = ++m_readGeneration;
+    m_refreshStartUs = Tracer::nowUs();
+    TraceSpan span("refresh", "onUpdateRequest");
+
+    for (int type : Metric::allTypes())
+        clearSeries(type);
+    m_buckets.clear();
+    m_snapshotShown = false;
+    m_loadedFrom = startFrom;
+    m_cache.beginView();
 
     qDebug() << "✅ Reading data...";
 
@@ -107,451 +225,1671 @@ void Backend::onUpdateRequest(bool height, bool weight, bool bp, bool bg, bool h
 
     qDebug() << "📅 Time range:" << startTime << " or " << startFrom.toString("yyyy/MM/dd hh:mm:ss") << " → " << endTime << endTo.toString("yyyy/MM/dd hh:mm:ss");
 
-    if(height)
-    {
-        readHeight(startTime,endTime);
-    }
-    if(weight)
-    {
-        readWeight(startTime,endTime);
-    }
-    if(bp)
-    {
-        readBP(startTime,endTime);
-    }
-    if(bg)
-    {
-        readBG(startTime,endTime);
-    }
-    if(hr)
-    {
-        readHR(startTime,endTime);
-    }
-    if(spo2)
-    {
-        readOxygenSaturation(startTime, endTime);
-    }
+    const QList<int> types = selectedTypes(height, weight, bp, bg, hr, spo2);
+
+    // ── صفحه‌ها روی thread جدا خوانده و تکه‌تکه به چارت داده می‌شوند ──
+    m_reading = true;
+    emit readStarted();
+
+    // در بازه‌های ماهانه چارت فقط روند روزانه/ساعتی را نشان می‌دهد
+    const int bucketSeconds = bucketSecondsFor(startFrom.msecsTo(endTo));
+
+    // ── آنچه در کش هست همین‌جا تحویل داده می‌شود؛ بقیه از bridge ──
+    const qint64 nowMs  = QDateTime::currentMSecsSinceEpoch();
+    const qint64 fromMs = startFrom.toMSecsSinceEpoch();
+    const qint64 toMs   = endTo.toMSecsSinceEpoch();
+    QList<int> toRead;
+    QHash<int, QDateTime> readFrom;   // ادامه‌ی یک پنجره‌ی کش‌شده تا endTo
+    for (int type : types) {
+        if (bucketSeconds > 0 && HealthBridge::supportsAggregate(type)) {
+            SeriesCache::Coarse coarse;
+            if (qint64(bucketSeconds) * 1000 == SeriesCache::CoarseBucketMs
+                && m_cache.lookupCoarse(type, fromMs, toMs, nowMs, &coarse)) {
+                const BucketSeries series{coarse.avg, coarse.avg2, coarse.min, coarse.max};
+                m_buckets.insert(type, series);
+                emit bucketSeriesRead(type, series.avg, series.avg2, series.min, series.max);
+                continue;
+            }
+        } else {
+            SeriesCache::Columns cached;
+            const qint64 coveredTo = m_cache.lookup(type, fromMs, toMs, nowMs, &cached);
+            if (coveredTo > fromMs) {
+                const SeriesChunk chunk{type, cached.values, cached.values2,
+                                        cached.specimen, cached.meal, cached.relation};
+                deliverChunk(chunk);
+                if (coveredTo >= toMs)
+                    continue;
+                readFrom.insert(type, QDateTime::fromMSecsSinceEpoch(coveredTo));
+            }
+        }
+        toRead.append(type);
+    }
+    if (toRead.size() < types.size() || !readFrom.isEmpty())
+        qDebug() << "♻️ Series cache:" << types.size() - toRead.size() << "served,"
+                 << readFrom.size() << "extended," << toRead.size() - readFrom.size() << "read";
+
+    QtConcurrent::run(&m_readPool, [this, generation, types, toRead, readFrom, bucketSeconds,
+                                    startFrom, startTime, endTime, endTo]() {
+        auto cancelled = [this, generation]() { return m_readGeneration.load() != generation; };
+        auto onPage = [this, generation, cancelled](const HealthBridge::Page &page) {
+            if (cancelled())
+                return false;
+            SeriesChunk chunk;
+            {
+                TraceSpan chunkSpan("read", "toChunk");
+                StageMetrics::Timer decodeTimer(StageMetrics::Decode, page.count);
+                chunk = toChunk(page);
+            }
+            QMetaObject::invokeMethod(this, [this, generation, chunk]() {
+                if (m_readGeneration.load() != generation)
+                    return;
+                TraceSpan deliverSpan("signal", "seriesChunkRead");
+                deliverSpan.arg("points", chunk.values.size());
+                deliverChunk(chunk);
+            }, Qt::QueuedConnection);
+            return true;
+        };
+
+        ShardedReader shardedReader(HealthBridge::instance());
+
+        QStringList problems;
+        QList<int>  incomplete;
+        for (int type : toRead) {
+            TraceSpan typeSpan("read", HealthBridge::typeName(type));
+            HealthBridge::StreamResult result;
+            StageMetrics::Timer bridgeTimer(StageMetrics::BridgeCall);
+            if (bucketSeconds > 0 && HealthBridge::supportsAggregate(type)) {
+                HealthBridge::AggregateResult aggregate =
+                    HealthBridge::instance()->aggregate(type, startTime, endTime, bucketSeconds);
+                result.status  = aggregate.status;
+                result.records = aggregate.buckets.size();
+                result.message = aggregate.message;
+                if (aggregate.status == HealthBridge::StreamComplete) {
+                    BucketSeries series = toBucketSeries(type, aggregate.buckets);
+                    QMetaObject::invokeMethod(this, [this, generation, type, series]() {
+                        if (m_readGeneration.load() != generation)
+                            return;
+                        TraceSpan deliverSpan("signal", "bucketSeriesRead");
+                        StageMetrics::Timer deliveryTimer(StageMetrics::QmlDelivery, series.avg.size());
+                        m_buckets.insert(type, series);
+                        emit bucketSeriesRead(type, series.avg, series.avg2, series.min, series.max);
+                    }, Qt::QueuedConnection);
+                }
+                if (cancelled())
+                    return;
+            } else {
+                // بازه‌های چندساله موازی و در چند shard خوانده می‌شوند
+                const QDateTime typeFrom = readFrom.value(type, startFrom);
+                const bool sharded = typeFrom.msecsTo(endTo) >= 2 * ShardedReader::MinShardMs;
+                result = sharded
+                    ? shardedReader.read(type, typeFrom, endTo, onPage, cancelled)
+                    : HealthBridge::instance()->stream(
+                          type, typeFrom.toUTC().toString(Qt::ISODateWithMs), endTime, onPage);
+            }
 
-    emit newDataRead(hList, wList, bpSystolicList, bpDiastolicList,
-                     heartRateList, bloodGlucoseList, oxygenSaturationList);
+            qDebug() << "📥" << HealthBridge::typeName(type) << ":" << result.records
+                     << "records in" << result.pages << "pages —"
+                     << HealthBridge::statusName(result.status);
+            bridgeTimer.setItems(result.records);
+            typeSpan.arg("records", result.records);
+            typeSpan.arg("pages", result.pages);
+            typeSpan.arg("status", HealthBridge::statusName(result.status));
+
+            if (result.status == HealthBridge::StreamCancelled)
+                return;
+            if (result.status == HealthBridge::StreamDenied)
+                QMetaObject::invokeMethod(this, &Backend::invalidatePermissions, Qt::QueuedConnection);
+            if (result.status != HealthBridge::StreamComplete) {
+                incomplete.append(type);
+                problems.append(QString("%1: %2").arg(HealthBridge::typeName(type),
+                                                      HealthBridge::statusName(result.status)));
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, generation, types, incomplete, startTime,
+                                         endTime, endTo, problems]() {
+            finishUpdate(generation, types, incomplete, startTime, endTime, endTo, problems);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void Backend::finishUpdate(quint64 generation, const QList<int> &types, const QList<int> &incomplete,
+                           const QString &startTime, const QString &endTime,
+                           const QDateTime &endTo, const QStringList &problems)
+{
+    if (m_readGeneration.load() != generation)
+        return;
+    m_reading = false;
+    TraceSpan span("refresh", "finishUpdate");
 
+    // فقط آنچه از Health Connect آمده — پیش از write های در صف
+    cacheLoadedWindows(types, incomplete, endTo);
+
+    // صفحه‌ها با seriesChunkRead رسیده‌اند؛ اینجا فقط write های در صف و محورها —
+    // ساختن دوباره‌ی همه‌ی سری‌ها (newDataRead) فقط برای snapshot
+    mergePendingWrites(types, endTo);
+    emit seriesAxesRead(seriesAxes());
+
+    if (!problems.isEmpty())
+        qDebug() << "⚠️ Incomplete read:" << problems.join(", ");
+    emit readFinished(problems.isEmpty(), problems.join("، "));
+
+    // همان لحظه، بدون تأخیر ثابت — QML با modelReset دوباره می‌کشد
     readMenstruationData(startTime,endTime);
+    mergePendingMenstruation();
+    publishMenstruation();
 
+    m_livePaintPending = static_cast<bool>(m_paintConnection);
+    saveSnapshot(true);
 
-    QString menstrJsonStr;
+    // کل refresh از کلیک تا آخرین signal یک span است؛ هر refresh فایل را به‌روز می‌کند
+    Tracer::complete("refresh", "refresh", m_refreshStartUs, Tracer::nowUs() - m_refreshStartUs,
+                     {{"types", types.size()}, {"problems", problems.size()}});
+    Tracer::flush();
+}
 
-    if (periodJsonDoc.isNull() || !periodJsonDoc.isObject()) {
-        menstrJsonStr = "{\"periods\":[],\"flows\":[]}";
-    } else {
-        QJsonObject root     = periodJsonDoc.object();
-        QJsonArray  inPeriods = root["periods"].toArray();
-        QJsonArray  inFlows   = root["flows"].toArray();
-
-        QJsonArray outPeriods;
-        for (const MenstruationPeriod &p : periodList) {
-            QJsonObject out;
-            out["startMs"] = p.start.toMSecsSinceEpoch();
-            out["endMs"]   = p.end.toMSecsSinceEpoch();
-            outPeriods.append(out);
+// ── کش پنجره‌ها ──────────────────────────────────────────────
+SeriesCache::Columns Backend::liveColumns(int type)
+{
+    SeriesCache::Columns columns;
+    if (const QList<QPointF> *list = seriesList(type))
+        columns.values = *list;
+    const QList<QList<QPointF> *> parallel = parallelSeries(type);
+    switch (Metric::shapeOf(type)) {
+    case Metric::Pair:
+        columns.values2 = *parallel.at(0);
+        break;
+    case Metric::Glucose:
+        columns.specimen = *parallel.at(0);
+        columns.meal     = *parallel.at(1);
+        columns.relation = *parallel.at(2);
+        break;
+    case Metric::Single:
+        break;
+    }
+    return columns;
+}
+
+void Backend::cacheLoadedWindows(const QList<int> &types, const QList<int> &incomplete,
+                                 const QDateTime &endTo)
+{
+    if (!m_loadedFrom.isValid())
+        return;
+    const qint64 fromMs = m_loadedFrom.toMSecsSinceEpoch();
+    const qint64 toMs   = endTo.toMSecsSinceEpoch();
+    const qint64 nowMs  = QDateTime::currentMSecsSinceEpoch();
+    const bool   daily  = qint64(bucketSecondsFor(toMs - fromMs)) * 1000 == SeriesCache::CoarseBucketMs;
+
+    for (int type : types) {
+        if (incomplete.contains(type))
+            continue;
+        const auto bucket = m_buckets.constFind(type);
+        if (bucket == m_buckets.cend())
+            m_cache.store(type, fromMs, toMs, nowMs, liveColumns(type));
+        else if (daily)
+            m_cache.storeCoarse(type, fromMs, toMs, nowMs,
+                                {bucket->avg, bucket->avg2, bucket->min, bucket->max});
+    }
+    emit memoryUsageChanged();
+}
+
+QVariantMap Backend::memoryUsage() const
+{
+    const SeriesCache::Usage usage = m_cache.usage();
+
+    QVariantMap perMetric;
+    for (auto it = usage.bytesPerType.cbegin(); it != usage.bytesPerType.cend(); ++it)
+        perMetric.insert(QString::fromLatin1(HealthBridge::typeName(it.key())), it.value());
+
+    QVariantList windows;
+    for (const SeriesCache::Window &w : m_cache.windows()) {
+        windows.append(QVariantMap{
+            {"metric",      QString::fromLatin1(HealthBridge::typeName(w.type))},
+            {"fromMs",      w.fromMs},
+            {"toMs",        w.toMs},
+            {"rawBytes",    w.raw.bytes()},
+            {"packedBytes", w.packed.bytes()},
+            {"packedRatio", w.packed.compressionRatio()},
+            {"coarseBytes", w.coarse.bytes()},
+            {"resident",    w.resident},
+            {"lastViewed",  w.lastViewed}
+        });
+    }
+
+    // سری‌هایی که الان به QML داده شده‌اند؛ با پنجره‌ی view ی جاری implicitly shared
+    // هستند، ولی QML یک کپی جدا در سری‌های Qt Charts نگه می‌دارد
+    qint64 liveBytes = 0;
+    for (const auto &member : seriesMembers())
+        liveBytes += (this->*member.second).size() * qint64(sizeof(QPointF));
+    for (const BucketSeries &b : m_buckets)
+        liveBytes += (b.avg.size() + b.avg2.size() + b.min.size() + b.max.size()) * qint64(sizeof(QPointF));
+
+    return {
+        {"budgetBytes",     usage.budgetBytes},
+        {"totalBytes",      usage.totalBytes()},
+        {"rawBytes",        usage.rawBytes},
+        {"packedBytes",     usage.packedBytes},
+        {"coarseBytes",     usage.coarseBytes},
+        {"liveBytes",       liveBytes},
+        {"windows",         usage.windows},
+        {"residentWindows", usage.resident},
+        {"packedWindows",   usage.packed},
+        {"hits",            usage.hits},
+        {"misses",          usage.misses},
+        {"evictions",       usage.evictions},
+        {"perMetric",       perMetric},
+        {"windowList",      windows}
+    };
+}
+
+// ── شروع گرم ─────────────────────────────────────────────────
+QList<QPair<QString, QList<QPointF> *>> Backend::namedSeries()
+{
+    QList<QPair<QString, QList<QPointF> *>> out;
+    for (const auto &member : seriesMembers())
+        out.append({QString::fromLatin1(member.first), &(this->*member.second)});
+    return out;
+}
+
+RenderSnapshot Backend::captureSnapshot()
+{
+    RenderSnapshot snapshot;
+    snapshot.savedAtMs    = QDateTime::currentMSecsSinceEpoch();
+    snapshot.loadedFromMs = m_loadedFrom.isValid() ? m_loadedFrom.toMSecsSinceEpoch() : 0;
+
+    // ── هر نوع حداکثر MaxPointsPerType نقطه؛ سری‌های موازی با همان اندیس‌ها ──
+    QHash<const QList<QPointF> *, QList<QPointF>> reduced;
+    for (int type : Metric::allTypes()) {
+        const QList<QPointF> *primary = seriesList(type);
+        if (!primary || primary->size() <= RenderSnapshot::MaxPointsPerType)
+            continue;
+        const QList<qsizetype> keep =
+            RenderSnapshot::extremaIndices(*primary, RenderSnapshot::MaxPointsPerType);
+        QList<const QList<QPointF> *> lists = {primary};
+        for (const QList<QPointF> *parallel : parallelSeries(type))
+            lists.append(parallel);
+        for (const QList<QPointF> *list : std::as_const(lists)) {
+            QList<QPointF> points;
+            points.reserve(keep.size());
+            for (qsizetype i : keep)
+                points.append(list->at(i));
+            reduced.insert(list, points);
         }
+    }
+    // بقیه‌ی QList ها implicitly shared هستند — کپی واقعی انجام نمی‌شود
+    for (const auto &named : namedSeries()) {
+        if (!named.second->isEmpty())
+            snapshot.series.insert(named.first, reduced.value(named.second, *named.second));
+    }
+    for (auto it = m_buckets.cbegin(); it != m_buckets.cend(); ++it)
+        snapshot.buckets.insert(it.key(), {it->avg, it->avg2, it->min, it->max});
+    snapshot.axes = m_displayedAxes;
+    for (const MenstruationModel::Period &p : m_menstruationModel->periods())
+        snapshot.periods.append(QPointF(p.startMs, p.endMs));
+    for (const MenstruationModel::Flow &f : m_menstruationModel->flows())
+        snapshot.flows.append(QPointF(f.timeMs, f.level));
+    return snapshot;
+}
+
+void Backend::applySnapshot(const RenderSnapshot &snapshot)
+{
+    for (const auto &named : namedSeries())
+        *named.second = snapshot.series.value(named.first);
+
+    m_buckets.clear();
+    for (auto it = snapshot.buckets.cbegin(); it != snapshot.buckets.cend(); ++it) {
+        if (it->size() != 4)
+            continue;
+        m_buckets.insert(it.key(), {it->at(0), it->at(1), it->at(2), it->at(3)});
+    }
+
+    if (snapshot.loadedFromMs > 0)
+        m_loadedFrom = QDateTime::fromMSecsSinceEpoch(snapshot.loadedFromMs);
+    m_displayedAxes     = snapshot.axes;
+    m_snapshotSavedAtMs = snapshot.savedAtMs;
+    m_snapshotPoints    = snapshot.pointCount();
+    m_snapshotShown     = true;
+
+    QList<MenstruationModel::Period> periods;
+    periods.reserve(snapshot.periods.size());
+    for (const QPointF &p : snapshot.periods)
+        periods.append({qint64(p.x()), qint64(p.y())});
+    QList<MenstruationModel::Flow> flows;
+    flows.reserve(snapshot.flows.size());
+    for (const QPointF &f : snapshot.flows)
+        flows.append({qint64(f.x()), int(f.y())});
+    m_menstruationModel->setPeriods(std::move(periods), std::move(flows));
+}
+
+void Backend::saveSnapshot(bool async)
+{
+    TraceSpan span("snapshot", "captureSnapshot");
+    RenderSnapshot snapshot = captureSnapshot();
+    if (snapshot.isEmpty())
+        return;
+    const QString filePath = QDir(path).filePath(SnapshotName);
+
+    auto save = [snapshot, filePath]() {
+        TraceSpan saveSpan("snapshot", "saveSnapshot");
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (snapshot.save(filePath, &error))
+            qDebug() << "🧊 Render snapshot saved:" << snapshot.pointCount() << "points in"
+                     << timer.elapsed() << "ms";
+        else
+            qWarning() << "⚠️ Cannot save render snapshot:" << error;
+    };
+    // روی m_snapshotPool — پشت خواندن‌های m_readPool منتظر نمی‌ماند و جلویشان را نمی‌گیرد
+    if (async)
+        QtConcurrent::run(&m_snapshotPool, save);
+    else
+        save();
+}
+
+void Backend::setDisplayedAxes(const QVariantMap &axes)
+{
+    m_displayedAxes = axes;
+}
 
-        QJsonArray outFlows;
-        for (const MenstruationFlow &f : periodFlowList) {
-            QJsonObject out;
-            out["timeMs"] = f.time.toMSecsSinceEpoch();
-            out["level"]  = f.level;
-            outFlows.append(out);
+void Backend::traceEnd(const QString &name, qint64 startUs)
+{
+    if (startUs >= 0)
+        Tracer::complete("qml", name, startUs, Tracer::nowUs() - startUs);
+}
+
+QString Backend::dumpMetrics()
+{
+    const QString filePath = QDir(path).filePath(
+        QString("metrics-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+    QString error;
+    if (!StageMetrics::dump(filePath, &error)) {
+        qWarning() << "⚠️ Cannot dump metrics:" << error;
+        return {};
+    }
+    qDebug() << "📈 Metrics dumped to" << filePath;
+    return filePath;
+}
+
+void Backend::trackFirstPaint(QQuickWindow *window)
+{
+    // frameSwapped روی render thread می‌آید؛ اینجا queued روی GUI thread
+    m_paintConnection = connect(window, &QQuickWindow::frameSwapped, this, [this]() {
+        const qint64 elapsed = m_startupTimer.elapsed();
+        if (!m_firstFrameLogged) {
+            m_firstFrameLogged = true;
+            Tracer::instant("startup", "firstFrame");
+            qDebug() << "🖼️ First frame:" << elapsed << "ms";
+            if (m_snapshotPoints > 0) {
+                m_meaningfulPaintLogged = true;
+                qDebug() << "⏱️ Time to first meaningful paint:" << elapsed
+                         << "ms (snapshot," << m_snapshotPoints << "points)";
+            }
+        }
+        if (m_livePaintPending) {
+            m_livePaintPending = false;
+            Tracer::instant("refresh", "firstLiveFrame");
+            qDebug() << "🖼️ First frame with Health Connect data:" << elapsed << "ms";
+            if (!m_meaningfulPaintLogged)
+                qDebug() << "⏱️ Time to first meaningful paint:" << elapsed << "ms (live read)";
+            disconnect(m_paintConnection);
         }
+    }, Qt::QueuedConnection);
+}
 
-        QJsonObject finalRoot;
-        finalRoot["periods"] = outPeriods;
-        finalRoot["flows"]   = outFlows;
-        menstrJsonStr = QJsonDocument(finalRoot).toJson(QJsonDocument::Compact);
+void Backend::onExportRequest(bool height, bool weight, bool bp, bool bg, bool hr, bool spo2)
+{
+    // snapshot فقط نقاط کاهش‌یافته دارد و نباید خروجی گرفته شود
+    if (m_reading || m_exporting || m_snapshotShown) {
+        emit exportCompleted(false, "داده‌ها هنوز در حال بارگذاری هستند");
+        return;
     }
 
-    qDebug() << "📤 menstruation JSON ready:" << menstrJsonStr.left(200);
+    const QList<int> types = selectedTypes(height, weight, bp, bg, hr, spo2);
+    const int mode = m_exportMode;
+
+    // ── متریک → خواندن خام از این زمان تا الان ──
+    //    سری‌هایی که تجمیعی خوانده شده‌اند از شروع بازه‌ی چارت؛ در XLSX
+    //    رکوردهای جدیدی که قبل از شروع بازه‌اند از watermark همان متریک
+    QHash<QString, qint64> reads;
+    const qint64 loadedFromMs = m_loadedFrom.isValid() ? m_loadedFrom.toMSecsSinceEpoch() : 0;
+    for (int type : types) {
+        if (m_buckets.contains(type))
+            reads.insert(Metric::key(type), loadedFromMs);
+    }
+    if (m_exportFormat == SeriesExporter::Xlsx && mode != ExportFull) {
+        const qint64 shownFromMs = m_loadedFrom.isValid() ? loadedFromMs
+                                                          : std::numeric_limits<qint64>::max();
+        for (int type : types) {
+            const QString metric = Metric::key(type);
+            const qint64 since = exportSince(mode, metric);
+            if (since > 0 && since < shownFromMs)
+                reads.insert(metric, since);
+        }
+        const qint64 menstruationSince = qMin(exportSince(mode, "menstruationPeriods"),
+                                              exportSince(mode, "menstruationFlows"));
+        if (menstruationSince > 0 && menstruationSince < shownFromMs)
+            reads.insert("menstruation", menstruationSince);
+    }
 
-    // ✅ فقط emit داخل تایمر - jsonStr کپی شده در lambda
-    QTimer::singleShot(100, this, [this, menstrJsonStr]() {
-        emit menstruationDataRead(menstrJsonStr);
+    if (reads.isEmpty()) {
+        finishExport(types, mode, reads, {}, QString(), {});
+        return;
+    }
+
+    // ── خواندن‌ها روی m_readPool، مثل onUpdateRequest؛ خروجی در ادامه روی thread اصلی ──
+    m_exporting = true;
+    const QString endTime = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    QtConcurrent::run(&m_readPool, [this, types, mode, reads, endTime]() {
+        HealthBridge *bridge = HealthBridge::instance();
+        QList<SeriesChunk> chunks;
+        QString menstruationJson;
+        QStringList problems;
+        for (auto it = reads.cbegin(); it != reads.cend(); ++it) {
+            const QString startTime =
+                QDateTime::fromMSecsSinceEpoch(it.value()).toUTC().toString(Qt::ISODateWithMs);
+            qDebug() << "🔁 Export reload" << it.key() << "from" << startTime;
+            if (!bridge) {
+                problems.append(QString("%1: Health Connect unavailable").arg(it.key()));
+                continue;
+            }
+            if (it.key() == "menstruation") {
+                menstruationJson = bridge->readMenstruation(startTime, endTime);
+                if (menstruationJson.startsWith("ERROR") || menstruationJson == "CLIENT_NULL")
+                    problems.append(QString("menstruation: %1").arg(menstruationJson.left(80)));
+                continue;
+            }
+            const int type = metricType(it.key());
+            HealthBridge::StreamResult result = bridge->stream(type, startTime, endTime,
+                [&chunks](const HealthBridge::Page &page) {
+                    chunks.append(toChunk(page));
+                    return true;
+                });
+            if (result.status == HealthBridge::StreamDenied)
+                QMetaObject::invokeMethod(this, &Backend::invalidatePermissions, Qt::QueuedConnection);
+            if (result.status != HealthBridge::StreamComplete) {
+                qDebug() << "⚠️" << HealthBridge::typeName(type) << "read:"
+                         << HealthBridge::statusName(result.status) << result.message.left(80);
+                problems.append(QString("%1: %2").arg(HealthBridge::typeName(type),
+                                                      HealthBridge::statusName(result.status)));
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, types, mode, reads, chunks,
+                                         menstruationJson, problems]() {
+            finishExport(types, mode, reads, chunks, menstruationJson, problems);
+        }, Qt::QueuedConnection);
     });
-#else
-    qDebug() << "Not Android";
-#endif
 }
 
-void Backend::onExportRequest(bool height, bool weight, bool bp, bool bg, bool hr, bool spo2)
+void Backend::finishExport(const QList<int> &types, int mode, const QHash<QString, qint64> &reads,
+                           const QList<SeriesChunk> &chunks, const QString &menstruationJson,
+                           const QStringList &problems)
 {
-#ifdef Q_OS_ANDROID
-    QXlsx::Document xlsx;
-    //xlsx.deleteSheet(xlsx.sheetNames().first());
-    if(height)
-    {
-        exportHeight(&xlsx);
+    m_exporting = false;
+
+    // خواندن ناقص یعنی ردیف‌های جاافتاده — خروجی نوشته نمی‌شود و watermark ها جلو نمی‌روند
+    if (!problems.isEmpty()) {
+        qDebug() << "⚠️ Export aborted, incomplete read:" << problems.join(", ");
+        emit exportCompleted(false, QString("Export aborted, incomplete Health Connect read: %1")
+                                        .arg(problems.join(", ")));
+        return;
     }
-    if(weight)
-    {
-        exportWeight(&xlsx);
+
+    // ── سری‌های بازه‌ی نمایش‌داده‌شده کنار گذاشته و بعد از خروجی برگردانده می‌شوند ──
+    const QList<QPair<QString, QList<QPointF> *>> series = namedSeries();
+    QList<QList<QPointF>> shownSeries;
+    for (const auto &named : series)
+        shownSeries.append(*named.second);
+    const QList<MenstruationPeriod> shownPeriods = periodList;
+    const QList<MenstruationFlow>   shownFlows   = periodFlowList;
+    auto restoreShown = [&]() {
+        for (qsizetype k = 0; k < series.size(); ++k)
+            *series.at(k).second = shownSeries.at(k);
+        periodList     = shownPeriods;
+        periodFlowList = shownFlows;
+    };
+
+    for (auto it = reads.cbegin(); it != reads.cend(); ++it) {
+        if (it.key() == "menstruation")
+            parseMenstruation(menstruationJson);
+        else
+            clearSeries(metricType(it.key()));
     }
-    if(bp)
-    {
-        exportBP(&xlsx);
+    for (const SeriesChunk &chunk : chunks)
+        appendChunk(chunk);
+
+    // ── CSV / NDJSON / HCOL مستقیم از سری‌های حافظه ──
+    if (m_exportFormat != SeriesExporter::Xlsx) {
+        exportSeries(types);
+        restoreShown();
+        return;
     }
-    if(bg)
-    {
-        exportBG(&xlsx);
+
+    QElapsedTimer exportTimer;
+    exportTimer.start();
+
+    const QString runningPath = QDir(path).filePath(RunningWorkbookName);
+
+    // ── watermark هر متریک: در حالت Full همه‌چیز نوشته می‌شود ──
+    auto since = [mode](const QString &metric) -> qint64 {
+        return (mode == ExportFull) ? 0 : exportSince(mode, metric);
+    };
+    auto backfill = [mode](const QString &metric) -> qint64 {
+        return (mode == ExportFull) ? 0 : QSettings().value(backfillKey(mode, metric), 0LL).toLongLong();
+    };
+
+    // ── فایل تجمعی: ادامه‌ی همان فایل، یا شروع از صفر اگر نباشد ──
+    std::unique_ptr<QXlsx::Document> xlsx;
+    if (mode == ExportRunning && QFile::exists(runningPath)) {
+        xlsx.reset(new QXlsx::Document(runningPath));
+        if (!xlsx->isLoadPackage()) {
+            qWarning() << "⚠️ Running workbook unreadable, starting a new one:" << runningPath;
+            xlsx.reset();
+        }
     }
-    if(hr)
-    {
-        exportHR(&xlsx);
+    if (!xlsx) {
+        xlsx.reset(new QXlsx::Document);
+        if (mode == ExportRunning) {
+            QSettings settings;
+            settings.remove("export/running");
+        }
     }
-    if(spo2)
-    {
-        exportOxygenSaturation(&xlsx);
+
+    // ── متریک → جدیدترین رکورد نوشته‌شده ──
+    //    با back-dated رکوردها فایل تجمعی ردیف‌های موجود را دوباره نمی‌نویسد
+    QHash<QString, qint64> newest;
+    QHash<QString, qint64> backfills;
+    for (int type : types) {
+        const QString metric = Metric::key(type);
+        backfills[metric] = backfill(metric);
+        newest[metric] = exportMetric(type, xlsx.get(), since(metric),
+                                      mode == ExportRunning && backfills[metric] > 0);
     }
     if ((periodFlowList.length() > 0) || (periodList.length() > 0))
     {
-        exportMenstruationData(&xlsx);
+        qint64 newestPeriod = 0, newestFlow = 0;
+        exportMenstruationData(xlsx.get(),
+                               since("menstruationPeriods"), since("menstruationFlows"),
+                               &newestPeriod, &newestFlow);
+        newest["menstruationPeriods"] = newestPeriod;
+        newest["menstruationFlows"]   = newestFlow;
+    }
+
+    restoreShown();
+
+    bool hasNewRecords = false;
+    for (auto it = newest.cbegin(); it != newest.cend(); ++it)
+        hasNewRecords = hasNewRecords || (it.value() > since(it.key()));
+
+    if (mode != ExportFull && !hasNewRecords) {
+        qDebug() << "📦 Export skipped: nothing newer than last export";
+        emit exportCompleted(true, QString("No new records since last export"));
+        return;
     }
 
-    QString excelFileName = QDateTime::currentDateTime().toString(QString("yyyy-MM-dd_hh:mm:ss"));
-    QString excelPath = QString("%1/%2.xlsx").arg(path, excelFileName);
+    qint64 xlsxRows = 0;
+    for (const QString &sheet : xlsx->sheetNames()) {
+        xlsx->selectSheet(sheet);
+        xlsxRows += qMax(0, xlsx->dimension().lastRow() - 1);
+    }
 
-    bool success = xlsx.saveAs(excelPath);
+    QString timestamp = QDateTime::currentDateTime().toString(QString("yyyy-MM-dd_hh:mm:ss"));
+    QString excelFileName;
+    bool success = false;
+    QString error;
     QString message;
+    ZipRepacker::Stats zipStats;
 
-    if(success)
+    if (mode == ExportRunning)
     {
-        message = QString("Excel file prepaired.\n");
-        success = copyToDownloads(excelPath,excelFileName);
-        if(success)
+        // ✅ اول فایل تجمعی داخل برنامه به‌صورت اتمی جایگزین می‌شود،
+        //    بعد یک کپی از آن در Downloads قرار می‌گیرد
+        excelFileName = QString("running_%1.xlsx").arg(timestamp);
+        LocalFileSink runningSink(runningPath);
+        success = writeWorkbook(xlsx.get(), &runningSink, &error, &zipStats);
+        if (success && !copyToDownloads(runningPath, excelFileName))
         {
-            message.append(QString("File %1 Saved to Downloads").arg(excelFileName));
+            // فایل تجمعی به‌روز شده؛ watermark جلو می‌رود تا ردیف‌ها تکراری نشوند
+            error = QString("Running workbook updated but cannot be copied to Downloads");
         }
     }
     else
     {
-        message = QString("Excel file Cannot write on \"%1\"").arg(excelPath);
+        excelFileName = timestamp + (mode == ExportDelta ? "_delta.xlsx" : ".xlsx");
+        // ✅ QXlsx بسته را در حافظه می‌سازد؛ ظرف ZIP با حالت انتخابی
+        //    مستقیم روی مقصد (Downloads) نوشته می‌شود — بدون فایل موقت
+        std::unique_ptr<OutputSink> sink(OutputSink::createDownloadsSink(excelFileName, XlsxMimeType));
+        success = writeWorkbook(xlsx.get(), sink.get(), &error, &zipStats);
+    }
+
+    if(success)
+    {
+        QSettings settings;
+        for (auto it = newest.cbegin(); it != newest.cend(); ++it) {
+            if (it.value() > exportWatermark(mode, it.key()))
+                settings.setValue(watermarkKey(mode, it.key()), it.value());
+        }
+        // back-dated رکوردی که در همین فاصله رسیده برای خروجی بعدی می‌ماند
+        for (auto it = backfills.cbegin(); it != backfills.cend(); ++it) {
+            if (it.value() > 0 && backfill(it.key()) == it.value())
+                settings.remove(backfillKey(mode, it.key()));
+        }
+        qDebug() << "💾 Export watermarks updated:" << newest;
+        logExportThroughput("xlsx", xlsxRows, zipStats.outputBytes, exportTimer.elapsed());
+
+        message = error.isEmpty()
+                      ? QString("Excel file prepaired.\nFile %1 Saved to Downloads").arg(excelFileName)
+                      : error;
+        success = error.isEmpty();
+    }
+    else
+    {
+        message = QString("Excel file Cannot write \"%1\": %2").arg(excelFileName, error);
     }
 
     emit exportCompleted(success,message);
-#else
-    qDebug() << "Not Android";
-#endif
 }
 
-void Backend::writeHeight(double heightMeters,QDateTime dt)
+int Backend::openExportSheet(QXlsx::Document *xlsx, const QString &name)
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    // ردیف بعدی برای نوشتن؛ 1 یعنی شیت تازه ساخته شده و هدر لازم دارد
+    if (xlsx->sheetNames().contains(name)) {
+        xlsx->selectSheet(name);
+        const int lastRow = xlsx->dimension().lastRow();
+        if (lastRow >= 1)
+            return lastRow + 1;
+        return 1;
+    }
+    xlsx->addSheet(name);
+    xlsx->selectSheet(name);
+    return 1;
+}
 
-    if (!activity.isValid()) {
-        qDebug() << "❌ Activity is invalid!";
-        emit heightWritten(false, "Activity is invalid");
-        return;
-    }
+bool Backend::writeWorkbook(QXlsx::Document *xlsx, OutputSink *sink, QString *error,
+                            ZipRepacker::Stats *zipStats)
+{
+    QElapsedTimer saveTimer;
+    saveTimer.start();
 
-    // بررسی اعتبار مقدار قد
-    if (heightMeters < 0.1 || heightMeters > 3) {
-        qDebug() << "❌ Invalid height value: " << heightMeters;
-        emit heightWritten(false, QString("مقدار قد نامعتبر است: %1 متر").arg(heightMeters));
-        return;
+    QBuffer packageBuffer;
+    packageBuffer.open(QIODevice::WriteOnly);
+    if (!xlsx->saveAs(&packageBuffer)) {
+        *error = QString("Excel file Cannot be built");
+        return false;
     }
+    const qint64 buildMs = saveTimer.elapsed();
+
+    ZipRepacker::Stats stats;
+    bool success = sink->open(QIODevice::WriteOnly)
+                   && ZipRepacker::repack(packageBuffer.data(), sink,
+                                          static_cast<ZipRepacker::Compression>(m_exportCompression),
+                                          &stats, error)
+                   && sink->commit();
+
+    qDebug() << "📦 Export package:"
+             << ZipRepacker::compressionName(m_exportCompression)
+             << "| xml:" << stats.uncompressedBytes
+             << "| qxlsx:" << stats.inputBytes << "B in" << buildMs << "ms"
+             << "| out:" << stats.outputBytes << "B in" << stats.elapsedMs << "ms";
+
+    if (!success) {
+        sink->discard();
+        if (error->isEmpty())
+            *error = QString("%1 (%2)").arg(sink->errorString(), sink->location());
+    }
+    if (zipStats)
+        *zipStats = stats;
+    return success;
+}
 
-    // ✅ دریافت زمان فعلی به فرمت ISO8601
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
+void Backend::exportSeries(const QList<int> &types)
+{
+    using Exp = SeriesExporter;
+    const auto format = static_cast<Exp::Format>(m_exportFormat);
 
-    // ✅ فراخوانی متد Kotlin با پارامتر زمان
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeHeight",
-        "(DLjava/lang/String;)Ljava/lang/String;",  // D=double, String=time
-        heightMeters,
-        jTime.object<jstring>()
-        );
+    QString fileName = QDateTime::currentDateTime().toString(QString("yyyy-MM-dd_hh:mm:ss"))
+                       + Exp::fileExtension(format);
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
+    std::unique_ptr<OutputSink> sink(OutputSink::createDownloadsSink(fileName, Exp::mimeType(format)));
+    Exp::Stats stats;
+    QString error;
 
-    if(success)
-    {
-        status = QString("%1 m").arg(heightMeters);
+    bool success = writeSeries(types, format, sink.get(), &stats, &error);
+
+    QString message;
+    if (success) {
+        logExportThroughput(Exp::formatName(format), stats.rows, stats.bytes, stats.elapsedMs);
+        message = QString("File %1 Saved to Downloads").arg(fileName);
+    } else {
+        message = QString("Cannot write \"%1\": %2")
+                      .arg(sink->location(), error.isEmpty() ? sink->errorString() : error);
     }
 
-    emit heightWritten(success, status);
+    emit exportCompleted(success, message);
+}
 
-#else
-    qDebug() << "Not Android - Height write skipped";
-    emit heightWritten(false, "Not running on Android");
-#endif
+bool Backend::writeSeries(const QList<int> &types,
+                          SeriesExporter::Format format, OutputSink *sink,
+                          SeriesExporter::Stats *stats, QString *error)
+{
+    using Exp = SeriesExporter;
+
+    // ── جدول‌ها فقط به سری‌های موجود اشاره می‌کنند — کپی نمی‌شوند ──
+    QList<Exp::Table> tables;
+    Metric::forEachMetric([&](auto m) {
+        using M = decltype(m);
+        if (!types.contains(M::type))
+            return;
+        const QList<QList<QPointF> *> parallel = parallelSeries(M::type);
+        Exp::Table table{M::key, {}};
+        for (std::size_t c = 0; c < std::size(M::columns); ++c) {
+            const QList<QPointF> *points = c == 0 ? seriesList(M::type) : parallel.at(qsizetype(c) - 1);
+            table.columns.append({M::columns[c].name, M::columns[c].type, points});
+        }
+        tables.append(table);
+    });
+
+    // ── قاعدگی: QDateTime ها یک بار به ms تبدیل می‌شوند ──
+    QList<QPointF> periodEnds;
+    periodEnds.reserve(periodList.size());
+    for (const MenstruationPeriod &p : periodList)
+        periodEnds.append(QPointF(p.start.toMSecsSinceEpoch(), p.end.toMSecsSinceEpoch()));
+
+    QList<QPointF> flowLevels;
+    flowLevels.reserve(periodFlowList.size());
+    for (const MenstruationFlow &f : periodFlowList)
+        flowLevels.append(QPointF(f.time.toMSecsSinceEpoch(), f.level));
+
+    if (!periodEnds.isEmpty())
+        tables.append({"menstruationPeriods", {{"end_ms", Exp::Int64, &periodEnds}}});
+    if (!flowLevels.isEmpty())
+        tables.append({"menstruationFlows", {{"level", Exp::UInt8, &flowLevels}}});
+
+    const bool success = sink->open(QIODevice::WriteOnly)
+                         && Exp::write(tables, format, sink, stats, error)
+                         && sink->commit();
+    if (!success)
+        sink->discard();
+    return success;
 }
 
-void Backend::writeWeight(double weightKg,QDateTime dt)
+// ── headless: fetch → decode → export در یک گذر ────────────────
+bool Backend::exportRange(const QList<int> &types, const QDateTime &from, const QDateTime &to,
+                          int format, int compression, OutputSink *sink,
+                          RangeExportStats *stats, QString *error)
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    TraceSpan span("headless", "exportRange");
+    RangeExportStats s;
+    QElapsedTimer timer;
+    const QString startTime = from.toUTC().toString(Qt::ISODateWithMs);
+    const QString endTime   = to.toUTC().toString(Qt::ISODateWithMs);
+
+    // snapshot ی بارگذاری‌شده، یا هنوز در راه، کنار گذاشته می‌شود
+    ++m_readGeneration;
+    for (int type : Metric::allTypes())
+        clearSeries(type);
+    m_buckets.clear();
+    m_snapshotShown = false;
+
+    // ── همه‌ی صفحه‌های خام، مثل خواندن‌های onExportRequest؛ بازه‌های چندساله shard می‌شوند ──
+    const bool sharded = from.msecsTo(to) >= 2 * ShardedReader::MinShardMs;
+    ShardedReader shardedReader(HealthBridge::instance());
+    auto onPage = [this](const HealthBridge::Page &page) {
+        SeriesChunk chunk;
+        {
+            StageMetrics::Timer decodeTimer(StageMetrics::Decode, page.count);
+            chunk = toChunk(page);
+        }
+        appendChunk(chunk);
+        return true;
+    };
 
-    if (!activity.isValid()) {
-        qDebug() << "❌ Activity is invalid!";
-        emit weightWritten(false, "Activity is invalid");
-        return;
-    }
+    QStringList problems;
+    timer.start();
+    for (int type : types) {
+        TraceSpan typeSpan("read", HealthBridge::typeName(type));
+        QElapsedTimer typeTimer;
+        typeTimer.start();
+        HealthBridge::StreamResult result;
+        {
+            StageMetrics::Timer bridgeTimer(StageMetrics::BridgeCall);
+            result = sharded ? shardedReader.read(type, from, to, onPage)
+                             : HealthBridge::instance()->stream(type, startTime, endTime, onPage);
+            bridgeTimer.setItems(result.records);
+        }
+        s.metrics.append({type, result.records, result.pages, typeTimer.elapsed(), int(result.status)});
+        s.records += result.records;
+        if (result.status != HealthBridge::StreamComplete)
+            problems.append(QString("%1: %2").arg(HealthBridge::typeName(type),
+                                                  HealthBridge::statusName(result.status)));
+    }
+    s.fetchMs = timer.elapsed();
+
+    timer.restart();
+    readMenstruationData(startTime, endTime);
+    s.periods        = int(periodList.size());
+    s.flows          = int(periodFlowList.size());
+    s.menstruationMs = timer.elapsed();
+
+    bool success = problems.isEmpty();
+    if (!success && error)
+        *error = QString("Incomplete read: %1").arg(problems.join(", "));
+
+    // ── export ──
+    timer.restart();
+    if (success && format == SeriesExporter::Xlsx) {
+        QXlsx::Document xlsx;
+        // ترتیب شیت‌ها همان ترتیب Metric::forEachMetric است، نه ترتیب --metrics
+        for (int type : Metric::allTypes()) {
+            if (types.contains(type))
+                exportMetric(type, &xlsx);
+        }
+        if (!periodList.isEmpty() || !periodFlowList.isEmpty())
+            exportMenstruationData(&xlsx);
+        // هر رکورد یک ردیف (sinceMs = 0)
+        s.rows = s.records + s.periods + s.flows;
+        QString writeError;
+        ZipRepacker::Stats zipStats;
+        // بدون setExportCompression، که تنظیم کاربر را ذخیره می‌کند
+        const int savedCompression = m_exportCompression;
+        if (compression >= ZipRepacker::Store && compression <= ZipRepacker::ParallelMaximum)
+            m_exportCompression = compression;
+        success = writeWorkbook(&xlsx, sink, &writeError, &zipStats);
+        m_exportCompression = savedCompression;
+        s.bytes = zipStats.outputBytes;
+        if (!success && error)
+            *error = writeError;
+    } else if (success) {
+        QString writeError;
+        SeriesExporter::Stats exportStats;
+        success = writeSeries(types, SeriesExporter::Format(format), sink, &exportStats, &writeError);
+        s.rows  = exportStats.rows;
+        s.bytes = exportStats.bytes;
+        if (!success && error)
+            *error = writeError.isEmpty() ? sink->errorString() : writeError;
+    }
+    s.exportMs = timer.elapsed();
+    if (success)
+        logExportThroughput(SeriesExporter::formatName(format), s.rows, s.bytes, s.exportMs);
+
+    // چیزی برای snapshot ی مخرب نمی‌ماند — snapshot ی برنامه دست نمی‌خورد
+    for (int type : Metric::allTypes())
+        clearSeries(type);
+    periodList.clear();
+    periodFlowList.clear();
 
-    if (weightKg < 0.1 || weightKg > 300.0) {
-        qDebug() << "❌ Invalid weight value: " << weightKg;
-        emit weightWritten(false, QString("مقدار وزن نامعتبر است: %1 کیلوگرم").arg(weightKg));
-        return;
-    }
+    if (stats)
+        *stats = s;
+    return success;
+}
 
-    // ✅ دریافت زمان فعلی
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
+void Backend::logExportThroughput(const QString &format, qint64 rows,
+                                  qint64 bytes, qint64 elapsedMs)
+{
+    StageMetrics::record(StageMetrics::ExportRows, elapsedMs * 1000, rows);
+
+    // برای مقایسه‌ی قالب‌ها با هم — همه با یک واحد
+    const double seconds = qMax<qint64>(elapsedMs, 1) / 1000.0;
+    qDebug() << "📊 Export throughput:" << format
+             << "|" << rows << "rows," << bytes << "B in" << elapsedMs << "ms"
+             << "|" << qRound64(rows / seconds) << "rows/s,"
+             << qRound64(bytes / 1024.0 / seconds) << "KiB/s";
+}
 
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeWeight",
-        "(DLjava/lang/String;)Ljava/lang/String;",
-        weightKg,
-        jTime.object<jstring>()
-        );
+int Backend::metricType(const QString &metric)
+{
+    return Metric::typeOf(metric);
+}
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
+Backend::SeriesChunk Backend::toChunk(const HealthBridge::Page &page)
+{
+    SeriesChunk chunk;
+    chunk.type = page.type;
+    Metric::visitMetric(page.type, [&](auto m) { decodePage<decltype(m)>(page, &chunk); });
+    return chunk;
+}
 
-    if(success)
-    {
-        status = QString("%1 Kg").arg(weightKg);
+template <typename M>
+void Backend::decodePage(const HealthBridge::Page &page, SeriesChunk *chunk)
+{
+    // شکل سری‌ها از Descriptor معلوم است — حلقه‌ی هر نقطه شرطی روی نوع ندارد
+    chunk->values.reserve(page.count);
+    if constexpr (M::shape == Metric::Pair)
+        chunk->values2.reserve(page.count);
+    if constexpr (M::shape == Metric::Glucose) {
+        chunk->specimen.reserve(page.count);
+        chunk->meal.reserve(page.count);
+        chunk->relation.reserve(page.count);
+    }
+
+    for (qsizetype i = 0; i < page.count; ++i) {
+        const double ms = double(page.timesMs[i]);
+        chunk->values.append(QPointF(ms, page.values[i]));
+        if constexpr (M::shape == Metric::Pair)
+            chunk->values2.append(QPointF(ms, page.values2[i]));
+        if constexpr (M::shape == Metric::Glucose) {
+            const int extras = page.extras[i];
+            chunk->specimen.append(QPointF(ms, extras & 0xFF));
+            chunk->meal.append(QPointF(ms, (extras >> 8) & 0xFF));
+            chunk->relation.append(QPointF(ms, (extras >> 16) & 0xFF));
+        }
     }
+}
 
-    emit weightWritten(success, status);
+// ── سری‌های حافظه: نام سری در Descriptor::series (و snapshot) → عضو Backend ──
+const QList<QPair<const char *, QList<QPointF> Backend::*>> &Backend::seriesMembers()
+{
+    static const QList<QPair<const char *, QList<QPointF> Backend::*>> members = {
+        {"height",           &Backend::hList},
+        {"weight",           &Backend::wList},
+        {"bpSystolic",       &Backend::bpSystolicList},
+        {"bpDiastolic",      &Backend::bpDiastolicList},
+        {"heartRate",        &Backend::heartRateList},
+        {"bloodGlucose",     &Backend::bloodGlucoseList},
+        {"bgSpecimen",       &Backend::bloodGlucoseSpecimenList},
+        {"bgMeal",           &Backend::bloodGlucoseMealList},
+        {"bgRelation",       &Backend::bloodGlucoseRelationList},
+        {"oxygenSaturation", &Backend::oxygenSaturationList}
+    };
+    return members;
+}
 
-#else
-    qDebug() << "Not Android - Weight write skipped";
-    emit weightWritten(false, "Not running on Android");
-#endif
+QList<QPointF> *Backend::seriesNamed(const char *name)
+{
+    for (const auto &member : seriesMembers()) {
+        if (qstrcmp(member.first, name) == 0)
+            return &(this->*member.second);
+    }
+    return nullptr;
+}
 
+QList<QPointF> *Backend::seriesList(int type)
+{
+    QList<QPointF> *out = nullptr;
+    Metric::visitMetric(type, [&](auto m) { out = seriesNamed(decltype(m)::series[0]); });
+    return out;
 }
 
-void Backend::writeBloodPressure(double systolicMmHg, double diastolicMmHg, QDateTime dt)
+QList<QList<QPointF> *> Backend::parallelSeries(int type)
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    QList<QList<QPointF> *> out;
+    Metric::visitMetric(type, [&](auto m) {
+        using M = decltype(m);
+        for (std::size_t c = 1; c < std::size(M::series); ++c)
+            out.append(seriesNamed(M::series[c]));
+    });
+    return out;
+}
 
-    if (!activity.isValid()) {
-        qDebug() << "❌ Activity is invalid!";
-        emit bloodPressureWritten(false, "Activity is invalid");
-        return;
+void Backend::clearSeries(int type)
+{
+    if (QList<QPointF> *list = seriesList(type))
+        list->clear();
+    for (QList<QPointF> *list : parallelSeries(type))
+        list->clear();
+}
+
+bool Backend::appendChunk(const SeriesChunk &chunk)
+{
+    QList<QPointF> *primary = seriesList(chunk.type);
+    if (!primary || chunk.values.isEmpty())
+        return true;
+    StageMetrics::Timer mergeTimer(StageMetrics::StoreMerge, chunk.values.size());
+
+    // سری‌های موازی (diastolic، متادیتای قند خون) هم‌اندیس با سری اصلی‌اند
+    const QList<QList<QPointF> *> parallel = parallelSeries(chunk.type);
+    QList<const QList<QPointF> *> source;
+    switch (Metric::shapeOf(chunk.type)) {
+    case Metric::Pair:    source = {&chunk.values2}; break;
+    case Metric::Glucose: source = {&chunk.specimen, &chunk.meal, &chunk.relation}; break;
+    case Metric::Single:  break;
+    }
+
+    auto byTime = [](const QPointF &a, const QPointF &b) { return a.x() < b.x(); };
+    const bool inOrder = (primary->isEmpty() || chunk.values.first().x() >= primary->last().x())
+                         && std::is_sorted(chunk.values.cbegin(), chunk.values.cend(), byTime);
+    if (inOrder) {
+        primary->append(chunk.values);
+        for (qsizetype k = 0; k < parallel.size(); ++k)
+            parallel[k]->append(*source[k]);
+        return true;
+    }
+
+    // صفحه‌ها صعودی‌اند؛ فقط نمونه‌های ضربان قلبِ رکوردهای هم‌پوشان جابه‌جا می‌رسند.
+    // chunk یک بار مرتب می‌شود، پشت سری اضافه می‌شود و دو بازه‌ی مرتب یک بار merge
+    // می‌شوند — نه درج تک‌تک نقطه‌ها (O(n·k))
+    QList<qsizetype> order(chunk.values.size());
+    std::iota(order.begin(), order.end(), qsizetype(0));
+    std::stable_sort(order.begin(), order.end(), [&chunk](qsizetype a, qsizetype b) {
+        return chunk.values.at(a).x() < chunk.values.at(b).x();
+    });
+
+    const qsizetype oldSize = primary->size();
+    primary->reserve(oldSize + chunk.values.size());
+    for (qsizetype i : order)
+        primary->append(chunk.values.at(i));
+    for (qsizetype k = 0; k < parallel.size(); ++k) {
+        parallel[k]->reserve(oldSize + chunk.values.size());
+        for (qsizetype i : order)
+            parallel[k]->append(source[k]->at(i));
+    }
+    if (oldSize == 0)
+        return true;
+
+    // فقط دنباله‌ای از سری قبلی که با chunk هم‌پوشانی دارد در merge شرکت می‌کند
+    const auto mid   = primary->begin() + oldSize;
+    const auto first = std::upper_bound(primary->begin(), mid, *mid, byTime);
+    if (first == mid)
+        return true;
+    if (parallel.isEmpty()) {
+        std::inplace_merge(first, mid, primary->end(), byTime);
+        return false;
     }
 
-    // اعتبارسنجی
-    if (systolicMmHg < 80 || systolicMmHg > 200) {
-        qDebug() << "❌ Invalid systolic value: " << systolicMmHg;
-        emit bloodPressureWritten(false,
-                                  QString("مقدار فشار سیستولیک نامعتبر است: %1 mmHg").arg(systolicMmHg));
-        return;
+    // با سری‌های موازی: merge روی اندیس‌ها، بعد همه‌ی سری‌ها با همان ترتیب چیده می‌شوند
+    const qsizetype from = first - primary->begin();
+    QList<qsizetype> merged(primary->size() - from);
+    std::iota(merged.begin(), merged.end(), from);
+    std::inplace_merge(merged.begin(), merged.begin() + (oldSize - from), merged.end(),
+                       [primary](qsizetype a, qsizetype b) {
+                           return primary->at(a).x() < primary->at(b).x();
+                       });
+    QList<QList<QPointF> *> all = parallel;
+    all.prepend(primary);
+    for (QList<QPointF> *list : all) {
+        QList<QPointF> tail;
+        tail.reserve(merged.size());
+        for (qsizetype i : merged)
+            tail.append(list->at(i));
+        std::copy(tail.cbegin(), tail.cend(), list->begin() + from);
     }
+    return false;
+}
 
-    if (diastolicMmHg < 40 || diastolicMmHg > 130) {
-        qDebug() << "❌ Invalid diastolic value: " << diastolicMmHg;
-        emit bloodPressureWritten(false,
-                                  QString("مقدار فشار دیاستولیک نامعتبر است: %1 mmHg").arg(diastolicMmHg));
+void Backend::deliverChunk(const SeriesChunk &chunk)
+{
+    const QList<QPointF> *primary = seriesList(chunk.type);
+    if (!primary || chunk.values.isEmpty())
         return;
-    }
+    const qsizetype before = primary->size();
+    const bool tail = appendChunk(chunk);
+    StageMetrics::Timer deliveryTimer(StageMetrics::QmlDelivery, chunk.values.size());
+    publishSeries(chunk.type, tail ? before : -1);
+}
 
-    if (systolicMmHg <= diastolicMmHg) {
-        qDebug() << "❌ Systolic must be > diastolic";
-        emit bloodPressureWritten(false, "فشار سیستولیک باید بزرگتر از دیاستولیک باشد");
+// from: اولین اندیس تازه وقتی فقط به انتهای سری اضافه شده؛ -1 یعنی نقطه‌های قبلی
+// جابه‌جا شده‌اند و QML کل سری را عوض می‌کند. سری تجمیعی مال setBuckets است
+void Backend::publishSeries(int type, qsizetype from)
+{
+    const QList<QPointF> *primary = seriesList(type);
+    if (!primary || m_buckets.contains(type))
         return;
+    QList<QPointF> values2;
+    if (Metric::shapeOf(type) == Metric::Pair)
+        values2 = *parallelSeries(type).at(0);
+    if (from >= 0) {
+        if (from < primary->size())
+            emit seriesChunkRead(type, primary->mid(from), values2.mid(from));
+    } else {
+        emit seriesReplaced(type, *primary, values2);
     }
+}
 
-    // ✅ دریافت زمان
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
+// محدوده‌ی محورها از سری‌های حافظه، با همان حاشیه‌های HealthChartView.setAllSeries؛
+// کلیدها مثل Main.displayedAxes. محور سری‌های تجمیعی را setBuckets تنظیم کرده است
+QVariantMap Backend::seriesAxes()
+{
+    QVariantMap axes;
+    double minTime = std::numeric_limits<double>::max();
+    const double noCeiling = std::numeric_limits<double>::max();
+
+    // اولین مقدار ± firstMargin، هر مقدار بیرون از بازه ± margin
+    auto fit = [&](const char *axis, int type, double scale, double firstMargin,
+                   double margin, double ceiling) {
+        const QList<QPointF> *list = seriesList(type);
+        if (!list || list->isEmpty() || m_buckets.contains(type))
+            return;
+        minTime = qMin(minTime, list->first().x());
+        double lo = list->first().y() * scale - firstMargin;
+        double hi = qMin(list->first().y() * scale + firstMargin, ceiling);
+        for (const QPointF &p : *list) {
+            const double v = p.y() * scale;
+            if (v < lo) lo = v - margin;
+            if (v > hi) hi = v + margin;
+        }
+        axes.insert(axis, QVariantList{lo, hi});
+    };
+    fit("height", HealthMeasurement::Height,           100.0, 10, 10, noCeiling);
+    fit("weight", HealthMeasurement::Weight,           1.0,   1,  1,  noCeiling);
+    fit("hr",     HealthMeasurement::HeartRate,        1.0,   1,  1,  noCeiling);
+    fit("bg",     HealthMeasurement::BloodGlucose,     1.0,   1,  2,  noCeiling);
+    fit("spo2",   HealthMeasurement::OxygenSaturation, 1.0,   1,  1,  100.0);
+
+    // فشار خون: یک محور برای systolic و diastolic، ۱۰٪ حاشیه
+    if (!bpSystolicList.isEmpty() && !m_buckets.contains(HealthMeasurement::BloodPressure)) {
+        minTime = qMin(minTime, bpSystolicList.first().x());
+        double lo = bpDiastolicList.first().y() - 1;
+        double hi = bpSystolicList.first().y() + 1;
+        for (const QList<QPointF> *list : {&bpSystolicList, &bpDiastolicList}) {
+            for (const QPointF &p : *list) {
+                lo = qMin(lo, p.y());
+                hi = qMax(hi, p.y());
+            }
+        }
+        const double margin = (hi - lo) * 0.1;
+        axes.insert("bp", QVariantList{lo - margin, hi + margin});
+    }
 
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeBloodPressure",
-        "(DDLjava/lang/String;)Ljava/lang/String;",
-        systolicMmHg,
-        diastolicMmHg,
-        jTime.object<jstring>()
-        );
+    for (auto it = m_buckets.cbegin(); it != m_buckets.cend(); ++it) {
+        if (!it->avg.isEmpty())
+            minTime = qMin(minTime, it->avg.first().x());
+    }
+    if (minTime < std::numeric_limits<double>::max())
+        axes.insert("x", QVariantList{minTime, double(QDateTime::currentMSecsSinceEpoch())});
+    return axes;
+}
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
+void Backend::writeHeight(double heightMeters,QDateTime dt)
+{
+    HealthMeasurement m;
+    m.type  = HealthMeasurement::Height;
+    m.time  = dt;
+    m.value = heightMeters;
 
-    if(success)
-    {
-        status = QString("%1/%2 mmHg").arg(systolicMmHg).arg(diastolicMmHg);
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        qDebug() << "❌ Invalid height value: " << heightMeters;
+        emit heightWritten(false, error);
+        return;
+    }
+    if (!enqueueWrite(m)) {
+        emit heightWritten(false, "Cannot write journal");
+        return;
     }
+    emit heightWritten(true, QString("%1 m").arg(heightMeters));
+    emit seriesAxesRead(seriesAxes());
+}
 
-    emit bloodPressureWritten(success, status);
+void Backend::writeWeight(double weightKg,QDateTime dt)
+{
+    HealthMeasurement m;
+    m.type  = HealthMeasurement::Weight;
+    m.time  = dt;
+    m.value = weightKg;
 
-#else
-    qDebug() << "Not Android - BP write skipped";
-    emit bloodPressureWritten(false, "Not running on Android");
-#endif
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        qDebug() << "❌ Invalid weight value: " << weightKg;
+        emit weightWritten(false, error);
+        return;
+    }
+    if (!enqueueWrite(m)) {
+        emit weightWritten(false, "Cannot write journal");
+        return;
+    }
+    emit weightWritten(true, QString("%1 Kg").arg(weightKg));
+    emit seriesAxesRead(seriesAxes());
+}
+
+void Backend::writeBloodPressure(double systolicMmHg, double diastolicMmHg, QDateTime dt)
+{
+    HealthMeasurement m;
+    m.type   = HealthMeasurement::BloodPressure;
+    m.time   = dt;
+    m.value  = systolicMmHg;
+    m.value2 = diastolicMmHg;
+
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        qDebug() << "❌ Invalid blood pressure:" << systolicMmHg << "/" << diastolicMmHg;
+        emit bloodPressureWritten(false, error);
+        return;
+    }
+    if (!enqueueWrite(m)) {
+        emit bloodPressureWritten(false, "Cannot write journal");
+        return;
+    }
+    emit bloodPressureWritten(true, QString("%1/%2 mmHg").arg(systolicMmHg).arg(diastolicMmHg));
+    emit seriesAxesRead(seriesAxes());
 }
 
 void Backend::writeHeartRate(int bpm,QDateTime dt)
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    HealthMeasurement m;
+    m.type  = HealthMeasurement::HeartRate;
+    m.time  = dt;
+    m.value = bpm;
 
-    if (!activity.isValid()) {
-        qDebug() << "❌ Activity is invalid!";
-        emit heartRateWritten(false, "Activity is invalid");
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        qDebug() << "❌ Invalid heart rate value: " << bpm;
+        emit heartRateWritten(false, error);
         return;
     }
+    if (!enqueueWrite(m)) {
+        emit heartRateWritten(false, "Cannot write journal");
+        return;
+    }
+    emit heartRateWritten(true, QString("%1 bpm").arg(bpm));
+    emit seriesAxesRead(seriesAxes());
+}
 
-    if (bpm < 30 || bpm > 250) {
-        qDebug() << "❌ Invalid heart rate value: " << bpm;
-        emit heartRateWritten(false,
-                              QString("مقدار ضربان قلب نامعتبر است: %1 bpm").arg(bpm));
+void Backend::writeBloodGlucose(double glucoseMgDl, int specimenSource, int mealType, int relationToMeal, QDateTime dt)
+{
+    HealthMeasurement m;
+    m.type           = HealthMeasurement::BloodGlucose;
+    m.time           = dt;
+    m.value          = glucoseMgDl;
+    m.specimenSource = specimenSource;
+    m.mealType       = mealType;
+    m.relationToMeal = relationToMeal;
+
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        emit bloodGlucoseWritten(false, error);
         return;
     }
+    if (!enqueueWrite(m)) {
+        emit bloodGlucoseWritten(false, "Cannot write journal");
+        return;
+    }
+    emit bloodGlucoseWritten(true, QString("%1 mg/dl").arg(glucoseMgDl));
+    emit seriesAxesRead(seriesAxes());
+}
 
-    // ✅ دریافت زمان
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
+void Backend::writeOxygenSaturation(double percentage, QDateTime dt)
+{
+    HealthMeasurement m;
+    m.type  = HealthMeasurement::OxygenSaturation;
+    m.time  = dt;
+    m.value = percentage;
 
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeHeartRate",
-        "(JLjava/lang/String;)Ljava/lang/String;",  // J=long, String=time
-        static_cast<jlong>(bpm),
-        jTime.object<jstring>()
-        );
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        qDebug() << "❌ Invalid SpO2 value:" << percentage;
+        emit oxygenSaturationWritten(false, error);
+        return;
+    }
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
+    // ⚠️ هشدار برای مقادیر پایین
+    if (percentage < 90.0) {
+        qWarning() << "⚠️ Warning: Low SpO2 value:" << percentage << "%";
+    }
 
-    if(success)
-    {
-        status = QString("%1 bpm").arg(bpm);
+    if (!enqueueWrite(m)) {
+        emit oxygenSaturationWritten(false, "Cannot write journal");
+        return;
     }
 
-    emit heartRateWritten(success, status);
+    QString status = QString("%1 %%").arg(percentage, 0, 'f', 1); // یک رقم اعشار
 
-#else
-    qDebug() << "Not Android - Heart rate write skipped";
-    emit heartRateWritten(false, "Not running on Android");
-#endif
+    // ✅ افزودن برچسب وضعیت
+    QString condition;
+    if (percentage >= 95.0) {
+        condition = " (نرمال ✅)";
+    } else if (percentage >= 90.0) {
+        condition = " (قابل توجه ⚠️)";
+    } else {
+        condition = " (خطرناک ⛔)";
+    }
+    status += condition;
+
+    qDebug() << "🫁 SpO2 queued:" << status;
+    emit oxygenSaturationWritten(true, status);
+    emit seriesAxesRead(seriesAxes());
 }
 
-void Backend::writeBloodGlucose(double glucoseMgDl, int specimenSource, int mealType, int relationToMeal, QDateTime dt)
+// ── صف write-behind ──────────────────────────────────────────
+bool Backend::enqueueWrite(const HealthMeasurement &m)
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
-    if (!activity.isValid()) {
-        emit bloodGlucoseWritten(false, "Activity is invalid");
-        return;
+    // بدون context ی Android سازنده زود برمی‌گردد و صف ساخته نمی‌شود
+    if (!m_writeQueue) {
+        qWarning() << "❌ Write queue unavailable; measurement not saved";
+        return false;
     }
+    if (!m_writeQueue->enqueue(m))
+        return false;
+    m_cache.invalidate(m.type, m.time.toMSecsSinceEpoch());
+    emit memoryUsageChanged();
+    qsizetype index = -1;
+    if (addLocalPoint(m, &index)) {
+        const bool tail = index == seriesList(m.type)->size() - 1;
+        publishSeries(m.type, tail ? index : -1);
+    }
+    if (Metric::key(m.type))
+        updateLatest(m);
+    return true;
+}
 
-    if (glucoseMgDl < 20.0 || glucoseMgDl > 600.0) {
-        emit bloodGlucoseWritten(false, QString("مقدار قند خون نامعتبر: %1 mg/dL").arg(glucoseMgDl));
+// ── آخرین اندازه‌گیری‌ها ─────────────────────────────────────
+void Backend::refreshLatest(int count)
+{
+    HealthBridge *bridge = HealthBridge::instance();
+    if (!bridge)
         return;
-    }
 
-    // ✅ UTC — مثل writeHeight
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
-
-    // ✅ اصلاح: (D, String, I, I, I) — String دوم میاد نه پنجم
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeBloodGlucose",
-        "(DLjava/lang/String;III)Ljava/lang/String;",
-        glucoseMgDl,
-        jTime.object<jstring>(),
-        (jint)specimenSource,
-        (jint)mealType,
-        (jint)relationToMeal
-        );
+    // روی m_readPool؛ در شروع برنامه قبل از هر خواندن بازه‌ای در صف است
+    QtConcurrent::run(&m_readPool, [this, bridge, count]() {
+        TraceSpan span("read", "refreshLatest");
+        QElapsedTimer timer;
+        timer.start();
+
+        QHash<int, LatestReading> latest;
+        const QList<int> &types = Metric::allTypes();
+        StageMetrics::Timer bridgeTimer(StageMetrics::BridgeCall);
+        HealthBridge::StreamResult result = bridge->latest(types, count,
+            [&latest, count](const HealthBridge::Page &page) {
+                // صفحه نزولی است، جز نمونه‌های داخل یک رکورد ضربان قلب
+                QList<qsizetype> order(page.count);
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&page](qsizetype a, qsizetype b) {
+                    return page.timesMs[a] > page.timesMs[b];
+                });
+
+                LatestReading r;
+                r.valid  = true;
+                r.time   = QDateTime::fromMSecsSinceEpoch(page.timesMs[order.first()]);
+                r.value  = page.values[order.first()];
+                r.value2 = page.values2[order.first()];
+                for (qsizetype k = 0; k < order.size() && k < count; ++k)
+                    r.recent.append(QPointF(page.timesMs[order[k]], page.values[order[k]]));
+                latest.insert(page.type, r);
+                return true;
+            });
+
+        bridgeTimer.setItems(result.records);
+        qDebug() << "⚡ Latest readings:" << result.records << "records,"
+                 << HealthBridge::statusName(result.status) << "in" << timer.elapsed() << "ms";
+        if (result.status == HealthBridge::StreamDenied)
+            QMetaObject::invokeMethod(this, &Backend::invalidatePermissions, Qt::QueuedConnection);
+        if (result.status != HealthBridge::StreamComplete)
+            return;
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
-    if (success) status = QString("%1 mg/dl").arg(glucoseMgDl);
-    emit bloodGlucoseWritten(success, status);
+        QMetaObject::invokeMethod(this, [this, latest]() {
+            for (auto it = latest.cbegin(); it != latest.cend(); ++it) {
+                // write ی محلی که هنوز flush نشده جدیدتر از Health Connect است
+                const LatestReading current = m_latest.value(it.key());
+                if (!current.valid || current.time <= it->time)
+                    m_latest.insert(it.key(), it.value());
+            }
+            emit latestReadingsChanged();
+        }, Qt::QueuedConnection);
+    });
+}
 
-#else
-    qDebug() << "Not Android";
-    emit bloodGlucoseWritten(false, "Not running on Android");
-#endif
+void Backend::updateLatest(const HealthMeasurement &m)
+{
+    LatestReading &r = m_latest[m.type];
+    if (r.valid && r.time > m.time)
+        return;
+    r.valid  = true;
+    r.time   = m.time;
+    r.value  = m.value;
+    r.value2 = m.value2;
+    r.recent.prepend(QPointF(m.time.toMSecsSinceEpoch(), m.value));
+    if (r.recent.size() > LatestCount)
+        r.recent.resize(LatestCount);
+    emit latestReadingsChanged();
 }
 
-void Backend::writeOxygenSaturation(double percentage, QDateTime dt)
+void Backend::emitLocalUpdate()
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    TraceSpan span("signal", "newDataRead");
+    StageMetrics::Timer deliveryTimer(StageMetrics::QmlDelivery,
+                                      hList.size() + wList.size() + bpSystolicList.size()
+                                      + heartRateList.size() + bloodGlucoseList.size()
+                                      + oxygenSaturationList.size());
+    emit newDataRead(hList, wList, bpSystolicList, bpDiastolicList,
+                     heartRateList, bloodGlucoseList, oxygenSaturationList);
+    // newDataRead سری‌ها را از نو می‌سازد؛ سری‌های تجمیعی بعد از آن دوباره
+    for (auto it = m_buckets.cbegin(); it != m_buckets.cend(); ++it)
+        emit bucketSeriesRead(it.key(), it->avg, it->avg2, it->min, it->max);
+}
 
-    if (!activity.isValid()) {
-        qDebug() << "❌ Activity is invalid!";
-        emit oxygenSaturationWritten(false, "Activity is invalid");
-        return;
-    }
+// ── خواندن تجمیعی ────────────────────────────────────────────
+int Backend::bucketSecondsFor(qint64 spanMs)
+{
+    if (spanMs >= DailyBucketsFromMs)
+        return 24 * 3600;
+    if (spanMs >= HourlyBucketsFromMs)
+        return 3600;
+    return 0;   // بزرگنمایی شده: رکوردهای خام
+}
 
-    // ✅ اعتبارسنجی مقدار
-    if (percentage < 50.0 || percentage > 100.0) {
-        qDebug() << "❌ Invalid SpO2 value:" << percentage;
-        emit oxygenSaturationWritten(false,
-                                     QString("مقدار اشباع اکسیژن نامعتبر است: %1%").arg(percentage));
+Backend::BucketSeries Backend::toBucketSeries(int type, const QList<HealthBridge::Bucket> &buckets)
+{
+    StageMetrics::Timer downsampleTimer(StageMetrics::Downsample, buckets.size());
+    BucketSeries series;
+    series.avg.reserve(buckets.size());
+    series.min.reserve(buckets.size());
+    series.max.reserve(buckets.size());
+
+    const bool bp = Metric::shapeOf(type) == Metric::Pair;
+    if (bp)
+        series.avg2.reserve(buckets.size());
+
+    for (const HealthBridge::Bucket &b : buckets) {
+        // نقطه وسط bucket رسم می‌شود
+        const double ms = double(b.startMs + (b.endMs - b.startMs) / 2);
+        series.avg.append(QPointF(ms, b.avg));
+        // BP: پایین‌ترین diastolic تا بالاترین systolic
+        series.min.append(QPointF(ms, bp ? b.min2 : b.min));
+        series.max.append(QPointF(ms, b.max));
+        if (bp)
+            series.avg2.append(QPointF(ms, b.avg2));
+    }
+    return series;
+}
+
+namespace {
+// در جای مرتب (بر اساس زمان) درج می‌کند؛ نقطه‌ی تکراری درج نمی‌شود
+qsizetype insertSorted(QList<QPointF> &list, const QPointF &p)
+{
+    auto it = std::lower_bound(list.begin(), list.end(), p.x(),
+                               [](const QPointF &a, double x) { return a.x() < x; });
+    for (auto j = it; j != list.end() && j->x() == p.x(); ++j)
+        if (j->y() == p.y())
+            return -1;
+    const qsizetype index = it - list.begin();
+    list.insert(index, p);
+    return index;
+}
+}
+
+bool Backend::addLocalPoint(const HealthMeasurement &m, qsizetype *inserted)
+{
+    // فقط اگر داخل بازه‌ی بارگذاری‌شده باشد؛ بقیه با onUpdateRequest بعدی می‌آیند
+    if (m_loadedFrom.isValid() && m.time < m_loadedFrom)
+        return false;
+
+    QList<QPointF> *primary = seriesList(m.type);
+    if (!primary)
+        return false;
+    const double ms = double(m.time.toMSecsSinceEpoch());
+    const qsizetype index = insertSorted(*primary, QPointF(ms, m.value));
+    if (index < 0)
+        return false;
+    const QList<QList<QPointF> *> parallel = parallelSeries(m.type);
+    const QList<double> values = Metric::parallelValues(m);
+    for (qsizetype k = 0; k < parallel.size(); ++k)
+        parallel[k]->insert(index, QPointF(ms, values.at(k)));
+    if (inserted)
+        *inserted = index;
+    return true;
+}
+
+void Backend::mergePendingWrites(const QList<int> &types, const QDateTime &endTo)
+{
+    if (!m_writeQueue)
         return;
-    }
+    StageMetrics::Timer mergeTimer(StageMetrics::StoreMerge, 0);
+    int merged = 0;
+    // نوع → اولین اندیس تازه؛ -1 اگر نقطه‌ای بین نقطه‌های خوانده‌شده نشسته باشد
+    QHash<int, qsizetype> from;
+    const QList<HealthMeasurement> pending = m_writeQueue->pending();
+    for (const HealthMeasurement &m : pending) {
+        if (m.time > endTo || !types.contains(m.type))
+            continue;
+        const qsizetype oldSize = seriesList(m.type) ? seriesList(m.type)->size() : 0;
+        qsizetype index = -1;
+        if (!addLocalPoint(m, &index))
+            continue;
+        ++merged;
+        const qsizetype readSize = from.contains(m.type) ? from.value(m.type) : oldSize;
+        from.insert(m.type, (readSize >= 0 && index >= readSize) ? readSize : -1);
+    }
+    mergeTimer.setItems(merged);
+    for (auto it = from.cbegin(); it != from.cend(); ++it)
+        publishSeries(it.key(), it.value());
+    if (merged > 0)
+        qDebug() << "📝 Merged" << merged << "pending write(s) into the chart";
+}
 
-    // ⚠️ هشدار برای مقادیر پایین
-    if (percentage < 90.0) {
-        qWarning() << "⚠️ Warning: Low SpO2 value:" << percentage << "%";
-    }
+QList<int> Backend::writeBatch(const QList<HealthMeasurement> &items)
+{
+    QList<int> status = insertBatch(items);
+    const int inserted = int(status.count(WriteOk));
+    emit batchWritten(inserted, int(items.size()) - inserted, status);
+    return status;
+}
+
+QList<int> Backend::insertBatch(const QList<HealthMeasurement> &items)
+{
+    QElapsedTimer timer;
+    timer.start();
 
-    // ✅ دریافت زمان فعلی به فرمت ISO8601
-    QString currentTime = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(currentTime);
+    QList<int> status(items.size(), WriteInvalid);
 
-    // ✅ فراخوانی متد Kotlin
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeOxygenSaturation",
-        "(DLjava/lang/String;)Ljava/lang/String;",  // D=double, String=time
-        percentage,
-        jTime.object<jstring>()
-        );
+    // ── نامعتبرها اصلاً به JNI نمی‌روند ──
+    QList<qsizetype> valid;
+    valid.reserve(items.size());
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        QString error = items.at(i).validate();
+        if (error.isEmpty())
+            valid.append(i);
+        else
+            qDebug() << "❌ writeBatch item" << i << ":" << error;
+    }
 
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
+    if (!valid.isEmpty()) {
+        QList<HealthMeasurement> batch;
+        batch.reserve(valid.size());
+        for (qsizetype i : valid)
+            batch.append(items.at(i));
 
-    if (success) {
-        status = QString("%1 %%").arg(percentage, 0, 'f', 1); // یک رقم اعشار
-
-        // ✅ افزودن برچسب وضعیت
-        QString condition;
-        if (percentage >= 95.0) {
-            condition = " (نرمال ✅)";
-        } else if (percentage >= 90.0) {
-            condition = " (قابل توجه ⚠️)";
+        QString json;
+        {
+            StageMetrics::Timer bridgeTimer(StageMetrics::BridgeCall, batch.size());
+            json = HealthBridge::instance()->writeBatch(batch);
+        }
+        QJsonArray itemStatus = QJsonDocument::fromJson(json.toUtf8()).object()["status"].toArray();
+
+        if (itemStatus.size() != valid.size()) {
+            qDebug() << "❌ writeBatch:" << json.left(120);
+            for (qsizetype i : valid)
+                status[i] = WriteFailed;
         } else {
-            condition = " (خطرناک ⛔)";
+            for (qsizetype k = 0; k < valid.size(); ++k)
+                status[valid.at(k)] = itemStatus.at(k).toInt(WriteFailed);
         }
-        status += condition;
     }
 
-    qDebug() << "🫁 SpO2 write result:" << status;
-    emit oxygenSaturationWritten(success, status);
+    // ── قدیمی‌ترین رکورد نوشته‌شده‌ی هر نوع؛ ورود فایل و صف نوشتن هر دو از اینجا می‌گذرند ──
+    QHash<int, qint64> oldest;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        if (status.at(i) != WriteOk)
+            continue;
+        const qint64 ms = items.at(i).time.toMSecsSinceEpoch();
+        auto it = oldest.find(items.at(i).type);
+        if (it == oldest.end())
+            oldest.insert(items.at(i).type, ms);
+        else
+            *it = qMin(*it, ms);
+    }
+    for (auto it = oldest.cbegin(); it != oldest.cend(); ++it)
+        markBackfill(it.key(), it.value());
+
+    qDebug() << "📊 writeBatch:" << status.count(WriteOk) << "/" << items.size()
+             << "inserted in" << timer.elapsed() << "ms";
+    return status;
+}
 
-#else
-    qDebug() << "Not Android - Oxygen saturation write skipped";
-    emit oxygenSaturationWritten(false, "Not running on Android");
-#endif
+QSet<qint64> Backend::existingSeconds(int type, qint64 fromMs, qint64 toMs)
+{
+    QSet<qint64> seconds;
+    HealthBridge *bridge = HealthBridge::instance();
+    if (!bridge || !HealthBridge::typeName(type))
+        return seconds;
+
+    // فقط زمان‌ها نگه داشته می‌شوند، صفحه به صفحه
+    HealthBridge::StreamResult result = bridge->stream(type,
+        QDateTime::fromMSecsSinceEpoch(fromMs).toUTC().toString(Qt::ISODateWithMs),
+        QDateTime::fromMSecsSinceEpoch(toMs).toUTC().toString(Qt::ISODateWithMs),
+        [&seconds](const HealthBridge::Page &page) {
+            for (qsizetype i = 0; i < page.count; ++i)
+                seconds.insert(page.timesMs[i] / 1000);
+            return true;
+        });
+    if (result.status != HealthBridge::StreamComplete)
+        qDebug() << "🔎 existingSeconds" << HealthBridge::typeName(type) << ":"
+                 << HealthBridge::statusName(result.status) << result.message.left(80);
+    return seconds;
+}
+
+void Backend::onImportRequest(const QString &fileUrl)
+{
+    if (m_importThread) {
+        emit importFinished(false, "Import already running");
+        return;
+    }
+
+    // FileDialog روی دسکتاپ file:// و روی Android content:// می‌دهد
+    QUrl url(fileUrl);
+    QString filePath = url.isLocalFile() ? url.toLocalFile() : fileUrl;
+    qDebug() << "📥 Import requested:" << filePath;
+
+    m_importer     = new HealthImporter(filePath, &Backend::insertBatch, &Backend::existingSeconds);
+    m_importThread = new QThread(this);
+    m_importer->moveToThread(m_importThread);
+
+    connect(m_importThread, &QThread::started, m_importer, &HealthImporter::run);
+    connect(m_importer, &HealthImporter::progress, this, &Backend::importProgress);
+    connect(m_importer, &HealthImporter::finished, this, [this](bool success, QString message) {
+        // هر جای هر بازه ممکن است رکورد تازه گرفته باشد
+        m_cache.clear();
+        emit memoryUsageChanged();
+        emit importFinished(success, message);
+        m_importThread->quit();
+    });
+    connect(m_importThread, &QThread::finished, m_importer, &QObject::deleteLater);
+    connect(m_importThread, &QThread::finished, m_importThread, &QObject::deleteLater);
+
+    m_importThread->start();
+}
+
+void Backend::onImportCancel()
+{
+    if (m_importer)
+        m_importer->cancel();
 }
 
 void Backend::writeMenstruationFlow(int flowLevel, QDateTime dt)
 {
+    HealthMeasurement m;
+    m.type  = HealthMeasurement::MenstruationFlow;
+    m.time  = dt;
+    m.value = flowLevel;
+
     // اعتبارسنجی
-    if (flowLevel < 1 || flowLevel > 3) {
+    QString error = m.validate();
+    if (!error.isEmpty()) {
         qDebug() << "❌ Invalid flow level:" << flowLevel;
-        emit menstruationFlowWritten(false,
-                                     QString("سطح خونریزی نامعتبر است: %1 (باید ۱ تا ۳ باشد)").arg(flowLevel));
+        emit menstruationFlowWritten(false, error);
+        return;
+    }
+    if (!enqueueWrite(m)) {
+        emit menstruationFlowWritten(false, "Cannot write journal");
         return;
     }
 
@@ -563,43 +1901,10 @@ void Backend::writeMenstruationFlow(int flowLevel, QDateTime dt)
         qDebug() << "🩸 Period started at:" << dt.toString("yyyy/MM/dd");
     }
 
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
-    if (!activity.isValid()) {
-        emit menstruationFlowWritten(false, "Activity is invalid");
-        return;
-    }
-
-    QString timeIso = dt.toUTC().toString(Qt::ISODateWithMs);
-    QJniObject jTime = QJniObject::fromString(timeIso);
-
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeMenstruationFlow",
-        "(Ljava/lang/String;I)Ljava/lang/String;",
-        jTime.object<jstring>(),
-        (jint)flowLevel
-        );
-
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
-
-    if (success) {
-        static const QStringList levelNames = {"", "سبک", "متوسط", "سنگین"};
-        status = QString("شدت %1 برای %2 ثبت شد")
-                     .arg(levelNames.value(flowLevel))
-                     .arg(dt.toString("yyyy/MM/dd hh:mm:ss"));
-    }
-
-    emit menstruationFlowWritten(success, status);
-
-#else
-    qDebug() << "Not Android - MenstruationFlow write skipped. Level:" << flowLevel;
-    emit menstruationFlowWritten(true,
-                                 QString("(Desktop) شدت %1 برای %2 ثبت شد")
-                                     .arg(flowLevel)
-                                     .arg(dt.toString("yyyy/MM/dd")));
-#endif
+    static const QStringList levelNames = {"", "سبک", "متوسط", "سنگین"};
+    emit menstruationFlowWritten(true, QString("شدت %1 برای %2 ثبت شد")
+                                           .arg(levelNames.value(flowLevel))
+                                           .arg(dt.toString("yyyy/MM/dd hh:mm:ss")));
 }
 
 void Backend::writeMenstruationPeriod(QDateTime endTime)
@@ -611,99 +1916,74 @@ void Backend::writeMenstruationPeriod(QDateTime endTime)
         return;
     }
 
-    // اعتبارسنجی بازه
-    if (endTime < currentPeriodStart) {
-        emit menstruationPeriodWritten(false,
-                                       "تاریخ پایان نمی‌تواند قبل از تاریخ شروع باشد");
-        return;
-    }
+    qDebug() << "start : " << currentPeriodStart.toString("yyyy/MM/dd hh:mm:ss") << " --- end : " << endTime.toString("yyyy/MM/dd hh:mm:ss");
 
-    qint64 durationDays = currentPeriodStart.daysTo(endTime);
-    if (durationDays > 15) {
-        emit menstruationPeriodWritten(false,
-                                       QString("طول دوره نامعتبر است: %1 روز (حداکثر ۱۵ روز)").arg(durationDays));
-        return;
-    }
+    HealthMeasurement m;
+    m.type   = HealthMeasurement::MenstruationPeriod;
+    m.time   = currentPeriodStart;
+    m.value2 = double(endTime.toMSecsSinceEpoch());
 
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
-    if (!activity.isValid()) {
-        emit menstruationPeriodWritten(false, "Activity is invalid");
+    QString error = m.validate();
+    if (!error.isEmpty()) {
+        emit menstruationPeriodWritten(false, error);
         return;
     }
-
-    qDebug() << "start : " << currentPeriodStart.toString("yyyy/MM/dd hh:mm:ss") << " --- end : " << endTime.toString("yyyy/MM/dd hh:mm:ss");
-
-    QString startIso = currentPeriodStart.toUTC().toString(Qt::ISODateWithMs);
-    QString endIso   = endTime.toUTC().toString(Qt::ISODateWithMs);
-
-    QJniObject jStart = QJniObject::fromString(startIso);
-    QJniObject jEnd   = QJniObject::fromString(endIso);
-
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "writeMenstruationPeriod",
-        "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-        jStart.object<jstring>(),
-        jEnd.object<jstring>()
-        );
-
-    QString status = result.toString();
-    bool success = !status.contains("ERROR") && !status.contains("NULL");
-
-    if (success) {
-        // ── پاک‌سازی state ──────────────────────────────────
-        periodActive = false;
-        currentPeriodStart = QDateTime();
-        savePeriodState();
-        emit periodStateChanged(periodActive);
-
-        status = QString("دوره از %1 تا %2 (%3 روز) ثبت شد")
-                     .arg(currentPeriodStart.toString("yyyy/MM/dd"))
-                     .arg(endTime.toString("yyyy/MM/dd"))
-                     .arg(durationDays + 1);
+    if (!enqueueWrite(m)) {
+        emit menstruationPeriodWritten(false, "Cannot write journal");
+        return;
     }
 
-    emit menstruationPeriodWritten(success, status);
+    const QString startStr = currentPeriodStart.toString("yyyy/MM/dd");
+    const qint64 durationDays = currentPeriodStart.daysTo(endTime);
 
-#else
-    QString startStr = currentPeriodStart.toString("yyyy/MM/dd");
+    // ── پاک‌سازی state ──────────────────────────────────
     periodActive = false;
     currentPeriodStart = QDateTime();
     savePeriodState();
     emit periodStateChanged(periodActive);
 
-    qDebug() << "Not Android - MenstruationPeriod write skipped."
-             << "Start:" << startStr
-             << "End:"   << endTime.toString("yyyy/MM/dd");
+    emit menstruationPeriodWritten(true, QString("دوره از %1 تا %2 (%3 روز) ثبت شد")
+                                             .arg(startStr)
+                                             .arg(endTime.toString("yyyy/MM/dd"))
+                                             .arg(durationDays + 1));
+}
 
-    emit menstruationPeriodWritten(true,
-                                   QString("(Desktop) دوره از %1 تا %2 (%3 روز) شبیه‌سازی شد")
-                                       .arg(startStr)
-                                       .arg(endTime.toString("yyyy/MM/dd"))
-                                       .arg(durationDays + 1));
-#endif
+// دوره‌ها و flow هایی که هنوز در صف نوشتن هستند — مثل mergePendingWrites برای سری‌ها
+void Backend::mergePendingMenstruation()
+{
+    if (!m_writeQueue)
+        return;
+    const QList<HealthMeasurement> pending = m_writeQueue->pending();
+    for (const HealthMeasurement &m : pending) {
+        if (m.type == HealthMeasurement::MenstruationFlow) {
+            const bool known = std::any_of(periodFlowList.cbegin(), periodFlowList.cend(),
+                                           [&m](const MenstruationFlow &f) { return f.time == m.time; });
+            if (!known)
+                periodFlowList.append({m.time, int(m.value)});
+        } else if (m.type == HealthMeasurement::MenstruationPeriod) {
+            const bool known = std::any_of(periodList.cbegin(), periodList.cend(),
+                                           [&m](const MenstruationPeriod &p) { return p.start == m.time; });
+            if (!known)
+                periodList.append({m.time, QDateTime::fromMSecsSinceEpoch(qint64(m.value2))});
+        }
+    }
 }
 
 void Backend::readMenstruationData(QString startFrom, QString endTo)
+{
+    QString jsonStr;
+    {
+        StageMetrics::Timer bridgeTimer(StageMetrics::BridgeCall);
+        jsonStr = HealthBridge::instance()->readMenstruation(startFrom, endTo);
+    }
+    parseMenstruation(jsonStr);
+}
+
+void Backend::parseMenstruation(const QString &jsonStr)
 {
     periodList.clear();
     periodFlowList.clear();
 
-#ifdef Q_OS_ANDROID
-    QJniObject jStart = QJniObject::fromString(startFrom);
-    QJniObject jEnd   = QJniObject::fromString(endTo);
-
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "readMenstruationData",
-        "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-        jStart.object<jstring>(),
-        jEnd.object<jstring>()
-        );
-
-    QString jsonStr = result.toString();
-
     if (jsonStr.startsWith("ERROR") ||
         jsonStr == "CLIENT_NULL"    ||
         jsonStr == "NO_MENSTRUATION_DATA") {
@@ -712,13 +1992,18 @@ void Backend::readMenstruationData(QString startFrom, QString endTo)
         return;
     }
 
-    periodJsonDoc = QJsonDocument::fromJson(jsonStr.toUtf8());
-    if (!periodJsonDoc.isObject()) {
+    TraceSpan parseSpan("json", "parseMenstruation");
+    StageMetrics::Timer decodeTimer(StageMetrics::Decode);
+    const QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
+    if (!doc.isObject()) {
         qDebug() << "❌ readMenstruationData: invalid JSON";
         return;
     }
 
-    QJsonObject root = periodJsonDoc.object();
+    QJsonObject root = doc.object();
+    // TRUNCATED: pageToken تکراری — آنچه تا آنجا خوانده شده نمایش داده می‌شود
+    if (root["status"].toString() == "TRUNCATED")
+        qWarning() << "⚠️ readMenstruationData: truncated, later pages were not read";
 
     // ── periods ──────────────────────────────────────────────
     QJsonArray periods = root["periods"].toArray();
@@ -741,11 +2026,6 @@ void Backend::readMenstruationData(QString startFrom, QString endTo)
             p.end.setTimeSpec(Qt::UTC);
         }
 
-        qDebug() << "[readMenst] period start raw:" << startStr;
-        qDebug() << "[readMenst] period start parsed:" << p.start.toString(Qt::ISODateWithMs);
-        qDebug() << "[readMenst] period start ms:" << p.start.toMSecsSinceEpoch();
-        qDebug() << "[readMenst] period start timeSpec:" << p.start.timeSpec();
-
         if (p.start.isValid() && p.end.isValid()) {
             periodList.append(p);
         } else {
@@ -777,19 +2057,32 @@ void Backend::readMenstruationData(QString startFrom, QString endTo)
              << periodFlowList.size() << "flows";
 
     // ✅ اینجا emit نکن! - onUpdateRequest این کار را می‌کند
-#else
-    qDebug() << "Not Android - readMenstruationData skipped";
-#endif
 }
 
-void Backend::exportMenstruationData(QXlsx::Document *xlsx)
+void Backend::publishMenstruation()
+{
+    TraceSpan span("signal", "menstruationModel");
+    QList<MenstruationModel::Period> periods;
+    periods.reserve(periodList.size());
+    for (const MenstruationPeriod &p : periodList)
+        periods.append({p.start.toMSecsSinceEpoch(), p.end.toMSecsSinceEpoch()});
+
+    QList<MenstruationModel::Flow> flows;
+    flows.reserve(periodFlowList.size());
+    for (const MenstruationFlow &f : periodFlowList)
+        flows.append({f.time.toMSecsSinceEpoch(), f.level});
+
+    m_menstruationModel->setPeriods(std::move(periods), std::move(flows));
+}
+
+void Backend::exportMenstruationData(QXlsx::Document *xlsx,
+                                     qint64 periodsSinceMs, qint64 flowsSinceMs,
+                                     qint64 *newestPeriodMs, qint64 *newestFlowMs)
 {
-#ifdef Q_OS_ANDROID
     // ══════════════════════════════════════════════════════════
     // Sheet 1 — دوره‌های قاعدگی (Menstruation Periods)
     // ══════════════════════════════════════════════════════════
-    xlsx->addSheet("Menstruation Periods");
-    xlsx->selectSheet("Menstruation Periods");
+    int row = openExportSheet(xlsx, "Menstruation Periods");
 
     // ── فرمت هدر ──────────────────────────────────────────────
     QXlsx::Format headerFormat;
@@ -806,26 +2099,32 @@ void Backend::exportMenstruationData(QXlsx::Document *xlsx)
     oddRowFormat.setPatternBackgroundColor(QColor("#FCE4EC"));
     oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
 
-    // ── ستون‌ها ────────────────────────────────────────────────
-    xlsx->write(1, 1, "Start Date",    headerFormat);
-    xlsx->write(1, 2, "Start Time",    headerFormat);
-    xlsx->write(1, 3, "End Date",      headerFormat);
-    xlsx->write(1, 4, "End Time",      headerFormat);
-    xlsx->write(1, 5, "Duration (days)", headerFormat);
-
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 14);
-    xlsx->setColumnWidth(4, 12);
-    xlsx->setColumnWidth(5, 16);
-
-    // ── داده‌ها ────────────────────────────────────────────────
+    if (row == 1) {
+        // ── ستون‌ها ────────────────────────────────────────────────
+        xlsx->write(1, 1, "Start Date",    headerFormat);
+        xlsx->write(1, 2, "Start Time",    headerFormat);
+        xlsx->write(1, 3, "End Date",      headerFormat);
+        xlsx->write(1, 4, "End Time",      headerFormat);
+        xlsx->write(1, 5, "Duration (days)", headerFormat);
+
+        // ── عرض ستون‌ها ────────────────────────────────────────────
+        xlsx->setColumnWidth(1, 14);
+        xlsx->setColumnWidth(2, 12);
+        xlsx->setColumnWidth(3, 14);
+        xlsx->setColumnWidth(4, 12);
+        xlsx->setColumnWidth(5, 16);
+        row = 2;
+    }
+
+    // ── داده‌ها — watermark دوره‌ها روی زمان شروع است ──────────
+    qint64 newestStart = periodsSinceMs;
     for (int i = 0; i < periodList.size(); i++) {
         const MenstruationPeriod &p = periodList.at(i);
-        int row = i + 2;
+        const qint64 startMs = p.start.toMSecsSinceEpoch();
+        if (startMs <= periodsSinceMs)
+            continue;
 
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
+        QXlsx::Format &rowFmt = (row % 2 == 0) ? oddRowFormat : dataFormat;
 
         QDateTime localStart = p.start.toLocalTime();
         QDateTime localEnd   = p.end.toLocalTime();
@@ -837,13 +2136,17 @@ void Backend::exportMenstruationData(QXlsx::Document *xlsx)
         xlsx->write(row, 3, localEnd.toString("yyyy-MM-dd"),   rowFmt);
         xlsx->write(row, 4, localEnd.toString("hh:mm:ss"),     rowFmt);
         xlsx->write(row, 5, durationDays,                      rowFmt);
+
+        newestStart = qMax(newestStart, startMs);
+        row++;
     }
+    if (newestPeriodMs)
+        *newestPeriodMs = newestStart;
 
     // ══════════════════════════════════════════════════════════
     // Sheet 2 — جریان خونریزی (Menstruation Flow)
     // ══════════════════════════════════════════════════════════
-    xlsx->addSheet("Menstruation Flow");
-    xlsx->selectSheet("Menstruation Flow");
+    row = openExportSheet(xlsx, "Menstruation Flow");
 
     // ── فرمت هدر ──────────────────────────────────────────────
     QXlsx::Format flowHeaderFormat;
@@ -869,25 +2172,31 @@ void Backend::exportMenstruationData(QXlsx::Document *xlsx)
     QXlsx::Format unknownFormat; // نامشخص
     unknownFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
 
-    // ── ستون‌ها ────────────────────────────────────────────────
-    xlsx->write(1, 1, "Date",         flowHeaderFormat);
-    xlsx->write(1, 2, "Time",         flowHeaderFormat);
-    xlsx->write(1, 3, "Flow Level",   flowHeaderFormat);
-    xlsx->write(1, 4, "Description",  flowHeaderFormat);
+    if (row == 1) {
+        // ── ستون‌ها ────────────────────────────────────────────────
+        xlsx->write(1, 1, "Date",         flowHeaderFormat);
+        xlsx->write(1, 2, "Time",         flowHeaderFormat);
+        xlsx->write(1, 3, "Flow Level",   flowHeaderFormat);
+        xlsx->write(1, 4, "Description",  flowHeaderFormat);
 
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 12);
-    xlsx->setColumnWidth(4, 16);
+        // ── عرض ستون‌ها ────────────────────────────────────────────
+        xlsx->setColumnWidth(1, 14);
+        xlsx->setColumnWidth(2, 12);
+        xlsx->setColumnWidth(3, 12);
+        xlsx->setColumnWidth(4, 16);
+        row = 2;
+    }
 
     // ── داده‌ها ────────────────────────────────────────────────
     static const QStringList levelLabels = {"Unknown", "Light", "Medium", "Heavy"};
     static const QStringList levelEmoji  = {"❓",       "🩸",    "🩸🩸",  "🩸🩸🩸"};
 
+    qint64 newestFlow = flowsSinceMs;
     for (int i = 0; i < periodFlowList.size(); i++) {
         const MenstruationFlow &f = periodFlowList.at(i);
-        int row = i + 2;
+        const qint64 timeMs = f.time.toMSecsSinceEpoch();
+        if (timeMs <= flowsSinceMs)
+            continue;
 
         QDateTime localTime = f.time.toLocalTime();
 
@@ -903,108 +2212,44 @@ void Backend::exportMenstruationData(QXlsx::Document *xlsx)
         xlsx->write(row, 2, localTime.toString("hh:mm:ss"),            *rowFmt);
         xlsx->write(row, 3, f.level,                                   *rowFmt);
         xlsx->write(row, 4, levelLabels.at(safeLevel),                 *rowFmt);
+
+        newestFlow = qMax(newestFlow, timeMs);
+        row++;
     }
-#else
-    qDebug() << "Not Android - readMenstruationData skipped";
-#endif
+    if (newestFlowMs)
+        *newestFlowMs = newestFlow;
 }
 
 bool Backend::copyToDownloads(const QString &srcPath, const QString &fileName)
 {
-#ifdef Q_OS_ANDROID
-    QJniEnvironment env;
-
-    // ─── ContentValues ───
-    QJniObject contentValues("android/content/ContentValues");
-
-    contentValues.callMethod<void>("put",
-                                   "(Ljava/lang/String;Ljava/lang/String;)V",
-                                   QJniObject::fromString("_display_name").object<jstring>(),
-                                   QJniObject::fromString(fileName).object<jstring>());
-
-    contentValues.callMethod<void>("put",
-                                   "(Ljava/lang/String;Ljava/lang/String;)V",
-                                   QJniObject::fromString("mime_type").object<jstring>(),
-                                   QJniObject::fromString(
-                                       "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"
-                                       ).object<jstring>());
-
-    // Android 10+ — مسیر داخل Downloads
-    contentValues.callMethod<void>("put",
-                                   "(Ljava/lang/String;Ljava/lang/String;)V",
-                                   QJniObject::fromString("relative_path").object<jstring>(),
-                                   QJniObject::fromString("Download/").object<jstring>());
-
-    // ─── ContentResolver ───
-    QJniObject activity = QJniObject::callStaticObjectMethod(
-        "org/qtproject/qt/android/QtNative",
-        "activity",
-        "()Landroid/app/Activity;");
-
-    QJniObject context = activity.callObjectMethod(
-        "getApplicationContext",
-        "()Landroid/content/Context;");
-
-    QJniObject resolver = context.callObjectMethod(
-        "getContentResolver",
-        "()Landroid/content/ContentResolver;");
-
-    // ─── MediaStore Downloads URI ───
-    QJniObject downloadsUri = QJniObject::callStaticObjectMethod(
-        "android/provider/MediaStore$Downloads",
-        "getContentUri",
-        "(Ljava/lang/String;)Landroid/net/Uri;",
-        QJniObject::fromString("external").object<jstring>());
-
-    // ─── Insert و دریافت URI فایل مقصد ───
-    QJniObject destUri = resolver.callObjectMethod(
-        "insert",
-        "(Landroid/net/Uri;Landroid/content/ContentValues;)Landroid/net/Uri;",
-        downloadsUri.object(),
-        contentValues.object());
-
-    if (!destUri.isValid()) {
-        qWarning() << "MediaStore insert failed";
-        return false;
-    }
-
-    // ─── خواندن فایل منبع ───
+    // ─── خواندن تکه‌تکه با یک بافر ثابت — بدون readAll ───
     QFile srcFile(srcPath);
     if (!srcFile.open(QIODevice::ReadOnly)) {
         qWarning() << "Cannot open source file:" << srcPath;
         return false;
     }
-    QByteArray data = srcFile.readAll();
-    srcFile.close();
 
-    // ─── نوشتن به OutputStream ───
-    QJniObject outputStream = resolver.callObjectMethod(
-        "openOutputStream",
-        "(Landroid/net/Uri;)Ljava/io/OutputStream;",
-        destUri.object());
-
-    if (!outputStream.isValid()) {
-        qWarning() << "Cannot open OutputStream";
+    std::unique_ptr<OutputSink> sink(OutputSink::createDownloadsSink(fileName, XlsxMimeType));
+    if (!sink->open(QIODevice::WriteOnly))
         return false;
-    }
 
-    jbyteArray byteArray = env->NewByteArray(data.size());
-    env->SetByteArrayRegion(byteArray, 0, data.size(),
-                            reinterpret_cast<const jbyte*>(data.constData()));
-
-    outputStream.callMethod<void>("write", "([B)V", byteArray);
-    outputStream.callMethod<void>("flush");
-    outputStream.callMethod<void>("close");
-    env->DeleteLocalRef(byteArray);
+    QByteArray chunk(CopyChunkSize, Qt::Uninitialized);
+    qint64 n;
+    while ((n = srcFile.read(chunk.data(), chunk.size())) > 0) {
+        if (sink->write(chunk.constData(), n) != n) {
+            qWarning() << "Cannot write to" << sink->location() << sink->errorString();
+            sink->discard();
+            return false;
+        }
+    }
 
-    qDebug() << "✅ File saved to Downloads:" << fileName;
-    return true;
+    if (n < 0) {
+        qWarning() << "Cannot read source file:" << srcPath << srcFile.errorString();
+        sink->discard();
+        return false;
+    }
 
-#else
-    Q_UNUSED(srcPath)
-    Q_UNUSED(fileName)
-    return false;
-#endif
+    return sink->commit();
 }
 
 void Backend::loadAvailablePath()
@@ -1023,32 +2268,21 @@ void Backend::loadAvailablePath()
             break;
         }
     }
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(path);
+    }
 #endif
 }
 
 
-void Backend::permissionRequest()
-{
-#ifdef Q_OS_ANDROID
-    // ✅ دریافت Activity (نه Application Context)
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
-
-    if (!activity.isValid()) {
-        qDebug() << ("❌ Activity is invalid!");
-        return;
-    }
-
+void Backend::permissionRequest()
+{
     // ✅ Init با دریافت نتیجه
     qDebug() << "🚀 Initializing Health Connect...";
 
-    QJniObject initResult = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "init",
-        "(Landroid/content/Context;)Ljava/lang/String;",  // ← حالا String
-        activity.object()
-        );
-
-    QString status = initResult.toString();
+    HealthBridge *bridge = HealthBridge::instance();
+    QString status = bridge->init();
 
     // ✅ بررسی وضعیت
     if (status == "HC_NOT_INSTALLED") {
@@ -1067,54 +2301,26 @@ void Backend::permissionRequest()
         // ادامه می‌دهیم چون شاید کار کند
     }
 
-    if (!status.startsWith("INIT_OK") && !status.startsWith("HC_UPDATE_REQUIRED")) {
+    if (!status.startsWith("INIT_SUCCESS") && !status.startsWith("HC_UPDATE_REQUIRED")) {
         qDebug() << "❌ Initialization failed:" << status;
         return;
     }
 
     // Check permissions
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "checkPermissions",
-        "()Ljava/lang/String;"
-        );
-    qDebug() << ("🔑 Current: " + result.toString());
+    qDebug() << ("🔑 Current: " + bridge->checkPermissions());
 
     // ✅ Request permissions با پاس دادن Activity
     qDebug() << ("\n🚀 Requesting permissions...");
-    result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "requestPermissions",
-        "(Landroid/app/Activity;)Ljava/lang/String;",
-        activity.object()
-        );
-
-    qDebug() << ("✅ Result: " + result.toString());
+    qDebug() << ("✅ Result: " + bridge->requestPermissions());
     qDebug() << ("\n💡 If dialog appeared, grant permissions then press Read.");
-
-#else
-    qDebug() << "Not Android";
-#endif
 }
 
 bool Backend::checkPermissions()
 {
-#ifdef Q_OS_ANDROID
-    QJniObject activity = QNativeInterface::QAndroidApplication::context();
-    if (!activity.isValid()) {
-        //emit permissionsChecked(false, "Activity is invalid");
-        return false;
-    }
-
-    QJniObject result = QJniObject::callStaticObjectMethod(
-        "org/verya/QMLHealthConnect/HealthBridge",
-        "checkPermissions",
-        "()Ljava/lang/String;"
-        );
-
-    QString jsonStr = result.toString();
+    QString jsonStr = HealthBridge::instance()->checkPermissions();
 
     // ── پارس JSON جدید ──────────────────────────────────────────
+    TraceSpan parseSpan("json", "parsePermissions");
     QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
 
     if (doc.isNull() || !doc.isObject()) {
@@ -1167,265 +2373,83 @@ bool Backend::checkPermissions()
 
     qDebug() << "🔐 Permissions:" << statusMsg;
 
+    storePermissions(allGranted, statusMsg);
+
     // ── ارسال JSON کامل به QML از طریق سیگنال ───────────────────
     emit permissionsState(allGranted, statusMsg);  // ← JSON کامل
 
-#else
-    qDebug() << "Not Android";
-#endif
     return true;
 }
 
-void Backend::readHeight(QString startTime,QString endTime)
+// ── کش وضعیت دسترسی‌ها ─────────────────────────────────────
+// تا وقتی callback نتیجه‌ی درخواست، resume برنامه یا TTL آن را باطل نکند،
+// checkPermissions (JNI + runBlocking) دوباره صدا زده نمی‌شود.
+bool Backend::ensurePermissions()
 {
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
-    // ─────────────────────────────────────────
-    // Height
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readHeight",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "📏 Height status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (height)";
-            return;
-        }
-
-        if (!status.startsWith("ERROR") && status != "NO_HEIGHT_DATA") {
-            heightJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = heightJsonDoc.array();
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                hList.append(QPointF(dt.toMSecsSinceEpoch(), obj["height_m"].toDouble()));
-            }
-        }
+    if (m_permissionsCheckedAt.isValid()
+        && !m_permissionsCheckedAt.hasExpired(PermissionCacheTtlMs)) {
+        return m_permissionsGranted;
     }
-#else
-    qDebug() << "Not Android";
-#endif
+    checkPermissions();
+    return m_permissionsGranted;
 }
 
-void Backend::exportHeight(QXlsx::Document *xlsx)
+void Backend::invalidatePermissions()
 {
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Height Data");
-    xlsx->selectSheet("Height Data");
-
-    // ── فرمت هدر ─────────────────────────────────────────────
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#1565C0"));
-    headerFormat.setFontColor(Qt::white);
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    // ── فرمت ردیف‌های داده ────────────────────────────────────
-    QXlsx::Format dataFormat;
-    dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#E3F2FD"));
-    oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",        headerFormat);
-    xlsx->write(1, 2, "Time",        headerFormat);
-    xlsx->write(1, 3, "Height (cm)", headerFormat);
-
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 14);
-
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = heightJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        double heightCm = obj["height_m"].toDouble() * 100.0;
-        int row = static_cast<int>(i) + 2;
-
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
-
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, heightCm,                  rowFmt);
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    if (!m_permissionsCheckedAt.isValid())
+        return;
+    qDebug() << "🔐 Permission cache invalidated";
+    m_permissionsCheckedAt.invalidate();
 }
 
-void Backend::readWeight(QString startTime, QString endTime)
+void Backend::storePermissions(bool granted, const QString &message)
 {
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
-    // ─────────────────────────────────────────
-    // Weight
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readWeight",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "⚖️ Weight status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (weight)";
-            return;
-        }
-
-        if (!status.startsWith("ERROR") && status != "NO_WEIGHT_DATA") {
-            weightJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = weightJsonDoc.array();
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                wList.append(QPointF(dt.toMSecsSinceEpoch(), obj["weight_kg"].toDouble()));
-            }
-        }
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    m_permissionsCheckedAt.start();
+    if (m_permissionsGranted == granted && m_permissionsMessage == message)
+        return;
+    const bool newlyGranted = granted && !m_permissionsGranted;
+    m_permissionsGranted = granted;
+    m_permissionsMessage = message;
+    emit permissionsGrantedChanged(granted);
+    // در اولین اجرا refreshLatest ی onQmlReady بدون دسترسی رد شده بود
+    if (newlyGranted)
+        refreshLatest();
 }
 
-void Backend::exportWeight(QXlsx::Document *xlsx)
+namespace {
+// یک سلول ستون C؛ شاخه‌ها روی Descriptor در زمان compile حذف می‌شوند
+template <typename M, std::size_t C>
+QVariant xlsxCell(double y)
 {
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Weight Data");
-    xlsx->selectSheet("Weight Data");
-
-    // ── فرمت هدر ─────────────────────────────────────────────
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#2E7D32"));
-    headerFormat.setFontColor(Qt::white);
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    // ── فرمت ردیف‌های داده ────────────────────────────────────
-    QXlsx::Format dataFormat;
-    dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#E8F5E9"));
-    oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",        headerFormat);
-    xlsx->write(1, 2, "Time",        headerFormat);
-    xlsx->write(1, 3, "Weight (kg)", headerFormat);
-
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 14);
-
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = weightJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        double weightKg = obj["weight_kg"].toDouble();
-        int row = static_cast<int>(i) + 2;
-
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
-
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, weightKg,                  rowFmt);
+    constexpr Metric::Column column = M::columns[C];
+    if constexpr (column.labels != nullptr) {
+        const QStringList &labels = column.labels();
+        const int index = int(y);
+        return (index >= 0 && index < labels.size()) ? labels.at(index) : QStringLiteral("Unknown");
+    } else if constexpr (column.integer) {
+        return int(y * column.scale);
+    } else {
+        return y * column.scale;
     }
-#else
-    qDebug() << "Not Android";
-#endif
 }
 
-void Backend::readBP(QString startTime, QString endTime)
+template <typename M, std::size_t... C>
+void writeXlsxColumns(QXlsx::Document *xlsx, int row, const QList<QPointF> *const *series,
+                      qsizetype i, const QXlsx::Format &format, std::index_sequence<C...>)
 {
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
-    // ─────────────────────────────────────────
-    // Blood Pressure
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readBloodPressure",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "🩺 BP status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (BP)";
-            return;
-        }
-
-        if (!status.contains("NO_BP_DATA") && !status.contains("ERROR")) {
-            bpJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = bpJsonDoc.array();
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                qint64 ms = dt.toMSecsSinceEpoch();
-
-                bpSystolicList.append(QPointF(ms, obj["systolic"].toDouble()));
-                bpDiastolicList.append(QPointF(ms, obj["diastolic"].toDouble()));
-                //qDebug() << QString("systolic_mmhg : %1 -- diastolic_mmhg : %2").arg(bpSystolicList.end()->y()).arg(bpDiastolicList.end()->y());
-            }
-        }
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    (xlsx->write(row, int(C) + 3, xlsxCell<M, C>(series[C]->at(i).y()), format), ...);
+}
 }
 
-void Backend::exportBP(QXlsx::Document *xlsx)
+template <typename M>
+qint64 Backend::exportSheet(QXlsx::Document *xlsx, qint64 sinceMs, bool skipExisting)
 {
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Blood Pressure Data");
-    xlsx->selectSheet("Blood Pressure Data");
+    constexpr std::size_t columnCount = std::size(M::columns);
 
     // ── فرمت هدر ─────────────────────────────────────────────
     QXlsx::Format headerFormat;
     headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#B71C1C"));
+    headerFormat.setPatternBackgroundColor(QColor(M::headerColor));
     headerFormat.setFontColor(Qt::white);
     headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
 
@@ -1434,392 +2458,267 @@ void Backend::exportBP(QXlsx::Document *xlsx)
     dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
 
     QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#FFEBEE"));
+    oddRowFormat.setPatternBackgroundColor(QColor(M::oddRowColor));
     oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
 
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",               headerFormat);
-    xlsx->write(1, 2, "Time",               headerFormat);
-    xlsx->write(1, 3, "Systolic (mmHg)",    headerFormat);
-    xlsx->write(1, 4, "Diastolic (mmHg)",   headerFormat);
-
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 18);
-    xlsx->setColumnWidth(4, 18);
-
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = bpJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        double systolic  = obj["systolic"].toDouble();
-        double diastolic = obj["diastolic"].toDouble();
-        int row = static_cast<int>(i) + 2;
-
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
-
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, systolic,                  rowFmt);
-        xlsx->write(row, 4, diastolic,                 rowFmt);
-    }
-#else
-    qDebug() << "Not Android";
-#endif
-}
-
-void Backend::readHR(QString startTime, QString endTime)
-{
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
-    // ─────────────────────────────────────────
-    // Heart Rate
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readHeartRate",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "❤️ Heart Rate status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (heart rate)";
-            return;
+    // ── Sheet: بیش از XlsxMaxRows ردیف در «<sheet>_2»، «<sheet>_3»، … ادامه می‌یابد ──
+    auto partName = [](int part) {
+        return part == 1 ? QString(M::sheet) : QString("%1_%2").arg(M::sheet).arg(part);
+    };
+    auto openPart = [&](int part) {
+        int next = openExportSheet(xlsx, partName(part));
+        if (next == 1) {
+            // ── هدر ستون‌ها و عرض‌ها ───────────────────────────────
+            xlsx->write(1, 1, "Date", headerFormat);
+            xlsx->write(1, 2, "Time", headerFormat);
+            xlsx->setColumnWidth(1, 14);
+            xlsx->setColumnWidth(2, 12);
+            for (std::size_t c = 0; c < columnCount; ++c) {
+                xlsx->write(1, int(c) + 3, M::columns[c].header, headerFormat);
+                xlsx->setColumnWidth(int(c) + 3, M::columns[c].width);
+            }
+            next = 2;
         }
-
-        if (!status.startsWith("ERROR") && status != "NO_HEART_RATE_DATA") {
-            heartRateJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = heartRateJsonDoc.array();
-            // qDebug() << "💓 Processing" << arr.size() << "heart rate records";
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                heartRateList.append(QPointF(dt.toMSecsSinceEpoch(), obj["bpm"].toDouble()));
+        return next;
+    };
+    // فایل تجمعی: ادامه در آخرین بخش موجود
+    int part = 1;
+    while (xlsx->sheetNames().contains(partName(part + 1)))
+        ++part;
+
+    // ── Date+Time ردیف‌های موجود از sinceMs به بعد؛ ثانیه هویت رکورد است، مثل existingSeconds ──
+    QSet<QString> existing;
+    if (skipExisting) {
+        const QString fromDate = QDateTime::fromMSecsSinceEpoch(sinceMs).toString("yyyy-MM-dd");
+        for (int p = 1; p <= part; ++p) {
+            if (!xlsx->selectSheet(partName(p)))
+                continue;
+            const int lastRow = xlsx->dimension().lastRow();
+            for (int r = 2; r <= lastRow; ++r) {
+                const QString date = xlsx->read(r, 1).toString();
+                if (date >= fromDate)
+                    existing.insert(date + ' ' + xlsx->read(r, 2).toString());
             }
         }
     }
-#else
-    qDebug() << "Not Android";
-#endif
+    int row = openPart(part);
+
+    // ── سری اصلی و سری‌های موازی، یک بار برای کل شیت ──────────
+    const QList<QPointF> *series[columnCount] = {seriesList(M::type)};
+    static_assert(std::size(M::series) == columnCount, "one series per column");
+    const QList<QList<QPointF> *> parallel = parallelSeries(M::type);
+    for (std::size_t c = 1; c < columnCount; ++c)
+        series[c] = parallel.at(qsizetype(c) - 1);
+    const QList<QPointF> &values = *series[0];
+
+    // ── داده‌ها — فقط رکوردهای بعد از sinceMs؛ سری بر اساس زمان مرتب است ──
+    qsizetype i = std::upper_bound(values.cbegin(), values.cend(), double(sinceMs),
+                                   [](double x, const QPointF &p) { return x < p.x(); })
+                  - values.cbegin();
+    qint64 newestMs = sinceMs;
+    for (; i < values.size(); ++i) {
+        const qint64 ms = qint64(values.at(i).x());
+        const QDateTime dt = QDateTime::fromMSecsSinceEpoch(ms);
+        const QString date = dt.toString("yyyy-MM-dd");
+        const QString time = dt.toString("hh:mm:ss");
+        if (!existing.isEmpty() && existing.contains(date + ' ' + time))
+            continue;
+        if (row > XlsxMaxRows)
+            row = openPart(++part);
+        const QXlsx::Format &rowFmt = (row % 2 == 0) ? oddRowFormat : dataFormat;
+
+        xlsx->write(row, 1, date, rowFmt);
+        xlsx->write(row, 2, time, rowFmt);
+        writeXlsxColumns<M>(xlsx, row, series, i, rowFmt, std::make_index_sequence<columnCount>());
+
+        newestMs = qMax(newestMs, ms);
+        row++;
+    }
+    if (part > 1)
+        qDebug() << "📑" << M::sheet << "split across" << part << "sheets of"
+                 << XlsxMaxRows << "rows";
+    return newestMs;
 }
 
-void Backend::exportHR(QXlsx::Document *xlsx)
+qint64 Backend::exportMetric(int type, QXlsx::Document *xlsx, qint64 sinceMs, bool skipExisting)
 {
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Heart Rate Data");
-    xlsx->selectSheet("Heart Rate Data");
-
-    // ── فرمت هدر ─────────────────────────────────────────────
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#E65100"));
-    headerFormat.setFontColor(Qt::white);
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    qint64 newestMs = sinceMs;
+    Metric::visitMetric(type, [&](auto m) {
+        newestMs = exportSheet<decltype(m)>(xlsx, sinceMs, skipExisting);
+    });
+    return newestMs;
+}
 
-    // ── فرمت ردیف‌های داده ────────────────────────────────────
-    QXlsx::Format dataFormat;
-    dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+QList<int> Backend::selectedTypes(bool height, bool weight, bool bp, bool bg, bool hr, bool spo2)
+{
+    // آرگومان‌ها به ترتیب Metric::forEachMetric اند
+    const bool selected[] = {height, weight, bp, bg, hr, spo2};
+    const QList<int> &all = Metric::allTypes();
+    Q_ASSERT(all.size() == qsizetype(std::size(selected)));
+    QList<int> types;
+    for (qsizetype i = 0; i < all.size(); ++i) {
+        if (selected[i])
+            types.append(all.at(i));
+    }
+    return types;
+}
 
-    QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#FFF3E0"));
-    oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+QString Backend::isoStringMonthsAgo(int months)
+{
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QDateTime past = now.addMonths(-months);
+    // فرمت ISO8601 که Kotlin می‌فهمد
+    return past.toString(Qt::ISODateWithMs);
+}
 
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",      headerFormat);
-    xlsx->write(1, 2, "Time",      headerFormat);
-    xlsx->write(1, 3, "BPM",       headerFormat);
+void Backend::savePeriodState()
+{
+    QSettings settings;
+    settings.setValue("menstruation/periodActive",
+                      periodActive);
+    settings.setValue("menstruation/periodStart",
+                      currentPeriodStart.toMSecsSinceEpoch());
+    settings.sync();
+    qDebug() << "💾 Period state saved:"
+             << "active=" << periodActive
+             << "start=" << currentPeriodStart.toString("yyyy/MM/dd hh:mm:ss");
+}
 
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 10);
+void Backend::setExportCompression(int mode)
+{
+    if (mode < ZipRepacker::Store || mode > ZipRepacker::ParallelMaximum) {
+        qDebug() << "❌ Invalid export compression:" << mode;
+        return;
+    }
+    if (mode == m_exportCompression)
+        return;
 
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = heartRateJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        int bpm = obj["bpm"].toInt();
-        int row = static_cast<int>(i) + 2;
+    m_exportCompression = mode;
 
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
+    QSettings settings;
+    settings.setValue("export/compression", m_exportCompression);
+    qDebug() << "💾 Export compression:" << ZipRepacker::compressionName(m_exportCompression);
 
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, bpm,                       rowFmt);
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    emit exportCompressionChanged(m_exportCompression);
 }
 
-void Backend::readBG(QString startTime, QString endTime)
+void Backend::setExportMode(int mode)
 {
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
-    // ─────────────────────────────────────────
-    // Blood Glucose
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readBloodGlucose",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "🩸 Glucose status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (blood glucose)";
-            return;
-        }
-
-        if (!status.startsWith("ERROR") && status != "NO_BLOOD_GLUCOSE_DATA") {
-            bloodGlucoseJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = bloodGlucoseJsonDoc.array();
-            // qDebug() << "🩸 Processing" << arr.size() << "blood glucose records";
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                bloodGlucoseList.append(QPointF(dt.toMSecsSinceEpoch(), obj["glucose"].toDouble()));
-            }
-        }
+    if (mode < ExportFull || mode > ExportRunning) {
+        qDebug() << "❌ Invalid export mode:" << mode;
+        return;
     }
-#else
-    qDebug() << "Not Android";
-#endif
-}
-
-void Backend::exportBG(QXlsx::Document *xlsx)
-{
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Blood Glucose Data");
-    xlsx->selectSheet("Blood Glucose Data");
-
-    // ── فرمت هدر ─────────────────────────────────────────────
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#4A148C"));
-    headerFormat.setFontColor(Qt::white);
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-
-    // ── فرمت ردیف‌های داده ────────────────────────────────────
-    QXlsx::Format dataFormat;
-    dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    if (mode == m_exportMode)
+        return;
 
-    QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#F3E5F5"));
-    oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    m_exportMode = mode;
 
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",             headerFormat);
-    xlsx->write(1, 2, "Time",             headerFormat);
-    xlsx->write(1, 3, "Glucose (mg/dL)",  headerFormat);
-    xlsx->write(1, 4, "Specimen Source",  headerFormat);
-    xlsx->write(1, 5, "Meal Type",        headerFormat);
-    xlsx->write(1, 6, "Relation to Meal", headerFormat);
-
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 18);
-    xlsx->setColumnWidth(4, 18);
-    xlsx->setColumnWidth(5, 14);
-    xlsx->setColumnWidth(6, 18);
-
-    // ── label map ها ─────────────────────────────────────────
-    static const QStringList specimenLabels = {
-        "Unknown", "Interstitial Fluid", "Capillary Blood",
-        "Plasma",  "Serum",              "Tears",
-        "Whole Blood"
-    };
-    static const QStringList mealLabels = {
-        "Unknown", "Before Meal", "After Meal", "Fasting"
-    };
-    static const QStringList relationLabels = {
-        "Unknown", "Before Meal", "After Meal",
-        "Fasting", "General"
-    };
+    QSettings settings;
+    settings.setValue("export/mode", m_exportMode);
+    qDebug() << "💾 Export mode:" << m_exportMode;
 
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = bloodGlucoseJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        double  glucose  = obj["glucose"].toDouble();
-        int specimen     = obj["specimenSource"].toInt(0);
-        int meal         = obj["mealType"].toInt(0);
-        int relation     = obj["relationToMeal"].toInt(0);
-        int row          = static_cast<int>(i) + 2;
-
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
-
-        // safe index access
-        QString specimenStr = (specimen >= 0 && specimen < specimenLabels.size())
-                                  ? specimenLabels.at(specimen) : "Unknown";
-        QString mealStr     = (meal     >= 0 && meal     < mealLabels.size())
-                              ? mealLabels.at(meal)         : "Unknown";
-        QString relationStr = (relation >= 0 && relation < relationLabels.size())
-                                  ? relationLabels.at(relation)  : "Unknown";
-
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, glucose,                   rowFmt);
-        xlsx->write(row, 4, specimenStr,               rowFmt);
-        xlsx->write(row, 5, mealStr,                   rowFmt);
-        xlsx->write(row, 6, relationStr,               rowFmt);
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    emit exportModeChanged(m_exportMode);
 }
 
-void Backend::readOxygenSaturation(QString startTime, QString endTime)
+void Backend::setExportFormat(int format)
 {
-#ifdef Q_OS_ANDROID
-    QString status;
-    QJniObject result;
+    if (format < SeriesExporter::Xlsx || format > SeriesExporter::Columnar) {
+        qDebug() << "❌ Invalid export format:" << format;
+        return;
+    }
+    if (format == m_exportFormat)
+        return;
 
-    // ─────────────────────────────────────────
-    // Oxygen Saturation (SpO₂)
-    // ─────────────────────────────────────────
-    {
-        QJniObject jStart = QJniObject::fromString(startTime);
-        QJniObject jEnd   = QJniObject::fromString(endTime);
-
-        result = QJniObject::callStaticObjectMethod(
-            "org/verya/QMLHealthConnect/HealthBridge",
-            "readOxygenSaturation",
-            "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;",
-            jStart.object<jstring>(),
-            jEnd.object<jstring>()
-            );
-
-        status = result.toString();
-        qDebug() << "🫁 Oxygen Saturation status:" << status.left(80);
-
-        if (status == "SECURITY_ERROR") {
-            qDebug() << "❌ Security error (oxygen saturation)";
-            return;
-        }
+    m_exportFormat = format;
 
-        if (!status.startsWith("ERROR") && status != "NO_OXYGEN_DATA") {
-            oxygenSaturationJsonDoc = QJsonDocument::fromJson(status.toUtf8());
-            QJsonArray arr = oxygenSaturationJsonDoc.array();
-            //qDebug() << "🫁 Processing" << arr.size() << "oxygen saturation records";
-            for (qsizetype i = 0; i < arr.size(); i++) {
-                QJsonObject obj = arr.at(i).toObject();
-                QDateTime dt = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
-                double percentage = obj["percentage"].toDouble();
-                oxygenSaturationList.append(QPointF(dt.toMSecsSinceEpoch(), percentage));
-            }
+    QSettings settings;
+    settings.setValue("export/format", m_exportFormat);
+    qDebug() << "💾 Export format:" << SeriesExporter::formatName(m_exportFormat);
 
-            qDebug() << "✅ Read" << oxygenSaturationList.size() << "valid SpO2 records";
-        }
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+    emit exportFormatChanged(m_exportFormat);
 }
 
-void Backend::exportOxygenSaturation(QXlsx::Document *xlsx)
+void Backend::setMemoryBudgetMB(int megabytes)
 {
-#ifdef Q_OS_ANDROID
-    // ── Sheet ────────────────────────────────────────────────
-    xlsx->addSheet("Oxygen Saturation Data");
-    xlsx->selectSheet("Oxygen Saturation Data");
-
-    // ── فرمت هدر ─────────────────────────────────────────────
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setPatternBackgroundColor(QColor("#006064"));
-    headerFormat.setFontColor(Qt::white);
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    if (megabytes < 0) {
+        qDebug() << "❌ Invalid memory budget:" << megabytes;
+        return;
+    }
+    if (megabytes == memoryBudgetMB())
+        return;
 
-    // ── فرمت ردیف‌های داده ────────────────────────────────────
-    QXlsx::Format dataFormat;
-    dataFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    m_cache.setBudgetBytes(qint64(megabytes) * 1024 * 1024);
 
-    QXlsx::Format oddRowFormat;
-    oddRowFormat.setPatternBackgroundColor(QColor("#E0F7FA"));
-    oddRowFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
+    QSettings settings;
+    settings.setValue("cache/budgetMB", megabytes);
+    qDebug() << "💾 Series cache budget:" << megabytes << "MB";
 
-    // ── هدر ستون‌ها ───────────────────────────────────────────
-    xlsx->write(1, 1, "Date",                    headerFormat);
-    xlsx->write(1, 2, "Time",                    headerFormat);
-    xlsx->write(1, 3, "Oxygen Saturation (%)",   headerFormat);
+    emit memoryBudgetChanged(megabytes);
+    emit memoryUsageChanged();
+}
 
-    // ── عرض ستون‌ها ────────────────────────────────────────────
-    xlsx->setColumnWidth(1, 14);
-    xlsx->setColumnWidth(2, 12);
-    xlsx->setColumnWidth(3, 22);
+void Backend::loadExportSettings()
+{
+    QSettings settings;
+    int mode = settings.value("export/compression", int(ZipRepacker::Fast)).toInt();
+    if (mode < ZipRepacker::Store || mode > ZipRepacker::ParallelMaximum)
+        mode = ZipRepacker::Fast;
+    m_exportCompression = mode;
+
+    int exportMode = settings.value("export/mode", int(ExportFull)).toInt();
+    if (exportMode < ExportFull || exportMode > ExportRunning)
+        exportMode = ExportFull;
+    m_exportMode = exportMode;
+
+    int format = settings.value("export/format", int(SeriesExporter::Xlsx)).toInt();
+    if (format < SeriesExporter::Xlsx || format > SeriesExporter::Columnar)
+        format = SeriesExporter::Xlsx;
+    m_exportFormat = format;
+}
 
-    // ── داده‌ها ────────────────────────────────────────────────
-    QJsonArray arr = oxygenSaturationJsonDoc.array();
-    for (qsizetype i = 0; i < arr.size(); i++) {
-        QJsonObject obj = arr.at(i).toObject();
-        QDateTime dt = QDateTime::fromString(
-                           obj["time"].toString(), Qt::ISODate
-                           ).toLocalTime();
-        double percentage = obj["percentage"].toDouble();
-        int row = static_cast<int>(i) + 2;
+QString Backend::watermarkKey(int mode, const QString &metric)
+{
+    // فایل تجمعی watermark جدا دارد تا خروجی‌های جدا از آن ردیفی کم نکنند
+    return (mode == ExportRunning ? QString("export/running/") : QString("export/watermark/")) + metric;
+}
 
-        QXlsx::Format &rowFmt = (i % 2 == 0) ? oddRowFormat : dataFormat;
+qint64 Backend::exportWatermark(int mode, const QString &metric)
+{
+    QSettings settings;
+    return settings.value(watermarkKey(mode, metric), 0LL).toLongLong();
+}
 
-        xlsx->write(row, 1, dt.toString("yyyy-MM-dd"), rowFmt);
-        xlsx->write(row, 2, dt.toString("hh:mm:ss"),   rowFmt);
-        xlsx->write(row, 3, percentage,                rowFmt);
-    }
-#else
-    qDebug() << "Not Android";
-#endif
+QString Backend::backfillKey(int mode, const QString &metric)
+{
+    // زیر export/running تا با شروع دوباره‌ی فایل تجمعی همراه watermark ها پاک شود
+    return (mode == ExportRunning ? QString("export/running/backfill/") : QString("export/backfill/")) + metric;
 }
 
-QString Backend::isoStringMonthsAgo(int months)
+qint64 Backend::exportSince(int mode, const QString &metric)
 {
-    QDateTime now = QDateTime::currentDateTimeUtc();
-    QDateTime past = now.addMonths(-months);
-    // فرمت ISO8601 که Kotlin می‌فهمد
-    return past.toString(Qt::ISODateWithMs);
+    // watermark جدیدترین زمان اندازه‌گیری است؛ رکوردی که بعداً با زمان قدیمی‌تر
+    // نوشته شده از زمان خودش دوباره خوانده می‌شود
+    QSettings settings;
+    const qint64 watermark = settings.value(watermarkKey(mode, metric), 0LL).toLongLong();
+    const qint64 backfill  = settings.value(backfillKey(mode, metric), 0LL).toLongLong();
+    return (backfill > 0 && backfill <= watermark) ? backfill - 1 : watermark;
 }
 
-void Backend::savePeriodState()
+void Backend::markBackfill(int type, qint64 ms)
 {
+    const char *metric = Metric::key(type);
+    if (!metric)
+        return;
     QSettings settings;
-    settings.setValue("menstruation/periodActive",
-                      periodActive);
-    settings.setValue("menstruation/periodStart",
-                      currentPeriodStart.toMSecsSinceEpoch());
-    settings.sync();
-    qDebug() << "💾 Period state saved:"
-             << "active=" << periodActive
-             << "start=" << currentPeriodStart.toString("yyyy/MM/dd hh:mm:ss");
+    for (int mode : {ExportDelta, ExportRunning}) {
+        // بعد از watermark: خروجی بعدی خودش برمی‌دارد
+        if (ms > settings.value(watermarkKey(mode, metric), 0LL).toLongLong())
+            continue;
+        const QString key = backfillKey(mode, metric);
+        const qint64 current = settings.value(key, 0LL).toLongLong();
+        if (current == 0 || ms < current)
+            settings.setValue(key, ms);
+    }
 }
 
 void Backend::loadPeriodState()
@@ -13,16 +13,51 @@
 #include <QThread>
 #include <QDir>
 #include <QSettings>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QUrl>
+#include <QGuiApplication>
+#include <QThreadPool>
+#include <QQuickWindow>
+#include <QtConcurrent/QtConcurrentRun>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <iterator>
+#include <atomic>
 #include "xlsxdocument.h"
 #include "xlsxformat.h"
 #include "xlsxworksheet.h"
+#include "ziprepacker.h"
+#include "outputsink.h"
+#include "seriesexporter.h"
+#include "healthmeasurement.h"
+#include "healthbridge.h"
+#include "shardedreader.h"
+#include "healthimporter.h"
+#include "writequeue.h"
+#include "rendersnapshot.h"
+#include "latestreading.h"
+#include "menstruationmodel.h"
+#include "tracer.h"
+#include "metricsmodel.h"
+#include "seriescache.h"
+#include "metricdescriptor.h"
 
 #ifdef Q_OS_ANDROID
-#include <QStandardPaths>
 #include <QJniObject>
 #include <QCoreApplication>
 #include <QtCore/qnativeinterface.h>
 #include <QJniEnvironment>
+#else
+#include <QProcess>
 #endif
 
 // ── ساختار داده دوره قاعدگی ──────────────────────────────────
@@ -40,8 +75,106 @@ struct MenstruationFlow {
 class Backend : public QObject
 {
     Q_OBJECT
+    // حالت فشرده‌سازی فایل Excel — مقادیر ZipRepacker::Compression
+    Q_PROPERTY(int exportCompression READ exportCompression WRITE setExportCompression NOTIFY exportCompressionChanged)
+    // کل بازه یا فقط رکوردهای بعد از آخرین خروجی موفق — مقادیر ExportMode
+    Q_PROPERTY(int exportMode READ exportMode WRITE setExportMode NOTIFY exportModeChanged)
+    // قالب فایل خروجی — مقادیر SeriesExporter::Format
+    Q_PROPERTY(int exportFormat READ exportFormat WRITE setExportFormat NOTIFY exportFormatChanged)
+    // اندازه‌گیری‌هایی که هنوز در journal منتظر Health Connect هستند
+    Q_PROPERTY(int pendingWrites READ pendingWrites NOTIFY pendingWritesChanged)
+    // آخرین وضعیت شناخته‌شده‌ی دسترسی‌ها — بدون فراخوانی JNI خوانده می‌شود
+    Q_PROPERTY(bool permissionsGranted READ permissionsGranted NOTIFY permissionsGrantedChanged)
+    Q_PROPERTY(QString permissionsMessage READ permissionsMessage NOTIFY permissionsGrantedChanged)
+    // آخرین اندازه‌گیری هر متریک — با یک رفت‌وبرگشت، مستقل از بازه‌ی چارت
+    Q_PROPERTY(LatestReading latestHeight READ latestHeight NOTIFY latestReadingsChanged)
+    Q_PROPERTY(LatestReading latestWeight READ latestWeight NOTIFY latestReadingsChanged)
+    Q_PROPERTY(LatestReading latestBloodPressure READ latestBloodPressure NOTIFY latestReadingsChanged)
+    Q_PROPERTY(LatestReading latestHeartRate READ latestHeartRate NOTIFY latestReadingsChanged)
+    Q_PROPERTY(LatestReading latestBloodGlucose READ latestBloodGlucose NOTIFY latestReadingsChanged)
+    Q_PROPERTY(LatestReading latestOxygenSaturation READ latestOxygenSaturation NOTIFY latestReadingsChanged)
+    // دوره‌ها با flow های گروه‌بندی‌شده — بعد از هر refresh در جا به‌روز می‌شود
+    Q_PROPERTY(MenstruationModel *menstruationModel READ menstruationModel CONSTANT)
+    // هیستوگرام تأخیر هر مرحله — برای overlay ی debug
+    Q_PROPERTY(MetricsModel *metrics READ metrics CONSTANT)
+    Q_PROPERTY(bool metricsOverlay READ metricsOverlay CONSTANT)
+    // حافظه‌ی سری‌ها: کش پنجره‌ها (SeriesCache) و سری‌های در حال نمایش
+    Q_PROPERTY(QVariantMap memoryUsage READ memoryUsage NOTIFY memoryUsageChanged)
+    Q_PROPERTY(int memoryBudgetMB READ memoryBudgetMB WRITE setMemoryBudgetMB NOTIFY memoryBudgetChanged)
 public:
     explicit Backend(QObject *parent = nullptr);
+    ~Backend() override;
+
+    enum ExportMode {
+        ExportFull    = 0,   // کل داده‌ی بارگذاری‌شده
+        ExportDelta   = 1,   // فقط جدیدها، در یک فایل کوچک جدا
+        ExportRunning = 2    // فقط جدیدها، افزوده به فایل تجمعی
+    };
+    Q_ENUM(ExportMode)
+
+    // وضعیت هر آیتم writeBatch — مقادیر ITEM_* در HealthBridge.kt
+    enum WriteStatus {
+        WriteOk      = 0,
+        WriteInvalid = 1,
+        WriteFailed  = 2,
+        WriteDenied  = 3
+    };
+    Q_ENUM(WriteStatus)
+
+    // چند اندازه‌گیری در یک فراخوانی؛ خروجی: WriteStatus هر آیتم به همان ترتیب
+    QList<int> writeBatch(const QList<HealthMeasurement> &items);
+    // بدون signal — از thread های دیگر (import) هم قابل صدا زدن است
+    static QList<int> insertBatch(const QList<HealthMeasurement> &items);
+    // ثانیه‌های epoch رکوردهای موجود یک نوع در بازه — برای حذف تکراری‌ها
+    static QSet<qint64> existingSeconds(int type, qint64 fromMs, qint64 toMs);
+    // زمان اولین فریم و اولین فریم با داده لاگ می‌شود — قبل از show() صدا زده شود
+    void trackFirstPaint(QQuickWindow *window);
+
+    // ── حالت headless (HeadlessRunner) ──
+    struct RangeExportStats {
+        struct Metric {
+            int    type      = 0;
+            qint64 records   = 0;
+            int    pages     = 0;
+            qint64 elapsedMs = 0;
+            int    status    = HealthBridge::StreamFailed;
+        };
+        QList<Metric> metrics;
+        qint64 records        = 0;
+        qint64 fetchMs        = 0;   // bridge + decode + merge، همه‌ی متریک‌ها
+        int    periods        = 0;
+        int    flows          = 0;
+        qint64 menstruationMs = 0;
+        qint64 exportMs       = 0;
+        qint64 rows           = 0;
+        qint64 bytes          = 0;
+    };
+    // سری‌های خام [from, to) را روی همین thread می‌خواند و با format در sink می‌نویسد؛
+    // بدون bucket، بدون signal به QML، و بدون اثر روی snapshot و watermark ها.
+    // compression < 0 یعنی همان تنظیم ذخیره‌شده (فقط برای Xlsx)
+    bool exportRange(const QList<int> &types, const QDateTime &from, const QDateTime &to,
+                     int format, int compression, OutputSink *sink,
+                     RangeExportStats *stats, QString *error);
+    // "heartRate" → HealthMeasurement::HeartRate؛ 0 برای نام ناشناخته
+    static int metricType(const QString &metric);
+
+    int exportCompression() const { return m_exportCompression; }
+    int exportMode() const { return m_exportMode; }
+    int exportFormat() const { return m_exportFormat; }
+    int pendingWrites() const { return m_pendingWrites; }
+    bool permissionsGranted() const { return m_permissionsGranted; }
+    QString permissionsMessage() const { return m_permissionsMessage; }
+    LatestReading latestHeight() const { return m_latest.value(HealthMeasurement::Height); }
+    LatestReading latestWeight() const { return m_latest.value(HealthMeasurement::Weight); }
+    LatestReading latestBloodPressure() const { return m_latest.value(HealthMeasurement::BloodPressure); }
+    LatestReading latestHeartRate() const { return m_latest.value(HealthMeasurement::HeartRate); }
+    LatestReading latestBloodGlucose() const { return m_latest.value(HealthMeasurement::BloodGlucose); }
+    LatestReading latestOxygenSaturation() const { return m_latest.value(HealthMeasurement::OxygenSaturation); }
+    MenstruationModel *menstruationModel() const { return m_menstruationModel; }
+    MetricsModel *metrics() const { return m_metrics; }
+    bool metricsOverlay() const { return m_metricsOverlay; }
+    QVariantMap memoryUsage() const;
+    int memoryBudgetMB() const { return int(m_cache.budgetBytes() / (1024 * 1024)); }
 
 public slots:
     void onQmlReady(void);
@@ -62,62 +195,225 @@ public slots:
                                QDateTime dt = QDateTime::currentDateTime());
     // فقط در پایان دوره صدا زده می‌شه — startTime از QSettings خوانده می‌شه
     void writeMenstruationPeriod(QDateTime endTime = QDateTime::currentDateTime());
+    void setExportCompression(int mode);
+    void setExportMode(int mode);
+    void setExportFormat(int format);
+    void setMemoryBudgetMB(int megabytes);
+    // fileUrl: مسیر محلی یا content:// از FileDialog
+    void onImportRequest(const QString &fileUrl);
+    void onImportCancel();
+    // وضعیت کش‌شده‌ی دسترسی‌ها را باطل می‌کند؛ بررسی بعدی از Health Connect می‌پرسد
+    void invalidatePermissions();
+    // QML بعد از هر بار چیدن چارت محدوده‌ی محورها را گزارش می‌دهد (برای snapshot)
+    void setDisplayedAxes(const QVariantMap &axes);
+    // آخرین count اندازه‌گیری همه‌ی متریک‌ها در یک فراخوانی bridge
+    void refreshLatest(int count = LatestCount);
+    // span های سمت QML: traceBegin زمان شروع را می‌دهد (-1 وقتی tracer خاموش است)
+    qint64 traceBegin() const { return Tracer::enabled() ? Tracer::nowUs() : -1; }
+    void traceEnd(const QString &name, qint64 startUs);
+    // StageMetrics در path/metrics-<زمان>.json؛ خروجی مسیر فایل یا خالی
+    QString dumpMetrics();
 
 private:
+    friend class BackendBench;   // bench/backendbench.cpp — مراحل خصوصی مسیر داده را جدا اندازه می‌گیرد
+
+    static constexpr const char *XlsxMimeType =
+        "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet";
+    static constexpr int CopyChunkSize = 64 * 1024;
+    // سقف ردیف‌های یک worksheet در Excel (شامل هدر)
+    static constexpr int XlsxMaxRows = 1048576;
+    static constexpr const char *RunningWorkbookName = "running_export.xlsx";
+    static constexpr const char *WriteJournalName = "write_journal.ndjson";
+    static constexpr const char *SnapshotName = "render_snapshot.bin";
+    static constexpr int LatestCount = 5;
+    static constexpr qint64 PermissionCacheTtlMs = 5 * 60 * 1000;
+    // از این طول بازه به بالا HR/BP/قند خون/SpO2 تجمیعی خوانده می‌شوند
+    static constexpr qint64 HourlyBucketsFromMs  = qint64(14) * 24 * 3600 * 1000;
+    static constexpr qint64 DailyBucketsFromMs   = qint64(60) * 24 * 3600 * 1000;
+
     QString path;
     QList<QPointF> hList;
-    QJsonDocument heightJsonDoc;
     QList<QPointF> wList;
-    QJsonDocument weightJsonDoc;
     QList<QPointF> bpSystolicList;
     QList<QPointF> bpDiastolicList;
-    QJsonDocument bpJsonDoc;
     QList<QPointF> heartRateList;
-    QJsonDocument heartRateJsonDoc;
     QList<QPointF> bloodGlucoseList;
-    QJsonDocument bloodGlucoseJsonDoc;
+    QList<QPointF> bloodGlucoseSpecimenList;   // y = specimenSource
+    QList<QPointF> bloodGlucoseMealList;       // y = mealType
+    QList<QPointF> bloodGlucoseRelationList;   // y = relationToMeal
     QList<QPointF> oxygenSaturationList;
-    QJsonDocument oxygenSaturationJsonDoc;
     QList<MenstruationPeriod> periodList;
     QList<MenstruationFlow>   periodFlowList;
-    QJsonDocument periodJsonDoc;
     bool      periodActive = false;
     QDateTime currentPeriodStart;
+    int       m_exportCompression = ZipRepacker::Fast;
+    int       m_exportMode        = ExportFull;
+    int       m_exportFormat      = SeriesExporter::Xlsx;
+    QDateTime m_loadedFrom;   // شروع بازه‌ی آخرین onUpdateRequest
+    QPointer<QThread>        m_importThread;
+    QPointer<HealthImporter> m_importer;
+    QThread     m_writeThread;
+    WriteQueue *m_writeQueue    = nullptr;   // روی m_writeThread زندگی می‌کند
+    int         m_pendingWrites = 0;
+    bool          m_permissionsGranted = false;
+    QString       m_permissionsMessage;
+    QElapsedTimer m_permissionsCheckedAt;   // نامعتبر یعنی کش خالی است
+    QThreadPool          m_readPool;
+    QThreadPool          m_snapshotPool;        // load و save ی snapshot، جدا از خواندن‌ها
+    std::atomic<quint64> m_readGeneration { 0 };   // صفحه‌های خواندن‌های قدیمی‌تر دور ریخته می‌شوند
+    bool                 m_reading = false;
+    bool                 m_exporting = false;   // خواندن‌های خروجی روی m_readPool
+
+    // یک صفحه‌ی تبدیل‌شده به نقاط چارت؛ سری‌های موازی هم‌اندیس با values
+    struct SeriesChunk {
+        int            type = 0;
+        QList<QPointF> values;
+        QList<QPointF> values2;    // فشار خون: diastolic
+        QList<QPointF> specimen;   // قند خون
+        QList<QPointF> meal;
+        QList<QPointF> relation;
+    };
+
+    // سری bucket ها — x = وسط bucket؛ برای BP، avg2 = diastolic و min = کمترین diastolic
+    struct BucketSeries {
+        QList<QPointF> avg;
+        QList<QPointF> avg2;
+        QList<QPointF> min;
+        QList<QPointF> max;
+    };
+    QHash<int, BucketSeries> m_buckets;   // نوع‌هایی که الان تجمیعی نمایش داده می‌شوند
+    SeriesCache              m_cache;     // پنجره‌های refresh های قبلی، با سقف حافظه
+
+    QHash<int, LatestReading> m_latest;
+    MenstruationModel        *m_menstruationModel = nullptr;
+    MetricsModel             *m_metrics           = nullptr;
+    bool                      m_metricsOverlay    = false;   // QMLHC_METRICS=1 یا debug/metrics
+
+    // ── شروع گرم ──
+    QVariantMap   m_displayedAxes;
+    qint64        m_snapshotSavedAtMs = 0;     // 0 یعنی snapshot بازیابی نشده
+    qsizetype     m_snapshotPoints    = 0;
+    bool          m_snapshotShown     = false; // سری‌ها هنوز نقاط کاهش‌یافته‌ی snapshot اند
+    bool          m_qmlReady          = false;
+    QElapsedTimer m_startupTimer;
+    QMetaObject::Connection m_paintConnection;
+    bool          m_firstFrameLogged  = false;
+    bool          m_meaningfulPaintLogged = false;
+    bool          m_livePaintPending  = false;
+    qint64        m_refreshStartUs    = 0;     // Tracer::nowUs() آخرین onUpdateRequest
 
     bool copyToDownloads(const QString &srcPath, const QString &fileName);
     void loadAvailablePath(void);
     void permissionRequest(void);
     bool checkPermissions(void);
-    void readHeight(QString startTime,QString endTime);
-    void exportHeight(QXlsx::Document *xlsx);
-    void readWeight(QString startTime,QString endTime);
-    void exportWeight(QXlsx::Document *xlsx);
-    void readBP(QString startTime,QString endTime);
-    void exportBP(QXlsx::Document *xlsx);
-    void readHR(QString startTime,QString endTime);
-    void exportHR(QXlsx::Document *xlsx);
-    void readBG(QString startTime,QString endTime);
-    void exportBG(QXlsx::Document *xlsx);
-    void readOxygenSaturation(QString startTime, QString endTime);
-    void exportOxygenSaturation(QXlsx::Document *xlsx);
+    bool ensurePermissions();
+    void storePermissions(bool granted, const QString &message);
+    static SeriesChunk toChunk(const HealthBridge::Page &page);
+    template <typename M>   // M: Metric::Descriptor
+    static void decodePage(const HealthBridge::Page &page, SeriesChunk *chunk);
+    // false اگر نقطه‌های قبلی سری جابه‌جا شده باشند (chunk ی هم‌پوشان)
+    bool appendChunk(const SeriesChunk &chunk);
+    // appendChunk و تحویل به QML: seriesChunkRead برای انتها، seriesReplaced برای هم‌پوشانی
+    void deliverChunk(const SeriesChunk &chunk);
+    void publishSeries(int type, qsizetype from);
+    QVariantMap seriesAxes();
+    void clearSeries(int type);
+    static const QList<QPair<const char *, QList<QPointF> Backend::*>> &seriesMembers();
+    QList<QPointF> *seriesNamed(const char *name);
+    QList<QPointF> *seriesList(int type);
+    // سری‌های هم‌اندیس با seriesList(type)، به ترتیب ستون‌های Descriptor
+    QList<QList<QPointF> *> parallelSeries(int type);
+    static int bucketSecondsFor(qint64 spanMs);
+    static BucketSeries toBucketSeries(int type, const QList<HealthBridge::Bucket> &buckets);
+    void finishUpdate(quint64 generation, const QList<int> &types, const QList<int> &incomplete,
+                      const QString &startTime, const QString &endTime,
+                      const QDateTime &endTo, const QStringList &problems);
+    // سری‌های خام در حال نمایش یک نوع — بدون کپی
+    SeriesCache::Columns liveColumns(int type);
+    void cacheLoadedWindows(const QList<int> &types, const QList<int> &incomplete,
+                            const QDateTime &endTo);
+    // شیت یک متریک؛ خروجی: جدیدترین رکورد نوشته‌شده (یا sinceMs)
+    // skipExisting: ردیف‌هایی که Date+Time شان در شیت هست دوباره نوشته نمی‌شوند
+    qint64 exportMetric(int type, QXlsx::Document *xlsx, qint64 sinceMs = 0,
+                        bool skipExisting = false);
+    template <typename M>   // M: Metric::Descriptor
+    qint64 exportSheet(QXlsx::Document *xlsx, qint64 sinceMs, bool skipExisting);
     void readMenstruationData(QString startFrom, QString endTo);
-    void exportMenstruationData(QXlsx::Document *xlsx);
+    void parseMenstruation(const QString &jsonStr);   // JSON ی readMenstruation → periodList/periodFlowList
+    void publishMenstruation();   // periodList/periodFlowList → m_menstruationModel
+    void exportMenstruationData(QXlsx::Document *xlsx, qint64 periodsSinceMs = 0,
+                                qint64 flowsSinceMs = 0, qint64 *newestPeriodMs = nullptr,
+                                qint64 *newestFlowMs = nullptr);
+    static int openExportSheet(QXlsx::Document *xlsx, const QString &name);
+    bool writeWorkbook(QXlsx::Document *xlsx, OutputSink *sink, QString *error,
+                       ZipRepacker::Stats *stats = nullptr);
+    void exportSeries(const QList<int> &types);
+    // جدول‌های SeriesExporter از سری‌های حافظه → sink (open تا commit)
+    bool writeSeries(const QList<int> &types,
+                     SeriesExporter::Format format, OutputSink *sink,
+                     SeriesExporter::Stats *stats, QString *error);
+    static void logExportThroughput(const QString &format, qint64 rows,
+                                    qint64 bytes, qint64 elapsedMs);
+    // خروجی بعد از خواندن‌های onExportRequest روی m_readPool؛ reads: متریک → sinceMs
+    void finishExport(const QList<int> &types, int mode, const QHash<QString, qint64> &reads,
+                      const QList<SeriesChunk> &chunks, const QString &menstruationJson,
+                      const QStringList &problems);
+    bool enqueueWrite(const HealthMeasurement &m);
+    bool addLocalPoint(const HealthMeasurement &m, qsizetype *inserted = nullptr);
+    void mergePendingMenstruation();
+    void mergePendingWrites(const QList<int> &types, const QDateTime &endTo);
+    void emitLocalUpdate();   // همه‌ی سری‌ها از نو — فقط snapshot
+    void updateLatest(const HealthMeasurement &m);
+    RenderSnapshot captureSnapshot();
+    void applySnapshot(const RenderSnapshot &snapshot);
+    void saveSnapshot(bool async);
+    QList<QPair<QString, QList<QPointF> *>> namedSeries();
 
+    // ترتیب آرگومان‌های exportSignal ی QML
+    static QList<int> selectedTypes(bool height, bool weight, bool bp, bool bg, bool hr, bool spo2);
     static QString isoStringMonthsAgo(int months);
     void savePeriodState();
     void loadPeriodState();
+    void loadExportSettings();
+    static QString watermarkKey(int mode, const QString &metric);
+    static qint64 exportWatermark(int mode, const QString &metric);
+    // قدیمی‌ترین رکورد نوشته‌شده با زمان قبل از watermark، تا خروجی بعدی
+    static QString backfillKey(int mode, const QString &metric);
+    static qint64 exportSince(int mode, const QString &metric);   // min(watermark, backfill - 1)
+    static void markBackfill(int type, qint64 ms);
 
     void askForPermission(const QStringList &permissions, int requestCode);
 
 signals:
     void permissionsState(bool success,QString message);
+    void permissionsGrantedChanged(bool granted);
+    void latestReadingsChanged();
     void newDataRead(QList<QPointF> hList,
                      QList<QPointF> wList,
                      QList<QPointF> bpSystolicList, QList<QPointF> bpDiastolicList,
                      QList<QPointF> heartRateList,
                      QList<QPointF> bloodGlucoseList,
                      QList<QPointF> oxygenSaturationList);
+    // خواندن صفحه‌ای: readStarted → seriesChunkRead/seriesReplaced (برای هر صفحه)
+    //   → seriesAxesRead → readFinished. newDataRead فقط برای snapshot
+    void readStarted();
+    void seriesChunkRead(int type, QList<QPointF> values, QList<QPointF> values2);
+    // صفحه‌ی هم‌پوشان: کل سری merge شده‌ی آن نوع
+    void seriesReplaced(int type, QList<QPointF> values, QList<QPointF> values2);
+    // کلیدها مثل Main.displayedAxes
+    void seriesAxesRead(QVariantMap axes);
+    void readFinished(bool complete, QString message);
+    // بعد از newDataRead ی snapshot — محورها همان‌طور که آخرین بار بودند
+    void snapshotRestored(QVariantMap axes, qint64 savedAtMs);
+    // جایگزین سری خام همان نوع در بازه‌های طولانی
+    void bucketSeriesRead(int type, QList<QPointF> avg, QList<QPointF> avg2,
+                          QList<QPointF> min, QList<QPointF> max);
     void exportCompleted(bool success, QString message);
+    void exportCompressionChanged(int mode);
+    void exportModeChanged(int mode);
+    void exportFormatChanged(int format);
+    void memoryUsageChanged();
+    void memoryBudgetChanged(int megabytes);
     void heightWritten(bool success, QString message);
     void weightWritten(bool success, QString message);
     void bloodPressureWritten(bool success, QString message);
@@ -126,9 +422,11 @@ signals:
     void oxygenSaturationWritten(bool success, QString message);
     void menstruationFlowWritten(bool success, QString message);
     void menstruationPeriodWritten(bool success, QString message);
-    // void menstruationDataRead(QList<MenstruationPeriod> periods,
-    //                           QList<MenstruationFlow>   flows);
-    void menstruationDataRead(QString jsonData);
+    void batchWritten(int inserted, int failed, QList<int> status);
+    void pendingWritesChanged(int count);
+    void writeRejected(int count, QString message);
+    void importProgress(int percent, qint64 rowsRead, qint64 inserted);
+    void importFinished(bool success, QString message);
     void periodStateChanged(bool state);
 };
 
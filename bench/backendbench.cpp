@@ -0,0 +1,865 @@
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <QtTest>
+
+#include "backend.h"
+#include "compressedseries.h"
+#include "desktophealthbridge.h"
+#include "fakehealthbridge.h"
+#include "syntheticdata.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// ── benchmark های مسیر داده، بدون Health Connect و بدون QML ────────
+// همه‌ی داده‌ها با seed ثابت ساخته می‌شوند، پس دو اجرا دقیقاً یک ورودی دارند.
+// اندازه‌ها 1k تا 1M نقطه‌اند؛ QMLHC_BENCH_MAX_POINTS سقف آن‌ها را کم می‌کند.
+//
+// اجرا (headless، خروجی قابل پردازش):
+//     QMLHealthConnect_bench -o results.csv,csv -o -,txt
+//     QMLHealthConnect_bench -o results.xml,xml        # شامل BenchmarkResult
+//     QMLHealthConnect_bench exportSheet HeartRate:10k  # فقط یک سطر
+namespace {
+
+using namespace Synthetic;
+
+constexpr int PageSize = FakeHealthBridge::PageSize;
+
+// آرایه‌های موازی یک stream — همان شکلی که nativeOnPage می‌سازد
+struct PageData {
+    int           type = 0;
+    QList<qint64> timesMs;
+    QList<double> values;
+    QList<double> values2;
+    QList<int>    extras;
+
+    static PageData from(int type, const QList<HealthMeasurement> &list)
+    {
+        PageData d;
+        d.type = type;
+        for (const HealthMeasurement &m : list) {
+            d.timesMs.append(m.time.toMSecsSinceEpoch());
+            d.values.append(m.value);
+            d.values2.append(m.value2);
+            d.extras.append(m.specimenSource | m.mealType << 8 | m.relationToMeal << 16);
+        }
+        return d;
+    }
+
+    HealthBridge::Page page(qsizetype offset, qsizetype count) const
+    {
+        HealthBridge::Page p;
+        p.type    = type;
+        p.count   = qMin(count, timesMs.size() - offset);
+        p.timesMs = timesMs.constData() + offset;
+        p.values  = values.constData() + offset;
+        p.values2 = values2.constData() + offset;
+        p.extras  = extras.constData() + offset;
+        return p;
+    }
+};
+
+// ── اندازه‌ها ───────────────────────────────────────────────
+int maxPoints()
+{
+    static const int max = [] {
+        bool ok = false;
+        const int v = qEnvironmentVariableIntValue("QMLHC_BENCH_MAX_POINTS", &ok);
+        return ok && v > 0 ? v : 1000000;
+    }();
+    return max;
+}
+
+// 1k, 10k, 100k, 1M تا سقف cap (و QMLHC_BENCH_MAX_POINTS)
+QList<QPair<QByteArray, int>> sizes(int cap = 1000000)
+{
+    static const QPair<QByteArray, int> all[] = {
+        {"1k", 1000}, {"10k", 10000}, {"100k", 100000}, {"1M", 1000000}
+    };
+    QList<QPair<QByteArray, int>> out;
+    for (const auto &s : all) {
+        if (s.second <= qMin(cap, maxPoints()))
+            out.append(s);
+    }
+    return out;
+}
+
+void addSizeRows(int cap = 1000000)
+{
+    QTest::addColumn<int>("count");
+    for (const auto &s : sizes(cap))
+        QTest::newRow(s.first.constData()) << s.second;
+}
+
+void addTypeSizeRows(int cap = 1000000)
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<int>("count");
+    for (int type : allTypes())
+        for (const auto &s : sizes(cap))
+            QTest::addRow("%s:%s", HealthBridge::typeName(type), s.first.constData()) << type << s.second;
+}
+
+// پیاده‌سازی C++ همان حلقه‌های HealthChartView.qml — خط پایه برای مقایسه با QML
+struct Bounds {
+    double minX, maxX, minY, maxY;
+};
+
+Bounds scanBounds(const QList<QPointF> &points)
+{
+    Bounds b { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+               std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+    for (const QPointF &p : points) {
+        b.minX = qMin(b.minX, p.x());
+        b.maxX = qMax(b.maxX, p.x());
+        b.minY = qMin(b.minY, p.y());
+        b.maxY = qMax(b.maxY, p.y());
+    }
+    return b;
+}
+
+// findClosestPoint: جستجوی خطی با آستانه
+qsizetype closestLinear(const QList<QPointF> &points, double x, double threshold)
+{
+    qsizetype best = -1;
+    double minDistance = std::numeric_limits<double>::max();
+    for (qsizetype j = 0; j < points.size(); ++j) {
+        const double dist = std::abs(points.at(j).x() - x);
+        if (dist < minDistance && dist < threshold) {
+            minDistance = dist;
+            best = j;
+        }
+    }
+    return best;
+}
+
+// همان نتیجه روی سری مرتب، با جستجوی دودویی
+qsizetype closestSorted(const QList<QPointF> &points, double x, double threshold)
+{
+    auto it = std::lower_bound(points.cbegin(), points.cend(), x,
+                               [](const QPointF &p, double v) { return p.x() < v; });
+    qsizetype best = -1;
+    double minDistance = threshold;
+    if (it != points.cend() && it->x() - x < minDistance) {
+        minDistance = it->x() - x;
+        best = it - points.cbegin();
+    }
+    if (it != points.cbegin() && x - std::prev(it)->x() < minDistance)
+        best = std::prev(it) - points.cbegin();
+    return best;
+}
+
+} // namespace
+
+class BackendBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parseTimestamps_data() { addSizeRows(); }
+    void parseTimestamps();
+    void decodePage_data() { addTypeSizeRows(); }
+    void decodePage();
+    void decodeAggregate_data() { addSizeRows(100000); }
+    void decodeAggregate();
+    void storeAppend_data() { addSizeRows(); }
+    void storeAppend();
+    void storeMergeOverlap_data() { addSizeRows(); }
+    void storeMergeOverlap();
+    void storeMergePending_data() { addSizeRows(); }
+    void storeMergePending();
+    void downsample_data() { addSizeRows(); }
+    void downsample();
+    void axisBounds_data() { addSizeRows(); }
+    void axisBounds();
+    void nearestPointLinear_data() { addSizeRows(100000); }
+    void nearestPointLinear();
+    void nearestPointSorted_data() { addSizeRows(); }
+    void nearestPointSorted();
+    void menstruationGroup_data() { addSizeRows(); }
+    void menstruationGroup();
+    void menstruationSegments_data() { addSizeRows(); }
+    void menstruationSegments();
+    void exportSheet_data() { addTypeSizeRows(100000); }
+    void exportSheet();
+    void exportMenstruation_data() { addSizeRows(100000); }
+    void exportMenstruation();
+    void exportSeries_data();
+    void exportSeries();
+    void zipRepack_data();
+    void zipRepack();
+    void readStream_data();
+    void readStream();
+    void desktopStream_data() { addSizeRows(); }
+    void desktopStream();
+    void writeBatch_data();
+    void writeBatch();
+    void importCsv_data() { addSizeRows(100000); }
+    void importCsv();
+    void compressSeries_data();
+    void compressSeries();
+    void scanCompressed_data();
+    void scanCompressed();
+
+private:
+    void loadStore(int type, int count);
+
+    std::unique_ptr<Backend> m_backend;
+    FakeHealthBridge         m_bridge;
+    QTemporaryDir            m_tempDir;
+};
+
+void BackendBench::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+    // Backend مسیرش را از EXTERNAL_STORAGE می‌گیرد؛ snapshot و journal اینجا می‌روند
+    qputenv("EXTERNAL_STORAGE", m_tempDir.path().toUtf8());
+    HealthBridge::setInstance(&m_bridge);
+    m_backend = std::make_unique<Backend>();
+}
+
+void BackendBench::cleanupTestCase()
+{
+    m_backend.reset();
+    HealthBridge::setInstance(nullptr);
+}
+
+// سری‌های Backend را با همان مسیر خواندن (toChunk → appendChunk) پر می‌کند
+void BackendBench::loadStore(int type, int count)
+{
+    m_backend->clearSeries(type);
+    const PageData data = PageData::from(type, measurements(type, count, stepFor(type)));
+    for (qsizetype offset = 0; offset < count; offset += PageSize)
+        m_backend->appendChunk(Backend::toChunk(data.page(offset, PageSize)));
+    QCOMPARE(m_backend->seriesList(type)->size(), qsizetype(count));
+}
+
+// ── decode ──────────────────────────────────────────────────
+void BackendBench::parseTimestamps()
+{
+    QFETCH(int, count);
+    QStringList iso;
+    iso.reserve(count);
+    for (const HealthMeasurement &m : measurements(HealthMeasurement::HeartRate, count, 1000))
+        iso.append(m.time.toString(Qt::ISODateWithMs));
+
+    qint64 sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QString &s : std::as_const(iso))
+            sum += QDateTime::fromString(s, Qt::ISODateWithMs).toMSecsSinceEpoch();
+    }
+    QVERIFY(sum != 0);
+}
+
+void BackendBench::decodePage()
+{
+    QFETCH(int, type);
+    QFETCH(int, count);
+    const PageData data = PageData::from(type, measurements(type, count, stepFor(type)));
+
+    qsizetype points = 0;
+    QBENCHMARK {
+        points = 0;
+        for (qsizetype offset = 0; offset < count; offset += PageSize)
+            points += Backend::toChunk(data.page(offset, PageSize)).values.size();
+    }
+    QCOMPARE(points, qsizetype(count));
+}
+
+void BackendBench::decodeAggregate()
+{
+    QFETCH(int, count);
+    // همان JSON ی aggregateBuckets در HealthBridge.kt
+    QRandomGenerator rng(Seed);
+    QJsonArray buckets;
+    for (int i = 0; i < count; ++i) {
+        const qint64 start = EpochMs + qint64(i) * 3600 * 1000;
+        const double avg   = 60 + rng.bounded(40.0);
+        buckets.append(QJsonObject{
+            {"start", start}, {"end", start + 3600 * 1000},
+            {"min", avg - 10}, {"avg", avg}, {"max", avg + 15},
+            {"min2", 0}, {"avg2", 0}, {"max2", 0},
+            {"count", 3600}
+        });
+    }
+    const QString json = QString::fromUtf8(QJsonDocument(QJsonObject{
+        {"status", "COMPLETE"}, {"buckets", buckets}
+    }).toJson(QJsonDocument::Compact));
+
+    HealthBridge::AggregateResult result;
+    QBENCHMARK {
+        result = HealthBridge::parseAggregateResult(json);
+    }
+    QCOMPARE(result.buckets.size(), qsizetype(count));
+}
+
+// ── store ───────────────────────────────────────────────────
+void BackendBench::storeAppend()
+{
+    QFETCH(int, count);
+    const int type = HealthMeasurement::HeartRate;
+    const PageData data = PageData::from(type, measurements(type, count, 1000));
+    QList<Backend::SeriesChunk> chunks;
+    for (qsizetype offset = 0; offset < count; offset += PageSize)
+        chunks.append(Backend::toChunk(data.page(offset, PageSize)));
+
+    QBENCHMARK {
+        m_backend->clearSeries(type);
+        for (const Backend::SeriesChunk &chunk : std::as_const(chunks))
+            m_backend->appendChunk(chunk);
+    }
+    QCOMPARE(m_backend->heartRateList.size(), qsizetype(count));
+}
+
+// یک صفحه‌ی نامرتب (نمونه‌های رکوردهای هم‌پوشان) در سری count نقطه‌ای
+void BackendBench::storeMergeOverlap()
+{
+    QFETCH(int, count);
+    const int type = HealthMeasurement::HeartRate;
+    loadStore(type, count);
+    const QList<QPointF> base = m_backend->heartRateList;
+
+    Backend::SeriesChunk overlap;
+    overlap.type = type;
+    QRandomGenerator rng(Seed);
+    for (int i = 0; i < PageSize; ++i)
+        overlap.values.append(QPointF(EpochMs + rng.bounded(qint64(count)) * 1000 + 500, 70));
+
+    QBENCHMARK {
+        // کپی واقعی در اولین insert اتفاق می‌افتد — هزینه‌ی O(n) آن جزو اندازه است
+        m_backend->heartRateList = base;
+        m_backend->appendChunk(overlap);
+    }
+    QCOMPARE(m_backend->heartRateList.size(), qsizetype(count + PageSize));
+}
+
+// write های در صف که در بازه‌ی بارگذاری‌شده‌اند (mergePendingWrites → addLocalPoint)
+void BackendBench::storeMergePending()
+{
+    QFETCH(int, count);
+    const int type = HealthMeasurement::HeartRate;
+    loadStore(type, count);
+    const QList<QPointF> base = m_backend->heartRateList;
+
+    QList<HealthMeasurement> pending = measurements(type, 100, qint64(count) * 10, Seed + 1);
+    for (HealthMeasurement &m : pending)
+        m.time = m.time.addMSecs(500);
+
+    int merged = 0;
+    QBENCHMARK {
+        m_backend->heartRateList = base;
+        merged = 0;
+        for (const HealthMeasurement &m : std::as_const(pending))
+            merged += m_backend->addLocalPoint(m) ? 1 : 0;
+    }
+    QCOMPARE(merged, int(pending.size()));
+}
+
+void BackendBench::downsample()
+{
+    QFETCH(int, count);
+    QList<HealthBridge::Bucket> buckets;
+    buckets.reserve(count);
+    QRandomGenerator rng(Seed);
+    for (int i = 0; i < count; ++i) {
+        HealthBridge::Bucket b;
+        b.startMs = EpochMs + qint64(i) * 3600 * 1000;
+        b.endMs   = b.startMs + 3600 * 1000;
+        b.avg     = 120 + rng.bounded(20.0);
+        b.min     = b.avg - 10;
+        b.max     = b.avg + 10;
+        b.avg2    = 80 + rng.bounded(10.0);
+        b.min2    = b.avg2 - 8;
+        buckets.append(b);
+    }
+
+    Backend::BucketSeries series;
+    QBENCHMARK {
+        series = Backend::toBucketSeries(HealthMeasurement::BloodPressure, buckets);
+    }
+    QCOMPARE(series.avg.size(), qsizetype(count));
+}
+
+// ── چارت: همتای C++ حلقه‌های onNewDataRead و findClosestPoint ──
+void BackendBench::axisBounds()
+{
+    QFETCH(int, count);
+    loadStore(HealthMeasurement::HeartRate, count);
+    const QList<QPointF> &points = m_backend->heartRateList;
+
+    Bounds b {};
+    QBENCHMARK {
+        b = scanBounds(points);
+    }
+    QVERIFY(b.minY <= b.maxY);
+}
+
+void BackendBench::nearestPointLinear()
+{
+    QFETCH(int, count);
+    loadStore(HealthMeasurement::HeartRate, count);
+    const QList<QPointF> &points = m_backend->heartRateList;
+    const double span      = points.last().x() - points.first().x();
+    const double threshold = span * 0.05;
+
+    QRandomGenerator rng(Seed);
+    QList<double> targets;
+    for (int i = 0; i < 100; ++i)
+        targets.append(points.first().x() + rng.bounded(span));
+
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (double x : std::as_const(targets))
+            found += closestLinear(points, x, threshold) >= 0;
+    }
+    QCOMPARE(found, targets.size());
+}
+
+void BackendBench::nearestPointSorted()
+{
+    QFETCH(int, count);
+    loadStore(HealthMeasurement::HeartRate, count);
+    const QList<QPointF> &points = m_backend->heartRateList;
+    const double span      = points.last().x() - points.first().x();
+    const double threshold = span * 0.05;
+
+    QRandomGenerator rng(Seed);
+    QList<double> targets;
+    for (int i = 0; i < 100; ++i)
+        targets.append(points.first().x() + rng.bounded(span));
+
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (double x : std::as_const(targets))
+            found += closestSorted(points, x, threshold) >= 0;
+    }
+    QCOMPARE(found, targets.size());
+}
+
+// ── قاعدگی: count = تعداد flow ها، هر دوره ۵ روز با یک flow در روز ──
+namespace {
+void menstruationData(int flowCount, QList<MenstruationModel::Period> *periods,
+                      QList<MenstruationModel::Flow> *flows)
+{
+    constexpr qint64 DayMs = 24 * 3600 * 1000;
+    QRandomGenerator rng(Seed);
+    for (int p = 0; p * 5 < flowCount; ++p) {
+        const qint64 start = EpochMs + p * 28 * DayMs + rng.bounded(3) * DayMs;
+        periods->append({start, start + 5 * DayMs});
+        for (int d = 0; d < 5 && flows->size() < flowCount; ++d)
+            flows->append({start + d * DayMs + 8 * 3600 * 1000, int(rng.bounded(1, 4))});
+    }
+    // ورودی Health Connect مرتب نیست؛ setPeriods خودش مرتب می‌کند
+    std::shuffle(flows->begin(), flows->end(), std::mt19937(Seed));
+}
+}
+
+void BackendBench::menstruationGroup()
+{
+    QFETCH(int, count);
+    QList<MenstruationModel::Period> periods;
+    QList<MenstruationModel::Flow>   flows;
+    menstruationData(count, &periods, &flows);
+
+    MenstruationModel model;
+    QBENCHMARK {
+        model.setPeriods(periods, flows);
+    }
+    QCOMPARE(model.flows().size(), qsizetype(count));
+}
+
+void BackendBench::menstruationSegments()
+{
+    QFETCH(int, count);
+    QList<MenstruationModel::Period> periods;
+    QList<MenstruationModel::Flow>   flows;
+    menstruationData(count, &periods, &flows);
+    MenstruationModel model;
+    model.setPeriods(periods, flows);
+
+    // یک پنجره‌ی ۹۰ روزه وسط داده — مثل چارت بزرگنمایی‌شده
+    const qreal from = model.periods().at(model.count() / 2).startMs;
+    const qreal to   = from + 90.0 * 24 * 3600 * 1000;
+    QList<qreal> segments;
+    QBENCHMARK {
+        segments = model.segments(from, to);
+    }
+    QVERIFY(!segments.isEmpty());
+}
+
+// ── export ──────────────────────────────────────────────────
+void BackendBench::exportSheet()
+{
+    QFETCH(int, type);
+    QFETCH(int, count);
+    loadStore(type, count);
+
+    qint64 newestMs = 0;
+    QBENCHMARK {
+        QXlsx::Document xlsx;
+        newestMs = m_backend->exportMetric(type, &xlsx, 0);
+    }
+    QCOMPARE(newestMs, qint64(m_backend->seriesList(type)->last().x()));
+    m_backend->clearSeries(type);
+}
+
+void BackendBench::exportMenstruation()
+{
+    QFETCH(int, count);
+    QList<MenstruationModel::Period> periods;
+    QList<MenstruationModel::Flow>   flows;
+    menstruationData(count, &periods, &flows);
+
+    m_backend->periodList.clear();
+    m_backend->periodFlowList.clear();
+    for (const MenstruationModel::Period &p : std::as_const(periods))
+        m_backend->periodList.append({QDateTime::fromMSecsSinceEpoch(p.startMs, QTimeZone::UTC),
+                                      QDateTime::fromMSecsSinceEpoch(p.endMs, QTimeZone::UTC)});
+    for (const MenstruationModel::Flow &f : std::as_const(flows))
+        m_backend->periodFlowList.append({QDateTime::fromMSecsSinceEpoch(f.timeMs, QTimeZone::UTC),
+                                          f.level});
+
+    qint64 newestFlowMs = 0;
+    QBENCHMARK {
+        QXlsx::Document xlsx;
+        m_backend->exportMenstruationData(&xlsx, 0, 0, nullptr, &newestFlowMs);
+    }
+    QVERIFY(newestFlowMs > 0);
+    m_backend->periodList.clear();
+    m_backend->periodFlowList.clear();
+}
+
+void BackendBench::exportSeries_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("count");
+    for (int format : {SeriesExporter::Csv, SeriesExporter::NdJson, SeriesExporter::Columnar})
+        for (const auto &s : sizes())
+            QTest::addRow("%s:%s", qPrintable(SeriesExporter::formatName(format)), s.first.constData())
+                << format << s.second;
+}
+
+void BackendBench::exportSeries()
+{
+    QFETCH(int, format);
+    QFETCH(int, count);
+    loadStore(HealthMeasurement::HeartRate, count);
+    const QList<SeriesExporter::Table> tables = {
+        {"heartRate", {{"bpm", SeriesExporter::Float64, &m_backend->heartRateList}}}
+    };
+
+    QByteArray bytes;
+    bytes.reserve(qsizetype(count) * 48);
+    SeriesExporter::Stats stats;
+    QBENCHMARK {
+        bytes.clear();
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(SeriesExporter::write(tables, SeriesExporter::Format(format), &buffer, &stats));
+    }
+    QCOMPARE(stats.rows, qint64(count));
+}
+
+void BackendBench::zipRepack_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<int>("count");
+    for (int mode : {ZipRepacker::Store, ZipRepacker::Fast, ZipRepacker::Maximum,
+                     ZipRepacker::ParallelMaximum})
+        for (const auto &s : sizes(100000))
+            QTest::addRow("%s:%s", qPrintable(ZipRepacker::compressionName(mode)), s.first.constData())
+                << mode << s.second;
+}
+
+void BackendBench::zipRepack()
+{
+    QFETCH(int, mode);
+    QFETCH(int, count);
+    loadStore(HealthMeasurement::HeartRate, count);
+
+    QBuffer package;
+    package.open(QIODevice::WriteOnly);
+    {
+        QXlsx::Document xlsx;
+        m_backend->exportMetric(HealthMeasurement::HeartRate, &xlsx, 0);
+        QVERIFY(xlsx.saveAs(&package));
+    }
+    const QByteArray zip = package.data();
+
+    QByteArray out;
+    ZipRepacker::Stats stats;
+    QBENCHMARK {
+        out.clear();
+        QBuffer buffer(&out);
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(ZipRepacker::repack(zip, &buffer, ZipRepacker::Compression(mode), &stats));
+    }
+    QVERIFY(stats.outputBytes > 0);
+}
+
+// ── bridge: یک stream در برابر ShardedReader، و writeBatch در برابر تکی ──
+// تأخیر هر فراخوانی/رکورد FakeHealthBridge هزینه‌ی IPC ی Health Connect را شبیه‌سازی می‌کند
+void BackendBench::readStream_data()
+{
+    QTest::addColumn<bool>("sharded");
+    QTest::addColumn<int>("count");
+    for (bool sharded : {false, true})
+        for (const auto &s : sizes(1000000))
+            QTest::addRow("%s:%s", sharded ? "sharded" : "single", s.first.constData())
+                << sharded << s.second;
+}
+
+void BackendBench::readStream()
+{
+    QFETCH(bool, sharded);
+    QFETCH(int, count);
+
+    // دو سال داده، تا ShardedReader واقعاً چند shard بسازد
+    const qint64 spanMs = qint64(730) * 24 * 3600 * 1000;
+    m_bridge.clear();
+    for (const HealthMeasurement &m : measurements(HealthMeasurement::HeartRate, count, spanMs / count))
+        m_bridge.insert(m);
+    m_bridge.setCallLatencyUs(2000);
+    m_bridge.setItemLatencyUs(1);
+
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(EpochMs, QTimeZone::UTC);
+    const QDateTime to   = from.addMSecs(spanMs + 1);
+    qint64 points = 0;
+    auto onPage = [&points](const HealthBridge::Page &page) {
+        points += Backend::toChunk(page).values.size();
+        return true;
+    };
+
+    HealthBridge::StreamResult result;
+    QBENCHMARK {
+        points = 0;
+        if (sharded) {
+            ShardedReader reader(&m_bridge);
+            result = reader.read(HealthMeasurement::HeartRate, from, to, onPage);
+        } else {
+            result = m_bridge.stream(HealthMeasurement::HeartRate,
+                                     from.toString(Qt::ISODateWithMs), to.toString(Qt::ISODateWithMs),
+                                     onPage);
+        }
+    }
+    m_bridge.setCallLatencyUs(0);
+    m_bridge.setItemLatencyUs(0);
+    m_bridge.clear();
+    QCOMPARE(result.status, HealthBridge::StreamComplete);
+    QCOMPARE(points, qint64(count));
+}
+
+// ── DesktopHealthBridge: تولید count ثانیه ضربان قلب 1 Hz، بدون تأخیر شبیه‌سازی‌شده ──
+void BackendBench::desktopStream()
+{
+    QFETCH(int, count);
+    DesktopHealthBridge::Profile profile;
+    profile.fromMs = EpochMs;
+    profile.toMs   = EpochMs + qint64(count) * 1000;
+    DesktopHealthBridge bridge(profile);
+
+    const QString from = QDateTime::fromMSecsSinceEpoch(profile.fromMs, QTimeZone::UTC)
+                             .toString(Qt::ISODateWithMs);
+    const QString to   = QDateTime::fromMSecsSinceEpoch(profile.toMs, QTimeZone::UTC)
+                             .toString(Qt::ISODateWithMs);
+    qint64 points = 0;
+    HealthBridge::StreamResult result;
+    QBENCHMARK {
+        points = 0;
+        result = bridge.stream(HealthMeasurement::HeartRate, from, to,
+                               [&points](const HealthBridge::Page &page) {
+                                   points += page.count;
+                                   return true;
+                               });
+    }
+    QCOMPARE(result.status, HealthBridge::StreamComplete);
+    // ساعت هر شب ۴۵ دقیقه شارژ می‌شود
+    QVERIFY(points > 0 && points <= count);
+}
+
+void BackendBench::writeBatch_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::addColumn<int>("count");
+    // مسیر تکی به ازای هر رکورد یک رفت‌وبرگشت دارد — بیش از 1k فقط صبر است
+    for (bool batched : {true, false})
+        for (const auto &s : sizes(batched ? 100000 : 1000))
+            QTest::addRow("%s:%s", batched ? "batch" : "single", s.first.constData())
+                << batched << s.second;
+}
+
+void BackendBench::writeBatch()
+{
+    QFETCH(bool, batched);
+    QFETCH(int, count);
+    const QList<HealthMeasurement> items =
+        measurements(HealthMeasurement::BloodPressure, count, 60 * 1000);
+    m_bridge.setCallLatencyUs(2000);
+    m_bridge.setItemLatencyUs(1);
+
+    int ok = 0;
+    QBENCHMARK {
+        m_bridge.clear();
+        ok = 0;
+        if (batched) {
+            for (qsizetype i = 0; i < items.size(); i += HealthImporter::BatchSize)
+                ok += int(Backend::insertBatch(items.mid(i, HealthImporter::BatchSize))
+                              .count(Backend::WriteOk));
+        } else {
+            for (const HealthMeasurement &m : items)
+                ok += int(Backend::insertBatch({m}).count(Backend::WriteOk));
+        }
+    }
+    m_bridge.setCallLatencyUs(0);
+    m_bridge.setItemLatencyUs(0);
+    m_bridge.clear();
+    QCOMPARE(ok, count);
+}
+
+// ── import: CSV ساده (metric,time_ms,value) با writer و reader واقعی Backend ──
+void BackendBench::importCsv()
+{
+    QFETCH(int, count);
+    const QString filePath = m_tempDir.filePath(QString("import-%1.csv").arg(count));
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QByteArray csv = "metric,time_ms,value\n";
+        for (const HealthMeasurement &m : measurements(HealthMeasurement::HeartRate, count, 1000)) {
+            csv += "heartRate," + QByteArray::number(m.time.toMSecsSinceEpoch()) + ','
+                   + QByteArray::number(m.value) + '\n';
+        }
+        file.write(csv);
+    }
+
+    HealthImporter::Result result;
+    QBENCHMARK {
+        m_bridge.clear();
+        HealthImporter importer(filePath, &Backend::insertBatch, &Backend::existingSeconds);
+        importer.run();
+        result = importer.result();
+    }
+    m_bridge.clear();
+    QCOMPARE(result.inserted, qint64(count));
+}
+
+// ── CompressedSeries روی ضربان قلب 1 Hz: نسبت فشرده‌سازی و سرعت scan ──
+void BackendBench::compressSeries_data()
+{
+    QTest::addColumn<int>("encoding");
+    QTest::addColumn<bool>("jitter");
+    QTest::addColumn<int>("count");
+    for (int encoding : {CompressedSeries::Xor, CompressedSeries::FixedPoint})
+        for (bool jitter : {false, true})
+            for (const auto &s : sizes())
+                QTest::addRow("%s:%s:%s", encoding == CompressedSeries::Xor ? "xor" : "fixed",
+                              jitter ? "jitter" : "exact", s.first.constData())
+                    << encoding << jitter << s.second;
+}
+
+void BackendBench::compressSeries()
+{
+    QFETCH(int, encoding);
+    QFETCH(bool, jitter);
+    QFETCH(int, count);
+    QList<QPointF> points = Synthetic::points(HealthMeasurement::HeartRate, count);
+    if (jitter) {
+        // ساعت واقعی دقیقاً هر 1000 ms نمونه نمی‌دهد: ±20 ms
+        QRandomGenerator rng(Seed);
+        for (QPointF &p : points)
+            p.setX(p.x() + int(rng.bounded(41)) - 20);
+    }
+
+    CompressedSeries series;
+    QBENCHMARK {
+        series = CompressedSeries(CompressedSeries::Encoding(encoding));
+        for (const QPointF &p : points)
+            series.append(qint64(p.x()), p.y());
+    }
+    QCOMPARE(series.size(), qint64(count));
+    QCOMPARE(series.points(), points);
+    qInfo("  %d samples → %lld B in %d blocks: %.1fx, %.2f bits/sample",
+          count, series.bytes(), series.blockCount(), series.compressionRatio(),
+          series.bytes() * 8.0 / count);
+}
+
+void BackendBench::scanCompressed_data()
+{
+    QTest::addColumn<qint64>("windowMs");
+    QTest::addColumn<int>("count");
+    const QList<QPair<const char *, qint64>> windows = {
+        {"hour", qint64(3600) * 1000}, {"day", qint64(24) * 3600 * 1000}, {"all", 0}
+    };
+    for (const auto &w : windows)
+        for (const auto &s : sizes())
+            QTest::addRow("%s:%s", w.first, s.first.constData()) << w.second << s.second;
+}
+
+void BackendBench::scanCompressed()
+{
+    QFETCH(qint64, windowMs);
+    QFETCH(int, count);
+    const QList<QPointF> points = Synthetic::points(HealthMeasurement::HeartRate, count);
+    const CompressedSeries series = CompressedSeries::fromPoints(points);
+
+    // بازه از وسط سری، تا بلوک‌های دو طرف رد شوند
+    const qint64 first = qint64(points.first().x());
+    const qint64 last  = qint64(points.last().x()) + 1;
+    const qint64 span  = windowMs > 0 ? qMin(windowMs, last - first) : last - first;
+    const qint64 from  = first + (last - first - span) / 2;
+    const qint64 to    = from + span;
+
+    QList<QPointF> out;
+    CompressedSeries::ScanStats stats;
+    qint64 iterations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        out.clear();
+        series.scan(from, to, &out, &stats);
+        ++iterations;
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    const auto inRange = std::count_if(points.cbegin(), points.cend(), [&](const QPointF &p) {
+        return p.x() >= from && p.x() < to;
+    });
+    QCOMPARE(out.size(), qsizetype(inRange));
+    qInfo("  %lld samples: %d blocks decoded, %d skipped, %.1f M samples/s",
+          qint64(out.size()), stats.blocksDecoded, stats.blocksSkipped,
+          elapsedNs > 0 ? double(stats.samples) * iterations * 1000.0 / elapsedNs : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    // headless: بدون display هم اجرا می‌شود
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QStandardPaths::setTestModeEnabled(true);
+
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("verya");
+    app.setApplicationName("QMLHealthConnect_bench");
+
+    // لاگ‌های qDebug ی Backend (هر writeBatch، هر export) خروجی را شلوغ می‌کنند
+    if (!qEnvironmentVariableIsSet("QMLHC_BENCH_VERBOSE"))
+        QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false"));
+
+    BackendBench bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "backendbench.moc"
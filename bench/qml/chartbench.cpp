@@ -0,0 +1,218 @@
+#include <QApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickWindow>
+#include <QSaveFile>
+#include <QSGRendererInterface>
+#include <QtQuickTest>
+
+#include <map>
+#include <memory>
+
+#include "menstruationmodel.h"
+#include "stagemetrics.h"
+#include "syntheticdata.h"
+#include "tracer.h"
+
+// ── benchmark ی QML: HealthChartView با داده‌ی مصنوعی ─────────────
+// tst_chartbench.qml چارت را پر می‌کند و pan / zoom / hover را با رویدادهای
+// واقعی ماوس پخش می‌کند. هزینه‌ی هر عمل و زمان هر فریم در یک
+// LatencyHistogram جدا جمع و در پایان در QMLHC_QML_BENCH_OUT نوشته می‌شود.
+//
+//     QMLHC_QML_BENCH_POINTS=100000 QMLHealthConnect_qmlbench
+//
+// پیش‌فرض‌ها: platform = offscreen، scenegraph = software.
+namespace {
+
+int envInt(const char *name, int fallback)
+{
+    bool ok = false;
+    const int v = qEnvironmentVariableIntValue(name, &ok);
+    return ok && v > 0 ? v : fallback;
+}
+
+} // namespace
+
+class BenchProbe : public QObject
+{
+    Q_OBJECT
+    // نقاط ضربان قلب (1 Hz)؛ متریک‌های دیگر با فاصله‌ی خودشان و حداکثر همین تعداد
+    Q_PROPERTY(int points READ points CONSTANT)
+    // تعداد گام‌های هر سناریوی pan / zoom / hover
+    Q_PROPERTY(int steps READ steps CONSTANT)
+    Q_PROPERTY(MenstruationModel *menstruation READ menstruation CONSTANT)
+
+public:
+    explicit BenchProbe(QObject *parent = nullptr)
+        : QObject(parent)
+        , m_points(envInt("QMLHC_QML_BENCH_POINTS", 10000))
+        , m_steps(envInt("QMLHC_QML_BENCH_STEPS", 60))
+        , m_menstruation(new MenstruationModel(this))
+    {
+    }
+
+    int points() const { return m_points; }
+    int steps() const { return m_steps; }
+    MenstruationModel *menstruation() const { return m_menstruation; }
+
+    Q_INVOKABLE QList<QPointF> series(int type, int count) const
+    {
+        return Synthetic::points(type, count);
+    }
+
+    // فشار خون diastolic، هم‌اندیس با series(BloodPressure, count)
+    Q_INVOKABLE QList<QPointF> diastolic(int count) const
+    {
+        QList<QPointF> values2;
+        Synthetic::points(HealthMeasurement::BloodPressure, count, &values2);
+        return values2;
+    }
+
+    // هر ۲۸ روز یک دوره‌ی ۵ روزه با یک flow در روز
+    Q_INVOKABLE void fillMenstruation(int flowCount)
+    {
+        constexpr qint64 DayMs = 24 * 3600 * 1000;
+        QRandomGenerator rng(Synthetic::Seed);
+        QList<MenstruationModel::Period> periods;
+        QList<MenstruationModel::Flow>   flows;
+        for (int p = 0; p * 5 < flowCount; ++p) {
+            const qint64 start = Synthetic::EpochMs + p * 28 * DayMs;
+            periods.append({start, start + 5 * DayMs});
+            for (int d = 0; d < 5 && flows.size() < flowCount; ++d)
+                flows.append({start + d * DayMs, int(rng.bounded(1, 4))});
+        }
+        m_menstruation->setPeriods(std::move(periods), std::move(flows));
+    }
+
+    // عدد اعشاری، چون qint64 در JS دقیق نمی‌ماند
+    Q_INVOKABLE double nowUs() const { return double(Tracer::nowUs()); }
+
+    Q_INVOKABLE void record(const QString &operation, double us)
+    {
+        histogram(operation).record(qint64(us));
+    }
+
+    // فریم‌ها از beforeSynchronizing تا frameSwapped، به نام "frame:<phase>"
+    Q_INVOKABLE void watch(QQuickWindow *window)
+    {
+        if (!window)
+            return;
+        connect(window, &QQuickWindow::beforeSynchronizing, this, [this] {
+            m_frameStartUs.store(Tracer::nowUs(), std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        connect(window, &QQuickWindow::frameSwapped, this, [this] {
+            const qint64 start = m_frameStartUs.exchange(-1, std::memory_order_relaxed);
+            if (start >= 0)
+                histogram("frame:" + phase()).record(Tracer::nowUs() - start);
+        }, Qt::DirectConnection);
+    }
+
+    Q_INVOKABLE void setPhase(const QString &phase)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_phase = phase;
+    }
+
+    // خلاصه روی stdout و JSON در QMLHC_QML_BENCH_OUT (پیش‌فرض qml-bench.json)
+    Q_INVOKABLE bool writeReport()
+    {
+        const QString filePath = qEnvironmentVariableIsSet("QMLHC_QML_BENCH_OUT")
+                                 ? qEnvironmentVariable("QMLHC_QML_BENCH_OUT")
+                                 : QDir::current().filePath("qml-bench.json");
+        QJsonArray operations;
+        QMutexLocker lock(&m_mutex);
+        for (const auto &[name, h] : m_histograms) {
+            const double meanUs = h->count() ? double(h->sumUs()) / h->count() : 0.0;
+            operations.append(QJsonObject{
+                {"name",   name},
+                {"count",  qint64(h->count())},
+                {"meanUs", meanUs},
+                {"p50Us",  qint64(h->percentileUs(0.50))},
+                {"p90Us",  qint64(h->percentileUs(0.90))},
+                {"p99Us",  qint64(h->percentileUs(0.99))},
+                {"maxUs",  qint64(h->maxUs())}
+            });
+            qInfo().noquote() << QString("%1 n=%2 mean=%3ms p50=%4ms p90=%5ms max=%6ms")
+                                     .arg(name, -28).arg(h->count(), 5)
+                                     .arg(meanUs / 1000.0, 0, 'f', 2)
+                                     .arg(h->percentileUs(0.50) / 1000.0, 0, 'f', 2)
+                                     .arg(h->percentileUs(0.90) / 1000.0, 0, 'f', 2)
+                                     .arg(h->maxUs() / 1000.0, 0, 'f', 2);
+        }
+
+        QJsonObject root{
+            {"points",      m_points},
+            {"steps",       m_steps},
+            {"platform",    QGuiApplication::platformName()},
+            {"graphicsApi", QQuickWindow::graphicsApi() == QSGRendererInterface::Software
+                            ? "software" : "rhi"},
+            {"operations",  operations}
+        };
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        qInfo().noquote() << "📈 QML bench report:" << filePath;
+        return file.commit();
+    }
+
+private:
+    LatencyHistogram &histogram(const QString &name)
+    {
+        QMutexLocker lock(&m_mutex);
+        std::unique_ptr<LatencyHistogram> &h = m_histograms[name];
+        if (!h)
+            h = std::make_unique<LatencyHistogram>();
+        return *h;
+    }
+
+    QString phase() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_phase;
+    }
+
+    int                 m_points;
+    int                 m_steps;
+    MenstruationModel  *m_menstruation;
+    mutable QMutex      m_mutex;
+    QString             m_phase = QStringLiteral("idle");
+    std::atomic<qint64> m_frameStartUs { -1 };
+    // مرتب بر اساس نام؛ LatencyHistogram جابه‌جاشدنی نیست
+    std::map<QString, std::unique_ptr<LatencyHistogram>> m_histograms;
+};
+
+class Setup : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void qmlEngineAvailable(QQmlEngine *engine)
+    {
+        engine->rootContext()->setContextProperty("benchProbe", &m_probe);
+    }
+
+private:
+    BenchProbe m_probe;
+};
+
+int main(int argc, char *argv[])
+{
+    // headless و بدون GPU، مگر اینکه از بیرون چیز دیگری خواسته شده باشد
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    if (!qEnvironmentVariableIsSet("QT_QUICK_BACKEND"))
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+
+    // ChartView به QApplication نیاز دارد؛ quick_test_main آن را نمی‌سازد
+    QApplication app(argc, argv);
+    Setup setup;
+    return quick_test_main_with_setup(argc, argv, "chartbench", QUICK_TEST_SOURCE_DIR, &setup);
+}
+
+#include "chartbench.moc"
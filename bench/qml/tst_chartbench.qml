@@ -0,0 +1,214 @@
+import QtQuick
+import QtTest
+import "../.."
+
+// ── سناریوهای benchmark ی چارت ────────────────────────────────
+// هر عمل با benchProbe.record زمان‌گیری می‌شود؛ فریم‌ها با setPhase
+// به نام سناریوی در حال اجرا ثبت می‌شوند. گزارش در cleanupTestCase.
+Item {
+    id: harness
+    width: 1280
+    height: 720
+
+    ThemeManager {
+        id: theme
+    }
+
+    HealthChartView {
+        id: chart
+        anchors.fill: parent
+        themeManager: theme
+        menstruationModel: benchProbe.menstruation
+    }
+
+    ChartInteractionZone {
+        id: zone
+        x: chart.x + chart.plotArea.x
+        y: chart.y + chart.plotArea.y
+        width: chart.plotArea.width
+        height: chart.plotArea.height
+        z: 5
+
+        xAxis: chart.xAxis
+        yAxes: [chart.heightAxis, chart.weightAxis, chart.bpAxis,
+                chart.hrAxis, chart.bgAxis, chart.spo2Axis]
+        chartView: chart
+        tooltipEnabled: true
+        tooltip: tooltip
+    }
+
+    GenericTooltip {
+        id: tooltip
+        z: 10000
+        themeManager: theme
+    }
+
+    SignalSpy {
+        id: timebarPainted
+        target: chart.periodTimebar
+        signalName: "painted"
+    }
+
+    TestCase {
+        id: bench
+        name: "ChartBench"
+        when: windowShown
+
+        readonly property int points: benchProbe.points
+        readonly property int steps: benchProbe.steps
+        readonly property int pageSize: 1000
+
+        // HeartRate 1 Hz با points نقطه؛ بقیه کم‌تراکم‌تر، مثل داده‌ی واقعی
+        property var data: ({})
+
+        function timed(operation, fn) {
+            let start = benchProbe.nowUs()
+            let result = fn()
+            benchProbe.record(operation, benchProbe.nowUs() - start)
+            return result
+        }
+
+        // waitForRendering فقط منتظر frameSwapped بعدی است؛ اگر چیزی عوض نشده
+        // باشد فریمی هم نمی‌آید، پس یک update صریح
+        function settle(phase) {
+            benchProbe.setPhase(phase)
+            harness.Window.window.update()
+            verify(waitForRendering(chart, 5000))
+        }
+
+        // محور X روی بازه‌ی ضربان قلب — pan / zoom / hover روی داده‌ی متراکم
+        function focusHeartRate() {
+            let hr = data.heartRate
+            chart.xAxis.min = new Date(hr[0].x)
+            chart.xAxis.max = new Date(hr[hr.length - 1].x)
+        }
+
+        function initTestCase() {
+            // LineSeries با useOpenGL روی scenegraph نرم‌افزاری رسم نمی‌شود
+            if (GraphicsInfo.api === GraphicsInfo.Software) {
+                for (let s of [chart.heightSeries, chart.weightSeries, chart.bpSystolicSeries,
+                               chart.bpDiastolicSeries, chart.heartRateSeries,
+                               chart.bloodGlucoseSeries, chart.oxygenSaturationSeries])
+                    s.useOpenGL = false
+            }
+            benchProbe.watch(harness.Window.window)
+
+            let sparse = Math.max(10, Math.floor(points / 100))
+            data = {
+                height:       benchProbe.series(1, 10),
+                weight:       benchProbe.series(2, sparse),
+                bpSystolic:   benchProbe.series(3, sparse),
+                bpDiastolic:  benchProbe.diastolic(sparse),
+                heartRate:    benchProbe.series(4, points),
+                bloodGlucose: benchProbe.series(5, sparse),
+                spo2:         benchProbe.series(6, Math.max(10, Math.floor(points / 10)))
+            }
+            benchProbe.fillMenstruation(Math.max(50, Math.floor(points / 50)))
+            settle("idle")
+        }
+
+        function cleanupTestCase() {
+            benchProbe.setPhase("idle")
+            verify(benchProbe.writeReport())
+        }
+
+        // ── onNewDataRead: بازسازی کامل همه‌ی سری‌ها ──
+        function test_1_setAllSeries() {
+            for (let rep = 0; rep < 3; rep++) {
+                benchProbe.setPhase("setAllSeries")
+                timed("setAllSeries", () => chart.setAllSeries(
+                          data.height, data.weight, data.bpSystolic, data.bpDiastolic,
+                          data.heartRate, data.bloodGlucose, data.spo2))
+                timed("render:setAllSeries", () => waitForRendering(chart, 30000))
+            }
+            compare(chart.heartRateSeries.count, points)
+        }
+
+        // ── onSeriesChunkRead: صفحه به صفحه، با یک فریم بین صفحه‌ها ──
+        function test_2_appendChunk() {
+            chart.clearAll()
+            let hr = data.heartRate
+            for (let offset = 0; offset < hr.length; offset += pageSize) {
+                let page = hr.slice(offset, offset + pageSize)
+                timed("appendChunk", () => chart.appendChunk(4, page, []))
+                settle("appendChunk")
+            }
+            compare(chart.heartRateSeries.count, points)
+            chart.setAllSeries(data.height, data.weight, data.bpSystolic, data.bpDiastolic,
+                               data.heartRate, data.bloodGlucose, data.spo2)
+        }
+
+        // ── HealthChartView.findClosestPoint: همه‌ی سری‌ها، خطی ──
+        function test_3_findClosestPoint() {
+            focusHeartRate()
+            let min = chart.xAxis.min.getTime()
+            let span = chart.xAxis.max.getTime() - min
+            let found = 0
+            for (let i = 0; i < steps; i++) {
+                let result = timed("findClosestPoint", () => chart.findClosestPoint(min + span * i / steps))
+                if (result.found)
+                    found++
+            }
+            compare(found, steps)
+        }
+
+        // ── hover: ChartInteractionZone.updateTooltip → findClosestPoint داخلی ──
+        function test_4_hover() {
+            focusHeartRate()
+            settle("hover")
+            for (let i = 0; i < steps; i++) {
+                let x = zone.width * (i + 0.5) / steps
+                timed("hover", () => mouseMove(zone, x, zone.height / 2))
+                settle("hover")
+            }
+            mouseMove(harness, 1, 1)
+        }
+
+        // ── pan: drag افقی، هر گام یک فریم ──
+        function test_5_pan() {
+            focusHeartRate()
+            let y = zone.height / 2
+            let x = zone.width * 0.75
+            mousePress(zone, x, y)
+            // اولین حرکت از dragThreshold رد می‌شود
+            mouseMove(zone, x - zone.dragThreshold - 1, y, -1, Qt.LeftButton)
+            x -= zone.dragThreshold + 1
+            for (let i = 0; i < steps; i++) {
+                x -= 4
+                timed("pan", () => mouseMove(zone, x, y, -1, Qt.LeftButton))
+                settle("pan")
+            }
+            mouseRelease(zone, x, y)
+        }
+
+        // ── zoom: چرخ ماوس، نیمی بزرگنمایی و نیمی کوچک‌نمایی ──
+        function test_6_zoom() {
+            focusHeartRate()
+            for (let i = 0; i < steps; i++) {
+                let delta = i < steps / 2 ? 120 : -120
+                timed("zoom", () => mouseWheel(zone, zone.width / 2, zone.height / 2, 0, delta))
+                settle("zoom")
+            }
+            verify(chart.xAxis.max.getTime() > chart.xAxis.min.getTime())
+        }
+
+        // ── PeriodTimebar.onPaint: از requestPaint تا painted ──
+        function test_7_periodTimebarPaint() {
+            let model = benchProbe.menstruation
+            verify(model.count > 0)
+            let first = model.data(model.index(0, 0), Qt.UserRole + 1)
+            let dayMs = 24 * 3600 * 1000
+            chart.xAxis.min = new Date(first)
+            chart.xAxis.max = new Date(first + 365 * dayMs)
+            settle("periodTimebar")
+
+            for (let i = 0; i < steps; i++) {
+                timebarPainted.clear()
+                let start = benchProbe.nowUs()
+                chart.periodTimebar.requestPaint()
+                timebarPainted.wait(5000)
+                benchProbe.record("periodTimebar.paint", benchProbe.nowUs() - start)
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "syntheticdata.h"
+
+#include <QTimeZone>
+
+#include <cmath>
+
+namespace Synthetic {
+
+HealthMeasurement sample(int type, qint64 ms, QRandomGenerator &rng)
+{
+    HealthMeasurement m {};
+    m.type = HealthMeasurement::Type(type);
+    m.time = QDateTime::fromMSecsSinceEpoch(ms, QTimeZone::UTC);
+    const double dayPhase = double(ms % (24 * 3600 * 1000)) / (24 * 3600 * 1000) * 2 * M_PI;
+    const double noise    = rng.generateDouble() - 0.5;
+
+    switch (type) {
+    case HealthMeasurement::Height:
+        m.value = 1.75 + noise * 0.01;
+        break;
+    case HealthMeasurement::Weight:
+        m.value = 72.0 + noise * 2.0;
+        break;
+    case HealthMeasurement::BloodPressure:
+        m.value  = qRound(120 + 8 * std::sin(dayPhase) + noise * 12);
+        m.value2 = qRound(78 + 5 * std::sin(dayPhase) + noise * 8);
+        break;
+    case HealthMeasurement::HeartRate:
+        // ریتم شبانه‌روزی + نویز؛ اعداد صحیح مثل خروجی ساعت‌ها
+        m.value = qRound(68 + 12 * std::sin(dayPhase) + noise * 10);
+        break;
+    case HealthMeasurement::BloodGlucose:
+        m.value          = qRound(105 + 25 * std::sin(dayPhase * 3) + noise * 20);
+        m.specimenSource = int(rng.bounded(1, 7));
+        m.mealType       = int(rng.bounded(0, 5));
+        m.relationToMeal = int(rng.bounded(0, 5));
+        break;
+    case HealthMeasurement::OxygenSaturation:
+        m.value = qRound(97 + noise * 3);
+        break;
+    }
+    return m;
+}
+
+QList<HealthMeasurement> measurements(int type, int count, qint64 stepMs, quint32 seed)
+{
+    QRandomGenerator rng(seed + quint32(type));
+    QList<HealthMeasurement> list;
+    list.reserve(count);
+    for (int i = 0; i < count; ++i)
+        list.append(sample(type, EpochMs + i * stepMs, rng));
+    return list;
+}
+
+qint64 stepFor(int type)
+{
+    switch (type) {
+    case HealthMeasurement::HeartRate:        return 1000;
+    case HealthMeasurement::OxygenSaturation: return 60 * 1000;
+    case HealthMeasurement::BloodGlucose:     return 4 * 3600 * 1000;
+    }
+    return 24 * 3600 * 1000;
+}
+
+const QList<int> &allTypes()
+{
+    static const QList<int> types = {
+        HealthMeasurement::Height, HealthMeasurement::Weight, HealthMeasurement::BloodPressure,
+        HealthMeasurement::HeartRate, HealthMeasurement::BloodGlucose,
+        HealthMeasurement::OxygenSaturation
+    };
+    return types;
+}
+
+QList<QPointF> points(int type, int count, QList<QPointF> *values2)
+{
+    QList<QPointF> out;
+    out.reserve(count);
+    if (values2)
+        values2->reserve(count);
+    for (const HealthMeasurement &m : measurements(type, count, stepFor(type))) {
+        const double ms = double(m.time.toMSecsSinceEpoch());
+        out.append(QPointF(ms, m.value));
+        if (values2)
+            values2->append(QPointF(ms, m.value2));
+    }
+    return out;
+}
+
+} // namespace Synthetic
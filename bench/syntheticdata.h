@@ -0,0 +1,30 @@
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QList>
+#include <QPointF>
+#include <QRandomGenerator>
+
+#include "healthmeasurement.h"
+
+// ── داده‌ی مصنوعی قطعی برای benchmark ها ──────────────────────
+// با seed ثابت ساخته می‌شود، پس دو اجرا دقیقاً یک ورودی دارند.
+// مقدارها در بازه‌ی write* هر متریک‌اند تا validate رد نکند.
+namespace Synthetic {
+
+constexpr qint64  EpochMs = 1704067200000;   // 2024-01-01T00:00:00Z
+constexpr quint32 Seed    = 20240101;
+
+HealthMeasurement sample(int type, qint64 ms, QRandomGenerator &rng);
+QList<HealthMeasurement> measurements(int type, int count, qint64 stepMs, quint32 seed = Seed);
+
+// فاصله‌ی نمونه‌ها: ضربان قلب 1 Hz، بقیه مثل اندازه‌گیری دستی یا دوره‌ای
+qint64 stepFor(int type);
+const QList<int> &allTypes();
+
+// همان شکل سری‌های Backend: x = زمان ms، y = value (و value2 برای فشار خون)
+QList<QPointF> points(int type, int count, QList<QPointF> *values2 = nullptr);
+
+} // namespace Synthetic
+
+#endif // SYNTHETICDATA_H
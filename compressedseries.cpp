@@ -0,0 +1,340 @@
+#include "compressedseries.h"
+
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// بیت‌ها از پرارزش به کم‌ارزش، پشت سر هم
+struct BitWriter {
+    QByteArray &data;
+    qint64     &bitCount;
+
+    void write(quint64 value, int n)
+    {
+        while (n > 0) {
+            const int used = int(bitCount & 7);
+            if (used == 0)
+                data.append('\0');
+            const int take = qMin(8 - used, n);
+            const quint8 chunk = quint8((value >> (n - take)) & ((1u << take) - 1));
+            data.data()[data.size() - 1] |= char(chunk << (8 - used - take));
+            n        -= take;
+            bitCount += take;
+        }
+    }
+
+    // '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+64 — delta-of-delta و تفاضل FixedPoint
+    void writeSigned(qint64 v)
+    {
+        if (v == 0) {
+            write(0, 1);
+        } else if (v >= -63 && v <= 64) {
+            write(0b10, 2);
+            write(quint64(v + 63), 7);
+        } else if (v >= -255 && v <= 256) {
+            write(0b110, 3);
+            write(quint64(v + 255), 9);
+        } else if (v >= -2047 && v <= 2048) {
+            write(0b1110, 4);
+            write(quint64(v + 2047), 12);
+        } else {
+            write(0b1111, 4);
+            write(quint64(v), 64);
+        }
+    }
+};
+
+struct BitReader {
+    const char *data;
+    qint64      pos = 0;
+
+    quint64 read(int n)
+    {
+        quint64 value = 0;
+        while (n > 0) {
+            const int used = int(pos & 7);
+            const int take = qMin(8 - used, n);
+            const quint8 byte = quint8(data[pos >> 3]);
+            value = (value << take) | ((byte >> (8 - used - take)) & ((1u << take) - 1));
+            n   -= take;
+            pos += take;
+        }
+        return value;
+    }
+
+    qint64 readSigned()
+    {
+        if (!read(1))
+            return 0;
+        if (!read(1))
+            return qint64(read(7)) - 63;
+        if (!read(1))
+            return qint64(read(9)) - 255;
+        if (!read(1))
+            return qint64(read(12)) - 2047;
+        return qint64(read(64));
+    }
+};
+
+} // namespace
+
+CompressedSeries::CompressedSeries(Encoding encoding, int decimals)
+    : m_encoding(encoding)
+    , m_decimals(qBound(0, decimals, 9))
+    , m_scale(std::pow(10.0, m_decimals))
+{
+}
+
+CompressedSeries CompressedSeries::fromPoints(const QList<QPointF> &points, int decimals)
+{
+    // FixedPoint فقط وقتی که بدون اتلاف باشد (و در دقت 53 بیتی double بماند)
+    CompressedSeries probe(FixedPoint, decimals);
+    const bool exact = std::all_of(points.cbegin(), points.cend(), [&probe](const QPointF &p) {
+        return std::abs(p.y() * probe.m_scale) < 9.0e15
+               && probe.fromFixed(probe.toFixed(p.y())) == p.y();
+    });
+
+    CompressedSeries series(exact ? FixedPoint : Xor, decimals);
+    for (const QPointF &p : points)
+        series.append(qint64(p.x()), p.y());
+    return series;
+}
+
+qint64 CompressedSeries::toFixed(double value) const
+{
+    return qRound64(value * m_scale);
+}
+
+double CompressedSeries::fromFixed(qint64 fixed) const
+{
+    // تقسیم بر 10^n (نه ضرب در 10^-n) همان double ی اعشاری اصلی را می‌دهد
+    return double(fixed) / m_scale;
+}
+
+bool CompressedSeries::append(qint64 ms, double value)
+{
+    if (!m_blocks.isEmpty() && ms < m_blocks.last().lastMs)
+        return false;
+    if (m_encoding == FixedPoint)
+        value = fromFixed(toFixed(value));
+
+    // ── بلوک جدید: اولین نمونه فقط در header ──
+    if (m_blocks.isEmpty() || m_blocks.last().count >= BlockSize) {
+        if (!m_blocks.isEmpty())
+            m_blocks.last().bits.squeeze();
+        Block block;
+        block.firstMs    = ms;
+        block.lastMs     = ms;
+        block.firstValue = value;
+        block.min        = value;
+        block.max        = value;
+        block.count      = 1;
+        m_blocks.append(block);
+
+        m_tail = Tail();
+        m_tail.prevMs    = ms;
+        m_tail.prevBits  = doubleBits(value);
+        m_tail.prevFixed = toFixed(value);
+        ++m_size;
+        return true;
+    }
+
+    Block &block = m_blocks.last();
+    BitWriter out{block.bits, block.bitCount};
+
+    const qint64 delta = ms - m_tail.prevMs;
+    out.writeSigned(delta - m_tail.prevDelta);
+    m_tail.prevDelta = delta;
+    m_tail.prevMs    = ms;
+
+    if (m_encoding == Xor) {
+        const quint64 bits = doubleBits(value);
+        const quint64 x    = bits ^ m_tail.prevBits;
+        if (x == 0) {
+            out.write(0, 1);
+        } else {
+            const int leading  = qMin(int(qCountLeadingZeroBits(x)), 31);
+            const int trailing = int(qCountTrailingZeroBits(x));
+            if (m_tail.prevLeading >= 0 && leading >= m_tail.prevLeading
+                && trailing >= m_tail.prevTrailing) {
+                // در پنجره‌ی بیت‌های معنادار قبلی جا می‌شود
+                out.write(0b10, 2);
+                out.write(x >> m_tail.prevTrailing, 64 - m_tail.prevLeading - m_tail.prevTrailing);
+            } else {
+                const int meaningful = 64 - leading - trailing;
+                out.write(0b11, 2);
+                out.write(quint64(leading), 5);
+                out.write(quint64(meaningful - 1), 6);
+                out.write(x >> trailing, meaningful);
+                m_tail.prevLeading  = leading;
+                m_tail.prevTrailing = trailing;
+            }
+        }
+        m_tail.prevBits = bits;
+    } else {
+        const qint64 fixed = toFixed(value);
+        out.writeSigned(fixed - m_tail.prevFixed);
+        m_tail.prevFixed = fixed;
+    }
+
+    block.lastMs = ms;
+    block.min    = qMin(block.min, value);
+    block.max    = qMax(block.max, value);
+    ++block.count;
+    ++m_size;
+    return true;
+}
+
+template <typename Visit>
+void CompressedSeries::decode(const Block &block, Visit visit) const
+{
+    BitReader in{block.bits.constData()};
+    qint64  ms       = block.firstMs;
+    qint64  delta    = 0;
+    double  value    = block.firstValue;
+    quint64 bits     = doubleBits(value);
+    int     leading  = 0;
+    int     trailing = 0;
+    qint64  fixed    = toFixed(value);
+    if (!visit(ms, value))
+        return;
+
+    for (int i = 1; i < block.count; ++i) {
+        delta += in.readSigned();
+        ms    += delta;
+        if (m_encoding == Xor) {
+            if (in.read(1)) {
+                if (in.read(1)) {
+                    leading = int(in.read(5));
+                    const int meaningful = int(in.read(6)) + 1;
+                    trailing = 64 - leading - meaningful;
+                }
+                bits ^= in.read(64 - leading - trailing) << trailing;
+                value = bitsDouble(bits);
+            }
+        } else {
+            fixed += in.readSigned();
+            value = fromFixed(fixed);
+        }
+        if (!visit(ms, value))
+            return;
+    }
+}
+
+qsizetype CompressedSeries::firstBlockFrom(qint64 ms) const
+{
+    return std::lower_bound(m_blocks.cbegin(), m_blocks.cend(), ms,
+                            [](const Block &b, qint64 t) { return b.lastMs < t; })
+           - m_blocks.cbegin();
+}
+
+qint64 CompressedSeries::bytes() const
+{
+    qint64 total = 0;
+    for (const Block &b : m_blocks)
+        total += b.bits.size() + qint64(sizeof(Block));
+    return total;
+}
+
+double CompressedSeries::compressionRatio() const
+{
+    const qint64 encoded = bytes();
+    return encoded > 0 ? double(m_size) * sizeof(QPointF) / encoded : 0.0;
+}
+
+qsizetype CompressedSeries::scan(qint64 fromMs, qint64 toMs, QList<QPointF> *out,
+                                 ScanStats *stats) const
+{
+    const qsizetype before = out->size();
+    ScanStats s;
+    for (qsizetype i = firstBlockFrom(fromMs); i < m_blocks.size() && m_blocks.at(i).firstMs < toMs; ++i) {
+        const Block &block = m_blocks.at(i);
+        ++s.blocksDecoded;
+        if (block.firstMs >= fromMs && block.lastMs < toMs)
+            out->reserve(out->size() + block.count);
+        decode(block, [&](qint64 ms, double value) {
+            if (ms >= toMs)
+                return false;
+            ++s.samples;
+            if (ms >= fromMs)
+                out->append(QPointF(double(ms), value));
+            return true;
+        });
+    }
+    s.blocksSkipped = blockCount() - s.blocksDecoded;
+    if (stats)
+        *stats = s;
+    return out->size() - before;
+}
+
+QList<QPointF> CompressedSeries::points() const
+{
+    QList<QPointF> out;
+    out.reserve(m_size);
+    if (!isEmpty())
+        scan(firstMs(), lastMs() + 1, &out);
+    return out;
+}
+
+bool CompressedSeries::range(qint64 fromMs, qint64 toMs, double *min, double *max,
+                             ScanStats *stats) const
+{
+    ScanStats s;
+    bool found = false;
+    double lo = 0, hi = 0;
+    auto take = [&](double a, double b) {
+        lo = found ? qMin(lo, a) : a;
+        hi = found ? qMax(hi, b) : b;
+        found = true;
+    };
+
+    for (qsizetype i = firstBlockFrom(fromMs); i < m_blocks.size() && m_blocks.at(i).firstMs < toMs; ++i) {
+        const Block &block = m_blocks.at(i);
+        // بلوک کامل در بازه: همان header
+        if (block.firstMs >= fromMs && block.lastMs < toMs) {
+            take(block.min, block.max);
+            continue;
+        }
+        ++s.blocksDecoded;
+        decode(block, [&](qint64 ms, double value) {
+            if (ms >= toMs)
+                return false;
+            ++s.samples;
+            if (ms >= fromMs)
+                take(value, value);
+            return true;
+        });
+    }
+    s.blocksSkipped = blockCount() - s.blocksDecoded;
+    if (stats)
+        *stats = s;
+    if (found) {
+        *min = lo;
+        *max = hi;
+    }
+    return found;
+}
+
+void CompressedSeries::clear()
+{
+    m_blocks.clear();
+    m_tail = Tail();
+    m_size = 0;
+}
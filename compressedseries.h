@@ -0,0 +1,107 @@
+#ifndef COMPRESSEDSERIES_H
+#define COMPRESSEDSERIES_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPointF>
+
+// ── سری فشرده به سبک Gorilla برای تاریخچه‌های طولانی ─────────
+// نمونه‌ها (زمان ms، مقدار) در بلوک‌های BlockSize تایی نگه داشته می‌شوند.
+// هر بلوک یک header دارد (اولین/آخرین زمان، min/max، تعداد، اولین مقدار)
+// و یک bitstream:
+//   زمان:   delta-of-delta —  '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+64 بیت
+//   مقدار:  Xor       — XOR بیت‌های double با مقدار قبلی:
+//                       '0' برابر | '10' + بیت‌های معنادار در همان پنجره |
+//                       '11' + 5 بیت صفرهای ابتدا + 6 بیت طول + بیت‌ها
+//           FixedPoint — round(value × 10^decimals)، تفاضل با قبلی در همان
+//                       bucket های delta-of-delta
+// در 1 Hz ضربان قلب هر نمونه معمولاً ۱ بیت زمان و چند بیت مقدار است،
+// به‌جای ۱۶ بایت QPointF. scan فقط بلوک‌هایی را باز می‌کند که با بازه
+// هم‌پوشانی دارند؛ بلوک‌هایی که کامل در بازه‌اند برای min/max باز نمی‌شوند.
+// نمونه‌ها باید به ترتیب زمان append شوند.
+class CompressedSeries
+{
+public:
+    enum Encoding {
+        Xor        = 0,   // بدون اتلاف برای هر double
+        FixedPoint = 1    // بدون اتلاف فقط برای مقدارهای با حداکثر decimals رقم اعشار
+    };
+
+    static constexpr int BlockSize = 1024;
+
+    struct ScanStats {
+        int    blocksDecoded = 0;
+        int    blocksSkipped = 0;
+        qint64 samples       = 0;   // نمونه‌های باز شده، نه فقط آن‌هایی که در بازه بودند
+    };
+
+    explicit CompressedSeries(Encoding encoding = Xor, int decimals = 0);
+
+    // FixedPoint اگر همه‌ی مقدارها با decimals رقم دقیقاً برگردند، وگرنه Xor
+    static CompressedSeries fromPoints(const QList<QPointF> &points, int decimals = 0);
+
+    Encoding encoding() const { return m_encoding; }
+    int decimals() const { return m_decimals; }
+
+    // false اگر ms از آخرین نمونه کوچک‌تر باشد
+    bool append(qint64 ms, double value);
+
+    bool isEmpty() const { return m_blocks.isEmpty(); }
+    qint64 size() const { return m_size; }
+    int blockCount() const { return int(m_blocks.size()); }
+    qint64 firstMs() const { return isEmpty() ? 0 : m_blocks.first().firstMs; }
+    qint64 lastMs() const { return isEmpty() ? 0 : m_blocks.last().lastMs; }
+
+    // bitstream ها + header ها
+    qint64 bytes() const;
+    // size × sizeof(QPointF) / bytes
+    double compressionRatio() const;
+
+    // نقاط [fromMs, toMs) به out اضافه می‌شوند؛ خروجی: تعداد اضافه‌شده
+    qsizetype scan(qint64 fromMs, qint64 toMs, QList<QPointF> *out,
+                   ScanStats *stats = nullptr) const;
+    QList<QPointF> points() const;
+    // min/max مقدارهای [fromMs, toMs)؛ false اگر نمونه‌ای نباشد
+    bool range(qint64 fromMs, qint64 toMs, double *min, double *max,
+               ScanStats *stats = nullptr) const;
+
+    void clear();
+
+private:
+    struct Block {
+        qint64     firstMs    = 0;
+        qint64     lastMs     = 0;
+        double     firstValue = 0;
+        double     min        = 0;
+        double     max        = 0;
+        int        count      = 0;
+        qint64     bitCount   = 0;
+        QByteArray bits;
+    };
+
+    // وضعیت encoder برای بلوک آخر
+    struct Tail {
+        qint64  prevMs       = 0;
+        qint64  prevDelta    = 0;
+        quint64 prevBits     = 0;    // Xor
+        int     prevLeading  = -1;   // -1: هنوز پنجره‌ای نیست
+        int     prevTrailing = 0;
+        qint64  prevFixed    = 0;    // FixedPoint
+    };
+
+    template <typename Visit>
+    void decode(const Block &block, Visit visit) const;
+    // اولین بلوکی که lastMs >= ms
+    qsizetype firstBlockFrom(qint64 ms) const;
+    qint64 toFixed(double value) const;
+    double fromFixed(qint64 fixed) const;
+
+    Encoding     m_encoding;
+    int          m_decimals;
+    double       m_scale;
+    QList<Block> m_blocks;
+    Tail         m_tail;
+    qint64       m_size = 0;
+};
+
+#endif // COMPRESSEDSERIES_H
@@ -0,0 +1,354 @@
+#include "desktophealthbridge.h"
+#include "recordinghealthbridge.h"
+#include "tracer.h"
+
+#include <QDateTime>
+#include <QDebug>
+
+#include <cmath>
+
+namespace {
+
+constexpr qint64 MinuteMs = 60 * 1000;
+constexpr qint64 HourMs   = 60 * MinuteMs;
+constexpr qint64 DayMs    = 24 * HourMs;
+
+// مقادیر mealLabels / relationLabels
+constexpr int BeforeMeal = 1;
+constexpr int AfterMeal  = 2;
+constexpr int Fasting    = 3;
+
+constexpr int CapillaryBlood = 2;
+
+} // namespace
+
+DesktopHealthBridge::Profile DesktopHealthBridge::Profile::fromEnvironment()
+{
+    Profile p;
+    bool ok = false;
+    const int seed = qEnvironmentVariableIntValue("QMLHC_DESKTOP_SEED", &ok);
+    if (ok)
+        p.seed = quint32(seed);
+
+    int days = qEnvironmentVariableIntValue("QMLHC_DESKTOP_DAYS", &ok);
+    if (!ok)
+        days = 730;
+    p.toMs   = QDateTime::currentMSecsSinceEpoch();
+    p.fromMs = p.toMs - qint64(qMax(days, 0)) * DayMs;
+
+    const int step = qEnvironmentVariableIntValue("QMLHC_DESKTOP_HR_STEP_MS", &ok);
+    if (ok && step > 0)
+        p.heartRateStepMs = step;
+
+    p.replayDir = qEnvironmentVariable("QMLHC_REPLAY_DIR");
+    return p;
+}
+
+DesktopHealthBridge::DesktopHealthBridge(const Profile &profile)
+    : m_profile(profile)
+{
+    // ── برنامه‌ی اندازه‌گیری هر متریک ──
+    m_schedules[HealthMeasurement::Height]           = { 30 * DayMs, { 7 * HourMs }, HourMs, 0.0 };
+    m_schedules[HealthMeasurement::Weight]           = { DayMs, { 7 * HourMs }, 40 * MinuteMs, 0.15 };
+    m_schedules[HealthMeasurement::BloodPressure]    = { DayMs, { 8 * HourMs, 20 * HourMs },
+                                                         30 * MinuteMs, 0.2 };
+    m_schedules[HealthMeasurement::HeartRate]        = { qMax<qint64>(1, profile.heartRateStepMs),
+                                                         { 0 }, 0, 0.0 };
+    // ناشتا، بعد از صبحانه، قبل از ناهار، بعد از شام
+    m_schedules[HealthMeasurement::BloodGlucose]     = { DayMs, { 7 * HourMs, 9 * HourMs + 30 * MinuteMs,
+                                                                  12 * HourMs + 30 * MinuteMs,
+                                                                  20 * HourMs + 30 * MinuteMs },
+                                                         20 * MinuteMs, 0.1 };
+    m_schedules[HealthMeasurement::OxygenSaturation] = { 15 * MinuteMs, { 0 }, MinuteMs, 0.05 };
+
+    if (m_profile.toMs > m_profile.fromMs)
+        generateMenstruation();
+
+    if (!m_profile.replayDir.isEmpty()) {
+        TraceSpan span("desktop", "replay");
+        QString error;
+        if (!RecordingHealthBridge::replay(m_profile.replayDir, this, &m_replayedPermissions, &error))
+            qWarning() << "❌ Replay failed:" << m_profile.replayDir << error;
+    }
+
+    qDebug() << "🖥️ Desktop health data:"
+             << (m_profile.toMs - m_profile.fromMs) / DayMs << "days, seed" << m_profile.seed
+             << "— HR every" << m_profile.heartRateStepMs << "ms"
+             << (m_profile.replayDir.isEmpty() ? QString() : "+ replay " + m_profile.replayDir);
+}
+
+QString DesktopHealthBridge::checkPermissions()
+{
+    const QString granted = FakeHealthBridge::checkPermissions();
+    return m_replayedPermissions.isEmpty() || isDenied() ? granted : m_replayedPermissions;
+}
+
+// ── stream / aggregate: داده‌ی تولیدی + رکوردهای ذخیره‌شده، صعودی ──
+HealthBridge::StreamResult DesktopHealthBridge::scan(int type, qint64 from, qint64 to,
+                                                     const PageCallback &onPage)
+{
+    const Schedule *s = schedule(type);
+    if (!s)
+        return FakeHealthBridge::scan(type, from, to, onPage);
+
+    const qint64 lo = qMax(from, m_profile.fromMs);
+    const qint64 hi = qMin(to, m_profile.toMs);
+    qint64 slot = lo > 0 ? lo / s->periodMs * s->offsets.size() : 0;
+    Sample generated;
+    bool haveGenerated = lo < hi && nextSample(*s, type, slot, lo, hi, &generated);
+
+    Columns stored, page;
+    qsizetype storedIndex = 0;
+    qint64 storedCursor   = from;
+    bool storedDone       = false;
+
+    StreamResult result;
+    for (;;) {
+        page.clear();
+        while (page.size() < PageSize) {
+            if (storedIndex == stored.size() && !storedDone) {
+                stored.clear();
+                storedIndex = 0;
+                collect(type, storedCursor, to, PageSize, false, stored);
+                storedDone = stored.size() < PageSize;
+                if (stored.size() > 0)
+                    storedCursor = stored.times.last() + 1;
+            }
+            const bool haveStored = storedIndex < stored.size();
+            if (!haveStored && !haveGenerated)
+                break;
+
+            if (haveStored && (!haveGenerated || stored.times.at(storedIndex) <= generated.ms)) {
+                // رکورد نوشته‌شده جای نمونه‌ی تولیدی هم‌زمان را می‌گیرد
+                if (haveGenerated && stored.times.at(storedIndex) == generated.ms)
+                    haveGenerated = nextSample(*s, type, slot, lo, hi, &generated);
+                page.append(stored.times.at(storedIndex), stored.values.at(storedIndex),
+                            stored.values2.at(storedIndex), stored.extras.at(storedIndex));
+                ++storedIndex;
+            } else {
+                page.append(generated.ms, generated.value, generated.value2, generated.extras);
+                haveGenerated = nextSample(*s, type, slot, lo, hi, &generated);
+            }
+        }
+        if (page.size() == 0)
+            break;
+
+        ++result.pages;
+        result.records += page.size();
+        if (!onPage(page.page(type))) {
+            result.status = StreamCancelled;
+            return result;
+        }
+        if (page.size() < PageSize)
+            break;
+    }
+
+    result.status = StreamComplete;
+    return result;
+}
+
+// ── latest: نزولی، از انتهای بازه‌ی تولیدی و رکوردهای ذخیره‌شده ──
+void DesktopHealthBridge::collectLatest(int type, int count, Columns &out) const
+{
+    const Schedule *s = schedule(type);
+    if (!s) {
+        FakeHealthBridge::collectLatest(type, count, out);
+        return;
+    }
+
+    Columns stored;
+    FakeHealthBridge::collectLatest(type, count, stored);
+    qsizetype storedIndex = 0;
+
+    const qint64 lo = m_profile.fromMs;
+    const qint64 hi = m_profile.toMs;
+    qint64 slot = (hi - 1) / s->periodMs * s->offsets.size() + s->offsets.size() - 1;
+    Sample generated;
+    bool haveGenerated = previousSample(*s, type, slot, lo, hi, &generated);
+
+    while (out.size() < count) {
+        const bool haveStored = storedIndex < stored.size();
+        if (!haveStored && !haveGenerated)
+            break;
+        if (haveStored && (!haveGenerated || stored.times.at(storedIndex) >= generated.ms)) {
+            if (haveGenerated && stored.times.at(storedIndex) == generated.ms)
+                haveGenerated = previousSample(*s, type, slot, lo, hi, &generated);
+            out.append(stored.times.at(storedIndex), stored.values.at(storedIndex),
+                       stored.values2.at(storedIndex), stored.extras.at(storedIndex));
+            ++storedIndex;
+        } else {
+            out.append(generated.ms, generated.value, generated.value2, generated.extras);
+            haveGenerated = previousSample(*s, type, slot, lo, hi, &generated);
+        }
+    }
+}
+
+const DesktopHealthBridge::Schedule *DesktopHealthBridge::schedule(int type) const
+{
+    if (type < HealthMeasurement::Height || type > HealthMeasurement::OxygenSaturation)
+        return nullptr;
+    const Schedule &s = m_schedules[type];
+    if (s.periodMs <= 0 || s.offsets.isEmpty() || m_profile.toMs <= m_profile.fromMs)
+        return nullptr;
+    return &s;
+}
+
+qint64 DesktopHealthBridge::slotTime(const Schedule &s, int type, qint64 slot) const
+{
+    const qsizetype perPeriod = s.offsets.size();
+    const qint64 jitter = s.jitterMs > 0 ? qint64(hash(type, slot, 1) % quint64(s.jitterMs)) : 0;
+    return slot / perPeriod * s.periodMs + s.offsets.at(slot % perPeriod) + jitter;
+}
+
+bool DesktopHealthBridge::nextSample(const Schedule &s, int type, qint64 &slot, qint64 lo,
+                                     qint64 hi, Sample *out) const
+{
+    for (;; ++slot) {
+        const qint64 ms = slotTime(s, type, slot);
+        if (ms >= hi)
+            return false;
+        if (ms >= lo && sampleAt(s, type, slot, ms, out)) {
+            ++slot;
+            return true;
+        }
+    }
+}
+
+bool DesktopHealthBridge::previousSample(const Schedule &s, int type, qint64 &slot, qint64 lo,
+                                         qint64 hi, Sample *out) const
+{
+    for (; slot >= 0; --slot) {
+        const qint64 ms = slotTime(s, type, slot);
+        if (ms < lo)
+            return false;
+        if (ms < hi && sampleAt(s, type, slot, ms, out)) {
+            --slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ── یک نمونه: ریتم شبانه‌روزی + روند چندروزه + نویز ──
+bool DesktopHealthBridge::sampleAt(const Schedule &s, int type, qint64 slot, qint64 ms,
+                                   Sample *out) const
+{
+    if (s.skip > 0 && unit(type, slot, 2) < s.skip)
+        return false;
+
+    const double hour   = double(ms % DayMs) / HourMs;
+    const double day    = double(ms) / DayMs;
+    const double noise  = unit(type, slot, 3) - 0.5;
+    const bool   asleep = hour < 6.5 || hour >= 23.0;
+
+    out->ms     = ms;
+    out->value2 = 0;
+    out->extras = CapillaryBlood;   // پیش‌فرض HealthMeasurement
+
+    switch (type) {
+    case HealthMeasurement::Height:
+        out->value = qRound((1.76 + noise * 0.01) * 100) / 100.0;
+        break;
+    case HealthMeasurement::Weight: {
+        const double v = 74.0 + 2.5 * std::sin(2 * M_PI * day / 365.25)
+                       + 2.0 * (smoothNoise(type, day / 45, 4) - 0.5) + noise * 0.6;
+        out->value = qRound(v * 10) / 10.0;
+        break;
+    }
+    case HealthMeasurement::BloodPressure: {
+        const double morning   = slot % s.offsets.size() == 0 ? 7.0 : 0.0;
+        const double systolic  = 117 + morning + 8 * (smoothNoise(type, day / 20, 4) - 0.5) + noise * 12;
+        const double diastolic = 0.6 * systolic + 5 + (unit(type, slot, 5) - 0.5) * 6;
+        out->value  = qRound(systolic);
+        out->value2 = qRound(diastolic);
+        break;
+    }
+    case HealthMeasurement::HeartRate: {
+        // ساعت هر شب کمی روی شارژر است
+        if (hour >= 19.0 && hour < 19.75)
+            return false;
+        double v = (asleep ? 56 : 72)
+                 + 6 * (smoothNoise(type, day / 30, 4) - 0.5)
+                 + 8 * (smoothNoise(type, double(ms) / MinuteMs, 5) - 0.5)
+                 + noise * 4;
+        // دوره‌های ورزش: چند ده دقیقه، چند بار در هفته
+        if (!asleep) {
+            const double activity = smoothNoise(type, double(ms) / (10 * MinuteMs), 6);
+            if (activity > 0.8)
+                v += (activity - 0.8) / 0.2 * 85;
+        }
+        out->value = qRound(qBound(40.0, v, 200.0));
+        break;
+    }
+    case HealthMeasurement::BloodGlucose: {
+        struct Context { double mean; double spread; int relation; };
+        static const Context contexts[] = {
+            { 92,  8,  Fasting    },
+            { 145, 25, AfterMeal  },
+            { 100, 10, BeforeMeal },
+            { 150, 30, AfterMeal  }
+        };
+        const Context &c = contexts[slot % s.offsets.size()];
+        const double v = c.mean + 10 * (smoothNoise(type, day / 30, 4) - 0.5) + noise * 2 * c.spread;
+        out->value  = qRound(qBound(40.0, v, 400.0));
+        out->extras = CapillaryBlood | (c.relation << 8) | (c.relation << 16);
+        break;
+    }
+    case HealthMeasurement::OxygenSaturation: {
+        double v = (asleep ? 95.0 : 97.0) + unit(type, slot, 5) * 3;
+        if (asleep && unit(type, slot, 6) < 0.02)
+            v -= 4;   // افت کوتاه شبانه
+        out->value = qRound(qMin(v, 100.0));
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+// splitmix64 روی (seed، نوع، اندیس، salt)
+quint64 DesktopHealthBridge::hash(int type, qint64 index, quint64 salt) const
+{
+    quint64 z = (quint64(m_profile.seed) << 32) ^ (quint64(type) << 24) ^ salt;
+    z += quint64(index) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+double DesktopHealthBridge::unit(int type, qint64 index, quint64 salt) const
+{
+    return double(hash(type, index, salt) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double DesktopHealthBridge::smoothNoise(int type, double x, quint64 salt) const
+{
+    const double cell = std::floor(x);
+    const double f    = x - cell;
+    const double u    = f * f * (3 - 2 * f);
+    const double a    = unit(type, qint64(cell), salt);
+    const double b    = unit(type, qint64(cell) + 1, salt);
+    return a + (b - a) * u;
+}
+
+// ── دوره‌ها: چرخه‌ی ۲۶ تا ۳۱ روزه، ۴ تا ۶ روز، یک flow در روز ──
+void DesktopHealthBridge::generateMenstruation()
+{
+    constexpr int Key = 0;   // جدا از نوع‌های HealthMeasurement
+    qint64 start = m_profile.fromMs / DayMs * DayMs + qint64(unit(Key, 0, 8) * 20) * DayMs;
+    for (qint64 cycle = 1; ; ++cycle) {
+        const int days = 4 + int(hash(Key, cycle, 9) % 3);
+        const qint64 endMs = start + (days - 1) * DayMs + 20 * HourMs;
+        if (endMs >= m_profile.toMs)
+            break;
+
+        insertPeriod(start + 8 * HourMs, endMs);
+        for (int d = 0; d < days; ++d) {
+            const int level = d < 2 ? 3 : d < 3 ? 2 : 1;
+            insertFlow(start + d * DayMs + 9 * HourMs,
+                       qMax(1, level - (unit(Key, cycle * 8 + d, 10) < 0.3 ? 1 : 0)));
+        }
+        start += (26 + qint64(hash(Key, cycle, 11) % 6)) * DayMs;
+    }
+}
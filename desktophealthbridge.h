@@ -0,0 +1,80 @@
+#ifndef DESKTOPHEALTHBRIDGE_H
+#define DESKTOPHEALTHBRIDGE_H
+
+#include <QString>
+#include <array>
+
+#include "fakehealthbridge.h"
+
+// ── منبع داده‌ی دسکتاپ ──────────────────────────────────────
+// بیرون از Android همین HealthBridge::instance() است. هر نمونه از روی
+// (seed، نوع، شماره‌ی نمونه) محاسبه می‌شود و جایی ذخیره نمی‌شود، پس چند
+// سال ضربان قلب 1 Hz حافظه‌ای نمی‌گیرد و هر بازه در هر اجرا همان است.
+// نوشتن‌ها و payload های ضبط‌شده (QMLHC_REPLAY_DIR) در FakeHealthBridge
+// نگه داشته و صفحه به صفحه با داده‌ی تولیدی merge می‌شوند.
+class DesktopHealthBridge : public FakeHealthBridge
+{
+public:
+    struct Profile {
+        quint32 seed            = 20240101;
+        qint64  fromMs          = 0;      // بازه‌ی داده‌ی تولیدی، [fromMs, toMs)
+        qint64  toMs            = 0;
+        qint64  heartRateStepMs = 1000;
+        QString replayDir;                // خالی یعنی بدون replay
+
+        // QMLHC_DESKTOP_SEED، QMLHC_DESKTOP_DAYS (پیش‌فرض 730 روز تا الان، 0 = بدون
+        // داده‌ی تولیدی)، QMLHC_DESKTOP_HR_STEP_MS و QMLHC_REPLAY_DIR
+        static Profile fromEnvironment();
+    };
+
+    explicit DesktopHealthBridge(const Profile &profile = Profile::fromEnvironment());
+
+    const Profile &profile() const { return m_profile; }
+
+    // اگر permissions.json ضبط شده باشد همان برگردانده می‌شود
+    QString checkPermissions() override;
+
+protected:
+    StreamResult scan(int type, qint64 from, qint64 to, const PageCallback &onPage) override;
+    void collectLatest(int type, int count, Columns &out) const override;
+
+private:
+    // زمان نمونه‌ها: هر periodMs (از epoch، UTC) در offsets از ابتدای دوره + jitter؛
+    // شماره‌ی نمونه فقط به زمان بستگی دارد، نه به بازه‌ی Profile
+    struct Schedule {
+        qint64            periodMs = 0;
+        QList<qint64>     offsets;
+        qint64            jitterMs = 0;
+        double            skip     = 0;   // احتمال ثبت‌نشدن یک نمونه
+    };
+
+    struct Sample {
+        qint64 ms      = 0;
+        double value   = 0;
+        double value2  = 0;
+        int    extras  = 0;
+    };
+
+    const Schedule *schedule(int type) const;
+    qint64 slotTime(const Schedule &s, int type, qint64 slot) const;
+    // ms = slotTime(s, type, slot)؛ false یعنی این نمونه ثبت نشده
+    bool   sampleAt(const Schedule &s, int type, qint64 slot, qint64 ms, Sample *out) const;
+    // نمونه‌ی بعدی/قبلی موجود در [lo, hi) از slot؛ slot از آن رد می‌شود
+    bool   nextSample(const Schedule &s, int type, qint64 &slot, qint64 lo, qint64 hi,
+                      Sample *out) const;
+    bool   previousSample(const Schedule &s, int type, qint64 &slot, qint64 lo, qint64 hi,
+                          Sample *out) const;
+
+    quint64 hash(int type, qint64 index, quint64 salt) const;
+    double  unit(int type, qint64 index, quint64 salt) const;
+    // نویز پیوسته در [0, 1] — x به واحد شبکه‌ی نویز
+    double  smoothNoise(int type, double x, quint64 salt) const;
+
+    void generateMenstruation();
+
+    Profile                  m_profile;
+    std::array<Schedule, 7>  m_schedules;      // اندیس = HealthMeasurement::Type
+    QString                  m_replayedPermissions;
+};
+
+#endif // DESKTOPHEALTHBRIDGE_H
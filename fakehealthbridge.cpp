@@ -0,0 +1,381 @@
+#include "fakehealthbridge.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimeZone>
+
+#include <limits>
+
+namespace {
+
+// مقادیر ITEM_* در HealthBridge.kt
+constexpr int ItemOk      = 0;
+constexpr int ItemInvalid = 1;
+constexpr int ItemDenied  = 3;
+
+QString isoUtc(qint64 ms)
+{
+    return QDateTime::fromMSecsSinceEpoch(ms, QTimeZone::UTC).toString(Qt::ISODateWithMs);
+}
+
+// رشته‌ی خالی در Kotlin یعنی بدون محدودیت
+qint64 parseBound(const QString &iso, qint64 fallback)
+{
+    if (iso.isEmpty())
+        return fallback;
+    QDateTime dt = QDateTime::fromString(iso, Qt::ISODateWithMs);
+    if (!dt.isValid())
+        dt = QDateTime::fromString(iso, Qt::ISODate);
+    return dt.isValid() ? dt.toMSecsSinceEpoch() : fallback;
+}
+
+} // namespace
+
+void FakeHealthBridge::simulateLatency(qsizetype items) const
+{
+    const qint64 us = m_callLatencyUs + qint64(m_itemLatencyUs) * items;
+    if (us > 0)
+        QThread::usleep(us);
+}
+
+QString FakeHealthBridge::init()
+{
+    ++m_calls;
+    return QStringLiteral("INIT_SUCCESS");
+}
+
+QString FakeHealthBridge::checkPermissions()
+{
+    ++m_calls;
+    simulateLatency(0);
+    const bool granted = !m_denied;
+    QJsonObject root;
+    root["allGranted"]   = granted;
+    root["grantedCount"] = granted ? 14 : 0;
+    root["totalCount"]   = 14;
+    root["permissions"]  = QJsonArray();
+    return QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+QString FakeHealthBridge::requestPermissions()
+{
+    ++m_calls;
+    return QStringLiteral("PERMISSION_REQUEST_LAUNCHED");
+}
+
+HealthBridge::StreamResult FakeHealthBridge::stream(int type, const QString &startIso,
+                                                    const QString &endIso, const PageCallback &onPage)
+{
+    ++m_calls;
+    if (m_denied) {
+        StreamResult result;
+        result.status = StreamDenied;
+        return result;
+    }
+
+    const qint64 from = parseBound(startIso, std::numeric_limits<qint64>::min());
+    const qint64 to   = parseBound(endIso, std::numeric_limits<qint64>::max());
+    return scan(type, from, to, [this, &onPage](const Page &page) {
+        simulateLatency(page.count);
+        return onPage(page);
+    });
+}
+
+HealthBridge::StreamResult FakeHealthBridge::latest(const QList<int> &types, int count,
+                                                    const PageCallback &onPage)
+{
+    ++m_calls;
+    StreamResult result;
+    if (m_denied) {
+        result.status = StreamDenied;
+        return result;
+    }
+
+    Columns columns;
+    result.status = StreamComplete;
+
+    // ── یک رفت‌وبرگشت برای همه‌ی نوع‌ها، مثل latestRecords ──
+    simulateLatency(0);
+    for (int type : types) {
+        columns.clear();
+        collectLatest(type, count, columns);
+        ++result.pages;
+        if (columns.size() == 0)
+            continue;
+
+        const Page page = columns.page(type);
+        result.records += page.count;
+        if (!onPage(page)) {
+            result.status = StreamCancelled;
+            break;
+        }
+    }
+    return result;
+}
+
+HealthBridge::AggregateResult FakeHealthBridge::aggregate(int type, const QString &startIso,
+                                                          const QString &endIso, int bucketSeconds)
+{
+    ++m_calls;
+    AggregateResult result;
+    if (m_denied) {
+        result.status = StreamDenied;
+        return result;
+    }
+    if (!supportsAggregate(type) || bucketSeconds <= 0) {
+        result.message = QStringLiteral("ERROR: Unsupported aggregate");
+        return result;
+    }
+
+    const qint64 from     = parseBound(startIso, 0);
+    const qint64 to       = parseBound(endIso, QDateTime::currentMSecsSinceEpoch());
+    const qint64 bucketMs = qint64(bucketSeconds) * 1000;
+
+    // ── مثل aggregateGroupByDuration: bucket ها از ابتدای بازه شروع می‌شوند ──
+    Bucket b;
+    double sum = 0, sum2 = 0;
+    scan(type, from, to, [&](const Page &page) {
+        for (qsizetype i = 0; i < page.count; ++i) {
+            const qint64 start = from + (page.timesMs[i] - from) / bucketMs * bucketMs;
+            if (b.count > 0 && start != b.startMs) {
+                b.avg  = sum / b.count;
+                b.avg2 = sum2 / b.count;
+                result.buckets.append(b);
+                b = Bucket();
+                sum = sum2 = 0;
+            }
+            const double value  = page.values[i];
+            const double value2 = page.values2[i];
+            if (b.count == 0) {
+                b.startMs = start;
+                b.endMs   = qMin(start + bucketMs, to);
+                b.min  = b.max  = value;
+                b.min2 = b.max2 = value2;
+            }
+            b.min  = qMin(b.min, value);
+            b.max  = qMax(b.max, value);
+            b.min2 = qMin(b.min2, value2);
+            b.max2 = qMax(b.max2, value2);
+            sum  += value;
+            sum2 += value2;
+            ++b.count;
+        }
+        return true;
+    });
+    if (b.count > 0) {
+        b.avg  = sum / b.count;
+        b.avg2 = sum2 / b.count;
+        result.buckets.append(b);
+    }
+    simulateLatency(result.buckets.size());
+
+    result.status = StreamComplete;
+    return result;
+}
+
+QString FakeHealthBridge::readMenstruation(const QString &startIso, const QString &endIso)
+{
+    ++m_calls;
+    if (m_denied)
+        return QStringLiteral("ERROR: SecurityException");
+
+    const qint64 from = parseBound(startIso, std::numeric_limits<qint64>::min());
+    const qint64 to   = parseBound(endIso, std::numeric_limits<qint64>::max());
+
+    QJsonArray periods, flows;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (const Period &p : std::as_const(m_periods)) {
+            if (p.endMs < from || p.startMs >= to)
+                continue;
+            QJsonObject o;
+            o["start"] = isoUtc(p.startMs);
+            o["end"]   = isoUtc(p.endMs);
+            periods.append(o);
+        }
+        for (auto it = m_flows.lowerBound(from); it != m_flows.end() && it.key() < to; ++it) {
+            QJsonObject o;
+            o["time"]  = isoUtc(it.key());
+            o["level"] = it.value();
+            flows.append(o);
+        }
+    }
+    simulateLatency(periods.size() + flows.size());
+
+    QJsonObject root;
+    root["periods"] = periods;
+    root["flows"]   = flows;
+    return QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+QString FakeHealthBridge::writeBatch(const QList<HealthMeasurement> &items)
+{
+    ++m_calls;
+    simulateLatency(items.size());
+
+    QJsonArray status, errors;
+    int inserted = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (qsizetype i = 0; i < items.size(); ++i) {
+            const HealthMeasurement &m = items.at(i);
+            const QString error = m.validate();
+            if (!error.isEmpty()) {
+                status.append(ItemInvalid);
+                errors.append(QJsonObject{{"index", int(i)}, {"message", error}});
+            } else if (m_denied) {
+                status.append(ItemDenied);
+            } else {
+                const qint64 ms = m.time.toMSecsSinceEpoch();
+                if (m.type == HealthMeasurement::MenstruationFlow)
+                    m_flows.insert(ms, int(m.value));
+                else if (m.type == HealthMeasurement::MenstruationPeriod)
+                    m_periods.append({ms, qint64(m.value2)});
+                else
+                    m_records[m.type].insert(ms, m);
+                status.append(ItemOk);
+                ++inserted;
+            }
+        }
+    }
+
+    QJsonObject root;
+    root["inserted"] = inserted;
+    root["failed"]   = int(items.size()) - inserted;
+    root["status"]   = status;
+    root["errors"]   = errors;
+    return QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+// ── منبع پیش‌فرض: رکوردهای ذخیره‌شده ────────────────────────
+HealthBridge::StreamResult FakeHealthBridge::scan(int type, qint64 from, qint64 to,
+                                                  const PageCallback &onPage)
+{
+    StreamResult result;
+    Columns columns;
+    qint64 cursor = from;
+
+    for (;;) {
+        // ── یک صفحه زیر قفل کپی می‌شود، callback بیرون از قفل ──
+        columns.clear();
+        collect(type, cursor, to, PageSize, false, columns);
+        if (columns.size() == 0)
+            break;
+
+        const Page page = columns.page(type);
+        ++result.pages;
+        result.records += page.count;
+        if (!onPage(page)) {
+            result.status = StreamCancelled;
+            return result;
+        }
+        if (columns.size() < PageSize)
+            break;
+        cursor = columns.times.last() + 1;
+    }
+
+    result.status = StreamComplete;
+    return result;
+}
+
+void FakeHealthBridge::collectLatest(int type, int count, Columns &out) const
+{
+    collect(type, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max(),
+            count, true, out);
+}
+
+void FakeHealthBridge::collect(int type, qint64 from, qint64 to, qsizetype limit,
+                               bool descending, Columns &out) const
+{
+    QMutexLocker lock(&m_mutex);
+    const auto records = m_records.constFind(type);
+    if (records == m_records.cend())
+        return;
+
+    if (descending) {
+        for (auto it = records->lowerBound(to); it != records->cbegin() && out.size() < limit; ) {
+            --it;
+            if (it.key() < from)
+                break;
+            const HealthMeasurement &m = it.value();
+            out.append(it.key(), m.value, m.value2, packExtras(m));
+        }
+        return;
+    }
+    for (auto it = records->lowerBound(from);
+         it != records->cend() && it.key() < to && out.size() < limit; ++it) {
+        const HealthMeasurement &m = it.value();
+        out.append(it.key(), m.value, m.value2, packExtras(m));
+    }
+}
+
+int FakeHealthBridge::packExtras(const HealthMeasurement &m)
+{
+    return (m.specimenSource & 0xFF)
+         | ((m.mealType & 0xFF) << 8)
+         | ((m.relationToMeal & 0xFF) << 16);
+}
+
+void FakeHealthBridge::Columns::clear()
+{
+    times.resize(0);
+    values.resize(0);
+    values2.resize(0);
+    extras.resize(0);
+}
+
+void FakeHealthBridge::Columns::append(qint64 ms, double value, double value2, int extra)
+{
+    times.append(ms);
+    values.append(value);
+    values2.append(value2);
+    extras.append(extra);
+}
+
+HealthBridge::Page FakeHealthBridge::Columns::page(int type) const
+{
+    Page page;
+    page.type    = type;
+    page.count   = times.size();
+    page.timesMs = times.constData();
+    page.values  = values.constData();
+    page.values2 = values2.constData();
+    page.extras  = extras.constData();
+    return page;
+}
+
+void FakeHealthBridge::insert(const HealthMeasurement &m)
+{
+    QMutexLocker lock(&m_mutex);
+    m_records[m.type].insert(m.time.toMSecsSinceEpoch(), m);
+}
+
+void FakeHealthBridge::insertPeriod(qint64 startMs, qint64 endMs)
+{
+    QMutexLocker lock(&m_mutex);
+    m_periods.append({startMs, endMs});
+}
+
+void FakeHealthBridge::insertFlow(qint64 ms, int level)
+{
+    QMutexLocker lock(&m_mutex);
+    m_flows.insert(ms, level);
+}
+
+void FakeHealthBridge::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_records.clear();
+    m_periods.clear();
+    m_flows.clear();
+}
+
+int FakeHealthBridge::recordCount(int type) const
+{
+    QMutexLocker lock(&m_mutex);
+    return int(m_records.value(type).size());
+}
@@ -0,0 +1,95 @@
+#ifndef FAKEHEALTHBRIDGE_H
+#define FAKEHEALTHBRIDGE_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <atomic>
+
+#include "healthbridge.h"
+
+// ── جایگزین Health Connect در حافظه ─────────────────────────
+// برای اجرای دسکتاپ، تست و benchmark: همان رشته‌های JSON، کدها و
+// صفحه‌بندی HealthBridge.kt را دارد. با setCallLatencyUs/setItemLatencyUs
+// می‌شود هزینه‌ی هر فراخوانی JNI/IPC و هر رکورد را شبیه‌سازی کرد.
+class FakeHealthBridge : public HealthBridge
+{
+public:
+    static constexpr int PageSize = 1000;   // مثل pageSize در streamRecords
+
+    FakeHealthBridge() = default;
+
+    QString init() override;
+    QString checkPermissions() override;
+    QString requestPermissions() override;
+    StreamResult stream(int type, const QString &startIso, const QString &endIso,
+                        const PageCallback &onPage) override;
+    StreamResult latest(const QList<int> &types, int count, const PageCallback &onPage) override;
+    AggregateResult aggregate(int type, const QString &startIso, const QString &endIso,
+                              int bucketSeconds) override;
+    QString readMenstruation(const QString &startIso, const QString &endIso) override;
+    QString writeBatch(const QList<HealthMeasurement> &items) override;
+
+    // درج مستقیم بدون شمارش فراخوانی و بدون تأخیر — برای آماده کردن داده
+    void insert(const HealthMeasurement &m);
+    void insertPeriod(qint64 startMs, qint64 endMs);
+    void insertFlow(qint64 ms, int level);
+    void clear();
+
+    // true: همه‌ی read/write ها مثل نبودن دسترسی رفتار می‌کنند
+    void setPermissionDenied(bool denied) { m_denied = denied; }
+    void setCallLatencyUs(int us) { m_callLatencyUs = us; }
+    void setItemLatencyUs(int us) { m_itemLatencyUs = us; }
+
+    int    recordCount(int type) const;
+    qint64 callCount() const { return m_calls; }
+
+protected:
+    // ستون‌های یک صفحه، به همان شکل Page — بین صفحه‌ها دوباره استفاده می‌شوند
+    struct Columns {
+        QList<qint64> times;
+        QList<double> values;
+        QList<double> values2;
+        QList<int>    extras;
+
+        qsizetype size() const { return times.size(); }
+        void clear();
+        void append(qint64 ms, double value, double value2, int extra);
+        Page page(int type) const;
+    };
+
+    // specimen | meal<<8 | relation<<16، مثل Page::extras
+    static int packExtras(const HealthMeasurement &m);
+
+    // رکوردهای ذخیره‌شده در [from, to)، حداکثر limit تا؛ descending یعنی از آخر
+    void collect(int type, qint64 from, qint64 to, qsizetype limit, bool descending,
+                 Columns &out) const;
+
+    // ── منبع داده‌ی stream / aggregate / latest ──
+    // پیش‌فرض همان رکوردهای ذخیره‌شده است؛ DesktopHealthBridge داده‌ی تولیدی را
+    // اینجا با آن‌ها merge می‌کند. بدون تأخیر شبیه‌سازی‌شده و بدون شمارش فراخوانی.
+    virtual StreamResult scan(int type, qint64 from, qint64 to, const PageCallback &onPage);
+    virtual void collectLatest(int type, int count, Columns &out) const;
+
+    void simulateLatency(qsizetype items) const;
+    bool isDenied() const { return m_denied; }
+
+private:
+    struct Period {
+        qint64 startMs;
+        qint64 endMs;
+    };
+
+    mutable QMutex                             m_mutex;
+    QHash<int, QMap<qint64, HealthMeasurement>> m_records;   // type → time_ms → رکورد
+    QList<Period>                              m_periods;
+    QMap<qint64, int>                          m_flows;      // time_ms → level
+
+    std::atomic_bool  m_denied        { false };
+    std::atomic_int   m_callLatencyUs { 0 };
+    std::atomic_int   m_itemLatencyUs { 0 };
+    std::atomic<qint64> m_calls       { 0 };
+};
+
+#endif // FAKEHEALTHBRIDGE_H
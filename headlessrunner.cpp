@@ -0,0 +1,268 @@
+#include "headlessrunner.h"
+#include "backend.h"
+#include "metricdescriptor.h"
+#include "outputsink.h"
+#include "seriesexporter.h"
+#include "stagemetrics.h"
+#include "tracer.h"
+#include "ziprepacker.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <cstring>
+
+namespace {
+
+enum ExitCode {
+    ExitOk        = 0,
+    ExitFailed    = 1,
+    ExitBadUsage  = 2
+};
+
+QStringList metricNames()
+{
+    QStringList names;
+    for (int type : Metric::allTypes())
+        names.append(QString::fromLatin1(Metric::key(type)));
+    return names;
+}
+
+// "now"، "2024-01-01" یا "2024-01-01T08:00:00Z"
+QDateTime parseTime(const QString &text, const QDateTime &now)
+{
+    if (text.compare("now", Qt::CaseInsensitive) == 0)
+        return now;
+    QDateTime dt = QDateTime::fromString(text, Qt::ISODateWithMs);
+    if (!dt.isValid())
+        dt = QDateTime::fromString(text, Qt::ISODate);
+    return dt;
+}
+
+// "30d"، "12w"، "6m"، "2y" (تا الان) یا "FROM..TO"
+bool parseRange(const QString &text, const QDateTime &now, QDateTime *from, QDateTime *to)
+{
+    static const QRegularExpression relative("^(\\d+)([dwmy])$");
+    const QRegularExpressionMatch match = relative.match(text);
+    if (match.hasMatch()) {
+        const int n = match.captured(1).toInt();
+        const QChar unit = match.captured(2).at(0);
+        *to = now;
+        if (unit == 'd')      *from = now.addDays(-n);
+        else if (unit == 'w') *from = now.addDays(-7 * qint64(n));
+        else if (unit == 'm') *from = now.addMonths(-n);
+        else                  *from = now.addYears(-n);
+        return n > 0;
+    }
+
+    const QStringList parts = text.split("..");
+    if (parts.size() != 2)
+        return false;
+    *from = parseTime(parts.at(0), now);
+    *to   = parts.at(1).isEmpty() ? now : parseTime(parts.at(1), now);
+    return from->isValid() && to->isValid() && *from < *to;
+}
+
+bool parseMetrics(const QString &text, QList<int> *types, QString *error)
+{
+    const QStringList names = text.compare("all", Qt::CaseInsensitive) == 0
+                              ? metricNames() : text.split(',', Qt::SkipEmptyParts);
+    for (const QString &name : names) {
+        const int type = Backend::metricType(name.trimmed());
+        if (!type) {
+            *error = QString("Unknown metric '%1' (one of: %2, all)")
+                         .arg(name, metricNames().join(", "));
+            return false;
+        }
+        if (!types->contains(type))
+            types->append(type);
+    }
+    return !types->isEmpty();
+}
+
+int formatFor(const QString &filePath)
+{
+    const QString suffix = "." + QFileInfo(filePath).suffix().toLower();
+    for (int format : {SeriesExporter::Xlsx, SeriesExporter::Csv,
+                       SeriesExporter::NdJson, SeriesExporter::Columnar}) {
+        if (SeriesExporter::fileExtension(format) == suffix)
+            return format;
+    }
+    return -1;
+}
+
+int compressionFor(const QString &name)
+{
+    for (int mode : {ZipRepacker::Store, ZipRepacker::Fast,
+                     ZipRepacker::Maximum, ZipRepacker::ParallelMaximum}) {
+        if (ZipRepacker::compressionName(mode) == name)
+            return mode;
+    }
+    return -1;
+}
+
+double perSecond(qint64 count, qint64 ms)
+{
+    return ms > 0 ? count * 1000.0 / ms : 0.0;
+}
+
+void printRun(QTextStream &out, const Backend::RangeExportStats &s, qint64 totalMs)
+{
+    for (const Backend::RangeExportStats::Metric &m : s.metrics) {
+        out << QString("  %1 %2 records %3 pages %4 ms %5 rec/s  %6\n")
+                   .arg(QString::fromLatin1(HealthBridge::typeName(m.type)), -18)
+                   .arg(m.records, 10).arg(m.pages, 6).arg(m.elapsedMs, 7)
+                   .arg(perSecond(m.records, m.elapsedMs), 12, 'f', 0)
+                   .arg(HealthBridge::statusName(m.status));
+    }
+    out << QString("  %1 %2 records            %3 ms %4 rec/s\n")
+               .arg("fetch", -18).arg(s.records, 10).arg(s.fetchMs, 7)
+               .arg(perSecond(s.records, s.fetchMs), 12, 'f', 0);
+    out << QString("  %1 %2 periods, %3 flows   %4 ms\n")
+               .arg("menstruation", -18).arg(s.periods, 5).arg(s.flows, 5).arg(s.menstruationMs, 7);
+    out << QString("  %1 %2 rows %3 bytes %4 ms %5 rows/s\n")
+               .arg("export", -18).arg(s.rows, 10).arg(s.bytes, 12).arg(s.exportMs, 7)
+               .arg(perSecond(s.rows, s.exportMs), 12, 'f', 0);
+    out << QString("  %1 %2 ms\n").arg("total", -18).arg(totalMs, 10);
+}
+
+void printStages(QTextStream &out)
+{
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+               .arg("stage", -16).arg("n", 8).arg("p50 ms", 9).arg("p90 ms", 9)
+               .arg("p99 ms", 9).arg("max ms", 9).arg("items/s", 12);
+    for (int stage = 0; stage < StageMetrics::StageCount; ++stage) {
+        const StageMetrics::Summary s = StageMetrics::summary(StageMetrics::Stage(stage));
+        if (!s.count)
+            continue;
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg(QString::fromLatin1(StageMetrics::stageName(s.stage)), -16)
+                   .arg(s.count, 8)
+                   .arg(s.p50Us / 1000.0, 9, 'f', 2)
+                   .arg(s.p90Us / 1000.0, 9, 'f', 2)
+                   .arg(s.p99Us / 1000.0, 9, 'f', 2)
+                   .arg(s.maxUs / 1000.0, 9, 'f', 2)
+                   .arg(s.itemsPerSecond(), 12, 'f', 0);
+    }
+}
+
+} // namespace
+
+bool HeadlessRunner::requested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+    return false;
+}
+
+int HeadlessRunner::run(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fetch, process and export health data without a window.");
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless", "Run without a window.");
+    QCommandLineOption rangeOption("range",
+        "Time range: Nd, Nw, Nm, Ny (last N days/weeks/months/years) or FROM..TO "
+        "(ISO 8601 date/time or 'now'). Default: 30d.", "range", "30d");
+    QCommandLineOption metricsOption("metrics",
+        QString("Comma separated metrics (%1) or 'all'. Default: all.").arg(metricNames().join(", ")),
+        "metrics", "all");
+    QCommandLineOption exportOption("export",
+        "Output file; the format follows the extension (.xlsx, .csv, .ndjson, .hcol).", "file");
+    QCommandLineOption compressionOption("compression",
+        "XLSX compression: store, fast, maximum or parallel. Default: the saved setting.",
+        "mode");
+    QCommandLineOption repeatOption("repeat",
+        "Run the whole pass N times; stage statistics cover all runs.", "n", "1");
+    QCommandLineOption verboseOption("verbose", "Keep qDebug output.");
+    parser.addOptions({headlessOption, rangeOption, metricsOption, exportOption,
+                       compressionOption, repeatOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption))
+        QLoggingCategory::setFilterRules("default.debug=false");
+
+    // ── آرگومان‌ها ──
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QDateTime from, to;
+    if (!parseRange(parser.value(rangeOption), now, &from, &to)) {
+        err << "Invalid --range: " << parser.value(rangeOption) << "\n";
+        return ExitBadUsage;
+    }
+    QList<int> types;
+    QString error;
+    if (!parseMetrics(parser.value(metricsOption), &types, &error)) {
+        err << (error.isEmpty() ? QString("No metrics selected") : error) << "\n";
+        return ExitBadUsage;
+    }
+    const QString filePath = parser.value(exportOption);
+    const int format = formatFor(filePath);
+    if (filePath.isEmpty() || format < 0) {
+        err << "--export needs a .xlsx, .csv, .ndjson or .hcol file\n";
+        return ExitBadUsage;
+    }
+    int compression = -1;
+    if (parser.isSet(compressionOption)) {
+        compression = compressionFor(parser.value(compressionOption));
+        if (compression < 0) {
+            err << "Invalid --compression: " << parser.value(compressionOption) << "\n";
+            return ExitBadUsage;
+        }
+    }
+    bool ok = false;
+    const int repeat = parser.value(repeatOption).toInt(&ok);
+    if (!ok || repeat < 1) {
+        err << "Invalid --repeat: " << parser.value(repeatOption) << "\n";
+        return ExitBadUsage;
+    }
+
+    // ── یک گذر: fetch → decode → export ──
+    QElapsedTimer timer;
+    timer.start();
+    Backend backend;
+    const qint64 startupMs = timer.elapsed();
+    StageMetrics::reset();
+
+    out << "range   " << from.toUTC().toString(Qt::ISODate) << " .. "
+        << to.toUTC().toString(Qt::ISODate) << "\n"
+        << "format  " << SeriesExporter::formatName(format) << " → " << filePath << "\n"
+        << "startup " << startupMs << " ms\n";
+
+    for (int i = 0; i < repeat; ++i) {
+        TraceSpan span("headless", "run");
+        span.arg("run", i);
+        timer.restart();
+        LocalFileSink sink(filePath);
+        Backend::RangeExportStats stats;
+        error.clear();
+        const bool success = backend.exportRange(types, from, to, format, compression,
+                                                 &sink, &stats, &error);
+        const qint64 totalMs = timer.elapsed();
+
+        if (repeat > 1)
+            out << "run " << (i + 1) << "/" << repeat << "\n";
+        printRun(out, stats, totalMs);
+        out.flush();
+        if (!success) {
+            err << "❌ Export failed: " << error << "\n";
+            return ExitFailed;
+        }
+    }
+
+    out << "\n";
+    printStages(out);
+    Tracer::flush();
+    return ExitOk;
+}
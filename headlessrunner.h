@@ -0,0 +1,22 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+// ── حالت خط فرمان، بدون پنجره ───────────────────────────────
+// با --headless به‌جای QApplication / QQuickView فقط یک QCoreApplication
+// ساخته می‌شود (بدون scenegraph و OpenGL). بازه خوانده، پردازش و در یک گذر
+// export می‌شود و زمان هر مرحله روی stdout چاپ می‌شود:
+//
+//     QMLHealthConnect --headless --range 2y --metrics heartRate,weight --export out.csv
+//     QMLHealthConnect --headless --range 2024-01-01..2024-07-01 --export out.xlsx
+//
+// قالب از پسوند --export می‌آید: .xlsx، .csv، .ndjson یا .hcol
+// کد خروج: 0 موفق، 1 خطای خواندن/نوشتن، 2 آرگومان نادرست.
+class HeadlessRunner
+{
+public:
+    // --headless در argv هست؟ (قبل از ساختن هر QCoreApplication)
+    static bool requested(int argc, char *argv[]);
+    static int run(int argc, char *argv[]);
+};
+
+#endif // HEADLESSRUNNER_H
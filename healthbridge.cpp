@@ -0,0 +1,431 @@
+#include "healthbridge.h"
+#include "metricdescriptor.h"
+#include "recordinghealthbridge.h"
+#include "stagemetrics.h"
+#include "tracer.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <atomic>
+
+#ifdef Q_OS_ANDROID
+#include <QCoreApplication>
+#include <QtCore/qnativeinterface.h>
+#include <cstdarg>
+#else
+#include "desktophealthbridge.h"
+#endif
+
+namespace {
+std::atomic<HealthBridge *> g_bridgeOverride { nullptr };
+
+HealthBridge *createDefaultBridge()
+{
+#ifdef Q_OS_ANDROID
+    // اگر کلاس پیدا نشود هم نال نیست؛ متدها "ERROR: ..." برمی‌گردانند
+    HealthBridge *bridge = new JniHealthBridge;
+#else
+    HealthBridge *bridge = new DesktopHealthBridge;
+#endif
+    // QMLHC_RECORD_DIR: payload ها برای replay روی دسکتاپ ضبط می‌شوند
+    const QString recordDir = qEnvironmentVariable("QMLHC_RECORD_DIR");
+    if (!recordDir.isEmpty())
+        bridge = new RecordingHealthBridge(bridge, recordDir);
+    return bridge;
+}
+}
+
+HealthBridge *HealthBridge::instance()
+{
+    if (HealthBridge *bridge = g_bridgeOverride.load())
+        return bridge;
+    // عمداً آزاد نمی‌شود — بعد از خروج از main ممکن است JVM در دسترس نباشد
+    static HealthBridge *bridge = createDefaultBridge();
+    return bridge;
+}
+
+void HealthBridge::setInstance(HealthBridge *bridge)
+{
+    g_bridgeOverride.store(bridge);
+}
+
+const char *HealthBridge::typeName(int type)
+{
+    return Metric::typeName(type);
+}
+
+QString HealthBridge::statusName(int status)
+{
+    switch (status) {
+    case StreamComplete:  return QStringLiteral("COMPLETE");
+    case StreamTruncated: return QStringLiteral("TRUNCATED");
+    case StreamCancelled: return QStringLiteral("CANCELLED");
+    case StreamDenied:    return QStringLiteral("SECURITY_ERROR");
+    case StreamFailed:    break;
+    }
+    return QStringLiteral("ERROR");
+}
+
+HealthBridge::StreamResult HealthBridge::parseStreamResult(const QString &json)
+{
+    StreamResult result;
+    if (json == "SECURITY_ERROR") {
+        result.status  = StreamDenied;
+        result.message = json;
+        return result;
+    }
+
+    const QJsonObject obj = QJsonDocument::fromJson(json.toUtf8()).object();
+    if (obj.isEmpty()) {
+        // "CLIENT_NULL" یا "ERROR: ..."
+        result.message = json;
+        return result;
+    }
+
+    const QString status = obj["status"].toString();
+    result.records = obj["records"].toInteger();
+    result.pages   = obj["pages"].toInt();
+    result.message = obj["message"].toString();
+    if      (status == "COMPLETE")  result.status = StreamComplete;
+    else if (status == "TRUNCATED") result.status = StreamTruncated;
+    else if (status == "CANCELLED") result.status = StreamCancelled;
+    return result;
+}
+
+bool HealthBridge::supportsAggregate(int type)
+{
+    return Metric::supportsAggregate(type);
+}
+
+HealthBridge::AggregateResult HealthBridge::parseAggregateResult(const QString &json)
+{
+    TraceSpan span("json", "parseAggregateResult");
+    StageMetrics::Timer decodeTimer(StageMetrics::Decode);
+    AggregateResult result;
+    if (json == "SECURITY_ERROR") {
+        result.status  = StreamDenied;
+        result.message = json;
+        return result;
+    }
+
+    const QJsonObject obj = QJsonDocument::fromJson(json.toUtf8()).object();
+    if (obj["status"].toString() != "COMPLETE") {
+        // TRUNCATED: bucket های محلی (قند خون، SpO2) پیش از آخرین صفحه متوقف شدند
+        if (obj["status"].toString() == "TRUNCATED")
+            result.status = StreamTruncated;
+        result.message = obj.isEmpty() ? json : obj["message"].toString();
+        return result;
+    }
+
+    const QJsonArray buckets = obj["buckets"].toArray();
+    result.buckets.reserve(buckets.size());
+    for (const QJsonValue &v : buckets) {
+        const QJsonObject o = v.toObject();
+        Bucket b;
+        b.startMs = o["start"].toInteger();
+        b.endMs   = o["end"].toInteger();
+        b.min     = o["min"].toDouble();
+        b.avg     = o["avg"].toDouble();
+        b.max     = o["max"].toDouble();
+        b.min2    = o["min2"].toDouble();
+        b.avg2    = o["avg2"].toDouble();
+        b.max2    = o["max2"].toDouble();
+        b.count   = o["count"].toInteger();
+        result.buckets.append(b);
+    }
+    result.status = StreamComplete;
+    return result;
+}
+
+#ifdef Q_OS_ANDROID
+namespace {
+
+// jstring محلی که با خروج از scope آزاد می‌شود
+class LocalString
+{
+public:
+    LocalString(JNIEnv *env, const QString &s)
+        : m_env(env)
+        , m_ref(env->NewString(reinterpret_cast<const jchar *>(s.utf16()), jsize(s.size())))
+    {
+    }
+    ~LocalString()
+    {
+        if (m_ref)
+            m_env->DeleteLocalRef(m_ref);
+    }
+    LocalString(const LocalString &) = delete;
+    LocalString &operator=(const LocalString &) = delete;
+
+    jstring get() const { return m_ref; }
+
+private:
+    JNIEnv *m_env;
+    jstring m_ref;
+};
+
+// رشته‌ی جاوا را می‌خواند و local ref را آزاد می‌کند
+QString takeString(JNIEnv *env, jstring s)
+{
+    if (!s)
+        return QStringLiteral("NULL");
+    const jsize len = env->GetStringLength(s);
+    const jchar *chars = env->GetStringChars(s, nullptr);
+    QString out(reinterpret_cast<const QChar *>(chars), len);
+    env->ReleaseStringChars(s, chars);
+    env->DeleteLocalRef(s);
+    return out;
+}
+
+constexpr const char *ReadSignature = "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;";
+
+static_assert(sizeof(jlong) == sizeof(qint64), "jlong must be 64-bit");
+static_assert(sizeof(jint) == sizeof(int), "jint must be int");
+
+// ── stream در حال اجرا روی این thread ──
+// streamRecords در Kotlin روی همان thread فراخوان اجرا می‌شود و
+// nativeOnPage را هم روی همان thread صدا می‌زند؛ پس thread_local کافی است.
+struct ActiveStream {
+    jlong                              requestId = 0;
+    const HealthBridge::PageCallback  *onPage    = nullptr;
+    // بافرهای صفحه — بین صفحه‌ها دوباره استفاده می‌شوند
+    QList<qint64> times;
+    QList<double> values;
+    QList<double> values2;
+    QList<int>    extras;
+};
+
+thread_local ActiveStream *t_stream = nullptr;
+std::atomic<jlong>         g_nextRequestId { 1 };
+
+jboolean JNICALL nativeOnPage(JNIEnv *env, jclass, jlong requestId, jint type, jint count,
+                              jlongArray times, jdoubleArray values, jdoubleArray values2,
+                              jintArray extras)
+{
+    ActiveStream *s = t_stream;
+    if (!s || s->requestId != requestId)
+        return JNI_FALSE;
+    if (count <= 0)
+        return JNI_TRUE;
+
+    TraceSpan span("jni", "page");
+    span.arg("type", int(type));
+    span.arg("records", int(count));
+
+    {
+        StageMetrics::Timer decodeTimer(StageMetrics::Decode, count);
+        s->times.resize(count);
+        s->values.resize(count);
+        s->values2.resize(count);
+        s->extras.resize(count);
+        env->GetLongArrayRegion(times, 0, count, reinterpret_cast<jlong *>(s->times.data()));
+        env->GetDoubleArrayRegion(values, 0, count, s->values.data());
+        env->GetDoubleArrayRegion(values2, 0, count, s->values2.data());
+        env->GetIntArrayRegion(extras, 0, count, reinterpret_cast<jint *>(s->extras.data()));
+    }
+
+    HealthBridge::Page page;
+    page.type    = type;
+    page.count   = count;
+    page.timesMs = s->times.constData();
+    page.values  = s->values.constData();
+    page.values2 = s->values2.constData();
+    page.extras  = s->extras.constData();
+    return (*s->onPage)(page) ? JNI_TRUE : JNI_FALSE;
+}
+
+} // namespace
+
+JniHealthBridge::JniHealthBridge()
+{
+    QJniEnvironment env;
+    jclass cls = env.findClass(ClassName);
+    if (!cls) {
+        qWarning() << "❌ HealthBridge class not found";
+        return;
+    }
+    m_class = static_cast<jclass>(env->NewGlobalRef(cls));
+
+    m_init               = env.findStaticMethod(m_class, "init",
+                                                "(Landroid/content/Context;)Ljava/lang/String;");
+    m_checkPermissions   = env.findStaticMethod(m_class, "checkPermissions", "()Ljava/lang/String;");
+    m_requestPermissions = env.findStaticMethod(m_class, "requestPermissions",
+                                                "(Landroid/app/Activity;)Ljava/lang/String;");
+    m_stream             = env.findStaticMethod(m_class, "streamRecords",
+                                                "(ILjava/lang/String;Ljava/lang/String;J)Ljava/lang/String;");
+    m_aggregate          = env.findStaticMethod(m_class, "aggregateBuckets",
+                                                "(ILjava/lang/String;Ljava/lang/String;J)Ljava/lang/String;");
+    m_latest             = env.findStaticMethod(m_class, "latestRecords", "([IIJ)Ljava/lang/String;");
+    m_readMenstruation   = env.findStaticMethod(m_class, "readMenstruationData", ReadSignature);
+    m_writeBatch         = env.findStaticMethod(m_class, "writeBatch", "([I[J[D[D[I)Ljava/lang/String;");
+
+    env.checkAndClearExceptions();
+
+    // ── callback صفحه‌ها — یک بار برای کل عمر برنامه ──
+    static const JNINativeMethod natives[] = {
+        { "nativeOnPage", "(JII[J[D[D[I)Z", reinterpret_cast<void *>(nativeOnPage) }
+    };
+    if (!env.registerNativeMethods(m_class, natives, 1))
+        qWarning() << "❌ Cannot register HealthBridge.nativeOnPage";
+}
+
+JniHealthBridge::~JniHealthBridge()
+{
+    if (m_class) {
+        QJniEnvironment env;
+        env->DeleteGlobalRef(m_class);
+    }
+}
+
+QString JniHealthBridge::callString(JNIEnv *env, jmethodID method, ...)
+{
+    if (!m_class || !method)
+        return QStringLiteral("ERROR: HealthBridge method not found");
+
+    va_list args;
+    va_start(args, method);
+    jobject result = env->CallStaticObjectMethodV(m_class, method, args);
+    va_end(args);
+
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        if (result)
+            env->DeleteLocalRef(result);
+        return QStringLiteral("ERROR: JNI exception");
+    }
+    return takeString(env, static_cast<jstring>(result));
+}
+
+QString JniHealthBridge::init()
+{
+    QJniEnvironment env;
+    QJniObject context = QNativeInterface::QAndroidApplication::context();
+    if (!context.isValid())
+        return QStringLiteral("ERROR: Activity is invalid");
+    return callString(env.jniEnv(), m_init, context.object());
+}
+
+QString JniHealthBridge::checkPermissions()
+{
+    TraceSpan span("jni", "checkPermissions");
+    QJniEnvironment env;
+    return callString(env.jniEnv(), m_checkPermissions);
+}
+
+QString JniHealthBridge::requestPermissions()
+{
+    QJniEnvironment env;
+    QJniObject activity = QNativeInterface::QAndroidApplication::context();
+    if (!activity.isValid())
+        return QStringLiteral("ERROR: Activity is invalid");
+    return callString(env.jniEnv(), m_requestPermissions, activity.object());
+}
+
+HealthBridge::StreamResult JniHealthBridge::stream(int type, const QString &startIso,
+                                                   const QString &endIso, const PageCallback &onPage)
+{
+    TraceSpan span("jni", QStringLiteral("stream %1").arg(typeName(type)));
+    ActiveStream active;
+    active.requestId = g_nextRequestId++;
+    active.onPage    = &onPage;
+
+    ActiveStream *outer = t_stream;
+    t_stream = &active;
+
+    QJniEnvironment env;
+    LocalString jStart(env.jniEnv(), startIso);
+    LocalString jEnd(env.jniEnv(), endIso);
+    const QString json = callString(env.jniEnv(), m_stream, jint(type),
+                                    jStart.get(), jEnd.get(), active.requestId);
+
+    t_stream = outer;
+    return parseStreamResult(json);
+}
+
+HealthBridge::StreamResult JniHealthBridge::latest(const QList<int> &types, int count,
+                                                   const PageCallback &onPage)
+{
+    TraceSpan span("jni", "latest");
+    ActiveStream active;
+    active.requestId = g_nextRequestId++;
+    active.onPage    = &onPage;
+
+    ActiveStream *outer = t_stream;
+    t_stream = &active;
+
+    QJniEnvironment env;
+    jintArray jTypes = env->NewIntArray(jsize(types.size()));
+    env->SetIntArrayRegion(jTypes, 0, jsize(types.size()), reinterpret_cast<const jint *>(types.constData()));
+    const QString json = callString(env.jniEnv(), m_latest, jTypes, jint(count), active.requestId);
+    env->DeleteLocalRef(jTypes);
+
+    t_stream = outer;
+    return parseStreamResult(json);
+}
+
+HealthBridge::AggregateResult JniHealthBridge::aggregate(int type, const QString &startIso,
+                                                         const QString &endIso, int bucketSeconds)
+{
+    TraceSpan span("jni", QStringLiteral("aggregate %1").arg(typeName(type)));
+    span.arg("bucketSeconds", bucketSeconds);
+    QJniEnvironment env;
+    LocalString jStart(env.jniEnv(), startIso);
+    LocalString jEnd(env.jniEnv(), endIso);
+    return parseAggregateResult(callString(env.jniEnv(), m_aggregate, jint(type),
+                                           jStart.get(), jEnd.get(), jlong(bucketSeconds)));
+}
+
+QString JniHealthBridge::readMenstruation(const QString &startIso, const QString &endIso)
+{
+    TraceSpan span("jni", "readMenstruation");
+    QJniEnvironment env;
+    LocalString jStart(env.jniEnv(), startIso);
+    LocalString jEnd(env.jniEnv(), endIso);
+    return callString(env.jniEnv(), m_readMenstruation, jStart.get(), jEnd.get());
+}
+
+QString JniHealthBridge::writeBatch(const QList<HealthMeasurement> &items)
+{
+    // ── آرایه‌های ستونی — یک فراخوانی JNI برای کل دسته ──
+    const jsize n = jsize(items.size());
+    QList<jint>    types(n), extras(n);
+    QList<jlong>   times(n);
+    QList<jdouble> values(n), values2(n);
+    for (jsize k = 0; k < n; ++k) {
+        const HealthMeasurement &m = items.at(k);
+        types[k]   = jint(m.type);
+        times[k]   = jlong(m.time.toMSecsSinceEpoch());
+        values[k]  = m.value;
+        values2[k] = m.value2;
+        extras[k]  = jint((m.specimenSource & 0xFF)
+                          | ((m.mealType & 0xFF) << 8)
+                          | ((m.relationToMeal & 0xFF) << 16));
+    }
+
+    QJniEnvironment env;
+    jintArray    jTypes   = env->NewIntArray(n);
+    jlongArray   jTimes   = env->NewLongArray(n);
+    jdoubleArray jValues  = env->NewDoubleArray(n);
+    jdoubleArray jValues2 = env->NewDoubleArray(n);
+    jintArray    jExtras  = env->NewIntArray(n);
+    env->SetIntArrayRegion(jTypes, 0, n, types.constData());
+    env->SetLongArrayRegion(jTimes, 0, n, times.constData());
+    env->SetDoubleArrayRegion(jValues, 0, n, values.constData());
+    env->SetDoubleArrayRegion(jValues2, 0, n, values2.constData());
+    env->SetIntArrayRegion(jExtras, 0, n, extras.constData());
+
+    QString json = callString(env.jniEnv(), m_writeBatch,
+                              jTypes, jTimes, jValues, jValues2, jExtras);
+
+    env->DeleteLocalRef(jTypes);
+    env->DeleteLocalRef(jTimes);
+    env->DeleteLocalRef(jValues);
+    env->DeleteLocalRef(jValues2);
+    env->DeleteLocalRef(jExtras);
+    return json;
+}
+
+#endif
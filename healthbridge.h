@@ -0,0 +1,145 @@
+#ifndef HEALTHBRIDGE_H
+#define HEALTHBRIDGE_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+
+#include "healthmeasurement.h"
+
+#ifdef Q_OS_ANDROID
+#include <QJniEnvironment>
+#include <QJniObject>
+#endif
+
+// ── رابط Backend با HealthBridge.kt ─────────────────────────
+// خروجی متدهای رشته‌ای همان چیزی است که Kotlin برمی‌گرداند (JSON یا
+// کدهایی مثل "SECURITY_ERROR" / "ERROR: ...")، تا پیاده‌سازی JNI و
+// FakeHealthBridge برای Backend یکسان باشند.
+// همه‌ی متدها از هر thread قابل صدا زدن هستند.
+class HealthBridge
+{
+public:
+    virtual ~HealthBridge() = default;
+
+    // یک صفحه از رکوردهای یک نوع، صعودی بر اساس زمان.
+    // آرایه‌ها فقط تا پایان callback معتبرند.
+    struct Page {
+        int            type    = 0;
+        qsizetype      count   = 0;
+        const qint64  *timesMs = nullptr;
+        const double  *values  = nullptr;
+        const double  *values2 = nullptr;   // فشار خون: diastolic
+        const int     *extras  = nullptr;   // قند خون: specimen | meal<<8 | relation<<16
+    };
+    // false یعنی بقیه‌ی صفحه‌ها لازم نیست (لغو)
+    using PageCallback = std::function<bool(const Page &page)>;
+
+    enum StreamStatus {
+        StreamComplete  = 0,
+        StreamTruncated = 1,   // pageToken تکراری — بقیه‌ی داده خوانده نشد
+        StreamCancelled = 2,
+        StreamDenied    = 3,
+        StreamFailed    = 4
+    };
+
+    struct StreamResult {
+        StreamStatus status  = StreamFailed;
+        qint64       records = 0;
+        int          pages   = 0;
+        QString      message;
+    };
+
+    // یک bucket از کوئری تجمیعی — برای BP مقادیر *2 همان diastolic است
+    struct Bucket {
+        qint64 startMs = 0;
+        qint64 endMs   = 0;
+        double min  = 0, avg  = 0, max  = 0;
+        double min2 = 0, avg2 = 0, max2 = 0;
+        qint64 count = 0;
+    };
+
+    struct AggregateResult {
+        StreamStatus   status = StreamFailed;
+        QList<Bucket>  buckets;    // صعودی بر اساس startMs، bucket خالی حذف شده
+        QString        message;
+    };
+
+    virtual QString init() = 0;
+    virtual QString checkPermissions() = 0;
+    virtual QString requestPermissions() = 0;
+
+    // type: HealthMeasurement::Type — هر صفحه به محض رسیدن به onPage داده می‌شود؛
+    // روی همان thread صدازننده و بدون نگه‌داشتن کل نتیجه در حافظه
+    virtual StreamResult stream(int type, const QString &startIso, const QString &endIso,
+                                const PageCallback &onPage) = 0;
+    // آخرین count رکورد هر نوع — یک صفحه‌ی نزولی برای هر نوع در یک فراخوانی؛
+    // هزینه به طول تاریخچه بستگی ندارد
+    virtual StreamResult latest(const QList<int> &types, int count, const PageCallback &onPage) = 0;
+    // min/avg/max در bucket های bucketSeconds ثانیه‌ای؛ فقط برای supportsAggregate
+    virtual AggregateResult aggregate(int type, const QString &startIso, const QString &endIso,
+                                      int bucketSeconds) = 0;
+    virtual QString readMenstruation(const QString &startIso, const QString &endIso) = 0;
+
+    // آیتم‌ها از قبل اعتبارسنجی شده‌اند؛ خروجی {inserted, failed, status[], errors[]}
+    // تنها مسیر نوشتن، قاعدگی هم (HealthMeasurement::MenstruationFlow/Period)
+    virtual QString writeBatch(const QList<HealthMeasurement> &items) = 0;
+
+    // روی Android پیاده‌سازی JNI، در غیر این صورت DesktopHealthBridge — هرگز nullptr؛
+    // با QMLHC_RECORD_DIR داخل RecordingHealthBridge
+    static HealthBridge *instance();
+    // برای تست و benchmark؛ مالکیت پیش caller می‌ماند، nullptr یعنی پیش‌فرض
+    static void setInstance(HealthBridge *bridge);
+
+    // نام نوع برای لاگ
+    static const char *typeName(int type);
+    static QString statusName(int status);
+    // رشته‌ی وضعیت streamRecords در Kotlin → StreamResult
+    static StreamResult parseStreamResult(const QString &json);
+    // نوع‌هایی که خواندن تجمیعی دارند: HR, BP, قند خون, SpO2
+    static bool supportsAggregate(int type);
+    // رشته‌ی aggregateBuckets در Kotlin → AggregateResult
+    static AggregateResult parseAggregateResult(const QString &json);
+};
+
+#ifdef Q_OS_ANDROID
+// ── پیاده‌سازی JNI ──────────────────────────────────────────
+// jclass (global ref) و jmethodID ها یک بار در سازنده resolve می‌شوند؛
+// رشته‌ها مستقیم با NewString ساخته و بلافاصله آزاد می‌شوند.
+class JniHealthBridge : public HealthBridge
+{
+public:
+    JniHealthBridge();
+    ~JniHealthBridge() override;
+
+    bool isValid() const { return m_class != nullptr; }
+
+    QString init() override;
+    QString checkPermissions() override;
+    QString requestPermissions() override;
+    StreamResult stream(int type, const QString &startIso, const QString &endIso,
+                        const PageCallback &onPage) override;
+    StreamResult latest(const QList<int> &types, int count, const PageCallback &onPage) override;
+    AggregateResult aggregate(int type, const QString &startIso, const QString &endIso,
+                              int bucketSeconds) override;
+    QString readMenstruation(const QString &startIso, const QString &endIso) override;
+    QString writeBatch(const QList<HealthMeasurement> &items) override;
+
+private:
+    QString callString(JNIEnv *env, jmethodID method, ...);
+
+    static constexpr const char *ClassName = "org/verya/QMLHealthConnect/HealthBridge";
+
+    jclass    m_class = nullptr;
+    jmethodID m_init               = nullptr;
+    jmethodID m_checkPermissions   = nullptr;
+    jmethodID m_requestPermissions = nullptr;
+    jmethodID m_stream             = nullptr;
+    jmethodID m_aggregate          = nullptr;
+    jmethodID m_latest             = nullptr;
+    jmethodID m_readMenstruation   = nullptr;
+    jmethodID m_writeBatch         = nullptr;
+};
+#endif
+
+#endif // HEALTHBRIDGE_H
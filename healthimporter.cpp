@@ -0,0 +1,343 @@
+#include "healthimporter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPair>
+#include <QVariant>
+
+#include "metricdescriptor.h"
+#include "xlsxdocument.h"
+
+namespace {
+
+constexpr int StatusOk = 0;   // Backend::WriteOk
+
+// فیلدهای CSV خروجی SeriesExporter — نام ستون‌های Metric::Descriptor؛
+// فیلد ناشناخته مقدار اصلی است
+void applyField(HealthMeasurement &m, const QByteArray &field, double value)
+{
+    Metric::setColumnValue(m, Metric::columnOf(m.type, field), value);
+}
+
+QByteArray unquote(const QByteArray &field)
+{
+    QByteArray f = field.trimmed();
+    if (f.size() >= 2 && f.startsWith('"') && f.endsWith('"'))
+        f = f.mid(1, f.size() - 2);
+    return f;
+}
+
+// epoch ms یا ISO-8601
+QDateTime parseTime(const QByteArray &text)
+{
+    bool isMs = false;
+    const qint64 ms = text.toLongLong(&isMs);
+    if (isMs)
+        return QDateTime::fromMSecsSinceEpoch(ms);
+    return QDateTime::fromString(QString::fromLatin1(text), Qt::ISODateWithMs);
+}
+
+// خروجی Excel تاریخ و ساعت محلی را در دو ستون متنی می‌نویسد
+QDateTime cellDateTime(const QVariant &date, const QVariant &time)
+{
+    if (date.metaType().id() == QMetaType::QDateTime)
+        return date.toDateTime();
+
+    QDate d = (date.metaType().id() == QMetaType::QDate)
+                  ? date.toDate()
+                  : QDate::fromString(date.toString(), "yyyy-MM-dd");
+    QTime t = (time.metaType().id() == QMetaType::QTime)
+                  ? time.toTime()
+                  : QTime::fromString(time.toString(), "hh:mm:ss");
+    return QDateTime(d, t);
+}
+
+int labelIndex(const QStringList &labels, const QVariant &cell)
+{
+    return qMax(0, labels.indexOf(cell.toString()));
+}
+
+quint64 seenKey(int type, qint64 seconds)
+{
+    return (quint64(type) << 48) ^ quint64(seconds);
+}
+
+} // namespace
+
+HealthImporter::HealthImporter(const QString &filePath, BatchWriter writer,
+                               ExistingReader reader, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_writer(std::move(writer))
+    , m_reader(std::move(reader))
+{
+    m_pending.reserve(BatchSize);
+}
+
+void HealthImporter::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // ── تشخیص قالب از محتوا — URI های content:// پسوند ندارند ──
+    bool isXlsx = false;
+    {
+        QFile probe(m_filePath);
+        if (probe.open(QIODevice::ReadOnly))
+            isXlsx = probe.peek(2) == "PK";
+    }
+
+    QString error;
+    const bool ok = isXlsx ? importXlsx(&error) : importCsv(&error);
+    if (ok && !m_cancelled)
+        flush();
+
+    m_result.elapsedMs = timer.elapsed();
+    const double seconds = qMax<qint64>(m_result.elapsedMs, 1) / 1000.0;
+    qDebug() << "📥 Import" << (isXlsx ? "xlsx" : "csv") << ":"
+             << m_result.rows << "rows |" << m_result.inserted << "inserted |"
+             << m_result.duplicates << "duplicates |" << m_result.invalid << "invalid |"
+             << m_result.failed << "failed | in" << m_result.elapsedMs << "ms |"
+             << qRound64(m_result.rows / seconds) << "rows/s";
+
+    QString message;
+    if (!ok)
+        message = error;
+    else if (m_cancelled)
+        message = QString("Import cancelled after %1 records").arg(m_result.inserted);
+    else
+        message = QString("%1 records imported\n%2 duplicates, %3 invalid, %4 failed")
+                      .arg(m_result.inserted).arg(m_result.duplicates)
+                      .arg(m_result.invalid).arg(m_result.failed);
+
+    emit finished(ok && !m_cancelled && m_result.failed == 0, message);
+}
+
+bool HealthImporter::importCsv(QString *error)
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Cannot open \"%1\": %2").arg(m_filePath, file.errorString());
+        return false;
+    }
+    const qint64 total = qMax<qint64>(file.size(), 1);
+
+    // ── هدر ──
+    QList<QByteArray> header = file.readLine().trimmed().split(',');
+    for (QByteArray &h : header)
+        h = unquote(h).toLower();
+
+    const int metricCol = int(header.indexOf("metric"));
+    const int fieldCol  = int(header.indexOf("field"));
+    int timeCol         = int(header.indexOf("time_ms"));
+    if (timeCol < 0)
+        timeCol = int(header.indexOf("time"));
+    const int valueCol  = int(header.indexOf("value"));
+    const int value2Col = int(header.indexOf("value2"));
+
+    if (metricCol < 0 || timeCol < 0 || valueCol < 0) {
+        *error = QString("Unrecognized CSV header — expected metric, time/time_ms and value");
+        return false;
+    }
+    const bool tidy = fieldCol >= 0;
+
+    // ── قالب tidy: فیلدهای یک رکورد در سطرهای پشت‌سرهم آمده‌اند ──
+    HealthMeasurement current {};
+    bool       hasCurrent = false;
+    QByteArray currentKey;
+
+    // readLine() بدون سقف طول — سطرهای پهن یا یادداشت‌های بلند تکه نمی‌شوند
+    while (!file.atEnd()) {
+        if (m_cancelled)
+            return true;
+
+        const QByteArray row = file.readLine().trimmed();
+        if (file.error() != QFileDevice::NoError)
+            break;
+        if (row.isEmpty())
+            continue;
+
+        const QList<QByteArray> f = row.split(',');
+        const QByteArray metric   = unquote(f.value(metricCol));
+        const QByteArray timeText = unquote(f.value(timeCol));
+        const int type = Metric::typeOf(QString::fromLatin1(metric));
+
+        if (tidy) {
+            const QByteArray key = metric + '|' + timeText;
+            if (key != currentKey) {
+                if (hasCurrent)
+                    addMeasurement(current);
+                hasCurrent = false;
+                currentKey = key;
+                if (type == 0) {
+                    m_result.skipped++;
+                    continue;
+                }
+                current      = HealthMeasurement {};
+                current.type = HealthMeasurement::Type(type);
+                current.time = parseTime(timeText);
+                hasCurrent   = true;
+            }
+            if (hasCurrent)
+                applyField(current, unquote(f.value(fieldCol)), unquote(f.value(valueCol)).toDouble());
+        } else {
+            if (type == 0) {
+                m_result.skipped++;
+                continue;
+            }
+            HealthMeasurement m {};
+            m.type  = HealthMeasurement::Type(type);
+            m.time  = parseTime(timeText);
+            m.value = unquote(f.value(valueCol)).toDouble();
+            if (value2Col >= 0)
+                m.value2 = unquote(f.value(value2Col)).toDouble();
+            addMeasurement(m);
+        }
+
+        reportProgress(int(file.pos() * 100 / total));
+    }
+    if (hasCurrent)
+        addMeasurement(current);
+
+    if (file.error() != QFileDevice::NoError) {
+        *error = QString("Read error: %1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool HealthImporter::importXlsx(QString *error)
+{
+    // QXlsx کل workbook را باز می‌کند؛ سطرها از همان‌جا یکی‌یکی خوانده می‌شوند
+    QXlsx::Document xlsx(m_filePath);
+    if (!xlsx.isLoadPackage()) {
+        *error = QString("Cannot read workbook \"%1\"").arg(m_filePath);
+        return false;
+    }
+
+    const QStringList sheets = xlsx.sheetNames();
+    qint64 totalRows = 0;
+    for (const QString &sheet : sheets) {
+        xlsx.selectSheet(sheet);
+        totalRows += qMax(0, xlsx.dimension().lastRow() - 1);
+    }
+    totalRows = qMax<qint64>(totalRows, 1);
+
+    qint64 done = 0;
+    for (const QString &sheet : sheets) {
+        xlsx.selectSheet(sheet);
+        const int lastRow = xlsx.dimension().lastRow();
+        const int type    = Metric::typeOfSheet(sheet);
+
+        if (type == 0) {
+            m_result.skipped += qMax(0, lastRow - 1);
+            done             += qMax(0, lastRow - 1);
+            continue;
+        }
+
+        for (int row = 2; row <= lastRow; ++row) {
+            if (m_cancelled)
+                return true;
+
+            HealthMeasurement m {};
+            m.type = HealthMeasurement::Type(type);
+            m.time = cellDateTime(xlsx.read(row, 1), xlsx.read(row, 2));
+
+            // ستون‌ها همان‌طور که Backend::exportSheet نوشته: واحد نمایش (scale) یا برچسب
+            Metric::visitMetric(type, [&](auto d) {
+                using M = decltype(d);
+                for (std::size_t c = 0; c < std::size(M::columns); ++c) {
+                    const Metric::Column &column = M::columns[c];
+                    const QVariant cell = xlsx.read(row, int(c) + 3);
+                    const double value = column.labels ? double(labelIndex(column.labels(), cell))
+                                                       : cell.toDouble() / column.scale;
+                    Metric::setColumnValue(m, int(c), value);
+                }
+            });
+
+            addMeasurement(m);
+            reportProgress(int(++done * 100 / totalRows));
+        }
+    }
+    return true;
+}
+
+void HealthImporter::addMeasurement(const HealthMeasurement &m)
+{
+    m_result.rows++;
+
+    if (!m.validate().isEmpty()) {
+        m_result.invalid++;
+        return;
+    }
+
+    const quint64 key = seenKey(m.type, m.time.toSecsSinceEpoch());
+    if (m_seen.contains(key)) {
+        m_result.duplicates++;
+        return;
+    }
+    m_seen.insert(key);
+
+    m_pending.append(m);
+    if (m_pending.size() >= BatchSize)
+        flush();
+}
+
+void HealthImporter::flush()
+{
+    if (m_pending.isEmpty())
+        return;
+
+    // ── برای هر نوع یک read روی بازه‌ی همین دسته ──
+    QHash<int, QPair<qint64, qint64>> ranges;
+    for (const HealthMeasurement &m : std::as_const(m_pending)) {
+        const qint64 ms = m.time.toMSecsSinceEpoch();
+        auto it = ranges.find(m.type);
+        if (it == ranges.end()) {
+            ranges.insert(m.type, qMakePair(ms, ms));
+        } else {
+            it->first  = qMin(it->first, ms);
+            it->second = qMax(it->second, ms);
+        }
+    }
+
+    QHash<int, QSet<qint64>> existing;
+    if (m_reader) {
+        for (auto it = ranges.cbegin(); it != ranges.cend(); ++it)
+            existing.insert(it.key(), m_reader(it.key(), it->first, it->second + 999));
+    }
+
+    QList<HealthMeasurement> fresh;
+    fresh.reserve(m_pending.size());
+    for (const HealthMeasurement &m : std::as_const(m_pending)) {
+        auto it = existing.constFind(m.type);
+        if (it != existing.cend() && it->contains(m.time.toSecsSinceEpoch()))
+            m_result.duplicates++;
+        else
+            fresh.append(m);
+    }
+    m_pending.clear();
+
+    if (fresh.isEmpty())
+        return;
+
+    const QList<int> status = m_writer(fresh);
+    for (int s : status) {
+        if (s == StatusOk)
+            m_result.inserted++;
+        else
+            m_result.failed++;
+    }
+    m_result.failed += qMax<qsizetype>(0, fresh.size() - status.size());
+
+    emit progress(qMax(m_lastPercent, 0), m_result.rows, m_result.inserted);
+}
+
+void HealthImporter::reportProgress(int percent)
+{
+    if (percent == m_lastPercent)
+        return;
+    m_lastPercent = percent;
+    emit progress(percent, m_result.rows, m_result.inserted);
+}
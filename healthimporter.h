@@ -0,0 +1,78 @@
+#ifndef HEALTHIMPORTER_H
+#define HEALTHIMPORTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <atomic>
+#include <functional>
+
+#include "healthmeasurement.h"
+
+// ── وارد کردن انبوه از CSV / XLSX ─────────────────────────────
+// روی یک QThread جدا اجرا می‌شود: فایل را سطر به سطر می‌خواند،
+// با همان بازه‌های write* اعتبارسنجی می‌کند، تکراری‌ها (داخل فایل و
+// موجود در Health Connect، با دقت ثانیه) را کنار می‌گذارد و بقیه را
+// در دسته‌های BatchSize تایی به writer می‌دهد.
+//
+// قالب‌های پشتیبانی‌شده:
+//   CSV خروجی همین برنامه:  metric,time_ms,field,value
+//   CSV ساده:               metric,time|time_ms,value[,value2]
+//   XLSX خروجی همین برنامه: شیت‌های "Height Data" و ...
+class HealthImporter : public QObject
+{
+    Q_OBJECT
+public:
+    // دسته را درج می‌کند و وضعیت هر آیتم را برمی‌گرداند (Backend::WriteStatus)
+    using BatchWriter    = std::function<QList<int>(const QList<HealthMeasurement> &)>;
+    // ثانیه‌های epoch رکوردهای موجود از یک نوع در بازه‌ی [fromMs, toMs]
+    using ExistingReader = std::function<QSet<qint64>(int type, qint64 fromMs, qint64 toMs)>;
+
+    struct Result {
+        qint64 rows       = 0;   // سطرهای داده‌ی خوانده‌شده
+        qint64 invalid    = 0;
+        qint64 duplicates = 0;
+        qint64 skipped    = 0;   // متریک‌هایی که import نمی‌شوند (مثلاً قاعدگی)
+        qint64 inserted   = 0;
+        qint64 failed     = 0;
+        qint64 elapsedMs  = 0;
+    };
+
+    static constexpr int BatchSize = 2000;
+
+    HealthImporter(const QString &filePath, BatchWriter writer,
+                   ExistingReader reader, QObject *parent = nullptr);
+
+    const Result &result() const { return m_result; }
+
+    // از هر thread قابل صدا زدن است
+    void cancel() { m_cancelled = true; }
+
+public slots:
+    void run();
+
+signals:
+    void progress(int percent, qint64 rowsRead, qint64 inserted);
+    void finished(bool success, QString message);
+
+private:
+    bool importCsv(QString *error);
+    bool importXlsx(QString *error);
+    void addMeasurement(const HealthMeasurement &m);
+    void flush();
+    void reportProgress(int percent);
+
+    QString        m_filePath;
+    BatchWriter    m_writer;
+    ExistingReader m_reader;
+
+    QList<HealthMeasurement> m_pending;
+    QSet<quint64>            m_seen;      // (type, ثانیه) های همین فایل
+    Result                   m_result;
+    int                      m_lastPercent = -1;
+    std::atomic_bool         m_cancelled { false };
+};
+
+#endif // HEALTHIMPORTER_H
@@ -0,0 +1,82 @@
+#include "healthmeasurement.h"
+
+QString HealthMeasurement::validate() const
+{
+    if (!time.isValid())
+        return QString("زمان اندازه‌گیری نامعتبر است");
+
+    switch (type) {
+    case Height:
+        if (value < 0.1 || value > 3)
+            return QString("مقدار قد نامعتبر است: %1 متر").arg(value);
+        break;
+    case Weight:
+        if (value < 0.1 || value > 300.0)
+            return QString("مقدار وزن نامعتبر است: %1 کیلوگرم").arg(value);
+        break;
+    case BloodPressure:
+        if (value < 80 || value > 200)
+            return QString("مقدار فشار سیستولیک نامعتبر است: %1 mmHg").arg(value);
+        if (value2 < 40 || value2 > 130)
+            return QString("مقدار فشار دیاستولیک نامعتبر است: %1 mmHg").arg(value2);
+        if (value <= value2)
+            return QString("فشار سیستولیک باید بزرگتر از دیاستولیک باشد");
+        break;
+    case HeartRate:
+        if (value < 30 || value > 250)
+            return QString("مقدار ضربان قلب نامعتبر است: %1 bpm").arg(value);
+        break;
+    case BloodGlucose:
+        if (value < 20.0 || value > 600.0)
+            return QString("مقدار قند خون نامعتبر: %1 mg/dL").arg(value);
+        break;
+    case OxygenSaturation:
+        if (value < 50.0 || value > 100.0)
+            return QString("مقدار اشباع اکسیژن نامعتبر است: %1%").arg(value);
+        break;
+    case MenstruationFlow:
+        if (value < 1 || value > 3)
+            return QString("سطح خونریزی نامعتبر است: %1 (باید ۱ تا ۳ باشد)").arg(value);
+        break;
+    case MenstruationPeriod: {
+        const qint64 startMs = time.toMSecsSinceEpoch();
+        const qint64 endMs   = qint64(value2);
+        if (endMs <= startMs)
+            return QString("تاریخ پایان نمی‌تواند قبل از تاریخ شروع باشد");
+        const qint64 days = (endMs - startMs) / (24 * 3600 * 1000LL);
+        if (days > 15)
+            return QString("طول دوره نامعتبر است: %1 روز (حداکثر ۱۵ روز)").arg(days);
+        break;
+    }
+    default:
+        return QString("نوع اندازه‌گیری نامعتبر است: %1").arg(int(type));
+    }
+    return QString();
+}
+
+const QStringList &HealthMeasurement::specimenLabels()
+{
+    static const QStringList labels = {
+        "Unknown", "Interstitial Fluid", "Capillary Blood",
+        "Plasma",  "Serum",              "Tears",
+        "Whole Blood"
+    };
+    return labels;
+}
+
+const QStringList &HealthMeasurement::mealLabels()
+{
+    static const QStringList labels = {
+        "Unknown", "Before Meal", "After Meal", "Fasting"
+    };
+    return labels;
+}
+
+const QStringList &HealthMeasurement::relationLabels()
+{
+    static const QStringList labels = {
+        "Unknown", "Before Meal", "After Meal",
+        "Fasting", "General"
+    };
+    return labels;
+}
@@ -0,0 +1,40 @@
+#ifndef HEALTHMEASUREMENT_H
+#define HEALTHMEASUREMENT_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+// ── یک اندازه‌گیری برای writeBatch و import ───────────────────
+// مقادیر Type با BATCH_* در HealthBridge.kt یکی است
+struct HealthMeasurement {
+    enum Type {
+        Height           = 1,   // value = متر
+        Weight           = 2,   // value = کیلوگرم
+        BloodPressure    = 3,   // value = systolic, value2 = diastolic
+        HeartRate        = 4,   // value = bpm
+        BloodGlucose     = 5,   // value = mg/dL
+        OxygenSaturation = 6,   // value = درصد
+        // قاعدگی: فقط از صف نوشتن، سری چارت ندارند
+        MenstruationFlow   = 7, // value = شدت ۱ تا ۳
+        MenstruationPeriod = 8  // time = شروع، value2 = پایان (epoch ms)
+    };
+
+    Type      type;
+    QDateTime time;
+    double    value  = 0.0;
+    double    value2 = 0.0;
+    int       specimenSource = 2;
+    int       mealType       = 0;
+    int       relationToMeal = 0;
+
+    // همان بازه‌های write* تکی؛ رشته‌ی خالی یعنی معتبر
+    QString validate() const;
+
+    // برچسب‌های ستون‌های قند خون در فایل Excel — اندیس = مقدار Health Connect
+    static const QStringList &specimenLabels();
+    static const QStringList &mealLabels();
+    static const QStringList &relationLabels();
+};
+
+#endif // HEALTHMEASUREMENT_H
@@ -0,0 +1,35 @@
+#ifndef LATESTREADING_H
+#define LATESTREADING_H
+
+#include <QDateTime>
+#include <QList>
+#include <QMetaType>
+#include <QPointF>
+
+// ── آخرین اندازه‌گیری یک متریک برای خلاصه‌ی داشبورد ─────────
+// از QML مثل myBackend.latestWeight.value خوانده می‌شود.
+struct LatestReading
+{
+    Q_GADGET
+    Q_PROPERTY(bool valid MEMBER valid)
+    Q_PROPERTY(QDateTime time MEMBER time)
+    Q_PROPERTY(double value MEMBER value)
+    Q_PROPERTY(double value2 MEMBER value2)
+    Q_PROPERTY(QList<QPointF> recent MEMBER recent)
+
+public:
+    bool           valid  = false;
+    QDateTime      time;
+    double         value  = 0;   // واحد همان HealthMeasurement::Type
+    double         value2 = 0;   // فشار خون: diastolic
+    QList<QPointF> recent;       // چند اندازه‌گیری آخر، نزولی — x = ms
+
+    bool operator==(const LatestReading &o) const
+    {
+        return valid == o.valid && time == o.time && value == o.value
+               && value2 == o.value2 && recent == o.recent;
+    }
+    bool operator!=(const LatestReading &o) const { return !(*this == o); }
+};
+
+#endif // LATESTREADING_H
@@ -6,9 +6,24 @@
 #include <QOpenGLContext>      // ✅ اضافه کن
 
 #include "backend.h"
+#include "headlessrunner.h"
+#include "tracer.h"
 
 int main(int argc, char *argv[])
 {
+    // ── --headless: فقط QCoreApplication، بدون scenegraph و OpenGL ──
+    if (HeadlessRunner::requested(argc, argv))
+        return HeadlessRunner::run(argc, argv);
+
+    // ── QMLHC_TRACE=1: مراحل راه‌اندازی پشت سر هم در path/trace.json ──
+    // (تنظیم debug/trace فقط از ساخت Backend به بعد را می‌گیرد)
+    qint64 stepUs = Tracer::nowUs();
+    auto traceStep = [&stepUs](const char *name) {
+        const qint64 now = Tracer::nowUs();
+        Tracer::complete("startup", QString::fromLatin1(name), stepUs, now - stepUs);
+        stepUs = now;
+    };
+
     // ✅ قبل از ساخت QApplication
     QSurfaceFormat format;
 
@@ -35,16 +50,19 @@ int main(int argc, char *argv[])
 #endif
 
     QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);  // مهم!
+    traceStep("surfaceFormat");
 
 
 
     // Qt Charts uses Qt Graphics View Framework for drawing, therefore QApplication must be used.
     QApplication app(argc, argv);
+    traceStep("QApplication");
 
     // ✅ چک کردن OpenGL support
     qDebug() << "OpenGL Version:" << QOpenGLContext::openGLModuleType();
 
     Backend *myBackend = new Backend(&app);
+    traceStep("Backend");
 
     QQuickView viewer;
 
@@ -64,10 +82,13 @@ int main(int argc, char *argv[])
     viewer.engine()->addImportPath(extraImportPath.arg(QGuiApplication::applicationDirPath(),
                                                        QString::fromLatin1("qml")));
     QObject::connect(viewer.engine(), &QQmlEngine::quit, &viewer, &QWindow::close);
+    traceStep("QQuickView");
 
     viewer.setTitle(QStringLiteral("Qt Charts QML Example Gallery"));
-    viewer.setSource(QUrl("qrc:/Main.qml"));
+    viewer.loadFromModule("QMLHealthConnect", "Main");   // از پیش کامپایل‌شده — CMakeLists.txt
+    traceStep("loadFromModule");
     viewer.setResizeMode(QQuickView::SizeRootObjectToView);
+    myBackend->trackFirstPaint(&viewer);
 
     // // ✅ چک نهایی OpenGL
     // if (viewer.openglContext()) {
@@ -79,6 +100,7 @@ int main(int argc, char *argv[])
     // }
 
     viewer.show();
+    traceStep("show");
 
     return app.exec();
 }
@@ -0,0 +1,117 @@
+#include "menstruationmodel.h"
+
+#include <QVariantMap>
+
+#include <algorithm>
+
+MenstruationModel::MenstruationModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int MenstruationModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_periods.size());
+}
+
+QVariant MenstruationModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_periods.size())
+        return {};
+
+    const Period &p = m_periods.at(index.row());
+    switch (role) {
+    case StartMsRole:   return p.startMs;
+    case EndMsRole:     return p.endMs;
+    case FlowCountRole: return int(p.flowCount);
+    case FlowsRole: {
+        QVariantList flows;
+        flows.reserve(p.flowCount);
+        for (qsizetype i = p.firstFlow; i < p.firstFlow + p.flowCount; ++i)
+            flows.append(QVariantMap{{"time", m_flows.at(i).timeMs}, {"level", m_flows.at(i).level}});
+        return flows;
+    }
+    }
+    return {};
+}
+
+QHash<int, QByteArray> MenstruationModel::roleNames() const
+{
+    return {
+        {StartMsRole,   "startMs"},
+        {EndMsRole,     "endMs"},
+        {FlowCountRole, "flowCount"},
+        {FlowsRole,     "flows"}
+    };
+}
+
+void MenstruationModel::setPeriods(QList<Period> periods, QList<Flow> flows)
+{
+    std::sort(periods.begin(), periods.end(),
+              [](const Period &a, const Period &b) { return a.startMs < b.startMs; });
+    std::sort(flows.begin(), flows.end(),
+              [](const Flow &a, const Flow &b) { return a.timeMs < b.timeMs; });
+
+    // ── merge-join: اولین flow ی هر دوره فقط جلو می‌رود ──
+    // دوره‌های هم‌پوشان flow های مشترک را هر دو می‌بینند (مثل قبل در QML)؛
+    // چون flow های هر دوره پشت سر هم‌اند، بازه‌ی [firstFlow, +flowCount) کافی است
+    qsizetype first = 0;
+    qint64 maxSpan = 0;
+    for (Period &p : periods) {
+        while (first < flows.size() && flows.at(first).timeMs < p.startMs)
+            ++first;
+        qsizetype last = first;
+        while (last < flows.size() && flows.at(last).timeMs <= p.endMs)
+            ++last;
+        p.firstFlow = first;
+        p.flowCount = last - first;
+        maxSpan = qMax(maxSpan, p.endMs - p.startMs);
+    }
+
+    const bool countChanging = periods.size() != m_periods.size();
+    beginResetModel();
+    m_periods   = std::move(periods);
+    m_flows     = std::move(flows);
+    m_maxSpanMs = maxSpan;
+    endResetModel();
+    if (countChanging)
+        emit countChanged();
+}
+
+void MenstruationModel::clear()
+{
+    setPeriods({}, {});
+}
+
+QList<qreal> MenstruationModel::segments(qreal fromMs, qreal toMs) const
+{
+    QList<qreal> out;
+
+    // اولین دوره‌ای که ممکن است تا fromMs ادامه داشته باشد
+    const qint64 earliestStart = qint64(fromMs) - m_maxSpanMs;
+    auto it = std::lower_bound(m_periods.cbegin(), m_periods.cend(), earliestStart,
+                               [](const Period &p, qint64 ms) { return p.startMs < ms; });
+
+    for (; it != m_periods.cend() && it->startMs <= toMs; ++it) {
+        const Period &p = *it;
+        if (p.endMs < fromMs)
+            continue;
+
+        if (p.flowCount == 0) {
+            out << qreal(p.startMs) << qreal(p.endMs) << -1;
+            continue;
+        }
+
+        // هر بخش از flow قبلی تا همین flow، با سطح همین flow؛
+        // اولی از شروع دوره و آخری تا پایان دوره
+        for (qsizetype j = 0; j < p.flowCount; ++j) {
+            const Flow &f = m_flows.at(p.firstFlow + j);
+            const qint64 segStart = (j == 0) ? p.startMs : m_flows.at(p.firstFlow + j - 1).timeMs;
+            const qint64 segEnd   = (j == p.flowCount - 1) ? p.endMs : f.timeMs;
+            if (segEnd < fromMs || segStart > toMs)
+                continue;
+            out << qreal(segStart) << qreal(segEnd) << qBound(0, f.level, 3);
+        }
+    }
+    return out;
+}
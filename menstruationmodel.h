@@ -0,0 +1,62 @@
+#ifndef MENSTRUATIONMODEL_H
+#define MENSTRUATIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QVariantList>
+
+// ── دوره‌های قاعدگی با flow های هر دوره، برای PeriodTimebar ──
+// هر سطر یک دوره است. flow ها یک بار در setPeriods با merge-join روی
+// آرایه‌های مرتب به دوره‌ها وصل می‌شوند — O(P + F) به جای P × F.
+class MenstruationModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    struct Flow {
+        qint64 timeMs;
+        int    level;   // 0=UNKNOWN, 1=LIGHT, 2=MEDIUM, 3=HEAVY
+    };
+    struct Period {
+        qint64 startMs;
+        qint64 endMs;
+        qsizetype firstFlow = 0;   // اندیس در m_flows
+        qsizetype flowCount = 0;
+    };
+
+    enum Roles {
+        StartMsRole = Qt::UserRole + 1,
+        EndMsRole,
+        FlowCountRole,
+        FlowsRole          // [{time, level}] — فقط برای delegate ها؛ رسم از segments
+    };
+
+    explicit MenstruationModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    int count() const { return int(m_periods.size()); }
+
+    // ورودی‌ها لازم نیست مرتب باشند
+    void setPeriods(QList<Period> periods, QList<Flow> flows);
+    void clear();
+
+    const QList<Period> &periods() const { return m_periods; }
+    const QList<Flow>   &flows() const { return m_flows; }
+
+    // بخش‌های رنگی قابل‌مشاهده در [fromMs, toMs] به‌صورت
+    // [start, end, level, start, end, level, ...]؛ level = -1 یعنی دوره بدون flow
+    Q_INVOKABLE QList<qreal> segments(qreal fromMs, qreal toMs) const;
+
+signals:
+    void countChanged();
+
+private:
+    QList<Period> m_periods;   // مرتب بر اساس startMs
+    QList<Flow>   m_flows;     // مرتب بر اساس timeMs
+    qint64        m_maxSpanMs = 0;   // طولانی‌ترین دوره — برای جستجوی دودویی
+};
+
+#endif // MENSTRUATIONMODEL_H
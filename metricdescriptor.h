@@ -0,0 +1,294 @@
+#ifndef METRICDESCRIPTOR_H
+#define METRICDESCRIPTOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <iterator>
+
+#include "healthmeasurement.h"
+#include "seriesexporter.h"
+
+// ── جدول compile-time متریک‌ها ───────────────────────────────
+// هر متریک یک Metric::Descriptor<Type> دارد: کلید (تنظیمات، CLI، جدول‌های
+// خروجی)، نام نوع در bridge، پشتیبانی از aggregate، شکل و نام سری‌های
+// موازی (Backend، snapshot)، ستون‌ها و رنگ شیت. مراحل decode
+// (Backend::toChunk)، store (appendChunk، addLocalPoint) و export
+// (Backend::exportSheet، writeSeries) template هایی روی Descriptor اند:
+// نوع فقط یک بار برای هر صفحه/شیت dispatch می‌شود و حلقه‌ی هر نقطه
+// نه شرطی روی نوع دارد و نه جستجوی رشته‌ای.
+//
+// متریک جدید: یک Descriptor، یک خط در forEachMetric، عضوهای سری‌اش در
+// Backend::seriesMembers و سری‌های چارتش در HealthChartView.metricView.
+// وارد کردن (healthimporter) و HealthBridge هم از همین جدول می‌خوانند.
+namespace Metric {
+
+// سری‌های موازی هم‌اندیس با سری اصلی — همان فیلدهای Backend::SeriesChunk
+enum Shape {
+    Single  = 0,   // values
+    Pair    = 1,   // values + values2 (Page::values2)
+    Glucose = 2    // values + specimen/meal/relation (Page::extras)
+};
+
+struct Column {
+    const char                 *name;             // CSV/NDJSON/HCOL
+    SeriesExporter::ColumnType  type;
+    const char                 *header;           // XLSX
+    int                         width;
+    double                      scale   = 1.0;    // XLSX: واحد نمایش
+    bool                        integer = false;
+    const QStringList        &(*labels)() = nullptr;   // XLSX: اندیس → متن
+};
+
+template <int Type> struct Descriptor;
+
+template <> struct Descriptor<HealthMeasurement::Height> {
+    static constexpr int         type        = HealthMeasurement::Height;
+    static constexpr const char *typeName    = "Height";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = false;
+    static constexpr const char *key         = "height";
+    static constexpr Shape       shape       = Single;
+    static constexpr int         decimals    = 3;          // m
+    static constexpr const char *sheet       = "Height Data";
+    static constexpr const char *headerColor = "#1565C0";
+    static constexpr const char *oddRowColor = "#E3F2FD";
+    static constexpr const char *series[]    = {"height"};
+    static constexpr Column      columns[]   = {
+        {"height_m", SeriesExporter::Float64, "Height (cm)", 14, 100.0}
+    };
+};
+
+template <> struct Descriptor<HealthMeasurement::Weight> {
+    static constexpr int         type        = HealthMeasurement::Weight;
+    static constexpr const char *typeName    = "Weight";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = false;
+    static constexpr const char *key         = "weight";
+    static constexpr Shape       shape       = Single;
+    static constexpr int         decimals    = 2;          // kg
+    static constexpr const char *sheet       = "Weight Data";
+    static constexpr const char *headerColor = "#2E7D32";
+    static constexpr const char *oddRowColor = "#E8F5E9";
+    static constexpr const char *series[]    = {"weight"};
+    static constexpr Column      columns[]   = {
+        {"weight_kg", SeriesExporter::Float64, "Weight (kg)", 14}
+    };
+};
+
+template <> struct Descriptor<HealthMeasurement::BloodPressure> {
+    static constexpr int         type        = HealthMeasurement::BloodPressure;
+    static constexpr const char *typeName    = "BloodPressure";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = true;
+    static constexpr const char *key         = "bloodPressure";
+    static constexpr Shape       shape       = Pair;
+    static constexpr int         decimals    = 0;          // mmHg
+    static constexpr const char *sheet       = "Blood Pressure Data";
+    static constexpr const char *headerColor = "#B71C1C";
+    static constexpr const char *oddRowColor = "#FFEBEE";
+    static constexpr const char *series[]    = {"bpSystolic", "bpDiastolic"};
+    static constexpr Column      columns[]   = {
+        {"systolic_mmhg",  SeriesExporter::Float64, "Systolic (mmHg)",  18},
+        {"diastolic_mmhg", SeriesExporter::Float64, "Diastolic (mmHg)", 18}
+    };
+};
+
+template <> struct Descriptor<HealthMeasurement::BloodGlucose> {
+    static constexpr int         type        = HealthMeasurement::BloodGlucose;
+    static constexpr const char *typeName    = "BloodGlucose";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = true;
+    static constexpr const char *key         = "bloodGlucose";
+    static constexpr Shape       shape       = Glucose;
+    static constexpr int         decimals    = 1;          // mg/dL
+    static constexpr const char *sheet       = "Blood Glucose Data";
+    static constexpr const char *headerColor = "#4A148C";
+    static constexpr const char *oddRowColor = "#F3E5F5";
+    static constexpr const char *series[]    = {"bloodGlucose", "bgSpecimen", "bgMeal", "bgRelation"};
+    static constexpr Column      columns[]   = {
+        {"glucose_mgdl",     SeriesExporter::Float64, "Glucose (mg/dL)",  18},
+        {"specimen_source",  SeriesExporter::UInt8,   "Specimen Source",  18, 1.0, true,
+         &HealthMeasurement::specimenLabels},
+        {"meal_type",        SeriesExporter::UInt8,   "Meal Type",        14, 1.0, true,
+         &HealthMeasurement::mealLabels},
+        {"relation_to_meal", SeriesExporter::UInt8,   "Relation to Meal", 18, 1.0, true,
+         &HealthMeasurement::relationLabels}
+    };
+};
+
+template <> struct Descriptor<HealthMeasurement::HeartRate> {
+    static constexpr int         type        = HealthMeasurement::HeartRate;
+    static constexpr const char *typeName    = "HeartRate";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = true;
+    static constexpr const char *key         = "heartRate";
+    static constexpr Shape       shape       = Single;
+    static constexpr int         decimals    = 0;          // bpm
+    static constexpr const char *sheet       = "Heart Rate Data";
+    static constexpr const char *headerColor = "#E65100";
+    static constexpr const char *oddRowColor = "#FFF3E0";
+    static constexpr const char *series[]    = {"heartRate"};
+    static constexpr Column      columns[]   = {
+        {"bpm", SeriesExporter::Float64, "BPM", 10, 1.0, true}
+    };
+};
+
+template <> struct Descriptor<HealthMeasurement::OxygenSaturation> {
+    static constexpr int         type        = HealthMeasurement::OxygenSaturation;
+    static constexpr const char *typeName    = "OxygenSaturation";   // HealthBridge / Kotlin
+    static constexpr bool        aggregate   = true;
+    static constexpr const char *key         = "oxygenSaturation";
+    static constexpr Shape       shape       = Single;
+    static constexpr int         decimals    = 1;          // %
+    static constexpr const char *sheet       = "Oxygen Saturation Data";
+    static constexpr const char *headerColor = "#006064";
+    static constexpr const char *oddRowColor = "#E0F7FA";
+    static constexpr const char *series[]    = {"oxygenSaturation"};
+    static constexpr Column      columns[]   = {
+        {"percentage", SeriesExporter::Float64, "Oxygen Saturation (%)", 22}
+    };
+};
+
+// f(Descriptor<T>()) برای همه‌ی متریک‌ها — ترتیب شیت‌ها و جدول‌های خروجی
+template <typename F>
+void forEachMetric(F &&f)
+{
+    f(Descriptor<HealthMeasurement::Height>());
+    f(Descriptor<HealthMeasurement::Weight>());
+    f(Descriptor<HealthMeasurement::BloodPressure>());
+    f(Descriptor<HealthMeasurement::BloodGlucose>());
+    f(Descriptor<HealthMeasurement::HeartRate>());
+    f(Descriptor<HealthMeasurement::OxygenSaturation>());
+}
+
+// f(Descriptor<type>()) برای type ی زمان اجرا؛ false اگر type متریک نباشد
+template <typename F>
+bool visitMetric(int type, F &&f)
+{
+    bool found = false;
+    forEachMetric([&](auto m) {
+        if (decltype(m)::type == type) {
+            f(m);
+            found = true;
+        }
+    });
+    return found;
+}
+
+inline const QList<int> &allTypes()
+{
+    static const QList<int> types = [] {
+        QList<int> out;
+        forEachMetric([&out](auto m) { out.append(decltype(m)::type); });
+        return out;
+    }();
+    return types;
+}
+
+// "height"، "bloodPressure"، …؛ nullptr اگر type متریک نباشد
+inline const char *key(int type)
+{
+    const char *out = nullptr;
+    visitMetric(type, [&out](auto m) { out = decltype(m)::key; });
+    return out;
+}
+
+// 0 اگر key متریک نباشد
+inline int typeOf(const QString &key)
+{
+    int out = 0;
+    forEachMetric([&](auto m) {
+        if (key == QLatin1String(decltype(m)::key))
+            out = decltype(m)::type;
+    });
+    return out;
+}
+
+// "Height"، "BloodPressure"، …؛ nullptr اگر type متریک نباشد
+inline const char *typeName(int type)
+{
+    const char *out = nullptr;
+    visitMetric(type, [&out](auto m) { out = decltype(m)::typeName; });
+    return out;
+}
+
+inline bool supportsAggregate(int type)
+{
+    bool out = false;
+    visitMetric(type, [&out](auto m) { out = decltype(m)::aggregate; });
+    return out;
+}
+
+// نام شیت XLSX، یا بخش‌های بعدی‌اش ("<sheet>_2"، …)؛ 0 اگر شیت متریک نباشد
+inline int typeOfSheet(const QString &sheet)
+{
+    int out = 0;
+    forEachMetric([&](auto m) {
+        const QString name = QString::fromLatin1(decltype(m)::sheet);
+        if (sheet == name)
+            out = decltype(m)::type;
+        else if (sheet.startsWith(name + QLatin1Char('_'))) {
+            bool isPart = false;
+            sheet.mid(name.size() + 1).toInt(&isPart);
+            if (isPart)
+                out = decltype(m)::type;
+        }
+    });
+    return out;
+}
+
+// اندیس ستون با نام CSV/NDJSON؛ -1 اگر نباشد
+inline int columnOf(int type, const QByteArray &name)
+{
+    int out = -1;
+    visitMetric(type, [&](auto m) {
+        using M = decltype(m);
+        for (std::size_t c = 0; c < std::size(M::columns); ++c) {
+            if (name == M::columns[c].name)
+                out = int(c);
+        }
+    });
+    return out;
+}
+
+inline Shape shapeOf(int type)
+{
+    Shape out = Single;
+    visitMetric(type, [&out](auto m) { out = decltype(m)::shape; });
+    return out;
+}
+
+// مقدارهای سری‌های موازی یک اندازه‌گیری، به ترتیب columns[1..]
+inline QList<double> parallelValues(const HealthMeasurement &m)
+{
+    switch (shapeOf(m.type)) {
+    case Pair:    return {m.value2};
+    case Glucose: return {double(m.specimenSource), double(m.mealType), double(m.relationToMeal)};
+    case Single:  break;
+    }
+    return {};
+}
+
+// عکس parallelValues: ستون column ی Descriptor (0 = value)
+inline void setColumnValue(HealthMeasurement &m, int column, double value)
+{
+    if (column <= 0) {
+        m.value = value;
+        return;
+    }
+    switch (shapeOf(m.type)) {
+    case Pair:
+        m.value2 = value;
+        break;
+    case Glucose:
+        if (column == 1)      m.specimenSource = int(value);
+        else if (column == 2) m.mealType       = int(value);
+        else                  m.relationToMeal = int(value);
+        break;
+    case Single:
+        m.value = value;
+        break;
+    }
+}
+
+} // namespace Metric
+
+#endif // METRICDESCRIPTOR_H
@@ -0,0 +1,72 @@
+#include "metricsmodel.h"
+
+MetricsModel::MetricsModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_timer(this)
+{
+    m_rows.resize(StageMetrics::StageCount);
+    m_timer.setInterval(RefreshMs);
+    connect(&m_timer, &QTimer::timeout, this, &MetricsModel::refresh);
+    refresh();
+}
+
+int MetricsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+QVariant MetricsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return {};
+
+    const StageMetrics::Summary &s = m_rows.at(index.row());
+    switch (role) {
+    case NameRole:   return QString::fromLatin1(StageMetrics::stageName(s.stage));
+    case CountRole:  return qint64(s.count);
+    case ItemsRole:  return qint64(s.items);
+    case MeanMsRole: return s.meanUs() / 1000.0;
+    case P50MsRole:  return s.p50Us / 1000.0;
+    case P90MsRole:  return s.p90Us / 1000.0;
+    case P99MsRole:  return s.p99Us / 1000.0;
+    case MaxMsRole:  return s.maxUs / 1000.0;
+    case RateRole:   return s.itemsPerSecond();
+    }
+    return {};
+}
+
+QHash<int, QByteArray> MetricsModel::roleNames() const
+{
+    return {
+        {NameRole,   "name"},
+        {CountRole,  "count"},
+        {ItemsRole,  "items"},
+        {MeanMsRole, "meanMs"},
+        {P50MsRole,  "p50Ms"},
+        {P90MsRole,  "p90Ms"},
+        {P99MsRole,  "p99Ms"},
+        {MaxMsRole,  "maxMs"},
+        {RateRole,   "rate"}
+    };
+}
+
+void MetricsModel::setActive(bool active)
+{
+    if (active == isActive())
+        return;
+    if (active) {
+        refresh();
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+    emit activeChanged();
+}
+
+void MetricsModel::refresh()
+{
+    for (int i = 0; i < StageMetrics::StageCount; ++i)
+        m_rows[i] = StageMetrics::summary(StageMetrics::Stage(i));
+    if (!m_rows.isEmpty())
+        emit dataChanged(index(0), index(int(m_rows.size()) - 1));
+}
@@ -0,0 +1,53 @@
+#ifndef METRICSMODEL_H
+#define METRICSMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QTimer>
+
+#include "stagemetrics.h"
+
+// ── StageMetrics برای overlay ی debug در QML ─────────────────
+// هر سطر یک مرحله است. تا وقتی active است هر RefreshMs یک بار
+// خلاصه‌ها دوباره خوانده می‌شوند؛ مسیر داده هیچ‌وقت منتظر model نمی‌ماند.
+class MetricsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+
+public:
+    static constexpr int RefreshMs = 1000;
+
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        CountRole,
+        ItemsRole,
+        MeanMsRole,
+        P50MsRole,
+        P90MsRole,
+        P99MsRole,
+        MaxMsRole,
+        RateRole            // items در ثانیه‌ی زمان همان مرحله
+    };
+
+    explicit MetricsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool isActive() const { return m_timer.isActive(); }
+    void setActive(bool active);
+
+public slots:
+    void refresh();
+
+signals:
+    void activeChanged();
+
+private:
+    QList<StageMetrics::Summary> m_rows;
+    QTimer m_timer;
+};
+
+#endif // METRICSMODEL_H
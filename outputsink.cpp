@@ -0,0 +1,303 @@
+#include "outputsink.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#ifdef Q_OS_ANDROID
+#include <QCoreApplication>
+#include <QtCore/qnativeinterface.h>
+#endif
+
+OutputSink *OutputSink::createDownloadsSink(const QString &fileName,
+                                            const QString &mimeType,
+                                            QObject *parent)
+{
+#ifdef Q_OS_ANDROID
+    return new MediaStoreSink(fileName, mimeType, parent);
+#else
+    Q_UNUSED(mimeType)
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
+    if (dir.isEmpty())
+        dir = QDir::homePath();
+    return new LocalFileSink(QDir(dir).filePath(fileName), parent);
+#endif
+}
+
+// ─────────────────────────────────────────────────────────────
+// LocalFileSink
+// ─────────────────────────────────────────────────────────────
+LocalFileSink::LocalFileSink(const QString &filePath, QObject *parent)
+    : OutputSink(parent)
+    , m_file(filePath)
+{
+}
+
+bool LocalFileSink::open(OpenMode mode)
+{
+    if (mode & ReadOnly)
+        return false;
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        setErrorString(m_file.errorString());
+        qWarning() << "Cannot open output file:" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    return OutputSink::open(WriteOnly | Unbuffered);
+}
+
+qint64 LocalFileSink::writeData(const char *data, qint64 len)
+{
+    const qint64 n = m_file.write(data, len);
+    if (n < 0)
+        setErrorString(m_file.errorString());
+    return n;
+}
+
+bool LocalFileSink::commit()
+{
+    if (!isOpen())
+        return false;
+    OutputSink::close();
+
+    if (!m_file.commit()) {
+        setErrorString(m_file.errorString());
+        qWarning() << "Cannot commit output file:" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void LocalFileSink::discard()
+{
+    m_file.cancelWriting();
+    if (m_file.isOpen())
+        m_file.commit();   // با cancelWriting فقط فایل موقت پاک می‌شود
+    if (isOpen())
+        OutputSink::close();
+}
+
+#ifdef Q_OS_ANDROID
+// ─────────────────────────────────────────────────────────────
+// MediaStoreSink
+// ─────────────────────────────────────────────────────────────
+MediaStoreSink::MediaStoreSink(const QString &displayName, const QString &mimeType,
+                               QObject *parent)
+    : OutputSink(parent)
+    , m_displayName(displayName)
+    , m_mimeType(mimeType)
+{
+}
+
+MediaStoreSink::~MediaStoreSink()
+{
+    if (isOpen())
+        discard();
+    releaseStream();
+}
+
+bool MediaStoreSink::open(OpenMode mode)
+{
+    if (mode & ReadOnly)
+        return false;
+
+    QJniEnvironment env;
+
+    // ─── ContentValues ───
+    QJniObject contentValues("android/content/ContentValues");
+
+    contentValues.callMethod<void>("put",
+                                   "(Ljava/lang/String;Ljava/lang/String;)V",
+                                   QJniObject::fromString("_display_name").object<jstring>(),
+                                   QJniObject::fromString(m_displayName).object<jstring>());
+
+    contentValues.callMethod<void>("put",
+                                   "(Ljava/lang/String;Ljava/lang/String;)V",
+                                   QJniObject::fromString("mime_type").object<jstring>(),
+                                   QJniObject::fromString(m_mimeType).object<jstring>());
+
+    // Android 10+ — مسیر داخل Downloads
+    contentValues.callMethod<void>("put",
+                                   "(Ljava/lang/String;Ljava/lang/String;)V",
+                                   QJniObject::fromString("relative_path").object<jstring>(),
+                                   QJniObject::fromString("Download/").object<jstring>());
+
+    // تا commit، فایل برای بقیه‌ی برنامه‌ها pending است
+    QJniObject one = QJniObject::callStaticObjectMethod("java/lang/Integer", "valueOf",
+                                                        "(I)Ljava/lang/Integer;", jint(1));
+    contentValues.callMethod<void>("put",
+                                   "(Ljava/lang/String;Ljava/lang/Integer;)V",
+                                   QJniObject::fromString("is_pending").object<jstring>(),
+                                   one.object());
+
+    // ─── ContentResolver ───
+    QJniObject context = QNativeInterface::QAndroidApplication::context();
+    m_resolver = context.callObjectMethod("getContentResolver",
+                                          "()Landroid/content/ContentResolver;");
+
+    // ─── MediaStore Downloads URI ───
+    QJniObject downloadsUri = QJniObject::callStaticObjectMethod(
+        "android/provider/MediaStore$Downloads",
+        "getContentUri",
+        "(Ljava/lang/String;)Landroid/net/Uri;",
+        QJniObject::fromString("external").object<jstring>());
+
+    // ─── Insert و دریافت URI فایل مقصد ───
+    m_uri = m_resolver.callObjectMethod(
+        "insert",
+        "(Landroid/net/Uri;Landroid/content/ContentValues;)Landroid/net/Uri;",
+        downloadsUri.object(),
+        contentValues.object());
+
+    if (env.checkAndClearExceptions() || !m_uri.isValid()) {
+        setErrorString("MediaStore insert failed");
+        qWarning() << "MediaStore insert failed";
+        return false;
+    }
+
+    m_stream = m_resolver.callObjectMethod("openOutputStream",
+                                           "(Landroid/net/Uri;)Ljava/io/OutputStream;",
+                                           m_uri.object());
+
+    if (env.checkAndClearExceptions() || !m_stream.isValid()) {
+        setErrorString("Cannot open OutputStream");
+        qWarning() << "Cannot open OutputStream";
+        m_resolver.callMethod<jint>("delete",
+                                    "(Landroid/net/Uri;Ljava/lang/String;[Ljava/lang/String;)I",
+                                    m_uri.object(), jstring(nullptr), jobjectArray(nullptr));
+        env.checkAndClearExceptions();
+        m_uri = QJniObject();
+        return false;
+    }
+
+    // ─── یک آرایه‌ی جاوا برای کل عمر sink ───
+    jbyteArray local = env->NewByteArray(ChunkSize);
+    m_chunk = static_cast<jbyteArray>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+
+    m_buffer.resize(ChunkSize);
+    m_used   = 0;
+    m_failed = false;
+
+    return OutputSink::open(WriteOnly | Unbuffered);
+}
+
+qint64 MediaStoreSink::writeData(const char *data, qint64 len)
+{
+    if (m_failed)
+        return -1;
+
+    qint64 remaining = len;
+    while (remaining > 0) {
+        const qsizetype n = qMin<qint64>(ChunkSize - m_used, remaining);
+        memcpy(m_buffer.data() + m_used, data, n);
+        m_used    += n;
+        data      += n;
+        remaining -= n;
+
+        if (m_used == ChunkSize && !flushChunk())
+            return -1;
+    }
+    return len;
+}
+
+bool MediaStoreSink::flushChunk()
+{
+    if (m_used == 0)
+        return true;
+
+    QJniEnvironment env;
+    env->SetByteArrayRegion(m_chunk, 0, jsize(m_used),
+                            reinterpret_cast<const jbyte *>(m_buffer.constData()));
+    m_stream.callMethod<void>("write", "([BII)V", m_chunk, jint(0), jint(m_used));
+
+    if (env.checkAndClearExceptions()) {
+        m_failed = true;
+        setErrorString("OutputStream.write failed");
+        qWarning() << "❌ OutputStream.write failed for" << m_displayName;
+        return false;
+    }
+    m_used = 0;
+    return true;
+}
+
+void MediaStoreSink::setPending(bool pending)
+{
+    QJniEnvironment env;
+    QJniObject values("android/content/ContentValues");
+    QJniObject flag = QJniObject::callStaticObjectMethod("java/lang/Integer", "valueOf",
+                                                         "(I)Ljava/lang/Integer;", jint(pending ? 1 : 0));
+    values.callMethod<void>("put",
+                            "(Ljava/lang/String;Ljava/lang/Integer;)V",
+                            QJniObject::fromString("is_pending").object<jstring>(),
+                            flag.object());
+    m_resolver.callMethod<jint>("update",
+                                "(Landroid/net/Uri;Landroid/content/ContentValues;Ljava/lang/String;[Ljava/lang/String;)I",
+                                m_uri.object(), values.object(), jstring(nullptr), jobjectArray(nullptr));
+    env.checkAndClearExceptions();
+}
+
+bool MediaStoreSink::commit()
+{
+    if (!isOpen())
+        return false;
+
+    bool ok = flushChunk();
+
+    QJniEnvironment env;
+    m_stream.callMethod<void>("flush");
+    m_stream.callMethod<void>("close");
+    ok = !env.checkAndClearExceptions() && ok;
+
+    OutputSink::close();
+
+    if (!ok) {
+        m_resolver.callMethod<jint>("delete",
+                                    "(Landroid/net/Uri;Ljava/lang/String;[Ljava/lang/String;)I",
+                                    m_uri.object(), jstring(nullptr), jobjectArray(nullptr));
+        env.checkAndClearExceptions();
+        // ردیف حذف شد؛ discard ی بعدی نباید دوباره delete بفرستد
+        m_uri = QJniObject();
+        releaseStream();
+        return false;
+    }
+
+    setPending(false);
+    releaseStream();
+    qDebug() << "✅ File saved to Downloads:" << m_displayName;
+    return true;
+}
+
+void MediaStoreSink::discard()
+{
+    QJniEnvironment env;
+    if (m_stream.isValid()) {
+        m_stream.callMethod<void>("close");
+        env.checkAndClearExceptions();
+    }
+    if (m_uri.isValid()) {
+        m_resolver.callMethod<jint>("delete",
+                                    "(Landroid/net/Uri;Ljava/lang/String;[Ljava/lang/String;)I",
+                                    m_uri.object(), jstring(nullptr), jobjectArray(nullptr));
+        env.checkAndClearExceptions();
+        m_uri = QJniObject();
+    }
+    if (isOpen())
+        OutputSink::close();
+    releaseStream();
+}
+
+void MediaStoreSink::releaseStream()
+{
+    if (m_chunk) {
+        QJniEnvironment env;
+        env->DeleteGlobalRef(m_chunk);
+        m_chunk = nullptr;
+    }
+    m_stream = QJniObject();
+    m_used   = 0;
+}
+#endif
@@ -0,0 +1,95 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <QIODevice>
+#include <QSaveFile>
+#include <QString>
+
+#ifdef Q_OS_ANDROID
+#include <QJniObject>
+#include <QJniEnvironment>
+#endif
+
+// ── مقصد نوشتن فایل‌های خروجی ───────────────────────────────────
+// یک QIODevice فقط‌نوشتنی که تا commit() صدا زده نشود، فایل نهایی
+// دیده نمی‌شود؛ discard() نیمه‌کاره‌ها را پاک می‌کند.
+class OutputSink : public QIODevice
+{
+    Q_OBJECT
+public:
+    using QIODevice::QIODevice;
+
+    virtual bool commit() = 0;
+    virtual void discard() = 0;
+    virtual QString location() const = 0;
+
+    bool isSequential() const override { return true; }
+
+    // پوشه‌ی Downloads: روی Android از MediaStore، روی دسکتاپ فایل محلی
+    static OutputSink *createDownloadsSink(const QString &fileName,
+                                           const QString &mimeType,
+                                           QObject *parent = nullptr);
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+};
+
+// ── فایل محلی (QSaveFile → جایگزینی اتمی در commit) ───────────────
+class LocalFileSink : public OutputSink
+{
+    Q_OBJECT
+public:
+    explicit LocalFileSink(const QString &filePath, QObject *parent = nullptr);
+
+    bool open(OpenMode mode) override;
+    bool commit() override;
+    void discard() override;
+    QString location() const override { return m_file.fileName(); }
+
+protected:
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    QSaveFile m_file;
+};
+
+#ifdef Q_OS_ANDROID
+// ── MediaStore Downloads ──────────────────────────────────────────
+// بایت‌ها در یک بافر ثابت جمع می‌شوند و هر بار ChunkSize بایت با یک
+// jbyteArray سراسریِ تکراری به OutputStream جاوا فرستاده می‌شود.
+class MediaStoreSink : public OutputSink
+{
+    Q_OBJECT
+public:
+    static constexpr int ChunkSize = 64 * 1024;
+
+    MediaStoreSink(const QString &displayName, const QString &mimeType,
+                   QObject *parent = nullptr);
+    ~MediaStoreSink() override;
+
+    bool open(OpenMode mode) override;
+    bool commit() override;
+    void discard() override;
+    QString location() const override { return "Download/" + m_displayName; }
+
+protected:
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    bool flushChunk();
+    void releaseStream();
+    void setPending(bool pending);
+
+    QString    m_displayName;
+    QString    m_mimeType;
+    QJniObject m_resolver;
+    QJniObject m_uri;
+    QJniObject m_stream;
+    jbyteArray m_chunk = nullptr;   // global ref
+    QByteArray m_buffer;
+    qsizetype  m_used   = 0;
+    bool       m_failed = false;
+};
+#endif
+
+#endif // OUTPUTSINK_H
@@ -0,0 +1,202 @@
+#include "recordinghealthbridge.h"
+#include "fakehealthbridge.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimeZone>
+
+namespace {
+
+const QString PagesFile        = QStringLiteral("pages.ndjson");
+const QString MenstruationFile = QStringLiteral("menstruation.ndjson");
+const QString PermissionsFile  = QStringLiteral("permissions.json");
+
+qint64 isoMs(const QString &iso)
+{
+    QDateTime dt = QDateTime::fromString(iso, Qt::ISODateWithMs);
+    if (!dt.isValid())
+        dt = QDateTime::fromString(iso, Qt::ISODate);
+    return dt.isValid() ? dt.toMSecsSinceEpoch() : -1;
+}
+
+} // namespace
+
+RecordingHealthBridge::RecordingHealthBridge(HealthBridge *inner, const QString &dir)
+    : m_inner(inner)
+    , m_dir(dir)
+{
+    QDir().mkpath(m_dir);
+    qDebug() << "⏺️ Recording bridge payloads to" << m_dir;
+}
+
+QString RecordingHealthBridge::init()
+{
+    return m_inner->init();
+}
+
+QString RecordingHealthBridge::checkPermissions()
+{
+    const QString json = m_inner->checkPermissions();
+    if (json.startsWith('{')) {
+        QMutexLocker lock(&m_mutex);
+        QSaveFile file(QDir(m_dir).filePath(PermissionsFile));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(json.toUtf8());
+            file.commit();
+        }
+    }
+    return json;
+}
+
+QString RecordingHealthBridge::requestPermissions()
+{
+    return m_inner->requestPermissions();
+}
+
+HealthBridge::StreamResult RecordingHealthBridge::stream(int type, const QString &startIso,
+                                                         const QString &endIso,
+                                                         const PageCallback &onPage)
+{
+    return m_inner->stream(type, startIso, endIso, recorder(onPage));
+}
+
+HealthBridge::StreamResult RecordingHealthBridge::latest(const QList<int> &types, int count,
+                                                         const PageCallback &onPage)
+{
+    return m_inner->latest(types, count, recorder(onPage));
+}
+
+// bucket ها از صفحه‌ها قابل بازسازی‌اند؛ ضبط نمی‌شوند
+HealthBridge::AggregateResult RecordingHealthBridge::aggregate(int type, const QString &startIso,
+                                                               const QString &endIso,
+                                                               int bucketSeconds)
+{
+    return m_inner->aggregate(type, startIso, endIso, bucketSeconds);
+}
+
+QString RecordingHealthBridge::readMenstruation(const QString &startIso, const QString &endIso)
+{
+    const QString json = m_inner->readMenstruation(startIso, endIso);
+    if (json.startsWith('{'))
+        append(MenstruationFile, json.toUtf8());
+    return json;
+}
+
+QString RecordingHealthBridge::writeBatch(const QList<HealthMeasurement> &items)
+{
+    return m_inner->writeBatch(items);
+}
+
+HealthBridge::PageCallback RecordingHealthBridge::recorder(const PageCallback &onPage)
+{
+    return [this, &onPage](const Page &page) {
+        QJsonArray times, values, values2, extras;
+        for (qsizetype i = 0; i < page.count; ++i) {
+            times.append(page.timesMs[i]);
+            values.append(page.values[i]);
+            values2.append(page.values2[i]);
+            extras.append(page.extras[i]);
+        }
+        const QJsonObject line{
+            {"type",    page.type},
+            {"times",   times},
+            {"values",  values},
+            {"values2", values2},
+            {"extras",  extras}
+        };
+        append(PagesFile, QJsonDocument(line).toJson(QJsonDocument::Compact));
+        return onPage(page);
+    };
+}
+
+void RecordingHealthBridge::append(const QString &fileName, const QByteArray &line)
+{
+    QMutexLocker lock(&m_mutex);
+    QFile file(QDir(m_dir).filePath(fileName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "❌ Cannot record to" << file.fileName() << file.errorString();
+        return;
+    }
+    file.write(line);
+    file.write("\n");
+}
+
+// ── replay ──────────────────────────────────────────────────
+bool RecordingHealthBridge::replay(const QString &dir, FakeHealthBridge *store,
+                                   QString *permissions, QString *error)
+{
+    const QDir root(dir);
+    if (!root.exists()) {
+        if (error)
+            *error = QStringLiteral("No such directory");
+        return false;
+    }
+
+    // ── صفحه‌ها ──
+    qint64 records = 0;
+    QFile pages(root.filePath(PagesFile));
+    if (pages.open(QIODevice::ReadOnly)) {
+        while (!pages.atEnd()) {
+            const QJsonObject o = QJsonDocument::fromJson(pages.readLine()).object();
+            const int type = o["type"].toInt();
+            if (!HealthBridge::typeName(type))
+                continue;
+            const QJsonArray times   = o["times"].toArray();
+            const QJsonArray values  = o["values"].toArray();
+            const QJsonArray values2 = o["values2"].toArray();
+            const QJsonArray extras  = o["extras"].toArray();
+            for (qsizetype i = 0; i < times.size(); ++i) {
+                HealthMeasurement m {};
+                m.type   = HealthMeasurement::Type(type);
+                m.time   = QDateTime::fromMSecsSinceEpoch(times.at(i).toInteger(), QTimeZone::UTC);
+                m.value  = values.at(i).toDouble();
+                m.value2 = values2.at(i).toDouble();
+                const int extra  = extras.at(i).toInt(2);
+                m.specimenSource = extra & 0xFF;
+                m.mealType       = (extra >> 8) & 0xFF;
+                m.relationToMeal = (extra >> 16) & 0xFF;
+                store->insert(m);
+                ++records;
+            }
+        }
+    }
+
+    // ── دوره‌ها؛ یک دوره ممکن است در چند خواندن ضبط شده باشد ──
+    QSet<QPair<qint64, qint64>> periods;
+    QFile menstruation(root.filePath(MenstruationFile));
+    if (menstruation.open(QIODevice::ReadOnly)) {
+        while (!menstruation.atEnd()) {
+            const QJsonObject o = QJsonDocument::fromJson(menstruation.readLine()).object();
+            for (const QJsonValue &v : o["periods"].toArray()) {
+                const QJsonObject p = v.toObject();
+                const qint64 start = isoMs(p["start"].toString());
+                const qint64 end   = isoMs(p["end"].toString());
+                if (start < 0 || end < 0 || periods.contains({start, end}))
+                    continue;
+                periods.insert({start, end});
+                store->insertPeriod(start, end);
+            }
+            for (const QJsonValue &v : o["flows"].toArray()) {
+                const QJsonObject f = v.toObject();
+                const qint64 time = isoMs(f["time"].toString());
+                if (time >= 0)
+                    store->insertFlow(time, f["level"].toInt(0));
+            }
+        }
+    }
+
+    QFile permissionsFile(root.filePath(PermissionsFile));
+    if (permissions && permissionsFile.open(QIODevice::ReadOnly))
+        *permissions = QString::fromUtf8(permissionsFile.readAll());
+
+    qDebug() << "⏯️ Replayed" << records << "records," << periods.size() << "periods from" << dir;
+    return true;
+}
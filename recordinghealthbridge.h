@@ -0,0 +1,52 @@
+#ifndef RECORDINGHEALTHBRIDGE_H
+#define RECORDINGHEALTHBRIDGE_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+#include "healthbridge.h"
+
+class FakeHealthBridge;
+
+// ── ضبط payload های bridge برای replay روی دسکتاپ ──────────────
+// همه‌ی فراخوانی‌ها به bridge اصلی می‌رود؛ آنچه از آن برمی‌گردد در dir
+// نوشته می‌شود:
+//     pages.ndjson         هر صفحه‌ی stream / latest در یک خط:
+//                          {"type":4,"times":[…],"values":[…],"values2":[…],"extras":[…]}
+//     menstruation.ndjson  هر خروجی readMenstruation در یک خط
+//     permissions.json     آخرین خروجی checkPermissions
+// QMLHC_RECORD_DIR ضبط را روشن می‌کند و QMLHC_REPLAY_DIR همان پوشه را در
+// DesktopHealthBridge پخش می‌کند.
+class RecordingHealthBridge : public HealthBridge
+{
+public:
+    // مالکیت inner پیش caller می‌ماند
+    RecordingHealthBridge(HealthBridge *inner, const QString &dir);
+
+    QString init() override;
+    QString checkPermissions() override;
+    QString requestPermissions() override;
+    StreamResult stream(int type, const QString &startIso, const QString &endIso,
+                        const PageCallback &onPage) override;
+    StreamResult latest(const QList<int> &types, int count, const PageCallback &onPage) override;
+    AggregateResult aggregate(int type, const QString &startIso, const QString &endIso,
+                              int bucketSeconds) override;
+    QString readMenstruation(const QString &startIso, const QString &endIso) override;
+    QString writeBatch(const QList<HealthMeasurement> &items) override;
+
+    // محتوای یک پوشه‌ی ضبط‌شده را در store درج می‌کند (تکراری‌ها یکی می‌شوند)؛
+    // permissions خروجی ضبط‌شده‌ی checkPermissions است، اگر باشد
+    static bool replay(const QString &dir, FakeHealthBridge *store, QString *permissions,
+                       QString *error);
+
+private:
+    PageCallback recorder(const PageCallback &onPage);
+    void append(const QString &fileName, const QByteArray &line);
+
+    HealthBridge *m_inner;
+    QString       m_dir;
+    QMutex        m_mutex;   // خط‌های هم‌زمان shard ها در هم نروند
+};
+
+#endif // RECORDINGHEALTHBRIDGE_H
@@ -0,0 +1,123 @@
+#include "rendersnapshot.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <numeric>
+
+namespace {
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_5;
+// سرعت مهم‌تر از اندازه است؛ زمان‌های پشت سر هم با سطح ۱ هم خوب فشرده می‌شوند
+constexpr int CompressionLevel = 1;
+}
+
+qsizetype RenderSnapshot::pointCount() const
+{
+    qsizetype count = 0;
+    for (const QList<QPointF> &points : series)
+        count += points.size();
+    for (const QList<QList<QPointF>> &lists : buckets) {
+        if (!lists.isEmpty())
+            count += lists.first().size();
+    }
+    return count;
+}
+
+QList<qsizetype> RenderSnapshot::extremaIndices(const QList<QPointF> &points, qsizetype maxPoints)
+{
+    QList<qsizetype> keep;
+    const qsizetype n = points.size();
+    if (n <= maxPoints || maxPoints < 4) {
+        keep.resize(qMin(n, qMax<qsizetype>(maxPoints, 0)));
+        std::iota(keep.begin(), keep.end(), 0);
+        return keep;
+    }
+
+    // دو نقطه از هر گروه؛ اولی و آخری جدا
+    const qsizetype groups = (maxPoints - 2) / 2;
+    keep.reserve(groups * 2 + 2);
+    keep.append(0);
+    for (qsizetype g = 0; g < groups; ++g) {
+        const qsizetype begin = 1 + (n - 2) * g / groups;
+        const qsizetype end   = 1 + (n - 2) * (g + 1) / groups;
+        if (begin >= end)
+            continue;
+        qsizetype lo = begin, hi = begin;
+        for (qsizetype i = begin + 1; i < end; ++i) {
+            if (points.at(i).y() < points.at(lo).y())
+                lo = i;
+            if (points.at(i).y() > points.at(hi).y())
+                hi = i;
+        }
+        keep.append(qMin(lo, hi));
+        if (hi != lo)
+            keep.append(qMax(lo, hi));
+    }
+    keep.append(n - 1);
+    return keep;
+}
+
+bool RenderSnapshot::save(const QString &filePath, QString *error) const
+{
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(StreamVersion);
+        out << savedAtMs << loadedFromMs << series << buckets << axes << periods << flows;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(StreamVersion);
+    header << Magic << Version;
+    header << qCompress(payload, CompressionLevel);
+
+    if (header.status() != QDataStream::Ok || !file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool RenderSnapshot::load(const QString &filePath, RenderSnapshot *out)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream header(&file);
+    header.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QByteArray compressed;
+    header >> magic >> version;
+    if (magic != Magic || version != Version)
+        return false;
+    header >> compressed;
+
+    const QByteArray payload = qUncompress(compressed);
+    if (header.status() != QDataStream::Ok || payload.isEmpty()) {
+        qWarning() << "⚠️ Render snapshot unreadable:" << filePath;
+        return false;
+    }
+
+    RenderSnapshot snapshot;
+    QDataStream in(payload);
+    in.setVersion(StreamVersion);
+    in >> snapshot.savedAtMs >> snapshot.loadedFromMs >> snapshot.series
+       >> snapshot.buckets >> snapshot.axes >> snapshot.periods >> snapshot.flows;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    *out = std::move(snapshot);
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QVariantMap>
+
+// ── آخرین چیزی که روی چارت بود، برای شروع گرم ───────────────
+// بعد از هر refresh و هنگام خروج ذخیره می‌شود و در اجرای بعدی
+// قبل از اولین فریم نمایش داده می‌شود؛ خواندن Health Connect در
+// پس‌زمینه آن را جایگزین می‌کند.
+// فایل: magic + version + payload فشرده‌ی QDataStream
+// سری‌های خام حداکثر MaxPointsPerType نقطه نگه می‌دارند — برای اولین فریم
+// بیشتر از عرض چارت لازم نیست و حجم فایل به طول بازه بستگی ندارد.
+struct RenderSnapshot
+{
+    static constexpr quint32   Magic   = 0x48435331;   // "HCS1"
+    static constexpr quint16   Version = 2;
+    static constexpr qsizetype MaxPointsPerType = 2000;
+
+    qint64 savedAtMs    = 0;
+    qint64 loadedFromMs = 0;
+    QHash<QString, QList<QPointF>>   series;    // نام سری در Backend → نقاط
+    QHash<int, QList<QList<QPointF>>> buckets;  // نوع → avg, avg2, min, max
+    QVariantMap axes;                            // محور → [min, max]
+    QList<QPointF> periods;                      // x = شروع، y = پایان
+    QList<QPointF> flows;                        // x = زمان، y = سطح
+
+    bool isEmpty() const { return series.isEmpty() && buckets.isEmpty(); }
+    qsizetype pointCount() const;
+
+    // اندیس‌های حداکثر maxPoints نقطه: اول، آخر و min/max ی y در هر گروه، به ترتیب
+    // — سری‌های موازی با همین اندیس‌ها هم‌اندیس می‌مانند
+    static QList<qsizetype> extremaIndices(const QList<QPointF> &points, qsizetype maxPoints);
+
+    // از طریق QSaveFile — فایل نیمه‌نوشته جایگزین نسخه‌ی قبلی نمی‌شود
+    bool save(const QString &filePath, QString *error = nullptr) const;
+    // فایل نبود، خراب بود یا version دیگری داشت → false
+    static bool load(const QString &filePath, RenderSnapshot *out);
+};
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,348 @@
+#include "seriescache.h"
+#include "healthmeasurement.h"
+#include "metricdescriptor.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+qint64 listBytes(const QList<QPointF> &list)
+{
+    return qint64(list.size()) * qint64(sizeof(QPointF));
+}
+
+// اولین نقطه با x >= ms
+qsizetype lowerIndex(const QList<QPointF> &list, qint64 ms)
+{
+    return std::lower_bound(list.cbegin(), list.cend(), double(ms),
+                            [](const QPointF &p, double x) { return p.x() < x; })
+           - list.cbegin();
+}
+
+QList<QPointF> sliced(const QList<QPointF> &list, qsizetype begin, qsizetype end)
+{
+    if (list.isEmpty() || (begin == 0 && end == list.size()))
+        return list;
+    return list.mid(begin, end - begin);
+}
+
+} // namespace
+
+// ── Columns / Coarse ────────────────────────────────────────
+qint64 SeriesCache::Columns::bytes() const
+{
+    return listBytes(values) + listBytes(values2) + listBytes(specimen)
+           + listBytes(meal) + listBytes(relation);
+}
+
+SeriesCache::Columns SeriesCache::Columns::slice(qint64 fromMs, qint64 toMs) const
+{
+    const qsizetype begin = lowerIndex(values, fromMs);
+    const qsizetype end   = lowerIndex(values, toMs);
+    Columns out;
+    out.values   = sliced(values, begin, end);
+    out.values2  = sliced(values2, begin, end);
+    out.specimen = sliced(specimen, begin, end);
+    out.meal     = sliced(meal, begin, end);
+    out.relation = sliced(relation, begin, end);
+    return out;
+}
+
+qint64 SeriesCache::Coarse::bytes() const
+{
+    return listBytes(avg) + listBytes(avg2) + listBytes(min) + listBytes(max);
+}
+
+SeriesCache::Coarse SeriesCache::Coarse::slice(qint64 fromMs, qint64 toMs) const
+{
+    const qsizetype begin = lowerIndex(avg, fromMs);
+    const qsizetype end   = lowerIndex(avg, toMs);
+    return {sliced(avg, begin, end), sliced(avg2, begin, end),
+            sliced(min, begin, end), sliced(max, begin, end)};
+}
+
+SeriesCache::Coarse SeriesCache::Coarse::fromColumns(int type, const Columns &raw,
+                                                     qint64 fromMs, qint64 toMs)
+{
+    Coarse coarse;
+    const bool bp = Metric::shapeOf(type) == Metric::Pair && raw.values2.size() == raw.values.size();
+
+    qint64 start = -1, count = 0;
+    double sum = 0, sum2 = 0, min = 0, max = 0, min2 = 0;
+    auto flush = [&]() {
+        if (count == 0)
+            return;
+        // مثل toBucketSeries: نقطه‌ی وسط bucket؛ برای BP، min کمترین diastolic است
+        const double ms = double(start + (qMin(start + CoarseBucketMs, toMs) - start) / 2);
+        coarse.avg.append(QPointF(ms, sum / count));
+        coarse.min.append(QPointF(ms, bp ? min2 : min));
+        coarse.max.append(QPointF(ms, max));
+        if (bp)
+            coarse.avg2.append(QPointF(ms, sum2 / count));
+    };
+
+    for (qsizetype i = 0; i < raw.values.size(); ++i) {
+        const qint64 ms = qint64(raw.values.at(i).x());
+        if (ms < fromMs || ms >= toMs)
+            continue;
+        const qint64 bucket = fromMs + (ms - fromMs) / CoarseBucketMs * CoarseBucketMs;
+        const double value  = raw.values.at(i).y();
+        const double value2 = bp ? raw.values2.at(i).y() : 0.0;
+        if (bucket != start) {
+            flush();
+            start = bucket;
+            count = 0;
+            sum = sum2 = 0;
+            min = max = value;
+            min2 = value2;
+        }
+        min  = qMin(min, value);
+        max  = qMax(max, value);
+        min2 = qMin(min2, value2);
+        sum  += value;
+        sum2 += value2;
+        ++count;
+    }
+    flush();
+    return coarse;
+}
+
+// ── SeriesCache ─────────────────────────────────────────────
+SeriesCache::SeriesCache(qint64 budgetBytes)
+    : m_budgetBytes(budgetBytes)
+{
+}
+
+void SeriesCache::setBudgetBytes(qint64 bytes)
+{
+    m_budgetBytes = qMax<qint64>(bytes, 0);
+    enforceBudget();
+}
+
+bool SeriesCache::fresh(const Window &w, qint64 nowMs) const
+{
+    const qint64 maxAgeMs = (w.toMs < nowMs - SettleMs) ? SettledMaxAgeMs : RecentMaxAgeMs;
+    return nowMs - w.loadedAtMs < maxAgeMs;
+}
+
+qint64 SeriesCache::lookup(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, Columns *out)
+{
+    // از پنجره‌هایی که fromMs را می‌پوشانند، آنکه دورتر می‌رود
+    Window *best = nullptr;
+    for (Window &w : m_windows) {
+        if (w.type != type || !w.hasPoints() || w.fromMs > fromMs || w.toMs <= fromMs
+            || !fresh(w, nowMs))
+            continue;
+        if (!best || w.toMs > best->toMs)
+            best = &w;
+    }
+    if (!best) {
+        ++m_misses;
+        return fromMs;
+    }
+
+    const qint64 coveredTo = qMin(best->toMs, toMs);
+    if (best->resident) {
+        *out = best->raw.slice(fromMs, coveredTo);
+    } else {
+        *out = Columns();
+        best->packed.scan(fromMs, coveredTo, &out->values);
+    }
+    best->lastViewed = m_view;
+    ++m_hits;
+    return coveredTo;
+}
+
+bool SeriesCache::lookupCoarse(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, Coarse *out)
+{
+    for (Window &w : m_windows) {
+        if (w.type != type || w.fromMs > fromMs || w.toMs < toMs || !fresh(w, nowMs))
+            continue;
+        if (w.resident) {
+            // هم‌تراز با bucket هایی که bridge برای همین بازه می‌داد
+            *out = Coarse::fromColumns(type, w.raw, fromMs, toMs);
+        } else if (!w.packed.isEmpty()) {
+            Columns unpacked;
+            w.packed.scan(fromMs, toMs, &unpacked.values);
+            *out = Coarse::fromColumns(type, unpacked, fromMs, toMs);
+        } else if (!w.coarse.isEmpty()) {
+            *out = w.coarse.slice(fromMs, toMs);
+        } else {
+            continue;
+        }
+        w.lastViewed = m_view;
+        ++m_hits;
+        return true;
+    }
+    ++m_misses;
+    return false;
+}
+
+void SeriesCache::store(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, const Columns &raw)
+{
+    // همان بازه از کش آمده بود؛ raw برشی از همان پنجره است
+    if (touchCovering(type, fromMs, toMs, nowMs, true))
+        return;
+    m_windows.removeIf([&](const Window &w) {
+        return w.type == type && w.fromMs >= fromMs && w.toMs <= toMs;
+    });
+
+    Window window;
+    window.type       = type;
+    window.fromMs     = fromMs;
+    window.toMs       = toMs;
+    window.loadedAtMs = nowMs;
+    window.resident   = true;
+    window.raw        = raw;
+    insert(std::move(window));
+}
+
+void SeriesCache::storeCoarse(int type, qint64 fromMs, qint64 toMs, qint64 nowMs,
+                              const Coarse &coarse)
+{
+    if (touchCovering(type, fromMs, toMs, nowMs, false))
+        return;
+    // نقاط پنجره‌های داخل بازه با bucket ها جایگزین نمی‌شوند
+    m_windows.removeIf([&](const Window &w) {
+        return w.type == type && !w.hasPoints() && w.fromMs >= fromMs && w.toMs <= toMs;
+    });
+
+    Window window;
+    window.type       = type;
+    window.fromMs     = fromMs;
+    window.toMs       = toMs;
+    window.loadedAtMs = nowMs;
+    window.coarse     = coarse;
+    insert(std::move(window));
+}
+
+bool SeriesCache::touchCovering(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, bool raw)
+{
+    for (Window &w : m_windows) {
+        if (w.type != type || w.fromMs > fromMs || w.toMs < toMs || !fresh(w, nowMs))
+            continue;
+        if (raw ? !w.hasPoints() : (!w.hasPoints() && w.coarse.isEmpty()))
+            continue;
+        w.lastViewed = m_view;
+        return true;
+    }
+    return false;
+}
+
+bool SeriesCache::packable(int type, int *decimals)
+{
+    // دقت معمول هر نوع؛ اگر داده دقیق‌تر باشد fromPoints به Xor برمی‌گردد.
+    // فشار خون و قند خون سری‌های موازی دارند
+    bool single = false;
+    Metric::visitMetric(type, [&](auto m) {
+        single    = decltype(m)::shape == Metric::Single;
+        *decimals = decltype(m)::decimals;
+    });
+    return single;
+}
+
+void SeriesCache::insert(Window window)
+{
+    window.lastViewed = m_view;
+    m_windows.append(std::move(window));
+    enforceBudget();
+}
+
+void SeriesCache::invalidate(int type, qint64 ms)
+{
+    m_windows.removeIf([&](const Window &w) {
+        return w.type == type && w.fromMs <= ms && ms < w.toMs;
+    });
+}
+
+void SeriesCache::clear()
+{
+    m_windows.clear();
+}
+
+void SeriesCache::enforceBudget()
+{
+    qint64 total = 0;
+    for (const Window &w : m_windows)
+        total += w.bytes();
+    if (total <= m_budgetBytes)
+        return;
+
+    // قدیمی‌ترین view اول؛ پنجره‌های view ی جاری کنار گذاشته می‌شوند
+    QList<qsizetype> order;
+    for (qsizetype i = 0; i < m_windows.size(); ++i) {
+        if (m_windows.at(i).lastViewed < m_view)
+            order.append(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](qsizetype a, qsizetype b) {
+        return m_windows.at(a).lastViewed < m_windows.at(b).lastViewed;
+    });
+
+    // ── ۱: داده‌ی خام → CompressedSeries (اگر نوع تک‌مقداری باشد) + bucket های روزانه ──
+    for (qsizetype i : order) {
+        if (total <= m_budgetBytes)
+            break;
+        Window &w = m_windows[i];
+        if (!w.resident)
+            continue;
+        total -= w.bytes();
+        if (w.coarse.isEmpty())
+            w.coarse = Coarse::fromColumns(w.type, w.raw, w.fromMs, w.toMs);
+        int decimals = 0;
+        if (packable(w.type, &decimals))
+            w.packed = CompressedSeries::fromPoints(w.raw.values, decimals);
+        w.raw      = Columns();
+        w.resident = false;
+        total += w.bytes();
+        ++m_evictions;
+    }
+
+    // ── ۲: CompressedSeries → فقط bucket های روزانه ──
+    for (qsizetype i : order) {
+        if (total <= m_budgetBytes)
+            break;
+        Window &w = m_windows[i];
+        if (w.packed.isEmpty())
+            continue;
+        total -= w.packed.bytes();
+        w.packed = CompressedSeries();
+    }
+
+    // ── ۳: اگر bucket ها هم جا نشدند، خود پنجره ──
+    QList<qsizetype> dropped;
+    for (qsizetype i : order) {
+        if (total <= m_budgetBytes)
+            break;
+        total -= m_windows.at(i).bytes();
+        dropped.append(i);
+    }
+    std::sort(dropped.begin(), dropped.end(), std::greater<qsizetype>());
+    for (qsizetype i : dropped)
+        m_windows.removeAt(i);
+
+    qDebug() << "🧹 Series cache over budget:" << m_evictions << "evictions so far,"
+             << total << "/" << m_budgetBytes << "B in" << m_windows.size() << "windows";
+}
+
+SeriesCache::Usage SeriesCache::usage() const
+{
+    Usage u;
+    u.budgetBytes = m_budgetBytes;
+    u.windows     = int(m_windows.size());
+    u.hits        = m_hits;
+    u.misses      = m_misses;
+    u.evictions   = m_evictions;
+    for (const Window &w : m_windows) {
+        u.rawBytes    += w.raw.bytes();
+        u.packedBytes += w.packed.bytes();
+        u.coarseBytes += w.coarse.bytes();
+        u.bytesPerType[w.type] += w.bytes();
+        if (w.resident)
+            ++u.resident;
+        if (!w.packed.isEmpty())
+            ++u.packed;
+    }
+    return u;
+}
@@ -0,0 +1,135 @@
+#ifndef SERIESCACHE_H
+#define SERIESCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+
+#include "compressedseries.h"
+
+// ── کش سری‌های بارگذاری‌شده با سقف حافظه ─────────────────────
+// هر refresh برای هر نوع یک «پنجره» [fromMs, toMs) ثبت می‌کند. سری‌های خام
+// با سری‌های Backend implicitly shared هستند، پس پنجره‌ی در حال نمایش
+// حافظه‌ی اضافه نمی‌گیرد. وقتی مجموع از budget بیشتر شود، پنجره‌هایی که
+// کمتر از همه اخیراً دیده شده‌اند به ترتیب کوچک می‌شوند:
+//     خام → CompressedSeries (فقط نوع‌های تک‌مقداری) + bucket های روزانه
+//         → فقط bucket های روزانه (Coarse) → حذف پنجره
+// lookup از پنجره‌ی فشرده فقط بلوک‌های هم‌پوشان با بازه را باز می‌کند.
+// پنجره‌های view ی جاری هیچ‌وقت evict نمی‌شوند.
+// حجم‌ها تقریبی‌اند: size × sizeof(QPointF)، بدون سربار QList.
+// فقط روی thread ی Backend استفاده می‌شود.
+class SeriesCache
+{
+public:
+    static constexpr qint64 DefaultBudgetBytes = qint64(64) * 1024 * 1024;
+    static constexpr qint64 CoarseBucketMs     = qint64(24) * 3600 * 1000;
+    // داده‌ی قدیمی‌تر از این در Health Connect عملاً عوض نمی‌شود (sync های دیرهنگام)
+    static constexpr qint64 SettleMs           = qint64(7) * 24 * 3600 * 1000;
+    // پنجره‌ای که به SettleMs ی اخیر می‌رسد فقط تا این مدت دوباره استفاده می‌شود
+    static constexpr qint64 RecentMaxAgeMs     = 10 * 60 * 1000;
+    // پنجره‌ی settled هم بعد از این مدت دوباره خوانده می‌شود: sync ی دیرهنگام
+    // یا نوشتن برنامه‌ی دیگر در گذشته از اینجا دیده نمی‌شود
+    static constexpr qint64 SettledMaxAgeMs    = qint64(6) * 3600 * 1000;
+
+    // سری‌های موازی هم‌اندیس با values — مثل Backend::SeriesChunk
+    struct Columns {
+        QList<QPointF> values;
+        QList<QPointF> values2;    // فشار خون: diastolic
+        QList<QPointF> specimen;   // قند خون
+        QList<QPointF> meal;
+        QList<QPointF> relation;
+
+        bool isEmpty() const { return values.isEmpty(); }
+        qint64 bytes() const;
+        // نقاط [fromMs, toMs) — بدون کپی وقتی کل سری در بازه است
+        Columns slice(qint64 fromMs, qint64 toMs) const;
+    };
+
+    // bucket های روزانه؛ همان شکل Backend::BucketSeries
+    struct Coarse {
+        QList<QPointF> avg;
+        QList<QPointF> avg2;
+        QList<QPointF> min;
+        QList<QPointF> max;
+
+        bool isEmpty() const { return avg.isEmpty(); }
+        qint64 bytes() const;
+        Coarse slice(qint64 fromMs, qint64 toMs) const;
+        // bucket های CoarseBucketMs از ابتدای fromMs، مثل aggregate ی bridge
+        static Coarse fromColumns(int type, const Columns &raw, qint64 fromMs, qint64 toMs);
+    };
+
+    struct Window {
+        int     type         = 0;
+        qint64  fromMs       = 0;
+        qint64  toMs         = 0;
+        qint64  loadedAtMs   = 0;
+        quint64 lastViewed   = 0;       // شماره‌ی view
+        bool    resident     = false;   // داده‌ی خام در حافظه است
+        Columns raw;
+        CompressedSeries packed;        // جای raw بعد از اولین eviction
+        Coarse  coarse;
+
+        bool hasPoints() const { return resident || !packed.isEmpty(); }
+        qint64 bytes() const { return raw.bytes() + packed.bytes() + coarse.bytes(); }
+    };
+
+    struct Usage {
+        qint64  budgetBytes = 0;
+        qint64  rawBytes    = 0;
+        qint64  packedBytes = 0;
+        qint64  coarseBytes = 0;
+        int     windows     = 0;
+        int     resident    = 0;
+        int     packed      = 0;
+        quint64 hits        = 0;
+        quint64 misses      = 0;
+        quint64 evictions   = 0;   // پنجره‌هایی که داده‌ی خامشان دور ریخته شد
+        QHash<int, qint64> bytesPerType;
+
+        qint64 totalBytes() const { return rawBytes + packedBytes + coarseBytes; }
+    };
+
+    explicit SeriesCache(qint64 budgetBytes = DefaultBudgetBytes);
+
+    qint64 budgetBytes() const { return m_budgetBytes; }
+    void setBudgetBytes(qint64 bytes);
+
+    // هر refresh یک view ی جدید است؛ پنجره‌هایی که در آن دیده می‌شوند محافظت می‌شوند
+    void beginView() { ++m_view; }
+
+    // نقاط از fromMs به بعد (خام یا باز شده از CompressedSeries)؛ خروجی پایان بخش پوشش‌داده‌شده است
+    // (fromMs یعنی miss، toMs یعنی کل بازه)
+    qint64 lookup(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, Columns *out);
+    // bucket های روزانه فقط وقتی یک پنجره کل بازه را بپوشاند
+    bool lookupCoarse(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, Coarse *out);
+
+    // پنجره‌های هم‌نوعی که داخل [fromMs, toMs) هستند جایگزین می‌شوند
+    void store(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, const Columns &raw);
+    void storeCoarse(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, const Coarse &coarse);
+
+    // اندازه‌گیری جدید در ms؛ پنجره‌های شامل آن دیگر معتبر نیستند
+    void invalidate(int type, qint64 ms);
+    void clear();
+
+    Usage usage() const;
+    const QList<Window> &windows() const { return m_windows; }
+
+private:
+    bool fresh(const Window &w, qint64 nowMs) const;
+    // پنجره‌ی تازه‌ای که [fromMs, toMs) را می‌پوشاند فقط دیده‌شده علامت می‌خورد
+    bool touchCovering(int type, qint64 fromMs, qint64 toMs, qint64 nowMs, bool raw);
+    // نوع‌هایی که فقط values دارند؛ decimals برای CompressedSeries::FixedPoint
+    static bool packable(int type, int *decimals);
+    void insert(Window window);
+    void enforceBudget();
+
+    QList<Window> m_windows;
+    qint64  m_budgetBytes;
+    quint64 m_view      = 1;
+    quint64 m_hits      = 0;
+    quint64 m_misses    = 0;
+    quint64 m_evictions = 0;
+};
+
+#endif // SERIESCACHE_H
@@ -0,0 +1,271 @@
+#include "seriesexporter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+// ── بافر ثابت روی QIODevice — append ها حافظه‌ی جدید نمی‌گیرند ──
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(QIODevice *out)
+        : m_out(out)
+    {
+        m_buffer.reserve(SeriesExporter::WriteBufferSize + 64);
+    }
+
+    void append(const char *data, qsizetype size)
+    {
+        m_buffer.append(data, size);
+        if (m_buffer.size() >= SeriesExporter::WriteBufferSize)
+            flush();
+    }
+    void append(const QByteArray &bytes) { append(bytes.constData(), bytes.size()); }
+    void append(char c) { append(&c, 1); }
+
+    void appendNumber(qint64 v)
+    {
+        char tmp[24];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        append(tmp, r.ptr - tmp);
+    }
+
+    // کوتاه‌ترین نمایشی که دوباره همان double را می‌دهد
+    void appendNumber(double v)
+    {
+        char tmp[32];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        append(tmp, r.ptr - tmp);
+    }
+
+    template <typename T>
+    void appendLE(T v)
+    {
+        char tmp[sizeof(T)];
+        qToLittleEndian<T>(v, tmp);
+        append(tmp, sizeof(T));
+    }
+
+    void appendName(const QByteArray &name)
+    {
+        appendLE<quint16>(quint16(name.size()));
+        append(name);
+    }
+
+    bool flush()
+    {
+        if (!m_ok || m_buffer.isEmpty())
+            return m_ok;
+        if (m_out->write(m_buffer) != m_buffer.size())
+            m_ok = false;
+        m_written += m_buffer.size();
+        m_buffer.resize(0);   // ظرفیت بافر حفظ می‌شود
+        return m_ok;
+    }
+
+    bool   ok() const      { return m_ok; }
+    qint64 written() const { return m_written + m_buffer.size(); }
+
+private:
+    QIODevice *m_out;
+    QByteArray m_buffer;
+    qint64     m_written = 0;
+    bool       m_ok      = true;
+};
+
+void appendValue(BufferedWriter &w, SeriesExporter::ColumnType type, double v)
+{
+    switch (type) {
+    case SeriesExporter::Int64:
+    case SeriesExporter::UInt8:   w.appendNumber(qint64(v)); return;
+    case SeriesExporter::Float64: w.appendNumber(v);         return;
+    }
+}
+
+} // namespace
+
+QString SeriesExporter::formatName(int format)
+{
+    switch (format) {
+    case Xlsx:     return QStringLiteral("xlsx");
+    case Csv:      return QStringLiteral("csv");
+    case NdJson:   return QStringLiteral("ndjson");
+    case Columnar: return QStringLiteral("hcol");
+    }
+    return QStringLiteral("unknown");
+}
+
+QString SeriesExporter::fileExtension(int format)
+{
+    return "." + formatName(format);
+}
+
+QString SeriesExporter::mimeType(int format)
+{
+    switch (format) {
+    case Xlsx:     return QStringLiteral("application/vnd.openxmlformats-officedocument.spreadsheetml.sheet");
+    case Csv:      return QStringLiteral("text/csv");
+    case NdJson:   return QStringLiteral("application/x-ndjson");
+    case Columnar: break;
+    }
+    return QStringLiteral("application/octet-stream");
+}
+
+bool SeriesExporter::write(const QList<Table> &tables, Format format, QIODevice *out,
+                           Stats *stats, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // ── همه‌ی ستون‌های یک جدول باید هم‌طول باشند ──
+    for (const Table &t : tables) {
+        for (const Column &c : t.columns) {
+            if (!c.points || c.points->size() != t.rows()) {
+                if (error)
+                    *error = QString("Column %1.%2 length mismatch")
+                                 .arg(QString::fromLatin1(t.metric), QString::fromLatin1(c.name));
+                return false;
+            }
+        }
+    }
+
+    Stats local;
+    bool ok = false;
+    switch (format) {
+    case Csv:      ok = writeCsv(tables, out, &local);      break;
+    case NdJson:   ok = writeNdJson(tables, out, &local);   break;
+    case Columnar: ok = writeColumnar(tables, out, &local); break;
+    case Xlsx:
+        if (error)
+            *error = QString("XLSX is written by QXlsx, not SeriesExporter");
+        return false;
+    }
+
+    local.tables    = int(tables.size());
+    local.elapsedMs = timer.elapsed();
+    if (stats)
+        *stats = local;
+
+    if (!ok && error)
+        *error = out->errorString();
+    return ok;
+}
+
+bool SeriesExporter::writeCsv(const QList<Table> &tables, QIODevice *out, Stats *stats)
+{
+    BufferedWriter w(out);
+    w.append(QByteArrayLiteral("metric,time_ms,field,value\n"));
+
+    for (const Table &t : tables) {
+        const qsizetype rows = t.rows();
+        for (qsizetype i = 0; i < rows; ++i) {
+            const qint64 timeMs = qint64(t.columns.first().points->at(i).x());
+            for (const Column &c : t.columns) {
+                w.append(t.metric);
+                w.append(',');
+                w.appendNumber(timeMs);
+                w.append(',');
+                w.append(c.name);
+                w.append(',');
+                appendValue(w, c.type, c.points->at(i).y());
+                w.append('\n');
+            }
+        }
+        stats->rows += rows;
+    }
+
+    const bool ok = w.flush();
+    stats->bytes = w.written();
+    return ok;
+}
+
+bool SeriesExporter::writeNdJson(const QList<Table> &tables, QIODevice *out, Stats *stats)
+{
+    BufferedWriter w(out);
+
+    for (const Table &t : tables) {
+        // کلیدها یک بار برای هر جدول ساخته می‌شوند
+        const QByteArray prefix = "{\"metric\":\"" + t.metric + "\",\"time_ms\":";
+        QList<QByteArray> keys;
+        keys.reserve(t.columns.size());
+        for (const Column &c : t.columns)
+            keys.append(",\"" + c.name + "\":");
+
+        const qsizetype rows = t.rows();
+        for (qsizetype i = 0; i < rows; ++i) {
+            w.append(prefix);
+            w.appendNumber(qint64(t.columns.first().points->at(i).x()));
+            for (qsizetype c = 0; c < t.columns.size(); ++c) {
+                const double v = t.columns.at(c).points->at(i).y();
+                w.append(keys.at(c));
+                if (std::isfinite(v))
+                    appendValue(w, t.columns.at(c).type, v);
+                else
+                    w.append(QByteArrayLiteral("null"));
+            }
+            w.append(QByteArrayLiteral("}\n"));
+        }
+        stats->rows += rows;
+    }
+
+    const bool ok = w.flush();
+    stats->bytes = w.written();
+    return ok;
+}
+
+bool SeriesExporter::writeColumnar(const QList<Table> &tables, QIODevice *out, Stats *stats)
+{
+    BufferedWriter w(out);
+    w.append("HCOL", 4);
+    w.appendLE<quint16>(ColumnarVersion);
+    w.appendLE<quint16>(quint16(tables.size()));
+
+    for (const Table &t : tables) {
+        const qsizetype rows = t.rows();
+
+        // ── توصیف جدول ──
+        w.appendName(t.metric);
+        w.appendLE<quint64>(quint64(rows));
+        w.appendLE<quint16>(quint16(t.columns.size() + 1));
+        w.appendName(QByteArrayLiteral("time_ms"));
+        w.appendLE<quint8>(Int64);
+        for (const Column &c : t.columns) {
+            w.appendName(c.name);
+            w.appendLE<quint8>(c.type);
+        }
+
+        // ── ستون زمان ──
+        const QList<QPointF> &timeSource = *t.columns.first().points;
+        for (qsizetype i = 0; i < rows; ++i)
+            w.appendLE<qint64>(qint64(timeSource.at(i).x()));
+
+        // ── ستون‌های مقدار ──
+        for (const Column &c : t.columns) {
+            const QList<QPointF> &points = *c.points;
+            switch (c.type) {
+            case Int64:
+                for (qsizetype i = 0; i < rows; ++i)
+                    w.appendLE<qint64>(qint64(points.at(i).y()));
+                break;
+            case Float64:
+                for (qsizetype i = 0; i < rows; ++i)
+                    w.appendLE<double>(points.at(i).y());
+                break;
+            case UInt8:
+                for (qsizetype i = 0; i < rows; ++i)
+                    w.appendLE<quint8>(quint8(points.at(i).y()));
+                break;
+            }
+        }
+        stats->rows += rows;
+    }
+
+    const bool ok = w.flush();
+    stats->bytes = w.written();
+    return ok;
+}
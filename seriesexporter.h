@@ -0,0 +1,73 @@
+#ifndef SERIESEXPORTER_H
+#define SERIESEXPORTER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QPointF>
+#include <QString>
+
+// ── خروجی سریع برای pipeline های تحلیل داده ────────────────────
+// مستقیم از سری‌های داخل حافظه (x = زمان ms، y = مقدار) و در یک گذر
+// روی device مقصد نوشته می‌شود؛ بدون ساختن شیء برای هر سلول.
+//
+// HCOL — فایل باینری ستونی (همه‌ی اعداد little-endian):
+//   "HCOL" | u16 version | u16 tableCount
+//   هر جدول:
+//     u16 nameLen | name | u64 rowCount | u16 columnCount
+//     هر ستون: u16 nameLen | name | u8 type (Int64=1, Float64=2, UInt8=3)
+//     سپس داده‌ی ستون‌ها پشت سر هم؛ ستون اول همیشه time_ms (Int64)
+class SeriesExporter
+{
+public:
+    enum Format {
+        Xlsx     = 0,   // مسیر QXlsx در Backend
+        Csv      = 1,   // metric,time_ms,field,value
+        NdJson   = 2,   // یک شیء JSON برای هر رکورد
+        Columnar = 3    // HCOL
+    };
+
+    enum ColumnType : quint8 {
+        Int64   = 1,
+        Float64 = 2,
+        UInt8   = 3
+    };
+
+    // y هر نقطه مقدار ستون است؛ x همه‌ی ستون‌های یک جدول یکسان است
+    struct Column {
+        QByteArray             name;
+        ColumnType             type   = Float64;
+        const QList<QPointF>  *points = nullptr;
+    };
+
+    struct Table {
+        QByteArray    metric;
+        QList<Column> columns;
+        qsizetype rows() const { return columns.isEmpty() ? 0 : columns.first().points->size(); }
+    };
+
+    struct Stats {
+        int    tables    = 0;
+        qint64 rows      = 0;
+        qint64 bytes     = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    static bool write(const QList<Table> &tables, Format format, QIODevice *out,
+                      Stats *stats = nullptr, QString *error = nullptr);
+
+    static QString formatName(int format);
+    static QString fileExtension(int format);
+    static QString mimeType(int format);
+
+    static constexpr quint16 ColumnarVersion = 1;
+    // بافر نوشتن؛ وقتی پر شود یکجا به device داده می‌شود
+    static constexpr qsizetype WriteBufferSize = 64 * 1024;
+
+private:
+    static bool writeCsv(const QList<Table> &tables, QIODevice *out, Stats *stats);
+    static bool writeNdJson(const QList<Table> &tables, QIODevice *out, Stats *stats);
+    static bool writeColumnar(const QList<Table> &tables, QIODevice *out, Stats *stats);
+};
+
+#endif // SERIESEXPORTER_H
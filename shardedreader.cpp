@@ -0,0 +1,219 @@
+#include "shardedreader.h"
+#include "stagemetrics.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+QString isoUtc(qint64 ms)
+{
+    return QDateTime::fromMSecsSinceEpoch(ms).toUTC().toString(Qt::ISODateWithMs);
+}
+
+// وضعیت بدتر برنده است: Denied > Failed > Truncated > Complete
+int severity(HealthBridge::StreamStatus status)
+{
+    switch (status) {
+    case HealthBridge::StreamComplete:  return 0;
+    case HealthBridge::StreamTruncated: return 1;
+    case HealthBridge::StreamCancelled: return 2;
+    case HealthBridge::StreamFailed:    return 3;
+    case HealthBridge::StreamDenied:    return 4;
+    }
+    return 3;
+}
+
+} // namespace
+
+ShardedReader::ShardedReader(HealthBridge *bridge, int shards)
+    : m_bridge(bridge)
+    , m_shards(qMax(1, shards))
+{
+}
+
+QList<QPair<qint64, qint64>> ShardedReader::split(qint64 fromMs, qint64 toMs, int shards)
+{
+    QList<QPair<qint64, qint64>> out;
+    if (toMs <= fromMs)
+        return out;
+
+    const qint64 span  = toMs - fromMs;
+    const qint64 count = qBound<qint64>(1, span / MinShardMs, qMax(1, shards));
+    const qint64 step  = span / count;
+
+    qint64 start = fromMs;
+    for (qint64 i = 0; i < count; ++i) {
+        const qint64 end = (i == count - 1) ? toMs : start + step;
+        out.append({start, end});
+        start = end;
+    }
+    return out;
+}
+
+HealthBridge::StreamResult ShardedReader::read(int type, const QDateTime &from, const QDateTime &to,
+                                               const HealthBridge::PageCallback &onPage,
+                                               const CancelCheck &cancelled)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    HealthBridge::StreamResult total;
+    if (!m_bridge)
+        return total;
+
+    const QList<QPair<qint64, qint64>> shards =
+        split(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch(), m_shards);
+
+    // ── هر shard روی thread خودش؛ صفحه‌ها فقط در Run همان shard کپی می‌شوند ──
+    QList<Run> runs(shards.size());
+    QList<bool> done(shards.size(), false);
+    QMutex mutex;
+    QWaitCondition shardDone;
+    std::atomic_bool stop { false };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(MaxParallel);
+    QList<QFuture<void>> futures;
+    futures.reserve(shards.size());
+
+    for (qsizetype i = 0; i < shards.size(); ++i) {
+        Run *run = &runs[i];
+        const QString startIso = isoUtc(shards.at(i).first);
+        const QString endIso   = isoUtc(shards.at(i).second);
+        futures.append(QtConcurrent::run(&pool, [this, type, i, run, startIso, endIso,
+                                                 &done, &mutex, &shardDone, &stop, &cancelled]() {
+            if (stop.load() || (cancelled && cancelled())) {
+                run->result.status = HealthBridge::StreamCancelled;
+            } else {
+                run->result = m_bridge->stream(type, startIso, endIso,
+                    [run, &stop, &cancelled](const HealthBridge::Page &page) {
+                        if (stop.load() || (cancelled && cancelled()))
+                            return false;
+                        run->timesMs.append(page.timesMs, page.count);
+                        run->values.append(page.values, page.count);
+                        run->values2.append(page.values2, page.count);
+                        run->extras.append(page.extras, page.count);
+                        return true;
+                    });
+                // بدون دسترسی، بقیه‌ی shard ها هم همان جواب را می‌گیرند
+                if (run->result.status == HealthBridge::StreamDenied)
+                    stop = true;
+            }
+            QMutexLocker locker(&mutex);
+            done[i] = true;
+            shardDone.wakeAll();
+        }));
+    }
+
+    // ── تحویل به ترتیب shard: هر shard به محض تمام شدن shard های قبلی ──
+    qsizetype delivered = 0;
+    for (qsizetype i = 0; i < runs.size(); ++i) {
+        {
+            QMutexLocker locker(&mutex);
+            while (!done.at(i))
+                shardDone.wait(&mutex);
+        }
+        Run &run = runs[i];
+        if (stop.load() || (cancelled && cancelled())
+            || run.result.status == HealthBridge::StreamCancelled
+            || run.result.status == HealthBridge::StreamDenied) {
+            stop = true;
+            break;
+        }
+
+        // پنجره‌ی این shard؛ اولی و آخری هرچه بیرون از [from, to) است را هم می‌گیرند
+        qsizetype first = 0, last = 0;
+        {
+            StageMetrics::Timer mergeTimer(StageMetrics::StoreMerge, run.timesMs.size());
+            sortRun(&run);
+            const qint64 lo = (i == 0) ? std::numeric_limits<qint64>::min() : shards.at(i).first;
+            const qint64 hi = (i == shards.size() - 1) ? std::numeric_limits<qint64>::max()
+                                                       : shards.at(i).second;
+            first = std::lower_bound(run.timesMs.cbegin(), run.timesMs.cend(), lo) - run.timesMs.cbegin();
+            last  = std::lower_bound(run.timesMs.cbegin(), run.timesMs.cend(), hi) - run.timesMs.cbegin();
+        }
+
+        for (qsizetype offset = first; offset < last; offset += PageSize) {
+            HealthBridge::Page page;
+            page.type    = type;
+            page.count   = qMin<qsizetype>(PageSize, last - offset);
+            page.timesMs = run.timesMs.constData() + offset;
+            page.values  = run.values.constData() + offset;
+            page.values2 = run.values2.constData() + offset;
+            page.extras  = run.extras.constData() + offset;
+            if (!onPage(page)) {
+                stop = true;
+                break;
+            }
+        }
+        if (stop.load())
+            break;
+        delivered += last - first;
+
+        // داده‌ی تحویل‌شده آزاد می‌شود؛ وضعیت برای جمع پایانی می‌ماند
+        const HealthBridge::StreamResult result = run.result;
+        run = Run();
+        run.result = result;
+    }
+    for (QFuture<void> &f : futures)
+        f.waitForFinished();
+
+    // ── جمع وضعیت‌ها ──
+    total.status = HealthBridge::StreamComplete;
+    for (qsizetype i = 0; i < runs.size(); ++i) {
+        const HealthBridge::StreamResult &r = runs.at(i).result;
+        total.pages   += r.pages;
+        total.records += r.records;
+        if (severity(r.status) > severity(total.status)) {
+            total.status  = r.status;
+            total.message = r.message;
+        }
+    }
+    // توقف با onPage، یا لغو
+    if ((stop.load() && total.status != HealthBridge::StreamDenied) || (cancelled && cancelled()))
+        total.status = HealthBridge::StreamCancelled;
+
+    m_lastElapsedMs = timer.elapsed();
+    qDebug() << "🧩" << HealthBridge::typeName(type) << ":" << shards.size() << "shards,"
+             << delivered << "points," << total.pages << "pages,"
+             << m_lastElapsedMs << "ms";
+    return total;
+}
+
+void ShardedReader::sortRun(Run *run)
+{
+    // صفحه‌های یک shard صعودی‌اند؛ فقط نمونه‌های ضربان قلب ممکن است جابه‌جا باشند
+    if (std::is_sorted(run->timesMs.cbegin(), run->timesMs.cend()))
+        return;
+
+    QList<qsizetype> order(run->timesMs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [run](qsizetype a, qsizetype b) {
+        return run->timesMs.at(a) < run->timesMs.at(b);
+    });
+
+    Run sorted;
+    sorted.result = run->result;
+    sorted.timesMs.reserve(order.size());
+    sorted.values.reserve(order.size());
+    sorted.values2.reserve(order.size());
+    sorted.extras.reserve(order.size());
+    for (qsizetype i : std::as_const(order)) {
+        sorted.timesMs.append(run->timesMs.at(i));
+        sorted.values.append(run->values.at(i));
+        sorted.values2.append(run->values2.at(i));
+        sorted.extras.append(run->extras.at(i));
+    }
+    *run = std::move(sorted);
+}
@@ -0,0 +1,57 @@
+#ifndef SHARDEDREADER_H
+#define SHARDEDREADER_H
+
+#include <QDateTime>
+#include <QList>
+#include <functional>
+
+#include "healthbridge.h"
+
+// ── خواندن موازی بازه‌های طولانی ────────────────────────────
+// بازه به چند تکه‌ی زمانی (shard) تقسیم می‌شود. هر shard با یک
+// stream جدا روی thread خودش خوانده می‌شود، و حداکثر MaxParallel
+// shard هم‌زمان اجرا می‌شوند تا از rate limit در Health Connect رد نشود.
+// shard i به محض اینکه shard های 0..i تمام شده باشند، مرتب و در
+// صفحه‌های PageSize تایی به onPage داده می‌شود — منتظر بقیه نمی‌ماند.
+// هر shard فقط نقطه‌های پنجره‌ی زمانی خودش را تحویل می‌دهد؛ رکوردی که
+// روی مرز دو shard است از هر دو برمی‌گردد و این‌طور فقط یک بار می‌آید.
+class ShardedReader
+{
+public:
+    static constexpr int    MaxParallel  = 3;
+    static constexpr int    PageSize     = 1000;
+    // برای بازه‌های کوتاه‌تر از این، sharding فقط سربار دارد
+    static constexpr qint64 MinShardMs   = qint64(90) * 24 * 3600 * 1000;
+
+    using CancelCheck = std::function<bool()>;
+
+    explicit ShardedReader(HealthBridge *bridge, int shards = MaxParallel * 2);
+
+    // onPage روی thread صدازننده صدا زده می‌شود، نه روی thread های shard
+    HealthBridge::StreamResult read(int type, const QDateTime &from, const QDateTime &to,
+                                    const HealthBridge::PageCallback &onPage,
+                                    const CancelCheck &cancelled = {});
+
+    // [from, to) به حداکثر shards تکه‌ی هم‌اندازه، نه کوتاه‌تر از MinShardMs
+    static QList<QPair<qint64, qint64>> split(qint64 fromMs, qint64 toMs, int shards);
+
+    qint64 lastElapsedMs() const { return m_lastElapsedMs; }
+
+private:
+    // خروجی یک shard — آرایه‌های موازی، مرتب بر اساس timesMs
+    struct Run {
+        QList<qint64> timesMs;
+        QList<double> values;
+        QList<double> values2;
+        QList<int>    extras;
+        HealthBridge::StreamResult result;
+    };
+
+    static void sortRun(Run *run);
+
+    HealthBridge *m_bridge;
+    int           m_shards;
+    qint64        m_lastElapsedMs = 0;
+};
+
+#endif // SHARDEDREADER_H
@@ -0,0 +1,180 @@
+#include "stagemetrics.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtCore/qalgorithms.h>
+
+#include <cmath>
+
+// ── LatencyHistogram ─────────────────────────────────────────
+int LatencyHistogram::bucketIndex(quint64 us)
+{
+    if (us < quint64(SubBuckets))
+        return int(us);
+    const int exponent = 63 - qCountLeadingZeroBits(us);
+    if (exponent > MaxExponent)
+        return BucketCount - 1;
+    const int sub = int((us >> (exponent - SubBits)) & (SubBuckets - 1));
+    return (exponent - SubBits + 1) * SubBuckets + sub;
+}
+
+quint64 LatencyHistogram::bucketLowUs(int index)
+{
+    if (index < SubBuckets)
+        return quint64(index);
+    const int exponent = index / SubBuckets + SubBits - 1;
+    const int sub      = index % SubBuckets;
+    return quint64(SubBuckets + sub) << (exponent - SubBits);
+}
+
+void LatencyHistogram::record(qint64 us, qint64 items)
+{
+    const quint64 value = quint64(qMax<qint64>(us, 0));
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_items.fetch_add(quint64(qMax<qint64>(items, 0)), std::memory_order_relaxed);
+    m_sumUs.fetch_add(value, std::memory_order_relaxed);
+
+    quint64 max = m_maxUs.load(std::memory_order_relaxed);
+    while (value > max && !m_maxUs.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64> &bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_items.store(0, std::memory_order_relaxed);
+    m_sumUs.store(0, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::percentileUs(double q) const
+{
+    // جمع از خود bucket ها — count ممکن است هم‌زمان جلوتر رفته باشد
+    std::array<quint64, BucketCount> counts;
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, q, 1.0) * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            const quint64 low  = bucketLowUs(i);
+            const quint64 high = (i + 1 < BucketCount) ? bucketLowUs(i + 1) - 1 : low;
+            return low + (high - low) / 2;
+        }
+    }
+    return maxUs();
+}
+
+// ── StageMetrics ─────────────────────────────────────────────
+namespace {
+std::array<LatencyHistogram, StageMetrics::StageCount> s_stages;
+}
+
+void StageMetrics::record(Stage stage, qint64 us, qint64 items)
+{
+    s_stages[stage].record(us, items);
+}
+
+const LatencyHistogram &StageMetrics::histogram(Stage stage)
+{
+    return s_stages[stage];
+}
+
+StageMetrics::Summary StageMetrics::summary(Stage stage)
+{
+    const LatencyHistogram &h = s_stages[stage];
+    Summary s;
+    s.stage = stage;
+    s.count = h.count();
+    s.items = h.items();
+    s.sumUs = h.sumUs();
+    s.maxUs = h.maxUs();
+    s.p50Us = h.percentileUs(0.50);
+    s.p90Us = h.percentileUs(0.90);
+    s.p99Us = h.percentileUs(0.99);
+    return s;
+}
+
+const char *StageMetrics::stageName(Stage stage)
+{
+    switch (stage) {
+    case BridgeCall:     return "bridgeCall";
+    case Decode:         return "decode";
+    case StoreMerge:     return "storeMerge";
+    case Downsample:     return "downsample";
+    case QmlDelivery:    return "qmlDelivery";
+    case ExportRows:     return "exportRows";
+    case WriteRoundTrip: return "writeRoundTrip";
+    case StageCount:     break;
+    }
+    return "unknown";
+}
+
+void StageMetrics::reset()
+{
+    for (LatencyHistogram &h : s_stages)
+        h.reset();
+}
+
+bool StageMetrics::dump(const QString &filePath, QString *error)
+{
+    QJsonArray stages;
+    for (int i = 0; i < StageCount; ++i) {
+        const Stage stage = Stage(i);
+        const Summary s = summary(stage);
+
+        QJsonArray buckets;   // [کران پایین µs، تعداد] — فقط غیرصفرها
+        const LatencyHistogram &h = histogram(stage);
+        for (int b = 0; b < LatencyHistogram::BucketCount; ++b) {
+            if (const quint64 n = h.bucketCount(b))
+                buckets.append(QJsonArray{qint64(LatencyHistogram::bucketLowUs(b)), qint64(n)});
+        }
+
+        stages.append(QJsonObject{
+            {"stage",          QString::fromLatin1(stageName(stage))},
+            {"count",          qint64(s.count)},
+            {"items",          qint64(s.items)},
+            {"sumUs",          qint64(s.sumUs)},
+            {"meanUs",         s.meanUs()},
+            {"p50Us",          qint64(s.p50Us)},
+            {"p90Us",          qint64(s.p90Us)},
+            {"p99Us",          qint64(s.p99Us)},
+            {"p999Us",         qint64(h.percentileUs(0.999))},
+            {"maxUs",          qint64(s.maxUs)},
+            {"itemsPerSecond", s.itemsPerSecond()},
+            {"buckets",        buckets}
+        });
+    }
+
+    QJsonObject root{
+        {"savedAt",    QDateTime::currentDateTime().toString(Qt::ISODateWithMs)},
+        {"subBuckets", LatencyHistogram::SubBuckets},
+        {"stages",     stages}
+    };
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef STAGEMETRICS_H
+#define STAGEMETRICS_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <array>
+#include <atomic>
+
+// ── هیستوگرام تأخیر به سبک HDR ──────────────────────────────
+// مقدارها میکروثانیه‌اند. هر توان دو به SubBuckets بخش مساوی
+// تقسیم می‌شود، پس خطای نسبی هر bucket حداکثر 1/SubBuckets است.
+// record فقط چند fetch_add با memory_order_relaxed است — بدون قفل،
+// از هر thread.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBits     = 3;
+    static constexpr int SubBuckets  = 1 << SubBits;                 // ۸ ⇒ ~۱۲٪ دقت
+    static constexpr int MaxExponent = 39;                           // ~۶ روز
+    static constexpr int BucketCount = (MaxExponent - SubBits + 2) * SubBuckets;
+
+    void record(qint64 us, qint64 items = 1);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 items() const { return m_items.load(std::memory_order_relaxed); }
+    quint64 sumUs() const { return m_sumUs.load(std::memory_order_relaxed); }
+    quint64 maxUs() const { return m_maxUs.load(std::memory_order_relaxed); }
+    quint64 bucketCount(int index) const { return m_buckets[index].load(std::memory_order_relaxed); }
+
+    // q در [0, 1]؛ مقدار میانه‌ی bucket ی که صدک در آن است
+    quint64 percentileUs(double q) const;
+
+    static int bucketIndex(quint64 us);
+    static quint64 bucketLowUs(int index);
+
+private:
+    std::atomic<quint64> m_count { 0 };
+    std::atomic<quint64> m_items { 0 };
+    std::atomic<quint64> m_sumUs { 0 };
+    std::atomic<quint64> m_maxUs { 0 };
+    std::array<std::atomic<quint64>, BucketCount> m_buckets {};
+};
+
+// ── شمارنده‌ها و هیستوگرام هر مرحله‌ی مسیر داده ─────────────
+// همیشه روشن است (برخلاف Tracer)؛ هزینه‌ی هر نمونه چند عمل اتمی است.
+class StageMetrics
+{
+public:
+    enum Stage {
+        BridgeCall,       // یک فراخوانی HealthBridge، رفت و برگشت کامل
+        Decode,           // آرایه‌های JNI/JSON → نقاط
+        StoreMerge,       // افزودن به سری‌ها، merge ی shard ها و write های در صف
+        Downsample,       // bucket ها → سری‌های چارت
+        QmlDelivery,      // emit تا پایان handler های QML
+        ExportRows,       // یک export کامل؛ items = ردیف‌ها
+        WriteRoundTrip,   // از enqueue تا تأیید Health Connect
+        StageCount
+    };
+
+    struct Summary {
+        Stage   stage = BridgeCall;
+        quint64 count = 0;
+        quint64 items = 0;
+        quint64 sumUs = 0;
+        quint64 maxUs = 0;
+        quint64 p50Us = 0;
+        quint64 p90Us = 0;
+        quint64 p99Us = 0;
+
+        double meanUs() const { return count ? double(sumUs) / count : 0.0; }
+        // برای ExportRows همان «ردیف در ثانیه» است
+        double itemsPerSecond() const { return sumUs ? items * 1e6 / sumUs : 0.0; }
+    };
+
+    static void record(Stage stage, qint64 us, qint64 items = 1);
+    static Summary summary(Stage stage);
+    static const LatencyHistogram &histogram(Stage stage);
+    static const char *stageName(Stage stage);
+    static void reset();
+
+    // JSON: خلاصه و bucket های غیرصفر هر مرحله
+    static bool dump(const QString &filePath, QString *error = nullptr);
+
+    // زمان‌سنج محدوده‌ای: در مخرب ثبت می‌کند
+    //     StageMetrics::Timer t(StageMetrics::Decode, page.count);
+    class Timer
+    {
+    public:
+        explicit Timer(Stage stage, qint64 items = 1) : m_stage(stage), m_items(items) { m_timer.start(); }
+        ~Timer() { record(m_stage, m_timer.nsecsElapsed() / 1000, m_items); }
+        void setItems(qint64 items) { m_items = items; }
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+    private:
+        Stage         m_stage;
+        qint64        m_items;
+        QElapsedTimer m_timer;
+    };
+};
+
+#endif // STAGEMETRICS_H
@@ -0,0 +1,199 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+namespace {
+
+struct Event {
+    char        phase;      // X = کامل، i = لحظه‌ای، M = metadata (نام thread)
+    const char *category;
+    QString     name;
+    qint64      tsUs;
+    qint64      durUs;
+    int         tid;
+    QVariantMap args;
+};
+
+const QElapsedTimer &clock()
+{
+    static const QElapsedTimer timer = [] { QElapsedTimer t; t.start(); return t; }();
+    return timer;
+}
+// ساعت هنگام بارگذاری برنامه شروع می‌شود، نه با اولین span
+[[maybe_unused]] const bool s_clockStarted = (clock(), true);
+
+QMutex        s_mutex;
+QList<Event>  s_events;
+QString       s_outputDir;
+qint64        s_dropped = 0;
+std::atomic<int> s_nextTid { 0 };
+thread_local int t_tid = 0;
+
+// شماره‌ی کوچک و پایدار برای هر thread؛ نام آن یک بار به‌صورت metadata ثبت می‌شود
+int currentTid()
+{
+    if (t_tid != 0)
+        return t_tid;
+    t_tid = ++s_nextTid;
+
+    QThread *thread = QThread::currentThread();
+    QString name = thread ? thread->objectName() : QString();
+    if (name.isEmpty())
+        // قبل از ساخت QApplication فقط main در حال اجراست
+        name = (!QCoreApplication::instance() || thread == QCoreApplication::instance()->thread())
+               ? QStringLiteral("main") : QStringLiteral("worker-%1").arg(t_tid);
+
+    QMutexLocker lock(&s_mutex);
+    s_events.append({'M', "__metadata", QStringLiteral("thread_name"), 0, 0, t_tid,
+                     {{"name", name}}});
+    return t_tid;
+}
+
+void record(Event &&event)
+{
+    QMutexLocker lock(&s_mutex);
+    if (s_events.size() >= Tracer::MaxEvents) {
+        ++s_dropped;
+        return;
+    }
+    s_events.append(std::move(event));
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled { qEnvironmentVariableIntValue("QMLHC_TRACE") > 0 };
+
+void Tracer::setEnabled(bool on)
+{
+    s_enabled.store(on, std::memory_order_relaxed);
+}
+
+void Tracer::setOutputDir(const QString &dir)
+{
+    QMutexLocker lock(&s_mutex);
+    s_outputDir = dir;
+}
+
+QString Tracer::outputPath()
+{
+    QMutexLocker lock(&s_mutex);
+    return s_outputDir.isEmpty() ? QString() : QDir(s_outputDir).filePath("trace.json");
+}
+
+qint64 Tracer::nowUs()
+{
+    return clock().nsecsElapsed() / 1000;
+}
+
+void Tracer::complete(const char *category, const QString &name,
+                      qint64 startUs, qint64 durationUs, const QVariantMap &args)
+{
+    if (!enabled())
+        return;
+    record({'X', category, name, startUs, durationUs, currentTid(), args});
+}
+
+void Tracer::instant(const char *category, const QString &name, const QVariantMap &args)
+{
+    if (!enabled())
+        return;
+    record({'i', category, name, nowUs(), 0, currentTid(), args});
+}
+
+bool Tracer::flush(QString *error)
+{
+    const QString filePath = outputPath();
+    if (!enabled() || filePath.isEmpty())
+        return false;
+
+    QList<Event> events;
+    qint64 dropped = 0;
+    {
+        QMutexLocker lock(&s_mutex);
+        events  = s_events;   // implicitly shared — serialize بیرون از قفل
+        dropped = s_dropped;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const Event &e : events) {
+        QJsonObject obj{
+            {"name", e.name},
+            {"cat",  QString::fromLatin1(e.category)},
+            {"ph",   QString(QChar::fromLatin1(e.phase))},
+            {"ts",   e.tsUs},
+            {"pid",  pid},
+            {"tid",  e.tid}
+        };
+        if (e.phase == 'X')
+            obj["dur"] = e.durUs;
+        else if (e.phase == 'i')
+            obj["s"] = "t";
+        if (!e.args.isEmpty())
+            obj["args"] = QJsonObject::fromVariantMap(e.args);
+        traceEvents.append(obj);
+    }
+
+    QJsonObject root{
+        {"traceEvents",     traceEvents},
+        {"displayTimeUnit", "ms"},
+        {"otherData",       QJsonObject{{"droppedEvents", dropped}}}
+    };
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ── TraceSpan ────────────────────────────────────────────────
+TraceSpan::TraceSpan(const char *category, const char *name)
+    : m_category(category)
+    , m_literal(name)
+{
+    if (Tracer::enabled())
+        m_startUs = Tracer::nowUs();
+}
+
+TraceSpan::TraceSpan(const char *category, const QString &name)
+    : m_category(category)
+{
+    if (Tracer::enabled()) {
+        m_name    = name;
+        m_startUs = Tracer::nowUs();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_startUs < 0)
+        return;
+    const qint64 endUs = Tracer::nowUs();
+    Tracer::complete(m_category, m_literal ? QString::fromLatin1(m_literal) : m_name,
+                     m_startUs, endUs - m_startUs, m_args);
+}
+
+void TraceSpan::arg(const char *key, const QVariant &value)
+{
+    if (m_startUs >= 0)
+        m_args.insert(QString::fromLatin1(key), value);
+}
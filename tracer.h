@@ -0,0 +1,63 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+
+// ── ردیابی زمان راه‌اندازی و refresh ─────────────────────────
+// خروجی: JSON با قالب Chrome trace-event در path/trace.json — در
+// chrome://tracing یا ui.perfetto.dev باز می‌شود.
+// پیش‌فرض خاموش است؛ با متغیر محیطی QMLHC_TRACE=1 یا تنظیم
+// "debug/trace" روشن می‌شود. وقتی خاموش است هر span فقط یک load اتمی است.
+class Tracer
+{
+public:
+    static constexpr int MaxEvents = 200000;   // بعد از آن رویدادها دور ریخته می‌شوند
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static void setOutputDir(const QString &dir);
+    static QString outputPath();
+
+    // میکروثانیه از شروع برنامه
+    static qint64 nowUs();
+
+    // رویداد کامل (ph = "X") — برای span هایی که شروعشان جای دیگری ثبت شده (QML)
+    static void complete(const char *category, const QString &name,
+                         qint64 startUs, qint64 durationUs, const QVariantMap &args = {});
+    // رویداد لحظه‌ای (ph = "i")، مثلاً اولین فریم
+    static void instant(const char *category, const QString &name, const QVariantMap &args = {});
+
+    // همه‌ی رویدادهای تا الان را در outputPath() می‌نویسد؛ بافر خالی نمی‌شود
+    static bool flush(QString *error = nullptr);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// span محدوده‌ای: از سازنده تا مخرب
+//     TraceSpan span("jni", "stream");
+//     span.arg("records", n);
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name);
+    TraceSpan(const char *category, const QString &name);
+    ~TraceSpan();
+
+    void arg(const char *key, const QVariant &value);
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_literal = nullptr;
+    QString     m_name;
+    qint64      m_startUs = -1;   // -1 یعنی tracer موقع ساخت خاموش بود
+    QVariantMap m_args;
+};
+
+#endif // TRACER_H
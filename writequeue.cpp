@@ -0,0 +1,270 @@
+#include "writequeue.h"
+#include "stagemetrics.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// مقادیر Backend::WriteStatus — این فایل به backend.h وابسته نیست
+namespace {
+constexpr int StatusOk      = 0;
+constexpr int StatusInvalid = 1;
+constexpr int StatusDenied  = 3;
+}
+
+WriteQueue::WriteQueue(const QString &journalPath, BatchWriter writer, QObject *parent)
+    : QObject(parent)
+    , m_journalPath(journalPath)
+    , m_writer(std::move(writer))
+    , m_timer(this)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &WriteQueue::flush);
+
+    loadJournal();
+}
+
+void WriteQueue::start()
+{
+    const int count = pendingCount();
+    emit pendingCountChanged(count);
+    if (count > 0) {
+        qDebug() << "📝 Write journal: replaying" << count << "pending measurement(s)";
+        scheduleFlush();
+    }
+}
+
+bool WriteQueue::enqueue(const HealthMeasurement &m)
+{
+    int count = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        Entry e;
+        e.id         = m_nextId++;
+        e.m          = m;
+        e.queuedAtMs = QDateTime::currentMSecsSinceEpoch();
+        if (!appendToJournal(e))
+            return false;
+        m_entries.append(e);
+        count = int(m_entries.size());
+    }
+
+    emit pendingCountChanged(count);
+    QMetaObject::invokeMethod(this, &WriteQueue::scheduleFlush, Qt::QueuedConnection);
+    return true;
+}
+
+QList<HealthMeasurement> WriteQueue::pending() const
+{
+    QMutexLocker lock(&m_mutex);
+    QList<HealthMeasurement> out;
+    out.reserve(m_entries.size());
+    for (const Entry &e : m_entries)
+        out.append(e.m);
+    return out;
+}
+
+int WriteQueue::pendingCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return int(m_entries.size());
+}
+
+void WriteQueue::scheduleFlush()
+{
+    // در حال backoff زودتر امتحان نمی‌کنیم؛ در غیر این صورت
+    // اندازه‌گیری‌های پشت سر هم در یک دسته جمع می‌شوند
+    if (m_timer.isActive())
+        return;
+    m_timer.start(m_backoffMs > 0 ? m_backoffMs : CoalesceMs);
+}
+
+void WriteQueue::flush()
+{
+    QList<Entry> batch;
+    {
+        QMutexLocker lock(&m_mutex);
+        batch = m_entries.mid(0, MaxBatch);
+    }
+    if (batch.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<HealthMeasurement> items;
+    items.reserve(batch.size());
+    for (const Entry &e : batch)
+        items.append(e.m);
+
+    const QList<int> status = m_writer(items);
+
+    // ── حذف آیتم‌های تمام‌شده از صف و journal ──
+    QSet<quint64> done;
+    int inserted = 0, rejected = 0, denied = 0, failed = 0;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (qsizetype k = 0; k < batch.size(); ++k) {
+        const int s = status.value(k, -1);
+        if (s == StatusOk) {
+            done.insert(batch.at(k).id);
+            ++inserted;
+            StageMetrics::record(StageMetrics::WriteRoundTrip, (nowMs - batch.at(k).queuedAtMs) * 1000);
+        } else if (s == StatusInvalid) {
+            done.insert(batch.at(k).id);
+            ++rejected;
+        } else if (s == StatusDenied) {
+            ++denied;
+        } else {
+            ++failed;
+        }
+    }
+
+    int remaining = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!done.isEmpty()) {
+            m_entries.removeIf([&done](const Entry &e) { return done.contains(e.id); });
+            if (!rewriteJournal())
+                qWarning() << "❌ Cannot rewrite write journal:" << m_journalPath;
+        }
+        remaining = int(m_entries.size());
+    }
+
+    qDebug() << "📝 Write queue flush:" << inserted << "inserted," << rejected << "rejected,"
+             << (denied + failed) << "deferred," << remaining << "pending,"
+             << timer.elapsed() << "ms";
+
+    if (!done.isEmpty())
+        emit pendingCountChanged(remaining);
+    if (inserted > 0)
+        emit flushed(inserted, remaining);
+    if (rejected > 0)
+        emit writeRejected(rejected, QString("%1 اندازه‌گیری توسط Health Connect رد شد").arg(rejected));
+
+    if (denied + failed > 0) {
+        // ── backoff نمایی: 1s, 2s, 4s ... تا MaxBackoffMs ──
+        m_backoffMs = m_backoffMs > 0 ? qMin(m_backoffMs * 2, MaxBackoffMs) : InitialBackoffMs;
+        emit writeDeferred(denied + failed, m_backoffMs);
+        m_timer.start(m_backoffMs);
+        return;
+    }
+
+    m_backoffMs = 0;
+    if (remaining > 0)
+        m_timer.start(0);   // بیشتر از MaxBatch در صف بود
+}
+
+// ─────────────────────────────────────────────────────────────
+// journal
+// ─────────────────────────────────────────────────────────────
+QByteArray WriteQueue::encode(const Entry &e)
+{
+    QJsonObject o;
+    o["id"]      = qint64(e.id);
+    o["type"]    = int(e.m.type);
+    o["time_ms"] = e.m.time.toMSecsSinceEpoch();
+    o["value"]   = e.m.value;
+    o["value2"]  = e.m.value2;
+    // مثل writeBatch: specimen | meal<<8 | relation<<16
+    o["extras"]  = (e.m.specimenSource & 0xFF)
+                  | ((e.m.mealType & 0xFF) << 8)
+                  | ((e.m.relationToMeal & 0xFF) << 16);
+    return QJsonDocument(o).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool WriteQueue::decode(const QByteArray &line, Entry *e)
+{
+    QJsonParseError err;
+    const QJsonObject o = QJsonDocument::fromJson(line, &err).object();
+    if (err.error != QJsonParseError::NoError || !o.contains("time_ms"))
+        return false;
+
+    const int extras = o["extras"].toInt();
+    e->id                = quint64(o["id"].toInteger());
+    e->m.type            = HealthMeasurement::Type(o["type"].toInt());
+    e->m.time            = QDateTime::fromMSecsSinceEpoch(o["time_ms"].toInteger());
+    e->m.value           = o["value"].toDouble();
+    e->m.value2          = o["value2"].toDouble();
+    e->m.specimenSource  = extras & 0xFF;
+    e->m.mealType        = (extras >> 8) & 0xFF;
+    e->m.relationToMeal  = (extras >> 16) & 0xFF;
+    return true;
+}
+
+void WriteQueue::loadJournal()
+{
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    // زمان واقعی enqueue ی اجرای قبلی معلوم نیست — از بارگذاری حساب می‌شود
+    const qint64 loadedAtMs = QDateTime::currentMSecsSinceEpoch();
+    int corrupt = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        Entry e;
+        // سطر نیمه‌کاره (قطع برق وسط append) نادیده گرفته می‌شود
+        if (!decode(line, &e) || !e.m.validate().isEmpty()) {
+            ++corrupt;
+            continue;
+        }
+        e.queuedAtMs = loadedAtMs;
+        m_entries.append(e);
+        m_nextId = qMax(m_nextId, e.id + 1);
+    }
+    file.close();
+
+    if (corrupt > 0) {
+        qWarning() << "⚠️ Write journal: skipped" << corrupt << "unreadable line(s)";
+        rewriteJournal();
+    }
+}
+
+bool WriteQueue::appendToJournal(const Entry &e)
+{
+    QDir().mkpath(QFileInfo(m_journalPath).absolutePath());
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "❌ Cannot open write journal:" << m_journalPath << file.errorString();
+        return false;
+    }
+
+    const QByteArray line = encode(e);
+    if (file.write(line) != line.size() || !file.flush()) {
+        qWarning() << "❌ Cannot append to write journal:" << file.errorString();
+        return false;
+    }
+#ifdef Q_OS_UNIX
+    // تا اینجا برنگشته‌ایم مگر اینکه سطر واقعاً روی دیسک باشد
+    ::fsync(file.handle());
+#endif
+    return true;
+}
+
+bool WriteQueue::rewriteJournal()
+{
+    if (m_entries.isEmpty())
+        return !QFile::exists(m_journalPath) || QFile::remove(m_journalPath);
+
+    QSaveFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    for (const Entry &e : std::as_const(m_entries))
+        file.write(encode(e));
+    return file.commit();
+}
@@ -0,0 +1,83 @@
+#ifndef WRITEQUEUE_H
+#define WRITEQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+#include "healthmeasurement.h"
+
+// ── صف write-behind با journal روی دیسک ─────────────────────
+// write* ها فقط اندازه‌گیری را به journal اضافه می‌کنند (append + fsync)
+// و فوراً برمی‌گردند. روی thread خود صف، اندازه‌گیری‌هایی که در
+// CoalesceMs پشت سر هم آمده‌اند یکجا به writer داده می‌شوند؛
+// شکست/عدم دسترسی با backoff نمایی دوباره امتحان می‌شود و
+// journal بعد از هر flush بازنویسی می‌شود. با اجرای دوباره‌ی برنامه،
+// آنچه در journal مانده دوباره در صف قرار می‌گیرد.
+//
+// journal: هر سطر یک شیء JSON
+//   {"id":..,"type":..,"time_ms":..,"value":..,"value2":..,"extras":..}
+class WriteQueue : public QObject
+{
+    Q_OBJECT
+public:
+    // همان امضای HealthImporter::BatchWriter — خروجی: Backend::WriteStatus
+    using BatchWriter = std::function<QList<int>(const QList<HealthMeasurement> &)>;
+
+    static constexpr int CoalesceMs       = 300;
+    static constexpr int MaxBatch         = 500;
+    static constexpr int InitialBackoffMs = 1000;
+    static constexpr int MaxBackoffMs     = 60 * 1000;
+
+    WriteQueue(const QString &journalPath, BatchWriter writer, QObject *parent = nullptr);
+
+    // از هر thread قابل صدا زدن است؛ false فقط اگر journal نوشته نشود
+    bool enqueue(const HealthMeasurement &m);
+
+    // کپی اندازه‌گیری‌هایی که هنوز در Health Connect نیستند
+    QList<HealthMeasurement> pending() const;
+    int pendingCount() const;
+
+public slots:
+    // بعد از moveToThread صدا زده شود — باقی‌مانده‌ی journal را می‌فرستد
+    void start();
+
+signals:
+    void pendingCountChanged(int count);
+    void flushed(int inserted, int remaining);
+    // آیتم‌هایی که Health Connect رد کرده و دوباره امتحان نمی‌شوند
+    void writeRejected(int count, QString message);
+    // نوشتن موقتاً ناموفق؛ retryInMs بعد دوباره امتحان می‌شود
+    void writeDeferred(int count, int retryInMs);
+
+private slots:
+    void scheduleFlush();
+    void flush();
+
+private:
+    struct Entry {
+        quint64           id = 0;
+        HealthMeasurement m;
+        qint64            queuedAtMs = 0;   // برای WriteRoundTrip؛ در journal نیست
+    };
+
+    void loadJournal();
+    bool appendToJournal(const Entry &e);
+    bool rewriteJournal();
+    static QByteArray encode(const Entry &e);
+    static bool decode(const QByteArray &line, Entry *e);
+
+    QString     m_journalPath;
+    BatchWriter m_writer;
+    QTimer      m_timer;
+
+    mutable QMutex m_mutex;          // m_entries، m_nextId و فایل journal
+    QList<Entry>   m_entries;
+    quint64        m_nextId    = 1;
+    int            m_backoffMs = 0;  // فقط روی thread صف
+};
+
+#endif // WRITEQUEUE_H
@@ -0,0 +1,353 @@
+#include "ziprepacker.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtEndian>
+
+#include <zlib.h>
+
+namespace {
+
+// ── ثابت‌های فرمت ZIP (APPNOTE.TXT) ───────────────────────────
+constexpr quint32 LocalHeaderSig   = 0x04034b50;
+constexpr quint32 CentralHeaderSig = 0x02014b50;
+constexpr quint32 EndOfCentralSig  = 0x06054b50;
+constexpr quint16 FlagUtf8Name     = 0x0800;
+constexpr quint16 MethodStored     = 0;
+constexpr quint16 MethodDeflated   = 8;
+constexpr int     DictionarySize   = 32 * 1024;
+
+quint16 readLE16(const char *p) { return qFromLittleEndian<quint16>(p); }
+quint32 readLE32(const char *p) { return qFromLittleEndian<quint32>(p); }
+
+void appendLE16(QByteArray &b, quint16 v)
+{
+    char tmp[2];
+    qToLittleEndian<quint16>(v, tmp);
+    b.append(tmp, 2);
+}
+
+void appendLE32(QByteArray &b, quint32 v)
+{
+    char tmp[4];
+    qToLittleEndian<quint32>(v, tmp);
+    b.append(tmp, 4);
+}
+
+struct ZipEntry {
+    QByteArray name;
+    quint16    flags   = 0;
+    quint16    method  = 0;
+    quint16    modTime = 0;
+    quint16    modDate = 0;
+    quint32    crc     = 0;
+    quint32    compressedSize   = 0;
+    quint32    uncompressedSize = 0;
+    quint32    localOffset      = 0;
+};
+
+int levelFor(ZipRepacker::Compression mode)
+{
+    switch (mode) {
+    case ZipRepacker::Fast:            return Z_BEST_SPEED;
+    case ZipRepacker::Maximum:
+    case ZipRepacker::ParallelMaximum: return Z_BEST_COMPRESSION;
+    case ZipRepacker::Store:           break;
+    }
+    return Z_NO_COMPRESSION;
+}
+
+} // namespace
+
+QString ZipRepacker::compressionName(int mode)
+{
+    switch (mode) {
+    case Store:           return QStringLiteral("store");
+    case Fast:            return QStringLiteral("fast");
+    case Maximum:         return QStringLiteral("maximum");
+    case ParallelMaximum: return QStringLiteral("parallel");
+    }
+    return QStringLiteral("unknown");
+}
+
+bool ZipRepacker::repack(const QByteArray &zipData, QIODevice *out,
+                         Compression mode, Stats *stats, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto fail = [error](const QString &msg) {
+        qWarning() << "❌ ZipRepacker:" << msg;
+        if (error) *error = msg;
+        return false;
+    };
+
+    const char     *base = zipData.constData();
+    const qsizetype size = zipData.size();
+
+    // ── پیدا کردن End Of Central Directory از انتهای فایل ──────
+    qsizetype eocd = -1;
+    for (qsizetype i = size - 22; i >= 0 && i >= size - 22 - 0xFFFF; --i) {
+        if (readLE32(base + i) == EndOfCentralSig) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd < 0)
+        return fail("end of central directory not found");
+
+    const quint16 entryCount = readLE16(base + eocd + 10);
+    const quint32 cdOffset   = readLE32(base + eocd + 16);
+
+    // ── خواندن Central Directory ─────────────────────────────────
+    QList<ZipEntry> entries;
+    entries.reserve(entryCount);
+
+    qsizetype pos = cdOffset;
+    for (int i = 0; i < entryCount; ++i) {
+        if (pos + 46 > size || readLE32(base + pos) != CentralHeaderSig)
+            return fail(QString("bad central header #%1").arg(i));
+
+        ZipEntry e;
+        e.flags            = readLE16(base + pos + 8);
+        e.method           = readLE16(base + pos + 10);
+        e.modTime          = readLE16(base + pos + 12);
+        e.modDate          = readLE16(base + pos + 14);
+        e.crc              = readLE32(base + pos + 16);
+        e.compressedSize   = readLE32(base + pos + 20);
+        e.uncompressedSize = readLE32(base + pos + 24);
+        const quint16 nameLen    = readLE16(base + pos + 28);
+        const quint16 extraLen   = readLE16(base + pos + 30);
+        const quint16 commentLen = readLE16(base + pos + 32);
+        e.localOffset      = readLE32(base + pos + 42);
+        e.name             = QByteArray(base + pos + 46, nameLen);
+
+        entries.append(e);
+        pos += 46 + nameLen + extraLen + commentLen;
+    }
+
+    // ── بازنویسی entry ها ─────────────────────────────────────────
+    Stats st;
+    st.inputBytes = size;
+    st.entries    = entries.size();
+
+    const int level = levelFor(mode);
+    QByteArray centralDir;
+    quint32    written = 0;
+
+    for (const ZipEntry &src : entries) {
+        const qsizetype lh = src.localOffset;
+        if (lh + 30 > size || readLE32(base + lh) != LocalHeaderSig)
+            return fail("bad local header: " + QString::fromUtf8(src.name));
+
+        const qsizetype dataStart = lh + 30 + readLE16(base + lh + 26) + readLE16(base + lh + 28);
+        if (dataStart + src.compressedSize > size)
+            return fail("truncated entry: " + QString::fromUtf8(src.name));
+
+        // ── داده‌ی خام (غیرفشرده) ──
+        QByteArray raw;
+        if (src.method == MethodStored) {
+            raw = QByteArray(base + dataStart, src.compressedSize);
+        } else if (src.method == MethodDeflated) {
+            if (!inflateRaw(base + dataStart, src.compressedSize, src.uncompressedSize, &raw))
+                return fail("inflate failed: " + QString::fromUtf8(src.name));
+        } else {
+            return fail(QString("unsupported method %1").arg(src.method));
+        }
+        st.uncompressedBytes += raw.size();
+
+        // ── فشرده‌سازی با حالت انتخابی ──
+        ZipEntry dst = src;
+        dst.flags = src.flags & FlagUtf8Name;   // data descriptor نداریم
+        dst.uncompressedSize = static_cast<quint32>(raw.size());
+
+        QByteArray payload;
+        if (mode == Store) {
+            dst.method = MethodStored;
+            dst.crc    = static_cast<quint32>(crc32(0L, reinterpret_cast<const Bytef *>(raw.constData()),
+                                                    static_cast<uInt>(raw.size())));
+            payload    = raw;
+        } else {
+            dst.method = MethodDeflated;
+            bool ok;
+            if (mode == ParallelMaximum && raw.size() >= 2 * ParallelChunkSize) {
+                ok = deflateParallel(raw, level, &payload, &dst.crc);
+            } else {
+                dst.crc = static_cast<quint32>(crc32(0L, reinterpret_cast<const Bytef *>(raw.constData()),
+                                                     static_cast<uInt>(raw.size())));
+                ok = deflateRaw(raw, level, &payload);
+            }
+            if (!ok)
+                return fail("deflate failed: " + QString::fromUtf8(src.name));
+        }
+        dst.compressedSize = static_cast<quint32>(payload.size());
+        dst.localOffset    = written;
+
+        // ── Local File Header ──
+        QByteArray header;
+        header.reserve(30 + dst.name.size());
+        appendLE32(header, LocalHeaderSig);
+        appendLE16(header, 20);                  // version needed
+        appendLE16(header, dst.flags);
+        appendLE16(header, dst.method);
+        appendLE16(header, dst.modTime);
+        appendLE16(header, dst.modDate);
+        appendLE32(header, dst.crc);
+        appendLE32(header, dst.compressedSize);
+        appendLE32(header, dst.uncompressedSize);
+        appendLE16(header, static_cast<quint16>(dst.name.size()));
+        appendLE16(header, 0);                   // extra length
+        header.append(dst.name);
+
+        if (out->write(header) != header.size() || out->write(payload) != payload.size())
+            return fail("write failed: " + out->errorString());
+
+        const quint64 next = quint64(written) + header.size() + payload.size();
+        if (next > 0xFFFFFFFFull)
+            return fail("package exceeds 4 GiB (zip64 not supported)");
+        written = static_cast<quint32>(next);
+
+        // ── Central Directory Header ──
+        appendLE32(centralDir, CentralHeaderSig);
+        appendLE16(centralDir, 20);              // version made by
+        appendLE16(centralDir, 20);              // version needed
+        appendLE16(centralDir, dst.flags);
+        appendLE16(centralDir, dst.method);
+        appendLE16(centralDir, dst.modTime);
+        appendLE16(centralDir, dst.modDate);
+        appendLE32(centralDir, dst.crc);
+        appendLE32(centralDir, dst.compressedSize);
+        appendLE32(centralDir, dst.uncompressedSize);
+        appendLE16(centralDir, static_cast<quint16>(dst.name.size()));
+        appendLE16(centralDir, 0);               // extra length
+        appendLE16(centralDir, 0);               // comment length
+        appendLE16(centralDir, 0);               // disk number
+        appendLE16(centralDir, 0);               // internal attributes
+        appendLE32(centralDir, 0);               // external attributes
+        appendLE32(centralDir, dst.localOffset);
+        centralDir.append(dst.name);
+    }
+
+    // ── End Of Central Directory ──
+    QByteArray tail = centralDir;
+    appendLE32(tail, EndOfCentralSig);
+    appendLE16(tail, 0);
+    appendLE16(tail, 0);
+    appendLE16(tail, static_cast<quint16>(entries.size()));
+    appendLE16(tail, static_cast<quint16>(entries.size()));
+    appendLE32(tail, static_cast<quint32>(centralDir.size()));
+    appendLE32(tail, written);
+    appendLE16(tail, 0);
+
+    if (out->write(tail) != tail.size())
+        return fail("write failed: " + out->errorString());
+
+    st.outputBytes = qint64(written) + tail.size();
+    st.elapsedMs   = timer.elapsed();
+    if (stats) *stats = st;
+    return true;
+}
+
+bool ZipRepacker::inflateRaw(const char *data, qsizetype size,
+                             qsizetype expectedSize, QByteArray *out)
+{
+    z_stream zs = {};
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+        return false;
+
+    out->resize(expectedSize);
+    zs.next_in   = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    zs.avail_in  = static_cast<uInt>(size);
+    zs.next_out  = reinterpret_cast<Bytef *>(out->data());
+    zs.avail_out = static_cast<uInt>(expectedSize);
+
+    const int ret = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END && qsizetype(zs.total_out) == expectedSize;
+}
+
+bool ZipRepacker::deflateRaw(const QByteArray &data, int level, QByteArray *out)
+{
+    z_stream zs = {};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    out->resize(deflateBound(&zs, static_cast<uLong>(data.size())));
+    zs.next_in   = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    zs.avail_in  = static_cast<uInt>(data.size());
+    zs.next_out  = reinterpret_cast<Bytef *>(out->data());
+    zs.avail_out = static_cast<uInt>(out->size());
+
+    const int ret = deflate(&zs, Z_FINISH);
+    out->resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+// ── deflate موازی به سبک pigz ────────────────────────────────────
+// هر تکه یک جریان raw deflate جداگانه است که با Z_SYNC_FLUSH روی مرز
+// بایت تمام می‌شود (فقط تکه‌ی آخر BFINAL دارد)، پس الحاق آن‌ها یک جریان
+// deflate معتبر می‌سازد. ۳۲KB انتهای تکه‌ی قبلی به‌عنوان dictionary
+// داده می‌شود تا نسبت فشرده‌سازی نزدیک حالت تک‌رشته‌ای بماند.
+bool ZipRepacker::deflateParallel(const QByteArray &data, int level,
+                                  QByteArray *out, quint32 *crc)
+{
+    struct Chunk {
+        qsizetype  offset = 0;
+        qsizetype  length = 0;
+        bool       last   = false;
+        QByteArray compressed;
+        uLong      crc    = 0;
+        bool       ok     = false;
+    };
+
+    QList<Chunk> chunks;
+    for (qsizetype off = 0; off < data.size(); off += ParallelChunkSize) {
+        Chunk c;
+        c.offset = off;
+        c.length = qMin(ParallelChunkSize, data.size() - off);
+        c.last   = (off + c.length) >= data.size();
+        chunks.append(c);
+    }
+
+    const Bytef *src = reinterpret_cast<const Bytef *>(data.constData());
+
+    QtConcurrent::blockingMap(chunks, [src, level](Chunk &c) {
+        c.crc = crc32(0L, src + c.offset, static_cast<uInt>(c.length));
+
+        z_stream zs = {};
+        if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+
+        if (c.offset > 0) {
+            const qsizetype dictLen = qMin<qsizetype>(DictionarySize, c.offset);
+            deflateSetDictionary(&zs, src + c.offset - dictLen, static_cast<uInt>(dictLen));
+        }
+
+        // deflateBound برای Z_FINISH است؛ چند بایت برای بلوک خالی sync flush
+        c.compressed.resize(deflateBound(&zs, static_cast<uLong>(c.length)) + 16);
+        zs.next_in   = const_cast<Bytef *>(src + c.offset);
+        zs.avail_in  = static_cast<uInt>(c.length);
+        zs.next_out  = reinterpret_cast<Bytef *>(c.compressed.data());
+        zs.avail_out = static_cast<uInt>(c.compressed.size());
+
+        const int ret = deflate(&zs, c.last ? Z_FINISH : Z_SYNC_FLUSH);
+        c.ok = c.last ? (ret == Z_STREAM_END) : (ret == Z_OK && zs.avail_in == 0);
+        c.compressed.resize(zs.total_out);
+        deflateEnd(&zs);
+    });
+
+    out->clear();
+    uLong combined = 0;
+    for (const Chunk &c : std::as_const(chunks)) {
+        if (!c.ok)
+            return false;
+        out->append(c.compressed);
+        combined = (c.offset == 0) ? c.crc
+                                   : crc32_combine(combined, c.crc, static_cast<z_off_t>(c.length));
+    }
+    *crc = static_cast<quint32>(combined);
+    return true;
+}
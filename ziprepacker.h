@@ -0,0 +1,47 @@
+#ifndef ZIPREPACKER_H
+#define ZIPREPACKER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+// ── بازنویسی ظرف ZIP فایل xlsx با سطح فشرده‌سازی دلخواه ─────────
+// QXlsx همیشه با سطح پیش‌فرض deflate می‌کند و تنظیمی برای آن ندارد؛
+// اینجا بسته‌ی ذخیره‌شده در حافظه را entry به entry باز می‌کنیم و
+// با حالت انتخاب‌شده دوباره روی device مقصد می‌نویسیم.
+class ZipRepacker
+{
+public:
+    enum Compression {
+        Store           = 0,   // بدون فشرده‌سازی (method 0)
+        Fast            = 1,   // deflate سطح 1
+        Maximum         = 2,   // deflate سطح 9
+        ParallelMaximum = 3    // deflate سطح 9 — تکه‌تکه روی چند هسته
+    };
+
+    struct Stats {
+        int    entries           = 0;
+        qint64 inputBytes        = 0;   // حجم بسته‌ی QXlsx
+        qint64 uncompressedBytes = 0;   // مجموع XML ها
+        qint64 outputBytes       = 0;   // حجم نهایی
+        qint64 elapsedMs         = 0;
+    };
+
+    static bool repack(const QByteArray &zipData, QIODevice *out,
+                       Compression mode, Stats *stats = nullptr,
+                       QString *error = nullptr);
+
+    static QString compressionName(int mode);
+
+    // تکه‌های ورودی در حالت موازی؛ entry های کوچک‌تر از دو تکه یکجا فشرده می‌شوند
+    static constexpr qsizetype ParallelChunkSize = 128 * 1024;
+
+private:
+    static bool inflateRaw(const char *data, qsizetype size,
+                           qsizetype expectedSize, QByteArray *out);
+    static bool deflateRaw(const QByteArray &data, int level, QByteArray *out);
+    static bool deflateParallel(const QByteArray &data, int level,
+                                QByteArray *out, quint32 *crc);
+};
+
+#endif // ZIPREPACKER_H